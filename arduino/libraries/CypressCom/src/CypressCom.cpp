@@ -27,13 +27,14 @@ CypressCom::CypressCom() {}
 /// @return Last address found
 uint8_t CypressCom::i2cScan()
 {
+	DB_PROFILE_SCOPE(GateProfile::PS::I2C_SCAN);
+
 	uint8_t address;
 	uint8_t resp;
 	uint8_t cnt_addr = 0;
 	uint8_t cnt_err = 0;
 	uint8_t list_addr[128] = {0};
 	uint8_t list_addr_with_err[128] = {0};
-	uint8_t list__err_code[128] = {0};
 
 	// Loop and test all 128 possible addresses
 	for (address = 0; address < 127; address++)
@@ -44,6 +45,7 @@ uint8_t CypressCom::i2cScan()
 		// Test address
 		_beginTransmissionWrapper(address);
 		resp = _endTransmissionWrapper(true, false);
+		_pushTrace(0, TR_PROBE, 0, resp);
 
 		// Handle response
 		if (resp == 0)
@@ -57,36 +59,36 @@ uint8_t CypressCom::i2cScan()
 			cnt_err++;
 
 			// Print unknown error code immediately
-			_Dbg.printMsg(_Dbg.MT::WARNING, "I2C Error[%d] Address[%s] DT[%s]", resp, _Dbg.hexStr(address), _Dbg.dtTrack());
+			DB_PRINT_MSG(_Dbg, _Dbg.MT::WARNING, "I2C Error[%d] Address[%s] DT[%s]", resp, _Dbg.hexStr(address), _Dbg.dtTrack());
 		}
 	}
 
 	// Store and print results
 	if (cnt_addr > 0)
 	{
-		_Dbg.printMsg(_Dbg.MT::INFO, "I2C Devices Found:");
+		DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "I2C Devices Found:");
 		for (size_t i = 0; i < cnt_addr; i++)
 		{ // print devices
-			_Dbg.printMsg(_Dbg.MT::INFO, "\t%d) %s", i, _Dbg.hexStr(list_addr[i]));
+			DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "\t%d) %s", i, _Dbg.hexStr(list_addr[i]));
 		}
 
-		// Store first 9 addresses
-		for (size_t i = 0; i < 9; i++)
+		// Store first CYP_MAX_ADDR addresses
+		for (size_t i = 0; i < CYP_MAX_ADDR; i++)
 		{
 			listAddr[i] = list_addr[i];
 		}
-		nAddr = cnt_addr;
+		nAddr = cnt_addr < CYP_MAX_ADDR ? cnt_addr : CYP_MAX_ADDR;
 	}
 	else
 	{
-		_Dbg.printMsg(_Dbg.WARNING, "No I2C Devices Found");
+		DB_PRINT_MSG(_Dbg, _Dbg.WARNING, "No I2C Devices Found");
 	}
 	if (cnt_err > 0)
 	{
-		_Dbg.printMsg(_Dbg.MT::ERROR, "I2C Errors Found");
+		DB_PRINT_MSG(_Dbg, _Dbg.MT::ERROR, "I2C Errors Found");
 		for (size_t i = 0; i < cnt_addr; i++)
 		{ // print errors
-			_Dbg.printMsg(_Dbg.MT::INFO, "\t%d) %s", i, _Dbg.hexStr(list_addr_with_err[i]));
+			DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "\t%d) %s", i, _Dbg.hexStr(list_addr_with_err[i]));
 		}
 	}
 
@@ -94,6 +96,116 @@ uint8_t CypressCom::i2cScan()
 	return list_addr[cnt_addr];
 }
 
+/// @brief Pack the I2C counters for sending over serial.
+///
+/// @details Output is [n_chips] followed by the counters for each chip in listAddr and a final
+/// entry for all other addresses (e.g., from scanning), see I2cCountStruct, all little endian.
+///
+/// @param p_out Array to store the packed counters.
+/// @param s Length of "p_out".
+///
+/// @return Number of bytes stored [0:"p_out" too short].
+uint8_t CypressCom::getCounts(uint8_t p_out[], uint8_t s)
+{
+	if (s < 1 + (nAddr + 1) * i2cCountSize)
+		return 0;
+
+	uint8_t len = 0;
+	p_out[len++] = nAddr;
+	for (size_t cnt_i = 0; cnt_i <= nAddr; cnt_i++)
+	{
+		// Use the last entry for other addresses
+		I2cCountStruct &r_cnt = I2cCnt[cnt_i < nAddr ? cnt_i : CYP_MAX_ADDR];
+		uint32_t vals[5] = {r_cnt.nTrans, r_cnt.nBytes, r_cnt.nNack, r_cnt.nTimeout, r_cnt.nErr};
+		for (size_t val_i = 0; val_i < 5; val_i++)
+			for (size_t byte_i = 0; byte_i < (val_i < 2 ? 4 : 2); byte_i++)
+				p_out[len++] = (vals[val_i] >> (8 * byte_i)) & 0xFF;
+	}
+	return len;
+}
+
+/// @brief Reset the I2C counters.
+void CypressCom::resetCounts()
+{
+	memset(I2cCnt, 0, sizeof(I2cCnt));
+}
+
+/// @brief Pack trace entries for sending over serial.
+///
+/// @details The trace is split into frames of up to traceFrameEntries entries, oldest first.
+/// Output is [frame_i, n_frames, n_entries] followed by n_entries entries packed as
+/// [addr, reg, dir, len, status, start(4), end(4)] with little endian micros() timestamps,
+/// see TraceStruct. An empty or compiled out trace gives a single frame [0, 0, 0].
+///
+/// @param frame_i Index of the frame to pack [0-n_frames-1].
+/// @param p_out Array to store the packed frame.
+/// @param s Length of "p_out".
+///
+/// @return Number of bytes stored [0:"frame_i" not valid or "p_out" too short].
+uint8_t CypressCom::getTraceBytes(uint8_t frame_i, uint8_t p_out[], uint8_t s)
+{
+	if (s < 3 + traceFrameEntries * traceEntrySize)
+		return 0;
+#if CYP_TRACE_SIZE
+	uint8_t n_frames = (_trCount + traceFrameEntries - 1) / traceFrameEntries;
+#else
+	uint8_t n_frames = 0;
+#endif
+	if (frame_i >= n_frames && !(frame_i == 0 && n_frames == 0))
+		return 0;
+
+	uint8_t len = 0;
+	p_out[len++] = frame_i;
+	p_out[len++] = n_frames;
+	p_out[len++] = 0;
+#if CYP_TRACE_SIZE
+	for (size_t ent_i = frame_i * traceFrameEntries; ent_i < _trCount && p_out[2] < traceFrameEntries; ent_i++)
+	{
+		TraceStruct &r_tr = _Tr[(_trHead + ent_i) % CYP_TRACE_SIZE];
+		p_out[len++] = r_tr.addr;
+		p_out[len++] = r_tr.reg;
+		p_out[len++] = r_tr.dir;
+		p_out[len++] = r_tr.len;
+		p_out[len++] = r_tr.status;
+		for (size_t byte_i = 0; byte_i < 4; byte_i++)
+			p_out[len++] = (r_tr.tsStart >> (8 * byte_i)) & 0xFF;
+		for (size_t byte_i = 0; byte_i < 4; byte_i++)
+			p_out[len++] = (r_tr.tsEnd >> (8 * byte_i)) & 0xFF;
+		p_out[2]++;
+	}
+#endif
+	return len;
+}
+
+/// @brief Clear the I2C trace.
+void CypressCom::resetTrace()
+{
+#if CYP_TRACE_SIZE
+	_trHead = 0;
+	_trCount = 0;
+#endif
+}
+
+/// @brief Store a finished I2C transaction in the trace ring buffer, overwriting the oldest entry when full.
+///
+/// @param reg First register [0 for TR_PROBE].
+/// @param dir Transaction type [TR_WRITE, TR_READ, TR_PROBE].
+/// @param len Data bytes written or requested.
+/// @param status Transaction status.
+void CypressCom::_pushTrace(uint8_t reg, uint8_t dir, uint8_t len, uint8_t status)
+{
+#if CYP_TRACE_SIZE
+	if (!isTraceOn)
+		return;
+	TraceStruct &r_tr = _Tr[(_trHead + _trCount) % CYP_TRACE_SIZE];
+	r_tr = {nowAddr, reg, dir, len, status, _tsTrStart, (uint32_t)micros()};
+	if (_trCount < CYP_TRACE_SIZE)
+		_trCount++;
+	else
+		_trHead = (_trHead + 1) % CYP_TRACE_SIZE;
+#endif
+}
+
 /// @brief Initialize wire coms and setup I2C.
 ///
 /// @return Output from @ref Wire::endTransmission() [0-4] or [-1=255:input argument error].
@@ -105,6 +217,8 @@ uint8_t CypressCom::i2cInit()
 	// Set I2C timeout to 5 seconds
 	Wire.setWireTimeout(5000000); // (us) for Wire librarary (default: 25000)
 	Wire.setTimeout(5000);		   // (ms) for Stream librarary
+
+	return 0;
 }
 
 /// @brief Lowest level function to read from a given Cypress register.
@@ -117,11 +231,14 @@ uint8_t CypressCom::i2cInit()
 /// @return Output from @ref Wire::endTransmission() [0-4] or [-1=255:input argument error].
 uint8_t CypressCom::i2cRead(uint8_t address, uint8_t reg, uint8_t p_byte_out_arr[], uint8_t s)
 {
+	DB_PROFILE_SCOPE(GateProfile::PS::I2C_READ);
+
 	if (s > 16)
 		return -1;
 	_beginTransmissionWrapper(address);
 	Wire.write(reg);
 	uint8_t resp = _endTransmissionWrapper(false); // master stops sending but keeps the transmission line open
+	I2cCnt[_nowInd].nBytes++;
 	if (resp == 0)
 	{
 		Wire.requestFrom(address, s);
@@ -132,13 +249,22 @@ uint8_t CypressCom::i2cRead(uint8_t address, uint8_t reg, uint8_t p_byte_out_arr
 			p_byte_out_arr[k] = Wire.read();
 			k++;
 		}
+		I2cCnt[_nowInd].nBytes += k;
 
 		if (k < s)
+		{
+			I2cCnt[_nowInd].nErr++;
+			_pushTrace(reg, TR_READ, s, 1);
 			return 1;
+		}
+		_pushTrace(reg, TR_READ, s, 0);
 		return 0;
 	}
 	else
+	{
+		_pushTrace(reg, TR_READ, s, resp);
 		return resp;
+	}
 }
 
 /// @brief Lowest level function to write to a given Cypress register.
@@ -150,10 +276,15 @@ uint8_t CypressCom::i2cRead(uint8_t address, uint8_t reg, uint8_t p_byte_out_arr
 /// @return Output from @ref Wire::endTransmission() [0-4] or [-1=255:input argument error].
 uint8_t CypressCom::i2cWrite(uint8_t address, uint8_t reg, uint8_t byte_val_in)
 {
+	DB_PROFILE_SCOPE(GateProfile::PS::I2C_WRITE);
+
 	_beginTransmissionWrapper(address);
 	Wire.write(reg);
 	Wire.write(byte_val_in);
-	return _endTransmissionWrapper();
+	I2cCnt[_nowInd].nBytes += 2;
+	uint8_t resp = _endTransmissionWrapper();
+	_pushTrace(reg, TR_WRITE, 1, resp);
+	return resp;
 }
 /// @brief OVERLOAD: Option to pass an array of bytes "array "p_byte_val_in_arr" to set multiple
 /// registers beginning at register specified by "reg".
@@ -164,6 +295,8 @@ uint8_t CypressCom::i2cWrite(uint8_t address, uint8_t reg, uint8_t byte_val_in)
 /// @return Output from @ref Wire::endTransmission() [0-4] or [-1=255:input argument error].
 uint8_t CypressCom::i2cWrite(uint8_t address, uint8_t reg, uint8_t p_byte_val_in_arr[], uint8_t s)
 {
+	DB_PROFILE_SCOPE(GateProfile::PS::I2C_WRITE);
+
 	if (s > 16)
 		return -1;
 	_beginTransmissionWrapper(address);
@@ -172,7 +305,10 @@ uint8_t CypressCom::i2cWrite(uint8_t address, uint8_t reg, uint8_t p_byte_val_in
 	{
 		Wire.write(p_byte_val_in_arr[i]);
 	}
-	return _endTransmissionWrapper();
+	I2cCnt[_nowInd].nBytes += s + 1;
+	uint8_t resp = _endTransmissionWrapper();
+	_pushTrace(reg, TR_WRITE, s, resp);
+	return resp;
 }
 
 /// @brief Updates a given byte value based on a given mask.
@@ -285,9 +421,11 @@ uint8_t CypressCom::ioWritePort(uint8_t address, uint8_t port, uint8_t byte_mask
 	else
 	{
 		uint8_t port_byte;
-		ioReadPort(address, REG_GO0, port, port_byte); // get current port values
+		uint8_t resp = ioReadPort(address, REG_GO0, port, port_byte); // get current port values
+		if (resp != 0)
+			return resp; // do not write an unknown port value
 		_updateRegByte(port_byte, byte_mask, bit_val_set);
-		uint8_t resp = i2cWrite(address, REG_GO0 + port, port_byte); // update port
+		resp = i2cWrite(address, REG_GO0 + port, port_byte); // update port
 		return resp;
 	}
 }
@@ -357,6 +495,8 @@ uint8_t CypressCom::ioWriteReg(uint8_t address, uint8_t p_byte_mask_arr[], uint8
 /// @return CStatus codes [-1: critical error or from @ref Wire::endTransmission()].
 uint8_t CypressCom::setupCypress(uint8_t address)
 {
+	DB_PROFILE_SCOPE(GateProfile::PS::CYP_SETUP);
+
 
 	// Check I2C lines
 	bool is_err = false;
@@ -370,18 +510,19 @@ uint8_t CypressCom::setupCypress(uint8_t address)
 	is_err = (digitalRead(PC4) == LOW) || (digitalRead(PC5) == LOW);
 #endif
 	if (is_err)
-		_Dbg.printMsg(_Dbg.MT::ERROR, "I2C LINES LOW: CHECK POWER");
+		DB_PRINT_MSG(_Dbg, _Dbg.MT::ERROR, "I2C LINES LOW: CHECK POWER");
 
 	// Test I2C connection
 	_beginTransmissionWrapper(address);
 	Wire.write((uint8_t)0);
+	I2cCnt[_nowInd].nBytes++;
 	uint8_t resp = _endTransmissionWrapper();
 
 	// Check for timeout
 	/// @todo Get this working
 	if (resp != 0)
 	{
-		_Dbg.printMsg(_Dbg.MT::ERROR, "FAILED SETUP I2C CHECK: WIRE STATUS[%d]", resp);
+		DB_PRINT_MSG(_Dbg, _Dbg.MT::ERROR, "FAILED SETUP I2C CHECK: WIRE STATUS[%d]", resp);
 	}
 
 	// Setup Cypress chip
@@ -390,12 +531,12 @@ uint8_t CypressCom::setupCypress(uint8_t address)
 		// Restore chip
 		resp = i2cWrite(address, REG_CMD, REG_CMD_RESTORE);
 		if (resp)
-			_Dbg.printMsg(_Dbg.MT::ERROR, "FAILED: CYPRESS CHIP RESTORE: WIRE STATUS[%d]", resp);
+			DB_PRINT_MSG(_Dbg, _Dbg.MT::ERROR, "FAILED: CYPRESS CHIP RESTORE: WIRE STATUS[%d]", resp);
 
 		// Reset chip
 		resp = i2cWrite(address, REG_CMD, REG_CMD_RECONF);
 		if (resp)
-			_Dbg.printMsg(_Dbg.MT::ERROR, "FAILED: CYPRESS CHIP RECONFIGURE: WIRE STATUS[%d]", resp);
+			DB_PRINT_MSG(_Dbg, _Dbg.MT::ERROR, "FAILED: CYPRESS CHIP RECONFIGURE: WIRE STATUS[%d]", resp);
 	}
 
 	return resp;
@@ -481,7 +622,15 @@ uint8_t CypressCom::setPortRegister(uint8_t address, uint8_t reg, uint8_t port,
 void CypressCom::_beginTransmissionWrapper(uint8_t address)
 {
 	nowAddr = address;
+#if CYP_TRACE_SIZE
+	_tsTrStart = micros();
+#endif
 	Wire.beginTransmission(address);
+
+	// Get counter index of the address
+	for (_nowInd = 0; _nowInd < nAddr && listAddr[_nowInd] != address; _nowInd++)
+		;
+	_nowInd = _nowInd < nAddr ? _nowInd : CYP_MAX_ADDR;
 }
 
 /// @brief Wrapper for Wire::endTransmission() to catch and print errors debugging.
@@ -493,8 +642,19 @@ void CypressCom::_beginTransmissionWrapper(uint8_t address)
 uint8_t CypressCom::_endTransmissionWrapper(bool send_stop, bool do_print_err)
 {
 	uint8_t resp = Wire.endTransmission(send_stop);
+
+	// Update counters
+	I2cCountStruct &r_cnt = I2cCnt[_nowInd];
+	r_cnt.nTrans++;
+	if (resp == 2 || resp == 3)
+		r_cnt.nNack++;
+	else if (resp == 5)
+		r_cnt.nTimeout++;
+	else if (resp != 0)
+		r_cnt.nErr++;
+
 	if (resp != 0 && do_print_err)
-		_Dbg.printMsg(_Dbg.MT::ERROR, "I2C Error[%d] Address[%s] from Wire::endTransmission()", resp, _Dbg.hexStr(nowAddr));
+		DB_PRINT_MSG(_Dbg, _Dbg.MT::ERROR, "I2C Error[%d] Address[%s] from Wire::endTransmission()", resp, _Dbg.hexStr(nowAddr));
 	return resp;
 }
 
@@ -520,9 +680,9 @@ void CypressCom::printRegByte(uint8_t p_byte_mask_in[], uint8_t s)
 	if (DB_VERBOSE == 0)
 		return;
 
-	_Dbg.printMsg(_Dbg.MT::INFO, "\tRegistry Bytes: ");
+	DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "\tRegistry Bytes: ");
 	for (size_t i = 0; i < s; i++)
 	{
-		_Dbg.printMsg(_Dbg.MT::INFO, "\tport[%d]\n\t\t 76543210\n\t\t%s", i, _Dbg.binStr(p_byte_mask_in[i]));
+		DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "\tport[%d]\n\t\t 76543210\n\t\t%s", i, _Dbg.binStr(p_byte_mask_in[i]));
 	}
 }
\ No newline at end of file
@@ -14,6 +14,15 @@
 #include <Wire.h>
 #include "CypressComBase.h"
 #include "GateDebug.h"
+#include "GateProfile.h"
+
+#ifndef CYP_MAX_ADDR
+#define CYP_MAX_ADDR 9 ///< maximum number of Cypress chips tracked, can be set with a build flag
+#endif
+
+#ifndef CYP_TRACE_SIZE
+#define CYP_TRACE_SIZE 48 ///< number of I2C transactions kept in the trace ring buffer [0:trace removed from the build], can be set with a build flag
+#endif
 
 /// @brief This class handles all of the Cypress chip I2C comms.
 ///
@@ -36,15 +45,56 @@ class CypressCom
 public:
 	// Global address variable
 	uint8_t nowAddr = 0; /// tracks current I2C address for debugging
-	uint8_t listAddr[9]; /// List of cypress up to 9 I2C addresses
+	uint8_t listAddr[CYP_MAX_ADDR]; /// List of up to CYP_MAX_ADDR cypress I2C addresses
 	uint8_t nAddr = 0; /// Number of cypress I2C addresses found
 
+	// Struct for the I2C counters of a chip
+	struct I2cCountStruct
+	{
+		uint32_t nTrans;   // transactions
+		uint32_t nBytes;   // data bytes written and read, excluding address bytes
+		uint16_t nNack;	   // transactions ended by a NACK [Wire status 2, 3]
+		uint16_t nTimeout; // transactions ended by a timeout [Wire status 5]
+		uint16_t nErr;	   // other failed transactions [Wire status 1, 4, short read]
+	};
+	I2cCountStruct I2cCnt[CYP_MAX_ADDR + 1] = {}; /// I2C counters by index in listAddr, last entry for all other addresses
+	static const uint8_t i2cCountSize = 14;	  /// Bytes per chip of packed counters [trans(4), bytes(4), nack(2), timeout(2), err(2)]
+
+	// I2C transaction trace
+	enum TR
+	{
+		TR_WRITE = 0, // register write
+		TR_READ = 1,  // register read
+		TR_PROBE = 2  // address only (i2cScan())
+	};
+	// Struct for a traced I2C transaction
+	struct TraceStruct
+	{
+		uint8_t addr;	  // I2C address
+		uint8_t reg;	  // first register [0 for TR_PROBE]
+		uint8_t dir;	  // transaction type [TR_WRITE, TR_READ, TR_PROBE]
+		uint8_t len;	  // data bytes written or requested, excluding the address and register bytes
+		uint8_t status;	  // Wire::endTransmission() status [0-5] or 1 for a short read
+		uint32_t tsStart; // micros() timestamp of Wire::beginTransmission()
+		uint32_t tsEnd;	  // micros() timestamp after the last byte was written or read
+	};
+	bool isTraceOn = true;						 /// set to record I2C transactions in the trace ring buffer
+	static const uint8_t traceEntrySize = 13;	 /// Bytes per packed trace entry [addr, reg, dir, len, status, start(4), end(4)]
+	static const uint8_t traceFrameEntries = 15; /// Trace entries per packed trace frame
+
 	// PWM config
 	const uint8_t pwmClockVal = 0;	 /// PWM clock config [0: 32 kHz(default), 1: 24 MHz, 2: 1.5 MHz, 3: 93.75 kHz, 4: 367.6 Hz(programmable), 5: previous PWM]
 	const uint8_t pwmPeriodVal = 32; /// PWM period of the PWM counter(1 - 255).Devisor for hardward clock
 
 private:
-	GateDebug _Dbg; /// unique instance of GateDebug class
+	GateDebug _Dbg;		 /// unique instance of GateDebug class
+	uint8_t _nowInd = 0; /// I2cCnt index of the current I2C address
+#if CYP_TRACE_SIZE
+	TraceStruct _Tr[CYP_TRACE_SIZE]; /// trace ring buffer
+	uint8_t _trHead = 0;			 /// index of the oldest trace entry
+	uint8_t _trCount = 0;			 /// number of stored trace entries
+	uint32_t _tsTrStart = 0;		 /// micros() timestamp of the current transaction start
+#endif
 
 	// -----------METHODS-----------------
 public:
@@ -63,6 +113,21 @@ public:
 	uint8_t i2cWrite(uint8_t, uint8_t, uint8_t);
 	uint8_t i2cWrite(uint8_t, uint8_t, uint8_t[], uint8_t);
 
+public:
+	uint8_t getCounts(uint8_t[], uint8_t);
+
+public:
+	void resetCounts();
+
+public:
+	uint8_t getTraceBytes(uint8_t, uint8_t[], uint8_t);
+
+public:
+	void resetTrace();
+
+private:
+	void _pushTrace(uint8_t, uint8_t, uint8_t, uint8_t);
+
 private:
 	void _updateRegByte(uint8_t &, uint8_t, uint8_t);
 
@@ -13,19 +13,88 @@
 
 //===========CLASS: GateDebug============
 
+// Static log variables shared by all instances
+const char GateDebug::_message_type_str[8][10] PROGMEM = {
+	"[INFO]",
+	"[INFO]",
+	"[INFO]",
+	"[INFO]",
+	"[INFO]",
+	"[ERROR]",
+	"[WARNING]",
+	"[DEBUG]"};
+uint8_t GateDebug::logLevel = DB_LOG_LEVEL;
+bool GateDebug::binaryLog = false;
+GateDebug::FmtCacheStruct GateDebug::_fmtCache[GateDebug::_fmtCacheSize] = {};
+uint8_t GateDebug::_logBuff[DB_LOG_BUFF_SIZE];
+uint16_t GateDebug::_logHead = 0;
+uint16_t GateDebug::_logCount = 0;
+uint16_t GateDebug::_nLogDropped = 0;
+uint16_t GateDebug::logHighWater = 0;
+uint16_t GateDebug::logDropped = 0;
+bool GateDebug::logBlockWhenFull = false;
+GateDebug::LogWriter GateDebug::logWriter = nullptr;
+uint16_t GateDebug::logSuppressed = 0;
+uint16_t GateDebug::logOverBudget = 0;
+uint16_t GateDebug::logBytesPerSec = DB_LOG_BYTES_PER_SEC;
+GateDebug::LogSiteStruct GateDebug::_logSite[DB_LOG_SITE_SLOTS] = {};
+uint16_t GateDebug::_budget = DB_LOG_BYTES_PER_SEC;
+uint32_t GateDebug::_tsBudget = 0;
+
 /// @brief Constructor
 GateDebug::GateDebug(){}
 
 /// @brief Print a message with elapsed time.
 ///
+/// @note Call through the DB_PRINT_MSG() macro so messages above DB_LOG_LEVEL are compiled out
+/// and the format string is kept in flash.
+///
 /// @param msg_type_enum Enum specifying message type.
 /// @param p_fmt Message string with formatting comparable to sprintf().
 /// @param ... Variable arguments related to the formatting string.
 void GateDebug::printMsg(MT msg_type_enum, const char *p_fmt, ...)
 {
-	if (DB_VERBOSE == 0)
+	va_list args;
+	va_start(args, p_fmt);
+	_printMsg(msg_type_enum, p_fmt, false, args);
+	va_end(args);
+}
+
+/// @brief Print a message with elapsed time using a format string stored in flash.
+///
+/// @param msg_type_enum Enum specifying message type.
+/// @param p_fmt_P Message string in flash (PSTR()) with formatting comparable to sprintf().
+/// @param ... Variable arguments related to the formatting string.
+void GateDebug::printMsg_P(MT msg_type_enum, const char *p_fmt_P, ...)
+{
+	va_list args;
+	va_start(args, p_fmt_P);
+	_printMsg(msg_type_enum, p_fmt_P, true, args);
+	va_end(args);
+}
+
+/// @brief Format and print a message, or push it to the binary log.
+///
+/// @param msg_type_enum Enum specifying message type.
+/// @param p_fmt Message string with formatting comparable to sprintf().
+/// @param is_P Set if "p_fmt" is stored in flash.
+/// @param args Arguments related to the formatting string.
+void GateDebug::_printMsg(MT msg_type_enum, const char *p_fmt, bool is_P, va_list args)
+{
+	if (DB_VERBOSE == 0 || msgLevel(msg_type_enum) > logLevel)
+		return;
+
+	// Skip messages from a call site that is over its rate limit
+	if (!_checkLogSite(p_fmt, is_P))
 		return;
 
+	// Push a binary record instead of formatting and printing the message
+	if (binaryLog)
+	{
+		_pushLogRecord(msg_type_enum, p_fmt, is_P, args);
+		return;
+	}
+
 	const uint8_t buff_s = 125;
 	static char buff[buff_s];
 	buff[0] = '\0';
@@ -38,10 +107,10 @@ void GateDebug::printMsg(MT msg_type_enum, const char *p_fmt, ...)
 	bool is_head2_msg = (msg_type_enum == MT::HEAD2);
 
 	// Format message
-	va_list args;
-	va_start(args, p_fmt); // Start retrieving additional arguments
-	vsnprintf(buff, buff_s, p_fmt, args);
-	va_end(args);
+	if (is_P)
+		vsnprintf_P(buff, buff_s, p_fmt, args);
+	else
+		vsnprintf(buff, buff_s, p_fmt, args);
 
 	// Get number of attention grabbing characters to print before and after message
 	size_t n =
@@ -55,37 +124,386 @@ void GateDebug::printMsg(MT msg_type_enum, const char *p_fmt, ...)
 		memset(buff_sym, '_', n);
 	else if (msg_type_enum == MT::ERROR)
 		memset(buff_sym, '!', n);
+	else
+		n = 0;
 	buff_sym[n] = '\0';
 
-	// Add additional new line for attention messages
-	if (msg_type_enum == MT::HEAD1 || msg_type_enum == MT::HEAD1A)
-		Serial.print("\n");
+	// Build line with message type, time string, header symbols and additional new lines for attention messages
+	static char line[DB_LOG_LINE_SIZE];
+	char type_str[sizeof(_message_type_str[0])];
+	strcpy_P(type_str, _message_type_str[msg_type_enum]);
+	int line_len = snprintf_P(line, DB_LOG_LINE_SIZE, PSTR("%s%s [%s]: %s%s%s\n%s"),
+							  msg_type_enum == MT::HEAD1 || msg_type_enum == MT::HEAD1A ? "\n" : "",
+							  type_str, _timeStr(0), buff_sym, buff, buff_sym,
+							  msg_type_enum == MT::HEAD1 || msg_type_enum == MT::HEAD1B ? "\n" : "");
+	line_len = line_len < DB_LOG_LINE_SIZE ? line_len : DB_LOG_LINE_SIZE - 1;
+
+	// Queue line if the log budget allows it and send what fits
+	if (_takeLogBudget(line_len) && !_pushLogBytes((const uint8_t *)line, line_len))
+		_countLogDropped();
+	flushLog();
+}
+
+/// @brief Send queued log output to the Serial port or the log writer.
+///
+/// @details Log output is queued in a RAM ring buffer of DB_LOG_BUFF_SIZE bytes and moved into the
+/// interrupt driven HardwareSerial transmit buffer only while it holds fewer than DB_LOG_TX_INFLIGHT
+/// bytes. Protocol frames written directly to the port therefore never wait behind more than
+/// DB_LOG_TX_INFLIGHT bytes of log output. Call this during idle time, it is also called after each
+/// message is queued.
+///
+/// If logWriter is set the queued bytes are handed to it instead, which lets SerialCom send them
+/// as log frames on the same port as the protocol. A line or record may be split between calls.
+///
+/// In binary mode each record is sent as [LOG_SYNC_BYTE][length][record][checksum] where the record is
+/// the message ID (2 bytes), micros() timestamp (4 bytes), message type (1 byte) and the raw arguments,
+/// all little endian, and the checksum is the sum of the record bytes modulo 256. Use
+/// gui/gate_log_decode.py to convert the records back to text.
+///
+/// @param do_block OPTIONAL: Set to wait until all queued output is sent. DEFAULT: false.
+void GateDebug::flushLog(bool do_block)
+{
+	// Report dropped messages once there is room for it
+	if (_nLogDropped > 0)
+	{
+		bool is_queued;
+		if (binaryLog)
+		{
+			uint32_t ts = micros();
+			uint8_t rec[9] = {LOG_ID_DROPPED & 0xFF, LOG_ID_DROPPED >> 8,
+							  (uint8_t)ts, (uint8_t)(ts >> 8), (uint8_t)(ts >> 16), (uint8_t)(ts >> 24),
+							  MT::WARNING, (uint8_t)_nLogDropped, (uint8_t)(_nLogDropped >> 8)};
+			is_queued = _pushLogFrame(rec, 9);
+		}
+		else
+		{
+			char line[40];
+			int line_len = snprintf_P(line, sizeof(line), PSTR("[WARNING]: Log messages dropped[%u]\n"), _nLogDropped);
+			is_queued = _pushLogBytes((const uint8_t *)line, line_len);
+		}
+		if (is_queued)
+			_nLogDropped = 0;
+	}
+
+	// Report suppressed repeats of call sites whose rate window has ended
+	uint32_t ts_now = millis();
+	for (size_t site_i = 0; site_i < DB_LOG_SITE_SLOTS; site_i++)
+		if (_logSite[site_i].nSuppressed > 0 && ts_now - _logSite[site_i].tsWindow >= DB_LOG_SITE_WINDOW)
+			_pushRepeatReport(_logSite[site_i]);
 
-	// Print message type
-	Serial.print(_message_type_str[msg_type_enum]);
+	do
+		_sendLogBytes();
+	while (do_block && _logCount > 0);
+}
 
-	// Print time string
-	Serial.print(" [");
-	Serial.print(_timeStr(0));
-	Serial.print("]: ");
+/// @brief Move queued log bytes to the log writer, or to the Serial transmit buffer while it holds fewer than DB_LOG_TX_INFLIGHT bytes.
+void GateDebug::_sendLogBytes()
+{
+	if (logWriter != nullptr)
+	{
+		// Hand over the contiguous bytes up to the end of the ring buffer until the writer is busy
+		while (_logCount > 0)
+		{
+			uint16_t n_run = DB_LOG_BUFF_SIZE - _logHead < _logCount ? DB_LOG_BUFF_SIZE - _logHead : _logCount;
+			uint16_t n_sent = logWriter(&_logBuff[_logHead], n_run);
+			if (n_sent == 0)
+				break;
+			n_sent = n_sent < n_run ? n_sent : n_run;
+			_logHead = (_logHead + n_sent) % DB_LOG_BUFF_SIZE;
+			_logCount -= n_sent;
+		}
+		return;
+	}
 
-	// Print preceding header symbols
-	if (is_head1_msg || is_head2_msg || msg_type_enum == MT::ERROR)
-		Serial.print(buff_sym);
+	while (_logCount > 0 && _txBuffSize - 1 - Serial.availableForWrite() < DB_LOG_TX_INFLIGHT)
+	{
+		Serial.write(_logBuff[_logHead]);
+		_logHead = (_logHead + 1) % DB_LOG_BUFF_SIZE;
+		_logCount--;
+	}
+}
 
-	// Print message
-	Serial.print(buff);
+/// @brief Check the rate limit of the call site of a message.
+///
+/// @details Each call site, identified by its format string address, may print DB_LOG_SITE_BURST
+/// messages per DB_LOG_SITE_WINDOW ms. Further messages are counted and reported as a single
+/// "repeated" message once the window has ended. Sites share DB_LOG_SITE_SLOTS slots, a site
+/// taking over a slot first reports the suppressed count of the previous one. No limit is applied
+/// while logBlockWhenFull is set.
+///
+/// @param p_fmt Message string with formatting comparable to sprintf().
+/// @param is_P Set if "p_fmt" is stored in flash.
+///
+/// @return true if the message should be printed, false if it was suppressed.
+bool GateDebug::_checkLogSite(const char *p_fmt, bool is_P)
+{
+	if (logBlockWhenFull)
+		return true;
+	LogSiteStruct &r_site = _logSite[((uintptr_t)p_fmt >> 1) % DB_LOG_SITE_SLOTS];
+	uint32_t ts = millis();
 
-	// Print proceding header symbols
-	if (is_head1_msg || is_head2_msg || msg_type_enum == MT::ERROR)
-		Serial.print(buff_sym);
+	// Take over the slot from another site
+	if (r_site.p_fmt != p_fmt || r_site.isP != is_P)
+	{
+		if (r_site.nSuppressed > 0)
+			_pushRepeatReport(r_site);
+		r_site = {p_fmt, ts, 0, 0, is_P};
+	}
 
-	// Add new line
-	Serial.print("\n");
+	// Start a new rate window, reporting the repeats suppressed in the last one first
+	if (ts - r_site.tsWindow >= DB_LOG_SITE_WINDOW)
+	{
+		if (r_site.nSuppressed > 0)
+			_pushRepeatReport(r_site);
+		r_site.tsWindow = ts;
+		r_site.nInWindow = 0;
+	}
 
-	// Add additional new line for attention messages
-	if (msg_type_enum == MT::HEAD1 || msg_type_enum == MT::HEAD1B)
-		Serial.print("\n");
+	if (r_site.nInWindow < DB_LOG_SITE_BURST)
+	{
+		r_site.nInWindow++;
+		return true;
+	}
+	r_site.nSuppressed = r_site.nSuppressed < 0xFFFF ? r_site.nSuppressed + 1 : r_site.nSuppressed;
+	logSuppressed = logSuppressed < 0xFFFF ? logSuppressed + 1 : logSuppressed;
+	return false;
+}
+
+/// @brief Store a message reporting the suppressed repeats of a call site in the log ring buffer.
+///
+/// @note In binary mode the record has message ID LOG_ID_REPEATED and the site's message ID
+/// and suppressed count as arguments. The report is not charged to the log budget.
+///
+/// @param r_site Rate limit entry of the call site, its suppressed count is cleared once reported.
+///
+/// @return true if the report was stored, false if the buffer was full.
+bool GateDebug::_pushRepeatReport(LogSiteStruct &r_site)
+{
+	bool is_queued;
+	if (binaryLog)
+	{
+		uint16_t id = _getFmtInfo(r_site.p_fmt, r_site.isP).id;
+		uint32_t ts = micros();
+		uint8_t rec[11] = {LOG_ID_REPEATED & 0xFF, LOG_ID_REPEATED >> 8,
+						   (uint8_t)ts, (uint8_t)(ts >> 8), (uint8_t)(ts >> 16), (uint8_t)(ts >> 24),
+						   MT::WARNING, (uint8_t)id, (uint8_t)(id >> 8),
+						   (uint8_t)r_site.nSuppressed, (uint8_t)(r_site.nSuppressed >> 8)};
+		is_queued = _pushLogFrame(rec, 11);
+	}
+	else
+	{
+		char fmt[40];
+		if (r_site.isP)
+			strncpy_P(fmt, r_site.p_fmt, sizeof(fmt) - 1);
+		else
+			strncpy(fmt, r_site.p_fmt, sizeof(fmt) - 1);
+		fmt[sizeof(fmt) - 1] = '\0';
+		char line[96];
+		int line_len = snprintf_P(line, sizeof(line), PSTR("[WARNING]: Message repeated[%u] more times: %s\n"), r_site.nSuppressed, fmt);
+		line_len = line_len < (int)sizeof(line) ? line_len : sizeof(line) - 1;
+		is_queued = _pushLogBytes((const uint8_t *)line, line_len);
+	}
+	if (is_queued)
+		r_site.nSuppressed = 0;
+	return is_queued;
+}
+
+/// @brief Take bytes from the global log budget of logBytesPerSec.
+///
+/// @details The budget refills continuously and holds at most one second of bytes, so short
+/// bursts pass while a steady stream is held to the budget. No limit is applied while
+/// logBlockWhenFull is set or logBytesPerSec is 0.
+///
+/// @param len Number of bytes the message takes.
+///
+/// @return true if the message fits in the budget, false if it should be skipped.
+bool GateDebug::_takeLogBudget(uint16_t len)
+{
+	if (logBlockWhenFull || logBytesPerSec == 0)
+		return true;
+
+	// Refill budget
+	uint32_t ts = millis();
+	uint32_t dt = ts - _tsBudget < 1000 ? ts - _tsBudget : 1000;
+	uint32_t n_refill = dt * logBytesPerSec / 1000;
+	if (n_refill > 0)
+	{
+		_budget = _budget + n_refill < logBytesPerSec ? _budget + n_refill : logBytesPerSec;
+		_tsBudget = ts;
+	}
+
+	if (len > _budget)
+	{
+		logOverBudget = logOverBudget < 0xFFFF ? logOverBudget + 1 : logOverBudget;
+		return false;
+	}
+	_budget -= len;
+	return true;
+}
+
+/// @brief Pack a message into a binary record and store it in the log ring buffer.
+///
+/// @note Integer arguments are stored as 2 bytes, long arguments as 4 bytes and strings as a
+/// length byte followed by up to 15 characters.
+///
+/// @param msg_type_enum Enum specifying message type.
+/// @param p_fmt Message string with formatting comparable to sprintf().
+/// @param is_P Set if "p_fmt" is stored in flash.
+/// @param args Arguments related to the formatting string.
+void GateDebug::_pushLogRecord(MT msg_type_enum, const char *p_fmt, bool is_P, va_list args)
+{
+	const uint8_t rec_s = 64;
+	uint8_t rec[rec_s];
+	uint8_t len = 0;
+
+	// Add header
+	FmtCacheStruct &r_fmt = _getFmtInfo(p_fmt, is_P);
+	uint32_t ts = micros();
+	rec[len++] = r_fmt.id & 0xFF;
+	rec[len++] = r_fmt.id >> 8;
+	for (size_t i = 0; i < 4; i++)
+		rec[len++] = (ts >> (8 * i)) & 0xFF;
+	rec[len++] = msg_type_enum;
+
+	// Add raw arguments
+	for (size_t arg_i = 0; arg_i < r_fmt.nArgs; arg_i++)
+	{
+		uint8_t arg_type = (r_fmt.argSig >> (2 * arg_i)) & 0x03;
+		if (arg_type == 3)
+		{
+			const char *p_str = va_arg(args, const char *);
+			uint8_t str_len = strnlen(p_str, 15);
+			str_len = str_len < rec_s - len - 1 ? str_len : rec_s - len - 1;
+			rec[len++] = str_len;
+			memcpy(&rec[len], p_str, str_len);
+			len += str_len;
+		}
+		else
+		{
+			uint32_t val = arg_type == 2 ? va_arg(args, unsigned long) : (uint16_t)va_arg(args, int);
+			uint8_t val_s = arg_type == 2 ? 4 : 2;
+			if (len + val_s > rec_s)
+				break;
+			for (size_t i = 0; i < val_s; i++)
+				rec[len++] = (val >> (8 * i)) & 0xFF;
+		}
+	}
+
+	if (_takeLogBudget(len + 3) && !_pushLogFrame(rec, len))
+		_countLogDropped();
+}
+
+/// @brief Frame a binary record and store it in the log ring buffer.
+///
+/// @param p_rec Record bytes.
+/// @param len Length of "p_rec".
+///
+/// @return true if the record was stored, false if the buffer was full.
+bool GateDebug::_pushLogFrame(const uint8_t p_rec[], uint8_t len)
+{
+	uint8_t frame[68];
+	uint8_t checksum = 0;
+	frame[0] = LOG_SYNC_BYTE;
+	frame[1] = len;
+	for (size_t i = 0; i < len; i++)
+	{
+		frame[2 + i] = p_rec[i];
+		checksum += p_rec[i];
+	}
+	frame[2 + len] = checksum;
+	return _pushLogBytes(frame, len + 3);
+}
+
+/// @brief Count a message dropped because the log ring buffer was full.
+void GateDebug::_countLogDropped()
+{
+	_nLogDropped = _nLogDropped < 0xFFFF ? _nLogDropped + 1 : _nLogDropped;
+	logDropped = logDropped < 0xFFFF ? logDropped + 1 : logDropped;
+}
+
+/// @brief Get the cached message ID and argument types for a format string.
+///
+/// @details The message ID is a 32-bit FNV-1a hash of the format string folded to 16 bits,
+/// which gui/gate_log_decode.py regenerates from the sources to decode the records. The
+/// hash and argument scan only run the first time a format string is seen.
+///
+/// @param p_fmt Message string with formatting comparable to sprintf().
+/// @param is_P Set if "p_fmt" is stored in flash.
+///
+/// @return Reference to the cache entry for the format string.
+GateDebug::FmtCacheStruct &GateDebug::_getFmtInfo(const char *p_fmt, bool is_P)
+{
+	FmtCacheStruct &r_fmt = _fmtCache[((uintptr_t)p_fmt >> 1) % _fmtCacheSize];
+	if (r_fmt.p_fmt == p_fmt && r_fmt.isP == is_P)
+		return r_fmt;
+
+	// Hash format string
+	uint32_t hash = 2166136261UL;
+	for (const char *p_c = p_fmt; _fmtChar(p_c, is_P) != '\0'; p_c++)
+	{
+		hash ^= (uint8_t)_fmtChar(p_c, is_P);
+		hash *= 16777619UL;
+	}
+	r_fmt.p_fmt = p_fmt;
+	r_fmt.isP = is_P;
+	r_fmt.id = (hash >> 16) ^ (hash & 0xFFFF);
+	r_fmt.id = r_fmt.id <= LOG_ID_REPEATED ? r_fmt.id + 2 : r_fmt.id;
+
+	// Get argument types from the conversion specifiers
+	r_fmt.argSig = 0;
+	r_fmt.nArgs = 0;
+	for (const char *p_c = p_fmt; _fmtChar(p_c, is_P) != '\0' && r_fmt.nArgs < 8; p_c++)
+	{
+		if (_fmtChar(p_c, is_P) != '%')
+			continue;
+		p_c++;
+		if (_fmtChar(p_c, is_P) == '%')
+			continue;
+		bool is_long = false;
+		while (_fmtChar(p_c, is_P) != '\0' && strchr("-+ #0123456789.lh", _fmtChar(p_c, is_P)) != nullptr)
+			is_long |= _fmtChar(p_c++, is_P) == 'l';
+		if (_fmtChar(p_c, is_P) == '\0')
+			break;
+		uint8_t arg_type = _fmtChar(p_c, is_P) == 's' ? 3 : (is_long ? 2 : 1);
+		r_fmt.argSig |= arg_type << (2 * r_fmt.nArgs++);
+	}
+	return r_fmt;
+}
+
+/// @brief Read a character of a format string stored in RAM or flash.
+///
+/// @param p_c Character address.
+/// @param is_P Set if "p_c" is stored in flash.
+///
+/// @return The character.
+char GateDebug::_fmtChar(const char *p_c, bool is_P)
+{
+	return is_P ? (char)pgm_read_byte(p_c) : *p_c;
+}
+
+/// @brief Store bytes in the log ring buffer, all or none.
+///
+/// @note If logBlockWhenFull is set, waits for the buffer to drain instead of failing.
+///
+/// @param p_bytes Bytes to send.
+/// @param len Length of "p_bytes".
+///
+/// @return true if the bytes were stored, false if the buffer was full.
+bool GateDebug::_pushLogBytes(const uint8_t p_bytes[], uint16_t len)
+{
+	if (len > DB_LOG_BUFF_SIZE)
+		return false;
+	while (logBlockWhenFull && _logCount + len > DB_LOG_BUFF_SIZE)
+		_sendLogBytes();
+	if (_logCount + len > DB_LOG_BUFF_SIZE)
+		return false;
+
+	uint16_t i_write = (_logHead + _logCount) % DB_LOG_BUFF_SIZE;
+	for (size_t i = 0; i < len; i++)
+		_logBuff[(i_write + i) % DB_LOG_BUFF_SIZE] = p_bytes[i];
+	_logCount += len;
+	logHighWater = _logCount > logHighWater ? _logCount : logHighWater;
+	return true;
 }
 
 /// @brief Generate a time string based on current run time.
@@ -105,7 +523,7 @@ const char *GateDebug::_timeStr(uint32_t ts_0)
 	uint32_t dt_ms = dt - (dt_m * (60UL * 1000UL)) - (dt_s * 1000UL);		  // milliseconds
 
 	// Format string and print
-	snprintf(buff[i], sizeof(buff[i]), "%02lu:%02lu:%03lu", dt_m, dt_s, dt_ms);
+	snprintf(buff[i], sizeof(buff[i]), "%02lu:%02lu:%03lu", (unsigned long)dt_m, (unsigned long)dt_s, (unsigned long)dt_ms);
 	uint8_t ii = i;
 	i = i == 1 ? 0 : i + 1;
 	return buff[ii];
@@ -117,7 +535,7 @@ const char *GateDebug::_timeStr(uint32_t ts_0)
 /// @param s Size of the array.
 ///
 /// @return Formatted string representing the array.
-const char *GateDebug::arrayStr(uint8_t p_arr[], size_t s)
+const char *GateDebug::arrayStr(const uint8_t p_arr[], size_t s)
 {
 	if (DB_VERBOSE == 0)
 		return "";
@@ -177,6 +595,8 @@ const char *GateDebug::hexStr(uint8_t h)
 /// @brief Track and return the elapsed time between calls.
 /// Initially call with an input argument of 1 to set the clock. Subsequent calls provide elapsed time.
 ///
+/// @note Returns an empty string in binary log mode, where the record timestamps give the timing.
+///
 /// @param do_reset If true, resets the clock. DEFAULT: false.
 ///
 /// @return Formatted time string in the form [s:ms:us].
@@ -188,6 +608,10 @@ const char *GateDebug::dtTrack(bool do_reset)
 		ts_0 = millis(); // store current time on first call
 		return "";
 	}
+	else if (binaryLog)
+	{ // skip formatting as binary log records carry their own timestamp
+		return "";
+	}
 	else
 	{ // get dt on subsiquent call
 		return (_timeStr(ts_0));
@@ -221,7 +645,7 @@ const char *GateDebug::bitIndStr(uint8_t byte_mask_in)
 		{
 			if (bitRead(byte_mask_in, j) == 1)
 			{
-				snprintf(buff2, sizeof(buff2), "%d,", j); // add comma right here
+				snprintf(buff2, sizeof(buff2), "%d,", (int)j); // add comma right here
 				strncat(buff1[i], buff2, sizeof(buff1[i]) - strlen(buff1[i]) - 1);
 			}
 		}
@@ -14,6 +14,62 @@
 
 extern bool DB_VERBOSE; ///< set this variable in your INO file to control debugging [0:silent, 1:verbose]
 
+// Log levels, a message is printed if its level is at or below the log level
+#define DB_LEVEL_NONE 0	   ///< no messages
+#define DB_LEVEL_ERROR 1   ///< ERROR messages
+#define DB_LEVEL_WARNING 2 ///< WARNING messages
+#define DB_LEVEL_INFO 3	   ///< INFO and header messages
+#define DB_LEVEL_DEBUG 4   ///< DEBUG messages
+
+#ifndef DB_LOG_LEVEL
+#define DB_LOG_LEVEL DB_LEVEL_DEBUG ///< compile-time log level, set with a build flag (e.g. -D DB_LOG_LEVEL=1)
+#endif
+
+/// @brief Print a message if its type is enabled by DB_LOG_LEVEL.
+///
+/// @details Use this instead of calling printMsg() directly. For a constant message type above
+/// DB_LOG_LEVEL the condition is known at compile time, so the call and its argument evaluation
+/// (e.g. bitIndStr(), arrayStr()) are removed from the build.
+///
+/// @param dbg GateDebug instance.
+/// @param msg_type Message type enum.
+/// @param fmt Format string literal, stored in flash.
+/// @param ... Arguments related to the formatting string.
+#define DB_PRINT_MSG(dbg, msg_type, fmt, ...)                        \
+	do                                                               \
+	{                                                                \
+		if (GateDebug::msgLevel(msg_type) <= DB_LOG_LEVEL)           \
+			(dbg).printMsg_P(msg_type, PSTR(fmt), ##__VA_ARGS__);    \
+	} while (0)
+
+#ifndef DB_LOG_BUFF_SIZE
+#define DB_LOG_BUFF_SIZE 256 ///< size of the log output ring buffer (bytes), can be set with a build flag
+#endif
+
+#ifndef DB_LOG_TX_INFLIGHT
+#define DB_LOG_TX_INFLIGHT 16 ///< most log bytes let into the Serial transmit buffer ahead of protocol frames, can be set with a build flag
+#endif
+
+#ifndef DB_LOG_LINE_SIZE
+#define DB_LOG_LINE_SIZE 200 ///< longest text log line (bytes), can be set with a build flag
+#endif
+
+#ifndef DB_LOG_SITE_SLOTS
+#define DB_LOG_SITE_SLOTS 8 ///< number of message sites tracked for rate limiting, can be set with a build flag
+#endif
+
+#ifndef DB_LOG_SITE_BURST
+#define DB_LOG_SITE_BURST 10 ///< most messages per site and rate window before they are suppressed, can be set with a build flag
+#endif
+
+#ifndef DB_LOG_SITE_WINDOW
+#define DB_LOG_SITE_WINDOW 1000 ///< per site rate window (ms), can be set with a build flag
+#endif
+
+#ifndef DB_LOG_BYTES_PER_SEC
+#define DB_LOG_BYTES_PER_SEC 2048 ///< default global log budget (bytes/s) [0:no limit], can be set with a build flag
+#endif
+
 /// @brief Used for printing different types of information to the Serial Output Window.
 ///
 /// @remarks This class is used in both the CypressComm and GateOperation classes.
@@ -22,15 +78,7 @@ class GateDebug
 
 	// ---------------VARIABLES---------------
 public:
-	const char _message_type_str[8][10] = {
-		"[INFO]",
-		"[INFO]",
-		"[INFO]",
-		"[INFO]",
-		"[INFO]",
-		"[ERROR]",
-		"[WARNING]",
-		"[DEBUG]"};
+	static const char _message_type_str[8][10]; ///< message type labels, stored in flash
 
 	enum MT
 	{
@@ -44,6 +92,63 @@ public:
 		DEBUG = 7
 	};
 
+	static uint8_t logLevel; ///< runtime log level, messages above it are skipped [DB_LEVEL_NONE-DB_LOG_LEVEL]
+
+	// Binary log settings
+	static bool binaryLog;					   ///< set to push compact records drained by flushLog() instead of printing text [0:text, 1:binary]
+	static const uint8_t LOG_SYNC_BYTE = 0xA5; ///< first byte of each binary log record sent by flushLog()
+	static const uint16_t LOG_ID_DROPPED = 0;  ///< message ID of the record reporting dropped records
+	static const uint16_t LOG_ID_REPEATED = 1; ///< message ID of the record reporting suppressed repeats of a message
+	static uint16_t logHighWater;			   ///< most bytes stored in the log ring buffer
+	static uint16_t logDropped;				   ///< number of messages dropped because the log ring buffer was full, saturating
+	static bool logBlockWhenFull;			   ///< set to wait for the log ring buffer to drain instead of dropping messages (e.g., during setup)
+	static uint16_t logSuppressed;			   ///< number of messages suppressed by the per site rate limit, saturating
+	static uint16_t logOverBudget;			   ///< number of messages skipped because logBytesPerSec was used up, saturating
+	static uint16_t logBytesPerSec;			   ///< global log budget (bytes/s) [0:no limit]
+
+	/// @brief Function that sends log output in place of Serial, returns the number of bytes it took [0:busy].
+	typedef uint16_t (*LogWriter)(const uint8_t[], uint16_t);
+	static LogWriter logWriter; ///< set to send log output through a protocol (e.g., SerialCom log frames) instead of writing it to Serial
+
+private:
+	// Struct for caching the message ID and argument types of a format string
+	struct FmtCacheStruct
+	{
+		const char *p_fmt; // format string address
+		uint16_t id;	   // message ID, hash of the format string
+		uint16_t argSig;   // argument types, 2 bits per argument [1:int, 2:long, 3:string]
+		uint8_t nArgs;	   // number of arguments
+		bool isP;		   // format string is stored in flash
+	};
+	static const uint8_t _fmtCacheSize = 16;
+	static FmtCacheStruct _fmtCache[_fmtCacheSize];
+
+	// Struct for rate limiting the messages of a call site
+	struct LogSiteStruct
+	{
+		const char *p_fmt;	   // format string address, identifies the call site
+		uint32_t tsWindow;	   // millis() timestamp of the start of the rate window
+		uint16_t nInWindow;	   // messages printed in the rate window
+		uint16_t nSuppressed;  // messages suppressed since the last repeat report, saturating
+		bool isP;			   // format string is stored in flash
+	};
+	static LogSiteStruct _logSite[DB_LOG_SITE_SLOTS];
+
+	// Global log budget
+	static uint16_t _budget;   // bytes left in the budget
+	static uint32_t _tsBudget; // millis() timestamp of the last budget refill
+
+	// Log output ring buffer holding text lines or framed binary records
+	static uint8_t _logBuff[DB_LOG_BUFF_SIZE];
+	static uint16_t _logHead;	  // index of the oldest byte
+	static uint16_t _logCount;	  // number of stored bytes
+	static uint16_t _nLogDropped; // number of messages dropped since the last drop report
+#ifdef SERIAL_TX_BUFFER_SIZE
+	static const uint16_t _txBuffSize = SERIAL_TX_BUFFER_SIZE; // size of the HardwareSerial transmit buffer
+#else
+	static const uint16_t _txBuffSize = 64; // size of the HardwareSerial transmit buffer
+#endif
+
 	// ---------------METHODS---------------
 public:
 	GateDebug();
@@ -51,11 +156,64 @@ public:
 public:
 	void printMsg(MT, const char *, ...);
 
+public:
+	void printMsg_P(MT, const char *, ...);
+
+private:
+	void _printMsg(MT, const char *, bool, va_list);
+
+public:
+	/// @brief Get the log level of a message type.
+	///
+	/// @param msg_type_enum Enum specifying message type.
+	///
+	/// @return Log level [DB_LEVEL_ERROR-DB_LEVEL_DEBUG].
+	static constexpr uint8_t msgLevel(MT msg_type_enum)
+	{
+		return msg_type_enum == MT::ERROR	  ? DB_LEVEL_ERROR
+			   : msg_type_enum == MT::WARNING ? DB_LEVEL_WARNING
+			   : msg_type_enum == MT::DEBUG	  ? DB_LEVEL_DEBUG
+											  : DB_LEVEL_INFO;
+	}
+
+public:
+	void flushLog(bool = false);
+
+private:
+	void _sendLogBytes();
+
+private:
+	bool _checkLogSite(const char *, bool);
+
+private:
+	bool _pushRepeatReport(LogSiteStruct &);
+
+private:
+	bool _takeLogBudget(uint16_t);
+
+private:
+	void _pushLogRecord(MT, const char *, bool, va_list);
+
+private:
+	FmtCacheStruct &_getFmtInfo(const char *, bool);
+
+private:
+	static char _fmtChar(const char *, bool);
+
+private:
+	bool _pushLogFrame(const uint8_t[], uint8_t);
+
+private:
+	bool _pushLogBytes(const uint8_t[], uint16_t);
+
+private:
+	void _countLogDropped();
+
 private:
 	const char *_timeStr(uint32_t);
 
 public:
-	const char *arrayStr(uint8_t[], size_t);
+	const char *arrayStr(const uint8_t[], size_t);
 
 public:
 	const char *binStr(uint8_t);
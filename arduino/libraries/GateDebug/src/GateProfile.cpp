@@ -0,0 +1,159 @@
+// ######################################
+
+//========= GateProfile.cpp ===========
+
+// ######################################
+
+/// @file Used for the GateProfile class
+
+//============= INCLUDE ================
+#include "GateProfile.h"
+
+//===========CLASS: GateProfile============
+
+#if DB_PROFILE
+GateProfile::ScopeStruct GateProfile::_S[GateProfile::nScopes] = {};
+#endif
+#if DB_SPAN_SIZE
+GateProfile::SpanStruct GateProfile::_Sp[DB_SPAN_SIZE] = {};
+uint16_t GateProfile::_spHead = 0;
+uint16_t GateProfile::_spCount = 0;
+#endif
+
+/// @brief Add a run time to the statistics of a profiling scope.
+///
+/// @param scope Profiling scope enum [0-nScopes-1].
+/// @param dt Run time (us).
+void GateProfile::addSample(uint8_t scope, uint32_t dt)
+{
+#if DB_PROFILE
+	if (scope >= nScopes)
+		return;
+	ScopeStruct &r_s = _S[scope];
+
+	r_s.dtMin = r_s.count == 0 || dt < r_s.dtMin ? dt : r_s.dtMin;
+	r_s.dtMax = dt > r_s.dtMax ? dt : r_s.dtMax;
+	r_s.dtSum += dt;
+	r_s.count++;
+
+	// Get histogram bin by shifting out 2 bits per bin
+	uint8_t bin_i = 0;
+	for (uint32_t dt_bin = dt >> 4; dt_bin > 0 && bin_i < nBins - 1; dt_bin >>= 2)
+		bin_i++;
+	if (r_s.hist[bin_i] < 0xFFFF)
+		r_s.hist[bin_i]++;
+#endif
+}
+
+/// @brief Clear the statistics of all profiling scopes.
+void GateProfile::resetScopes()
+{
+#if DB_PROFILE
+	memset(_S, 0, sizeof(_S));
+#endif
+}
+
+/// @brief Pack the statistics of a profiling scope for sending over serial.
+///
+/// @details Output is [scope, n_scopes, count, min, max, sum, hist[nBins]] with the
+/// 32-bit values and the 16-bit histogram counts little endian.
+///
+/// @param scope Profiling scope enum [0-nScopes-1].
+/// @param p_out Array to store the packed scope.
+/// @param s Length of "p_out".
+///
+/// @return Number of bytes stored [0:profiling disabled, scope not valid or "p_out" too short].
+uint8_t GateProfile::getScopeBytes(uint8_t scope, uint8_t p_out[], uint8_t s)
+{
+#if DB_PROFILE
+	if (scope >= nScopes || s < scopeSize)
+		return 0;
+	ScopeStruct &r_s = _S[scope];
+
+	uint8_t len = 0;
+	p_out[len++] = scope;
+	p_out[len++] = nScopes;
+	uint32_t vals[4] = {r_s.count, r_s.dtMin, r_s.dtMax, r_s.dtSum};
+	for (size_t val_i = 0; val_i < 4; val_i++)
+		for (size_t byte_i = 0; byte_i < 4; byte_i++)
+			p_out[len++] = (vals[val_i] >> (8 * byte_i)) & 0xFF;
+	for (size_t bin_i = 0; bin_i < nBins; bin_i++)
+	{
+		p_out[len++] = r_s.hist[bin_i] & 0xFF;
+		p_out[len++] = r_s.hist[bin_i] >> 8;
+	}
+	return len;
+#else
+	return 0;
+#endif
+}
+
+/// @brief Add a span record to the timeline, overwriting the oldest record when full.
+///
+/// @note Use through DB_SPAN_BEGIN(), DB_SPAN_END() or DB_SPAN_SCOPE().
+///
+/// @param kind Span record kind enum [SK_BEGIN, SK_END].
+/// @param span Timeline span enum [0-63].
+/// @param arg Span argument.
+void GateProfile::addSpan(uint8_t kind, uint8_t span, uint8_t arg)
+{
+#if DB_SPAN_SIZE
+	SpanStruct &r_sp = _Sp[(_spHead + _spCount) % DB_SPAN_SIZE];
+	r_sp = {(uint32_t)micros(), (uint8_t)(kind << 6 | (span & 0x3F)), arg};
+	if (_spCount < DB_SPAN_SIZE)
+		_spCount++;
+	else
+		_spHead = (_spHead + 1) % DB_SPAN_SIZE;
+#endif
+}
+
+/// @brief Clear the timeline.
+void GateProfile::resetSpans()
+{
+#if DB_SPAN_SIZE
+	_spHead = 0;
+	_spCount = 0;
+#endif
+}
+
+/// @brief Pack timeline span records for sending over serial.
+///
+/// @details The timeline is split into frames of up to spanFrameRecs records, oldest first.
+/// Output is [frame_i, n_frames, n_recs] followed by n_recs records packed as
+/// [ts(4), kind << 6 | span, arg] with a little endian micros() timestamp. An empty or
+/// compiled out timeline gives a single frame [0, 0, 0].
+///
+/// @param frame_i Index of the frame to pack [0-n_frames-1].
+/// @param p_out Array to store the packed frame.
+/// @param s Length of "p_out".
+///
+/// @return Number of bytes stored [0:"frame_i" not valid or "p_out" too short].
+uint8_t GateProfile::getSpanBytes(uint8_t frame_i, uint8_t p_out[], uint8_t s)
+{
+	if (s < 3 + spanFrameRecs * spanRecSize)
+		return 0;
+#if DB_SPAN_SIZE
+	uint8_t n_frames = (_spCount + spanFrameRecs - 1) / spanFrameRecs;
+#else
+	uint8_t n_frames = 0;
+#endif
+	if (frame_i >= n_frames && !(frame_i == 0 && n_frames == 0))
+		return 0;
+
+	uint8_t len = 0;
+	p_out[len++] = frame_i;
+	p_out[len++] = n_frames;
+	p_out[len++] = 0;
+#if DB_SPAN_SIZE
+	for (size_t rec_i = frame_i * spanFrameRecs; rec_i < _spCount && p_out[2] < spanFrameRecs; rec_i++)
+	{
+		SpanStruct &r_sp = _Sp[(_spHead + rec_i) % DB_SPAN_SIZE];
+		for (size_t byte_i = 0; byte_i < 4; byte_i++)
+			p_out[len++] = (r_sp.ts >> (8 * byte_i)) & 0xFF;
+		p_out[len++] = r_sp.code;
+		p_out[len++] = r_sp.arg;
+		p_out[2]++;
+	}
+#endif
+	return len;
+}
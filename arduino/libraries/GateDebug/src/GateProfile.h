@@ -0,0 +1,185 @@
+// ######################################
+
+//========== GateProfile.h ============
+
+// ######################################
+
+/// @file Used for the GateProfile class
+
+#ifndef _GATE_PROFILE_h
+#define _GATE_PROFILE_h
+
+//============= INCLUDE ================
+#include "Arduino.h"
+
+#ifndef DB_PROFILE
+#define DB_PROFILE 1 ///< set to 0 with a build flag to remove all profiling scopes from the build
+#endif
+
+#ifndef DB_SPAN_SIZE
+#define DB_SPAN_SIZE 96 ///< number of span records kept in the timeline ring buffer [0:timeline removed from the build], can be set with a build flag
+#endif
+
+#define DB_PROFILE_CAT_(a, b) a##b
+#define DB_PROFILE_CAT(a, b) DB_PROFILE_CAT_(a, b)
+
+#if DB_PROFILE
+/// @brief Time the rest of the enclosing block and add it to the statistics of a profiling scope.
+///
+/// @param scope Profiling scope enum (e.g. GateProfile::PS::POLL_PASS).
+#define DB_PROFILE_SCOPE(scope) GateProfileScope DB_PROFILE_CAT(_profScope, __LINE__)(scope)
+#else
+#define DB_PROFILE_SCOPE(scope)
+#endif
+
+#if DB_SPAN_SIZE
+/// @brief Add a span begin record to the timeline.
+///
+/// @param span Timeline span enum (e.g. GateProfile::SP::SP_WALL_TRAVEL).
+/// @param arg Span argument, e.g. the chip index.
+#define DB_SPAN_BEGIN(span, arg) GateProfile::addSpan(GateProfile::SK::SK_BEGIN, span, arg)
+/// @brief Add a span end record to the timeline, see DB_SPAN_BEGIN().
+#define DB_SPAN_END(span, arg) GateProfile::addSpan(GateProfile::SK::SK_END, span, arg)
+/// @brief Add span begin and end records around the rest of the enclosing block, see DB_SPAN_BEGIN().
+#define DB_SPAN_SCOPE(span, arg) GateSpanScope DB_PROFILE_CAT(_spanScope, __LINE__)(span, arg)
+#else
+#define DB_SPAN_BEGIN(span, arg) \
+	do                           \
+	{                            \
+	} while (0)
+#define DB_SPAN_END(span, arg) \
+	do                         \
+	{                          \
+	} while (0)
+#define DB_SPAN_SCOPE(span, arg)
+#endif
+
+/// @brief Used to collect micros() timing statistics for named code sections (profiling scopes).
+///
+/// @details Each scope accumulates the count, min, max and sum of its durations and a coarse
+/// histogram with bins that grow by a factor of 4 from 16 us [<16, <64, <256, <1024, <4096, <16384, <65536, >=65536].
+/// The table is shared by all instances so scopes in different libraries end up in one place.
+/// A timeline of span begin and end records (DB_SPAN_SCOPE()) is kept alongside for viewing a
+/// whole move, see gui/gate_timeline.py.
+class GateProfile
+{
+
+	// --------------VARIABLES--------------
+public:
+	// Profiling scopes
+	enum PS
+	{
+		I2C_SCAN = 0,	// CypressCom::i2cScan()
+		I2C_READ = 1,	// CypressCom::i2cRead()
+		I2C_WRITE = 2,	// CypressCom::i2cWrite()
+		CYP_SETUP = 3,	// CypressCom::setupCypress()
+		IO_SETUP = 4,	// GateOperation::_setupCypressIO()
+		PWM_SETUP = 5,	// GateOperation::_setupCypressPWM()
+		MOVE_TOTAL = 6, // GateOperation::moveWallsConductor()
+		MOVE_INIT = 7,	// GateOperation::_initWallsMove()
+		POLL_PASS = 8,	// GateOperation::_monitorWallsMove()
+		PWM_CUTOFF = 9, // PWM off write in GateOperation::_monitorWallsMove()
+		MSG_HANDLE = 10 // handling of a received serial message
+	};
+	static const uint8_t nScopes = 11;	 // Number of profiling scopes
+	static const uint8_t nBins = 8;		 // Number of histogram bins
+	static const uint8_t scopeSize = 34; // Bytes per scope when packed for serial [scope, n_scopes, count(4), min(4), max(4), sum(4), hist(2 x nBins)]
+
+	// Timeline spans
+	enum SP
+	{
+		SP_MOVE = 0,		// GateOperation::moveWallsConductor(), arg: number of chips moving
+		SP_CHIP_INIT = 1,	// GateOperation::_initWallsMove(), arg: chip index
+		SP_POLL_PASS = 2,	// one poll pass over all moving chips, arg: pass number (low byte)
+		SP_CHIP_POLL = 3,	// GateOperation::_monitorWallsMove(), arg: chip index
+		SP_WALL_TRAVEL = 4, // move start to limit switch of a wall, arg: chip index << 3 | wall
+		SP_PWM_CUTOFF = 5,	// PWM off write in GateOperation::_monitorWallsMove(), arg: chip index
+		SP_REPLY_TX = 6,	// building and queuing a move reply, arg: message type
+		SP_MSG = 7			// handling of a received serial message, arg: message type
+	};
+	// Span record kinds
+	enum SK
+	{
+		SK_BEGIN = 0,
+		SK_END = 1
+	};
+	static const uint8_t spanRecSize = 6;	 // Bytes per span record when packed for serial [ts(4), kind << 6 | span, arg]
+	static const uint8_t spanFrameRecs = 30; // Span records per packed timeline frame
+
+	// Struct for a timeline span record
+	struct SpanStruct
+	{
+		uint32_t ts;  // micros() timestamp
+		uint8_t code; // record kind << 6 | span
+		uint8_t arg;  // span argument
+	};
+
+	// Struct for the statistics of a scope
+	struct ScopeStruct
+	{
+		uint32_t count;		 // number of timed runs
+		uint32_t dtMin;		 // shortest run (us)
+		uint32_t dtMax;		 // longest run (us)
+		uint32_t dtSum;		 // summed run time (us)
+		uint16_t hist[nBins]; // run counts per histogram bin, saturating
+	};
+
+private:
+#if DB_PROFILE
+	static ScopeStruct _S[nScopes]; // statistics table
+#endif
+#if DB_SPAN_SIZE
+	static SpanStruct _Sp[DB_SPAN_SIZE]; // timeline ring buffer
+	static uint16_t _spHead;				// index of the oldest span record
+	static uint16_t _spCount;				// number of stored span records
+#endif
+
+	// ---------------METHODS---------------
+public:
+	static void addSample(uint8_t, uint32_t);
+
+public:
+	static void resetScopes();
+
+public:
+	static uint8_t getScopeBytes(uint8_t, uint8_t[], uint8_t);
+
+public:
+	static void addSpan(uint8_t, uint8_t, uint8_t);
+
+public:
+	static void resetSpans();
+
+public:
+	static uint8_t getSpanBytes(uint8_t, uint8_t[], uint8_t);
+};
+
+/// @brief Times its own lifetime and adds it to a profiling scope, use via DB_PROFILE_SCOPE().
+class GateProfileScope
+{
+private:
+	uint8_t _scope; // profiling scope index
+	uint32_t _ts;	// micros() timestamp at construction
+
+public:
+	GateProfileScope(uint8_t scope) : _scope(scope), _ts(micros()) {}
+
+public:
+	~GateProfileScope() { GateProfile::addSample(_scope, micros() - _ts); }
+};
+
+/// @brief Adds timeline span begin and end records for its own lifetime, use via DB_SPAN_SCOPE().
+class GateSpanScope
+{
+private:
+	uint8_t _span; // timeline span index
+	uint8_t _arg;  // span argument
+
+public:
+	GateSpanScope(uint8_t span, uint8_t arg) : _span(span), _arg(arg) { GateProfile::addSpan(GateProfile::SK::SK_BEGIN, _span, _arg); }
+
+public:
+	~GateSpanScope() { GateProfile::addSpan(GateProfile::SK::SK_END, _span, _arg); }
+};
+
+#endif
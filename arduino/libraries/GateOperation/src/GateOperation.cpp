@@ -9,6 +9,26 @@
 
 //======== CLASS: WALL_OPERATION ==========
 
+// Wall map tables stored in flash, read with pgm_read_byte()
+const uint8_t GateOperation::WallMapStruct::pwmSrc[8] PROGMEM =
+	{4, 6, 7, 5, 3, 1, 0, 2};
+const uint8_t GateOperation::WallMapStruct::ioDown[2][8] PROGMEM = {
+	{4, 1, 0, 0, 3, 3, 5, 4}, // port
+	{3, 3, 1, 7, 2, 4, 0, 7}  // pin/bit
+};
+const uint8_t GateOperation::WallMapStruct::ioUp[2][8] PROGMEM = {
+	{4, 1, 0, 3, 3, 3, 4, 4}, // port
+	{0, 2, 2, 0, 3, 5, 5, 4}  // pin/bit
+};
+const uint8_t GateOperation::WallMapStruct::pwmDown[2][8] PROGMEM = {
+	{1, 1, 0, 3, 5, 5, 5, 4}, // port
+	{1, 0, 0, 1, 2, 3, 1, 2}  // pin/bit
+};
+const uint8_t GateOperation::WallMapStruct::pwmUp[2][8] PROGMEM = {
+	{4, 1, 0, 0, 3, 3, 2, 4}, // port
+	{1, 4, 4, 5, 6, 7, 2, 6}  // pin/bit
+};
+
 /// @brief CONSTUCTOR: Create GateOperation class instance
 ///
 /// @param _nCham: Spcify number of cypress boards to track [1-49]
@@ -31,10 +51,10 @@ GateOperation::GateOperation(uint8_t _pwmDuty, uint16_t _dtMoveTimeout)
 	// Update pin function map [0,1,2,3] [io down, io up, pwm down, pwm up]
 	for (size_t i = 0; i < 8; i++)
 	{														  // loop wall map entries
-		wms.funMap[wms.ioDown[0][i]][wms.ioDown[1][i]] = 1;	  // label io down
-		wms.funMap[wms.ioUp[0][i]][wms.ioUp[1][i]] = 2;		  // label io up
-		wms.funMap[wms.pwmDown[0][i]][wms.pwmDown[1][i]] = 3; // label pwm down
-		wms.funMap[wms.pwmUp[0][i]][wms.pwmUp[1][i]] = 4;	  // label pwm up
+		wms.funMap[pgm_read_byte(&wms.ioDown[0][i])][pgm_read_byte(&wms.ioDown[1][i])] = 1;	  // label io down
+		wms.funMap[pgm_read_byte(&wms.ioUp[0][i])][pgm_read_byte(&wms.ioUp[1][i])] = 2;		  // label io up
+		wms.funMap[pgm_read_byte(&wms.pwmDown[0][i])][pgm_read_byte(&wms.pwmDown[1][i])] = 3; // label pwm down
+		wms.funMap[pgm_read_byte(&wms.pwmUp[0][i])][pgm_read_byte(&wms.pwmUp[1][i])] = 4;	  // label pwm up
 	}
 }
 
@@ -47,9 +67,9 @@ GateOperation::GateOperation(uint8_t _pwmDuty, uint16_t _dtMoveTimeout)
 /// @note these methods are only used in the construtor
 ///
 /// @param r_pms: Reference to PMS to be updated
-/// @param p_port_1: Array of port values from an @ref GateOperation::WallMapStruct
-/// @param p_pin_1: Array of pin values from an @ref GateOperation::WallMapStruct
-void GateOperation::_makePMS(PinMapStruct &r_pms, uint8_t p_port_1[], uint8_t p_pin_1[])
+/// @param p_port_1: Array of port values from an @ref GateOperation::WallMapStruct (stored in flash)
+/// @param p_pin_1: Array of pin values from an @ref GateOperation::WallMapStruct (stored in flash)
+void GateOperation::_makePMS(PinMapStruct &r_pms, const uint8_t p_port_1[], const uint8_t p_pin_1[])
 {
 	_resetPMS(r_pms);
 	_addPortPMS(r_pms, p_port_1, p_pin_1);
@@ -61,7 +81,7 @@ void GateOperation::_makePMS(PinMapStruct &r_pms, uint8_t p_port_1[], uint8_t p_
 ///
 /// @param p_port_2: Array of port values from an @ref GateOperation::WallMapStruct
 /// @param p_pin_2: Array of pin values from an @ref GateOperation::WallMapStruct
-void GateOperation::_makePMS(PinMapStruct &r_pms, uint8_t p_port_1[], uint8_t p_pin_1[], uint8_t p_port_2[], uint8_t p_pin_2[])
+void GateOperation::_makePMS(PinMapStruct &r_pms, const uint8_t p_port_1[], const uint8_t p_pin_1[], const uint8_t p_port_2[], const uint8_t p_pin_2[])
 {
 	_resetPMS(r_pms);
 	_addPortPMS(r_pms, p_port_1, p_pin_1);
@@ -75,17 +95,17 @@ void GateOperation::_makePMS(PinMapStruct &r_pms, uint8_t p_port_1[], uint8_t p_
 /// @param r_pms: Reference to PMS to be updated
 /// @param p_port: Array of port values from an @ref GateOperation::WallMapStruct
 /// @param p_pin: Array of pin values from an @ref GateOperation::WallMapStruct
-void GateOperation::_addPortPMS(PinMapStruct &r_pms, uint8_t p_port[], uint8_t p_pin[])
+void GateOperation::_addPortPMS(PinMapStruct &r_pms, const uint8_t p_port[], const uint8_t p_pin[])
 {
 
 	for (size_t wal_i = 0; wal_i < 8; wal_i++)
 	{ // loop port list by wall
 		for (size_t prt_i = 0; prt_i < 6; prt_i++)
 		{ // loop port array in struct
-			if (r_pms.portInc[prt_i] != p_port[wal_i] && r_pms.portInc[prt_i] != 255)
+			if (r_pms.portInc[prt_i] != pgm_read_byte(&p_port[wal_i]) && r_pms.portInc[prt_i] != 255)
 				continue;																 // find first emtpy  or existing entry and store there
 			r_pms.nPortsInc = r_pms.portInc[prt_i] == 255 ? prt_i + 1 : r_pms.nPortsInc; // update length
-			r_pms.portInc[prt_i] = p_port[wal_i];
+			r_pms.portInc[prt_i] = pgm_read_byte(&p_port[wal_i]);
 			break;
 		}
 	}
@@ -98,7 +118,7 @@ void GateOperation::_addPortPMS(PinMapStruct &r_pms, uint8_t p_port[], uint8_t p
 /// @param r_pms: Reference to PMS to be updated.
 /// @param p_port: Array of port values from an @ref GateOperation::WallMapStruct.
 /// @param p_pin: Array of pin values from an @ref GateOperation::WallMapStruct.
-void GateOperation::_addPinPMS(PinMapStruct &r_pms, uint8_t p_port[], uint8_t p_pin[])
+void GateOperation::_addPinPMS(PinMapStruct &r_pms, const uint8_t p_port[], const uint8_t p_pin[])
 {
 	for (size_t prt_i = 0; prt_i < 6; prt_i++)
 	{ // loop ports in struct arr
@@ -106,14 +126,14 @@ void GateOperation::_addPinPMS(PinMapStruct &r_pms, uint8_t p_port[], uint8_t p_
 			break; // bail if reached end of list
 		for (size_t wal_i = 0; wal_i < 8; wal_i++)
 		{ // loop wall list
-			if (p_port[wal_i] != r_pms.portInc[prt_i])
+			if (pgm_read_byte(&p_port[wal_i]) != r_pms.portInc[prt_i])
 				continue; // check port match
 			for (size_t pin_ii = 0; pin_ii < 8; pin_ii++)
 			{ // loop pin struct
 				if (r_pms.pinInc[prt_i][pin_ii] != 255)
 					continue;						// find first emtpy entry and store there
 				r_pms.nPinsInc[prt_i] = pin_ii + 1; // update length
-				r_pms.pinInc[prt_i][pin_ii] = p_pin[wal_i];
+				r_pms.pinInc[prt_i][pin_ii] = pgm_read_byte(&p_pin[wal_i]);
 				r_pms.wallInc[prt_i][pin_ii] = wal_i;
 				break;
 			}
@@ -232,7 +252,7 @@ void GateOperation::_updateDynamicPMS(PinMapStruct r_pms1, PinMapStruct &r_pms2,
 /// @brief Initialize/reset all relivant runtime variables to prepare for new session
 void GateOperation::initGateOperation()
 {
-	_Dbg.printMsg(_Dbg.MT::HEAD1A, "START: WALL OPPERATION INITIALIZATION");
+	DB_PRINT_MSG(_Dbg, _Dbg.MT::HEAD1A, "START: WALL OPPERATION INITIALIZATION");
 
 	// Update chamber address and existing walls map
 	for (size_t cyp_i = 0; cyp_i < CypCom.nAddr; cyp_i++)
@@ -252,7 +272,7 @@ void GateOperation::initGateOperation()
 	}
 
 	// Log/print initialization status
-	_Dbg.printMsg(_Dbg.MT::HEAD1B, "FINISHED: WALL OPPERATION INITIALIZATION");
+	DB_PRINT_MSG(_Dbg, _Dbg.MT::HEAD1B, "FINISHED: WALL OPPERATION INITIALIZATION");
 }
 
 /// @brief Initialize/reset Cypress hardware
@@ -260,13 +280,13 @@ void GateOperation::initGateOperation()
 /// @return Output from @ref Wire::endTransmission() [0-4] or [-1=255:input argument error].
 uint8_t GateOperation::initCypress()
 {
-	_Dbg.printMsg(_Dbg.MT::HEAD1A, "START: CYPRESS INITIALIZATION");
+	DB_PRINT_MSG(_Dbg, _Dbg.MT::HEAD1A, "START: CYPRESS INITIALIZATION");
 
 	// Loop through all cypress boards
 	for (size_t cyp_i = 0; cyp_i < CypCom.nAddr; cyp_i++)
 	{
 		uint8_t resp = 0;
-		_Dbg.printMsg(_Dbg.MT::INFO, "INITIALIZATING: Chamber[%d] Cypress Chip[%s]", cyp_i, _Dbg.hexStr(C[cyp_i].addr));
+		DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "INITIALIZATING: Chamber[%d] Cypress Chip[%s]", cyp_i, _Dbg.hexStr(C[cyp_i].addr));
 
 		//............... Initialize Cypress Chip ...............
 
@@ -274,11 +294,11 @@ uint8_t GateOperation::initCypress()
 		C[cyp_i].i2cStatus = C[cyp_i].i2cStatus > 0 ? C[cyp_i].i2cStatus : CypCom.setupCypress(C[cyp_i].addr);
 		if (C[cyp_i].i2cStatus != 0)
 		{
-			_Dbg.printMsg(_Dbg.MT::ERROR, "Cypress Chip Setup: chamber=[%d|%s] status[%d]", cyp_i, _Dbg.hexStr(C[cyp_i].addr), resp);
+			DB_PRINT_MSG(_Dbg, _Dbg.MT::ERROR, "Cypress Chip Setup: chamber=[%d|%s] status[%d]", cyp_i, _Dbg.hexStr(C[cyp_i].addr), resp);
 			continue; // skip chamber if failed
 		}
 		else
-			_Dbg.printMsg(_Dbg.MT::INFO, "FINISHED: Cypress Chip Setup: chamber=[%d|%s] status[%d]", cyp_i, _Dbg.hexStr(C[cyp_i].addr), resp);
+			DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "FINISHED: Cypress Chip Setup: chamber=[%d|%s] status[%d]", cyp_i, _Dbg.hexStr(C[cyp_i].addr), resp);
 
 		//............... Initialize Cypress IO ...............
 
@@ -286,11 +306,11 @@ uint8_t GateOperation::initCypress()
 		C[cyp_i].i2cStatus = C[cyp_i].i2cStatus > 0 ? C[cyp_i].i2cStatus : _setupCypressIO(C[cyp_i].addr);
 		if (C[cyp_i].i2cStatus != 0) // print error if failed
 		{
-			_Dbg.printMsg(_Dbg.MT::ERROR, "Cypress IO Setup: chamber=[%d|%s] status[%d]", cyp_i, _Dbg.hexStr(C[cyp_i].addr), resp);
+			DB_PRINT_MSG(_Dbg, _Dbg.MT::ERROR, "Cypress IO Setup: chamber=[%d|%s] status[%d]", cyp_i, _Dbg.hexStr(C[cyp_i].addr), resp);
 			continue; // skip chamber if failed
 		}
 		else
-			_Dbg.printMsg(_Dbg.MT::INFO, "FINISHED: Cypress IO Setup: chamber=[%d|%s] status[%d]", cyp_i, _Dbg.hexStr(C[cyp_i].addr), resp);
+			DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "FINISHED: Cypress IO Setup: chamber=[%d|%s] status[%d]", cyp_i, _Dbg.hexStr(C[cyp_i].addr), resp);
 
 		//............... Get Starting Wall Position ...............
 
@@ -299,7 +319,7 @@ uint8_t GateOperation::initCypress()
 
 		// Print warning if walls initialized in up position
 		if (C[cyp_i].bitWallPosition != 0)
-			_Dbg.printMsg(_Dbg.MT::WARNING, "WALLS DETECTED IN UP STATE: chamber[%d] walls%s", cyp_i, _Dbg.bitIndStr(C[cyp_i].bitWallPosition));
+			DB_PRINT_MSG(_Dbg, _Dbg.MT::WARNING, "WALLS DETECTED IN UP STATE: chamber[%d] walls%s", cyp_i, _Dbg.bitIndStr(C[cyp_i].bitWallPosition));
 
 		//............... Initialize Cypress PWM ...............
 
@@ -307,11 +327,11 @@ uint8_t GateOperation::initCypress()
 		C[cyp_i].i2cStatus = C[cyp_i].i2cStatus > 0 ? C[cyp_i].i2cStatus : _setupCypressPWM(C[cyp_i].addr);
 		if (C[cyp_i].i2cStatus != 0)
 		{
-			_Dbg.printMsg(_Dbg.MT::ERROR, "Cypress PWM Setup: chamber=[%d|%s] status[%d]", cyp_i, _Dbg.hexStr(C[cyp_i].addr), resp);
+			DB_PRINT_MSG(_Dbg, _Dbg.MT::ERROR, "Cypress PWM Setup: chamber=[%d|%s] status[%d]", cyp_i, _Dbg.hexStr(C[cyp_i].addr), resp);
 			continue; // skip chamber if failed
 		}
 		else
-			_Dbg.printMsg(_Dbg.MT::INFO, "FINISHED: Cypress PWM Setup: chamber=[%d|%s] status[%d]", cyp_i, _Dbg.hexStr(C[cyp_i].addr), resp);
+			DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "FINISHED: Cypress PWM Setup: chamber=[%d|%s] status[%d]", cyp_i, _Dbg.hexStr(C[cyp_i].addr), resp);
 	}
 
 	//............... Check Status ...............
@@ -322,10 +342,10 @@ uint8_t GateOperation::initCypress()
 		i2c_status = i2c_status == 0 ? C[cyp_i].i2cStatus : i2c_status; // update status
 
 	// Print status
-	_Dbg.printMsg(i2c_status == 0 ? _Dbg.MT::HEAD1B : _Dbg.MT::ERROR,
-				  "%s: CYPRESS INITIALIZATION: STATUS[%d]",
-				  i2c_status == 0 ? "FINISHED" : "FAILED",
-				  i2c_status);
+	DB_PRINT_MSG(_Dbg, i2c_status == 0 ? _Dbg.MT::HEAD1B : _Dbg.MT::ERROR,
+				       "%s: CYPRESS INITIALIZATION: STATUS[%d]",
+				       i2c_status == 0 ? "FINISHED" : "FAILED",
+				       i2c_status);
 
 	return i2c_status;
 }
@@ -337,8 +357,8 @@ uint8_t GateOperation::initCypress()
 uint8_t GateOperation::initWalls(uint8_t move_dir)
 {
 	uint8_t run_status = 0;
-	_Dbg.printMsg(_Dbg.MT::HEAD1A, "START: WALL %s INITIALIZATION",
-				  move_dir == 1 ? "UP" : "DWON");
+	DB_PRINT_MSG(_Dbg, _Dbg.MT::HEAD1A, "START: WALL %s INITIALIZATION",
+				       move_dir == 1 ? "UP" : "DWON");
 
 	//............... Run Walls Up for initialize/reinitialize ...............
 
@@ -371,10 +391,10 @@ uint8_t GateOperation::initWalls(uint8_t move_dir)
 	//............... Check Status ...............
 
 	// Print status
-	_Dbg.printMsg(run_status <= 1 ? _Dbg.MT::HEAD1B : _Dbg.MT::ERROR,
-				  "%s: WALL %s INITIALIZATION: STATUS[%d]",
-				  run_status <= 1 ? "FINISHED" : "FAILED",
-				  move_dir == 1 ? "UP" : "DOWN", run_status);
+	DB_PRINT_MSG(_Dbg, run_status <= 1 ? _Dbg.MT::HEAD1B : _Dbg.MT::ERROR,
+				       "%s: WALL %s INITIALIZATION: STATUS[%d]",
+				       run_status <= 1 ? "FINISHED" : "FAILED",
+				       move_dir == 1 ? "UP" : "DOWN", run_status);
 
 	return run_status;
 }
@@ -390,6 +410,8 @@ uint8_t GateOperation::initWalls(uint8_t move_dir)
 /// @return method output from @ref Wire::endTransmission().
 uint8_t GateOperation::_setupCypressIO(uint8_t address)
 {
+	DB_PROFILE_SCOPE(GateProfile::PS::IO_SETUP);
+
 	uint8_t i2c_status = 0;
 
 	// Set entire output register to off
@@ -428,12 +450,14 @@ uint8_t GateOperation::_setupCypressIO(uint8_t address)
 /// @return Wire::method output from @ref Wire::endTransmission() or [-1=255:input argument error].
 uint8_t GateOperation::_setupCypressPWM(uint8_t address)
 {
+	DB_PROFILE_SCOPE(GateProfile::PS::PWM_SETUP);
+
 	uint8_t i2c_status = 0;
 
 	// Setup PWM sources
 	for (size_t src_i = 0; src_i < 8; src_i++)
 	{
-		i2c_status = CypCom.setupSourcePWM(address, wms.pwmSrc[src_i], pwmDuty);
+		i2c_status = CypCom.setupSourcePWM(address, pgm_read_byte(&wms.pwmSrc[src_i]), pwmDuty);
 		if (i2c_status != 0)
 			return i2c_status;
 	}
@@ -472,6 +496,9 @@ uint8_t GateOperation::_setupCypressPWM(uint8_t address)
 /// @endcode
 uint8_t GateOperation::setWallsToMove(uint8_t cyp_i, uint8_t byte_wall_state_new)
 {
+	// Any armed register images are stale once the move flags change
+	isArmed = false;
+
 	// Set up/down move flags using bitwise comparison and exclude any walls with errors
 	C[cyp_i].bitWallMoveUpFlag = ~C[cyp_i].bitWallPosition &
 								 byte_wall_state_new;
@@ -481,18 +508,163 @@ uint8_t GateOperation::setWallsToMove(uint8_t cyp_i, uint8_t byte_wall_state_new
 	// Bail if nothing to move
 	if (C[cyp_i].bitWallMoveUpFlag == 0 && C[cyp_i].bitWallMoveDownFlag == 0)
 	{
-		_Dbg.printMsg(_Dbg.MT::INFO, "FINISHED: WALL MOVE SETUP: No Walls to Move: chamber[%d]", cyp_i);
+		DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "FINISHED: WALL MOVE SETUP: No Walls to Move: chamber[%d]", cyp_i);
 		return 0;
 	}
 	else
 	{
-		_Dbg.printMsg(_Dbg.MT::INFO, "FINISHED: WALL MOVE SETUP: chamber[%d] up%s down%s", cyp_i,
-					  C[cyp_i].bitWallMoveUpFlag > 0 ? _Dbg.bitIndStr(C[cyp_i].bitWallMoveUpFlag) : "[none]",
-					  C[cyp_i].bitWallMoveDownFlag > 0 ? _Dbg.bitIndStr(C[cyp_i].bitWallMoveDownFlag) : "[none]");
+		DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "FINISHED: WALL MOVE SETUP: chamber[%d] up%s down%s", cyp_i,
+					       C[cyp_i].bitWallMoveUpFlag > 0 ? _Dbg.bitIndStr(C[cyp_i].bitWallMoveUpFlag) : "[none]",
+					       C[cyp_i].bitWallMoveDownFlag > 0 ? _Dbg.bitIndStr(C[cyp_i].bitWallMoveDownFlag) : "[none]");
 		return 1;
 	}
 }
 
+/// @brief Clear the move flags of all chambers and disarm.
+///
+/// @details Called whenever a new move is staged from scratch and when arming fails, so walls
+/// flagged by an earlier armed or failed move are not moved by the next one.
+void GateOperation::clearWallsMove()
+{
+	for (size_t cyp_i = 0; cyp_i < CypCom.nAddr; cyp_i++)
+	{
+		C[cyp_i].bitWallMoveUpFlag = 0;
+		C[cyp_i].bitWallMoveDownFlag = 0;
+	}
+	isArmed = false;
+}
+
+/// @brief Get the EEPROM address of a configuration table entry.
+///
+/// @note The table is a layout version byte (@ref GateOperation::eepromConfigVersion) followed
+/// by @ref GateOperation::maxConfig entries of one byte with the number of stored chips (0xFF
+/// when empty) and @ref GateOperation::maxConfigCyp wall bytes.
+///
+/// @param cfg_i Index of the configuration [0-maxConfig].
+///
+/// @return EEPROM address of the entry.
+uint16_t GateOperation::_configAddr(uint8_t cfg_i)
+{
+	return eepromConfigAddr + 1 + cfg_i * (maxConfigCyp + 1);
+}
+
+/// @brief Store a maze configuration in the EEPROM configuration table.
+///
+/// @note A table without the current layout version, as written by an older firmware or
+/// never written, is cleared first. Unchanged bytes are not rewritten.
+///
+/// @param cfg_i Index of the configuration to store [0-maxConfig].
+/// @param p_wall_byte_arr Byte array with the wall position bytes for each chip [0:down, 1:up].
+/// @param s Length of "p_wall_byte_arr" [0-maxCyp].
+///
+/// @return Status codes [0:success] or [-1=255:input argument error].
+///
+/// @see GateOperation::_configAddr()
+uint8_t GateOperation::storeWallConfig(uint8_t cfg_i, uint8_t p_wall_byte_arr[], uint8_t s)
+{
+	if (cfg_i >= maxConfig || s > maxCyp)
+		return -1;
+
+	// Start a new table if the stored layout does not match
+	if (EEPROM.read(eepromConfigAddr) != eepromConfigVersion)
+	{
+		for (size_t c_i = 0; c_i < maxConfig; c_i++)
+			EEPROM.update(_configAddr(c_i), 0xFF);
+		EEPROM.update(eepromConfigAddr, eepromConfigVersion);
+		DB_PRINT_MSG(_Dbg, _Dbg.MT::WARNING, "WALL CONFIG TABLE CLEARED: layout version[%d]", eepromConfigVersion);
+	}
+
+	uint16_t addr = _configAddr(cfg_i);
+	EEPROM.update(addr, s);
+	for (size_t cyp_i = 0; cyp_i < maxConfigCyp; cyp_i++)
+		EEPROM.update(addr + 1 + cyp_i, cyp_i < s ? p_wall_byte_arr[cyp_i] : 0);
+
+	DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "FINISHED: STORE WALL CONFIG: config[%d] chambers[%d] walls%s", cfg_i, s, _Dbg.arrayStr(p_wall_byte_arr, s));
+	return 0;
+}
+
+/// @brief Set all walls for movement from a maze configuration stored in EEPROM.
+///
+/// @param cfg_i Index of the configuration to apply [0-maxConfig].
+///
+/// @return Status codes [0:no move, 1:success, 2:empty configuration, 3:table stored with another layout] or [-1=255:input argument error].
+///
+/// @see GateOperation::storeWallConfig()
+uint8_t GateOperation::setWallsToConfig(uint8_t cfg_i)
+{
+	// The configuration replaces any staged or armed move
+	clearWallsMove();
+	if (cfg_i >= maxConfig)
+		return -1;
+
+	// Reject a table written with another layout, a never written table reads as empty
+	uint8_t version = EEPROM.read(eepromConfigAddr);
+	if (version != eepromConfigVersion)
+	{
+		DB_PRINT_MSG(_Dbg, _Dbg.MT::WARNING, "SKIPPED: WALL CONFIG SETUP: Table Layout: config[%d] version[%d]", cfg_i, version);
+		return version == 0xFF ? 2 : 3;
+	}
+
+	uint16_t addr = _configAddr(cfg_i);
+	uint8_t n_cyp = EEPROM.read(addr);
+	if (n_cyp > maxConfigCyp)
+	{
+		DB_PRINT_MSG(_Dbg, _Dbg.MT::WARNING, "SKIPPED: WALL CONFIG SETUP: Empty Config: config[%d]", cfg_i);
+		return 2;
+	}
+
+	// Set walls to move for all stored chambers
+	uint8_t run_status = 0;
+	for (size_t cyp_i = 0; cyp_i < n_cyp && cyp_i < CypCom.nAddr; cyp_i++)
+		run_status |= setWallsToMove(cyp_i, EEPROM.read(addr + 1 + cyp_i));
+
+	return run_status;
+}
+
+/// @brief Precompute the output register images for all walls set to move so that the move
+/// can later be started with a single register write per chip.
+///
+/// @details
+/// This method depends on the move flags being set by the `setWallsToMove()` method and
+/// is cleared by any later call to it. The armed move is started by `moveWallsConductor()`.
+/// On an i2c error all move flags are cleared, see `clearWallsMove()`.
+///
+/// @return Status codes [0:no move, 1:armed, 2:i2c error].
+uint8_t GateOperation::armWallsMove()
+{
+	uint8_t run_status = 0;
+	isArmed = false;
+
+	for (size_t cyp_i = 0; cyp_i < CypCom.nAddr; cyp_i++)
+	{
+		if (C[cyp_i].bitWallMoveUpFlag == 0 && C[cyp_i].bitWallMoveDownFlag == 0)
+			continue;
+
+		// Build active pin maps and get the current output register values
+		_stageWallsMove(cyp_i);
+		uint8_t resp = CypCom.ioReadReg(C[cyp_i].addr, REG_GO0, C[cyp_i].regOutArm, 6);
+		if (resp != 0)
+		{
+			DB_PRINT_MSG(_Dbg, _Dbg.MT::ERROR, "Arm Walls Move: chamber=[%d|%s] status[%d]", cyp_i, _Dbg.hexStr(C[cyp_i].addr), resp);
+			run_status = 2;
+			continue;
+		}
+
+		// Set the active pwm bits in the register image
+		for (size_t prt_i = 0; prt_i < 6; prt_i++)
+			C[cyp_i].regOutArm[prt_i] |= C[cyp_i].pmsActvPWM.byteMaskAll[prt_i];
+		run_status = run_status == 0 ? 1 : run_status;
+	}
+
+	// Drop the flags of a failed arm so they do not leak into the next move
+	if (run_status == 2)
+		clearWallsMove();
+	isArmed = run_status == 1;
+	DB_PRINT_MSG(_Dbg, run_status <= 1 ? _Dbg.MT::INFO : _Dbg.MT::ERROR, "%s: ARM WALLS MOVE: STATUS[%d]",
+				       run_status <= 1 ? "FINISHED" : "FAILED", run_status);
+	return run_status;
+}
+
 /// @brief Private workhorse of the class, which mannages initiating and compleating
 /// the wall movement for each block of cypress boards
 ///
@@ -503,6 +675,8 @@ uint8_t GateOperation::setWallsToMove(uint8_t cyp_i, uint8_t byte_wall_state_new
 /// @return Status/error codes [0:no move, 1:success, 2:i2c error, 3:timeout] or [-1=255:input argument error].
 uint8_t GateOperation::moveWallsConductor()
 {
+	DB_PROFILE_SCOPE(GateProfile::PS::MOVE_TOTAL);
+
 	// Create and array of all cypress boards set to move
 	uint8_t cyp_arr[CypCom.nAddr];
 	uint8_t n_cyp_move = 0;
@@ -515,15 +689,19 @@ uint8_t GateOperation::moveWallsConductor()
 	// Bail if no cypress boards set to move
 	if (n_cyp_move == 0)
 	{
-		_Dbg.printMsg(_Dbg.MT::INFO, "SKIPPED: STAGED MOVE WALL: No Walls to Move");
+		DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "SKIPPED: STAGED MOVE WALL: No Walls to Move");
 		return 0;
 	}
+	DB_SPAN_SCOPE(GateProfile::SP::SP_MOVE, n_cyp_move);
 
 	uint8_t run_status = 0;
 
 	// Set timeout variables
 	uint32_t ts_start = millis();
+	uint32_t ts_trigger = tsMoveTrigger != 0 ? tsMoveTrigger : micros();
 	_Dbg.dtTrack(1);
+	MoveTs = {};
+	MoveTs.tsStart = micros();
 
 	//............... Start Wall Move ...............
 
@@ -535,14 +713,27 @@ uint8_t GateOperation::moveWallsConductor()
 		uint8_t resp = _initWallsMove(cyp_i);
 		run_status = run_status <= 1 ? resp : run_status; // update overal run status
 
+		// Start the travel span of each wall set to move
+		for (size_t wall_i = 0; wall_i < 8; wall_i++)
+			if (bitRead(C[cyp_i].bitWallMoveUpFlag | C[cyp_i].bitWallMoveDownFlag, wall_i))
+				DB_SPAN_BEGIN(GateProfile::SP::SP_WALL_TRAVEL, cyp_i << 3 | wall_i);
+
+		// Track latency from trigger to first pwm write
+		if (i == 0)
+		{
+			dtTriggerToPwm = micros() - ts_trigger;
+			Sync.logEvent(Sync.EV::MOVE_START);
+		}
+
 		// Print walls being moved
-		_Dbg.printMsg(_Dbg.MT::INFO, "\t START: Walls Move: chamber[%d] up%s down%s error%s status[%d]",
-					  cyp_i,
-					  C[cyp_i].bitWallMoveUpFlag > 0 ? _Dbg.bitIndStr(C[cyp_i].bitWallMoveUpFlag) : "[none]",
-					  C[cyp_i].bitWallMoveDownFlag > 0 ? _Dbg.bitIndStr(C[cyp_i].bitWallMoveDownFlag) : "[none]",
-					  C[cyp_i].bitWallErrorFlag > 0 ? _Dbg.bitIndStr(C[cyp_i].bitWallErrorFlag) : "[none]",
-					  resp);
+		DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "\t START: Walls Move: chamber[%d] up%s down%s error%s status[%d]",
+					       cyp_i,
+					       C[cyp_i].bitWallMoveUpFlag > 0 ? _Dbg.bitIndStr(C[cyp_i].bitWallMoveUpFlag) : "[none]",
+					       C[cyp_i].bitWallMoveDownFlag > 0 ? _Dbg.bitIndStr(C[cyp_i].bitWallMoveDownFlag) : "[none]",
+					       C[cyp_i].bitWallErrorFlag > 0 ? _Dbg.bitIndStr(C[cyp_i].bitWallErrorFlag) : "[none]",
+					       resp);
 	}
+	MoveTs.tsPwmOn = micros();
 
 	//............... Monitor Wall Move ...............
 
@@ -551,9 +742,12 @@ uint8_t GateOperation::moveWallsConductor()
 	uint8_t do_move_check = 1; // will track if all chamber movement done
 
 	// Track wall movement
+	uint16_t n_poll = 0;
 	while (!is_timedout && do_move_check != 0) // loop till finished or timed out
 	{
 		do_move_check = 0; // reset check flag
+		n_poll++;
+		DB_SPAN_SCOPE(GateProfile::SP::SP_POLL_PASS, n_poll & 0xFF);
 
 		for (size_t i = 0; i < n_cyp_move; i++)
 		{
@@ -571,15 +765,23 @@ uint8_t GateOperation::moveWallsConductor()
 			is_timedout = millis() >= ts_start + dtMoveTimeout; // check for timeout
 
 			// Update check flag and and timeout flag
-			do_move_check += C[cyp_i].bitWallMoveUpFlag;
-			do_move_check += C[cyp_i].bitWallMoveDownFlag;
+			/// @note: or the flags, a sum can wrap to 0 with several chips moving
+			do_move_check |= C[cyp_i].bitWallMoveUpFlag;
+			do_move_check |= C[cyp_i].bitWallMoveDownFlag;
 		}
 	}
 
 	//............... Check/Track Final Move Status ...............
 
+	// Update move counters
+	MoveCnt.nMoves++;
+	MoveCnt.nPollPasses += n_poll;
+	MoveCnt.nPollLastMove = n_poll;
+	MoveCnt.nPollMax = n_poll > MoveCnt.nPollMax ? n_poll : MoveCnt.nPollMax;
+
 	// Check for timeout
 	run_status = is_timedout ? 3 : run_status; // update overal run status
+	Sync.logEvent(run_status <= 1 ? Sync.EV::MOVE_END : Sync.EV::MOVE_FAIL);
 
 	// Check final status
 	for (size_t i = 0; i < n_cyp_move; i++)
@@ -588,15 +790,15 @@ uint8_t GateOperation::moveWallsConductor()
 
 		// Check status for this chamber
 		bool is_err = C[cyp_i].bitWallMoveUpFlag != 0 || C[cyp_i].bitWallMoveDownFlag != 0;
-		_Dbg.printMsg(is_err ? _Dbg.MT::ERROR : _Dbg.MT::INFO,
-					  "%s%s: Walls Move: chamber[%d] up%s down%s error%s status[%d]",
-					  is_err ? " " : "\t",
-					  is_err ? "FAILED" : "FINISHED",
-					  cyp_i,
-					  C[cyp_i].bitWallMoveUpFlag > 0 ? _Dbg.bitIndStr(C[cyp_i].bitWallMoveUpFlag) : "[done]",
-					  C[cyp_i].bitWallMoveDownFlag > 0 ? _Dbg.bitIndStr(C[cyp_i].bitWallMoveDownFlag) : "[done]",
-					  C[cyp_i].bitWallErrorFlag > 0 ? _Dbg.bitIndStr(C[cyp_i].bitWallErrorFlag) : "[none]",
-					  run_status);
+		DB_PRINT_MSG(_Dbg, is_err ? _Dbg.MT::ERROR : _Dbg.MT::INFO,
+					       "%s%s: Walls Move: chamber[%d] up%s down%s error%s status[%d]",
+					       is_err ? " " : "\t",
+					       is_err ? "FAILED" : "FINISHED",
+					       cyp_i,
+					       C[cyp_i].bitWallMoveUpFlag > 0 ? _Dbg.bitIndStr(C[cyp_i].bitWallMoveUpFlag) : "[done]",
+					       C[cyp_i].bitWallMoveDownFlag > 0 ? _Dbg.bitIndStr(C[cyp_i].bitWallMoveDownFlag) : "[done]",
+					       C[cyp_i].bitWallErrorFlag > 0 ? _Dbg.bitIndStr(C[cyp_i].bitWallErrorFlag) : "[none]",
+					       run_status);
 
 		// Handle chamber failure
 		if (C[cyp_i].bitWallMoveUpFlag != 0 || C[cyp_i].bitWallMoveDownFlag != 0)
@@ -607,30 +809,23 @@ uint8_t GateOperation::moveWallsConductor()
 			// Turn off all pwm for this chamber
 			uint8_t resp = CypCom.ioWriteReg(C[cyp_i].addr, pmsAllPWM.byteMaskAll, 6, 0); // stop all pwm output
 			run_status = run_status <= 1 ? resp : run_status;							   // update overal run status
+			MoveTs.tsPwmOff = micros();
 		}
 	}
 
 	// Reset move flags
-	for (size_t cyp_i = 0; cyp_i < CypCom.nAddr; cyp_i++)
-	{
-		C[cyp_i].bitWallMoveUpFlag = 0;
-		C[cyp_i].bitWallMoveDownFlag = 0;
-	}
+	clearWallsMove();
+	tsMoveTrigger = 0;
+	MoveTs.tsEnd = micros();
 
 	return run_status;
 }
 
-/// @brief Used to start wall movement through PWM output
+/// @brief Used to build the dynamic active pin maps for the walls set to move
 ///
 /// @param cyp_i Index/number of the chamber to set [0-48]
-///
-/// @return Status/error codes [1:move started, 2:i2c error] or [-1=255:input argument error].
-uint8_t GateOperation::_initWallsMove(uint8_t cyp_i)
+void GateOperation::_stageWallsMove(uint8_t cyp_i)
 {
-	// Handle array inputs
-	if (cyp_i > CypCom.nAddr)
-		return -1;
-
 	// Reset/Modify in dynamic PinMapStruct
 	_resetPMS(C[cyp_i].pmsActvPWM);
 	_resetPMS(C[cyp_i].pmsActvIO);
@@ -640,9 +835,34 @@ uint8_t GateOperation::_initWallsMove(uint8_t cyp_i)
 	_updateDynamicPMS(pmsUpIO, C[cyp_i].pmsActvIO, C[cyp_i].bitWallMoveUpFlag);		  // pwm up
 	_updateDynamicPMS(pmsDownPWM, C[cyp_i].pmsActvPWM, C[cyp_i].bitWallMoveDownFlag); // io down
 	_updateDynamicPMS(pmsUpPWM, C[cyp_i].pmsActvPWM, C[cyp_i].bitWallMoveUpFlag);	  // io up
+}
+
+/// @brief Used to start wall movement through PWM output
+///
+/// @note Armed moves write the register image precomputed by @ref GateOperation::armWallsMove()
+/// and skip the pin map and register read steps.
+///
+/// @param cyp_i Index/number of the chamber to set [0-48]
+///
+/// @return Status/error codes [1:move started, 2:i2c error] or [-1=255:input argument error].
+uint8_t GateOperation::_initWallsMove(uint8_t cyp_i)
+{
+	DB_PROFILE_SCOPE(GateProfile::PS::MOVE_INIT);
+	DB_SPAN_SCOPE(GateProfile::SP::SP_CHIP_INIT, cyp_i);
+
+	// Handle array inputs
+	if (cyp_i > CypCom.nAddr)
+		return -1;
 
 	// Move walls up/down
-	uint8_t i2c_status = CypCom.ioWriteReg(C[cyp_i].addr, C[cyp_i].pmsActvPWM.byteMaskAll, 6, 1);
+	uint8_t i2c_status;
+	if (isArmed)
+		i2c_status = CypCom.i2cWrite(C[cyp_i].addr, REG_GO0, C[cyp_i].regOutArm, 6);
+	else
+	{
+		_stageWallsMove(cyp_i);
+		i2c_status = CypCom.ioWriteReg(C[cyp_i].addr, C[cyp_i].pmsActvPWM.byteMaskAll, 6, 1);
+	}
 
 	// Return run status
 	return i2c_status != 0 ? 2 : 1;
@@ -658,6 +878,9 @@ uint8_t GateOperation::_initWallsMove(uint8_t cyp_i)
 /// @return Status/error codes [0:still_waiting 1:all_move_down, 2:i2c error, 3:temeout] or [-1=255:input argument error].
 uint8_t GateOperation::_monitorWallsMove(uint8_t cyp_i)
 {
+	DB_PROFILE_SCOPE(GateProfile::PS::POLL_PASS);
+	DB_SPAN_SCOPE(GateProfile::SP::SP_CHIP_POLL, cyp_i);
+
 	// Handle array inputs
 	if (cyp_i > CypCom.nAddr)
 		return -1;
@@ -668,6 +891,7 @@ uint8_t GateOperation::_monitorWallsMove(uint8_t cyp_i)
 	// Get io input and output registry bytes.
 	uint8_t io_all_reg[14];
 	i2c_status = CypCom.ioReadReg(C[cyp_i].addr, REG_GI0, io_all_reg, 14); // read through all input registers (6 active, 2 unused) and the 6 active output registers
+	uint32_t ts_read = micros();
 
 	// Copy out input and output registry values seperately
 	uint8_t io_in_reg[6] = {io_all_reg[0], io_all_reg[1], io_all_reg[2], io_all_reg[3], io_all_reg[4], io_all_reg[5]};		// copy out values
@@ -704,8 +928,8 @@ uint8_t GateOperation::_monitorWallsMove(uint8_t cyp_i)
 			// Update pwm registry array
 			/// @note: sets both up and down pwm reg entries to be turned off as this makes the code easier
 			uint8_t wall_n = C[cyp_i].pmsActvIO.wallInc[prt_i][pin_i]; // get wall number
-			bitWrite(io_out_mask[wms.pwmDown[0][wall_n]], wms.pwmDown[1][wall_n], 1);
-			bitWrite(io_out_mask[wms.pwmUp[0][wall_n]], wms.pwmUp[1][wall_n], 1);
+			bitWrite(io_out_mask[pgm_read_byte(&wms.pwmDown[0][wall_n])], pgm_read_byte(&wms.pwmDown[1][wall_n]), 1);
+			bitWrite(io_out_mask[pgm_read_byte(&wms.pwmUp[0][wall_n])], pgm_read_byte(&wms.pwmUp[1][wall_n]), 1);
 
 			// Get triggered switch [1:io_down, 2:io_up]
 			uint8_t swtch_fun = wms.funMap[port_n][pin_n];
@@ -723,23 +947,75 @@ uint8_t GateOperation::_monitorWallsMove(uint8_t cyp_i)
 			// Flag to update pwm
 			do_pwm_update = true;
 
+			// Output and log switch event
+			Sync.logEvent(swtch_fun == 1 ? Sync.EV::WALL_DOWN : Sync.EV::WALL_UP, cyp_i, wall_n);
+			DB_SPAN_END(GateProfile::SP::SP_WALL_TRAVEL, cyp_i << 3 | wall_n);
+
 			// Print wall move finished message
-			_Dbg.printMsg(_Dbg.MT::INFO, "\t\t FINISHED: Wall Move: chamber[%d] wall[%d][%s] dt[%s]",
-						  cyp_i, wall_n, swtch_fun == 1 ? "down" : "up", _Dbg.dtTrack());
+			DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "\t\t FINISHED: Wall Move: chamber[%d] wall[%d][%s] dt[%s]",
+						       cyp_i, wall_n, swtch_fun == 1 ? "down" : "up", _Dbg.dtTrack());
 		}
 	}
 
 	// Send pwm off command if move complete or timed out
 	if (do_pwm_update)
-	{																					 // check for update flag
+	{ // check for update flag
+		DB_PROFILE_SCOPE(GateProfile::PS::PWM_CUTOFF);
+		DB_SPAN_SCOPE(GateProfile::SP::SP_PWM_CUTOFF, cyp_i);
+		MoveTs.tsLastSwitch = ts_read;
 		uint8_t resp = CypCom.ioWriteReg(C[cyp_i].addr, io_out_mask, 6, 0, io_out_reg); // include last reg read and turn off pwms
 		i2c_status = i2c_status == 0 ? resp : i2c_status;								 // update i2c status
+		MoveTs.tsPwmOff = micros();
 	}
 
 	// Return run status
 	return i2c_status != 0 ? 2 : (C[cyp_i].bitWallMoveUpFlag == 0 && C[cyp_i].bitWallMoveDownFlag == 0);
 }
 
+/// @brief Pack the move counters for sending over serial.
+///
+/// @param p_out Array to store the counters as little endian values, see MoveCountStruct.
+/// @param s Length of "p_out".
+///
+/// @return Number of bytes stored [0:"p_out" too short, moveCountSize].
+uint8_t GateOperation::getCounts(uint8_t p_out[], uint8_t s)
+{
+	if (s < moveCountSize)
+		return 0;
+
+	uint8_t len = 0;
+	uint32_t vals[4] = {MoveCnt.nMoves, MoveCnt.nPollPasses, MoveCnt.nPollLastMove, MoveCnt.nPollMax};
+	for (size_t val_i = 0; val_i < 4; val_i++)
+		for (size_t byte_i = 0; byte_i < (val_i < 2 ? 4 : 2); byte_i++)
+			p_out[len++] = (vals[val_i] >> (8 * byte_i)) & 0xFF;
+	return len;
+}
+
+/// @brief Reset the move counters.
+void GateOperation::resetCounts()
+{
+	MoveCnt = {};
+}
+
+/// @brief Pack the stage timestamps of the last move for sending over serial.
+///
+/// @param p_out Array to store the timestamps as little endian micros() values, see MoveTimeStruct.
+/// @param s Length of "p_out".
+///
+/// @return Number of bytes stored [0:"p_out" too short, moveTimeSize].
+uint8_t GateOperation::getMoveTimes(uint8_t p_out[], uint8_t s)
+{
+	if (s < moveTimeSize)
+		return 0;
+
+	uint8_t len = 0;
+	uint32_t vals[5] = {MoveTs.tsStart, MoveTs.tsPwmOn, MoveTs.tsLastSwitch, MoveTs.tsPwmOff, MoveTs.tsEnd};
+	for (size_t val_i = 0; val_i < 5; val_i++)
+		for (size_t byte_i = 0; byte_i < 4; byte_i++)
+			p_out[len++] = (vals[val_i] >> (8 * byte_i)) & 0xFF;
+	return len;
+}
+
 /// @brief Used to get the current wall state/position based on limit switch IO
 ///
 /// @param cyp_i Index/number of the chamber to set [0-CypCom.nAddr].
@@ -763,10 +1039,10 @@ uint8_t GateOperation::getWallState(uint8_t cyp_i, uint8_t pos_state_get, uint8_
 	{
 		// Get down io state
 		if (pos_state_get == 0)
-			bitWrite(byte_state_out, wall_i, bitRead(io_in_reg[wms.ioDown[0][wall_i]], wms.ioDown[1][wall_i]));
+			bitWrite(byte_state_out, wall_i, bitRead(io_in_reg[pgm_read_byte(&wms.ioDown[0][wall_i])], pgm_read_byte(&wms.ioDown[1][wall_i])));
 		// Get up io state
 		else
-			bitWrite(byte_state_out, wall_i, bitRead(io_in_reg[wms.ioUp[0][wall_i]], wms.ioUp[1][wall_i]));
+			bitWrite(byte_state_out, wall_i, bitRead(io_in_reg[pgm_read_byte(&wms.ioUp[0][wall_i])], pgm_read_byte(&wms.ioUp[1][wall_i])));
 	}
 
 	return resp;
@@ -810,7 +1086,7 @@ uint8_t GateOperation::testWallIO(uint8_t cyp_i, uint8_t p_wall_inc[], uint8_t s
 	// Test input pins
 	uint8_t r_bit_out;
 	uint8_t resp = 0;
-	_Dbg.printMsg(_Dbg.MT::HEAD1, "RUNNING: Test IO switches: chamber[%d] walls%s", cyp_i, _Dbg.arrayStr(p_wi, s));
+	DB_PRINT_MSG(_Dbg, _Dbg.MT::HEAD1, "RUNNING: Test IO switches: chamber[%d] walls%s", cyp_i, _Dbg.arrayStr(p_wi, s));
 	while (true)
 	{ // loop indefinitely
 		for (size_t i = 0; i < s; i++)
@@ -818,25 +1094,25 @@ uint8_t GateOperation::testWallIO(uint8_t cyp_i, uint8_t p_wall_inc[], uint8_t s
 			uint8_t wall_n = p_wi[i];
 
 			// Check down pins
-			resp = CypCom.ioReadPin(C[cyp_i].addr, wms.ioDown[0][wall_n], wms.ioDown[1][wall_n], r_bit_out);
+			resp = CypCom.ioReadPin(C[cyp_i].addr, pgm_read_byte(&wms.ioDown[0][wall_n]), pgm_read_byte(&wms.ioDown[1][wall_n]), r_bit_out);
 			if (resp != 0) // break out of loop if error returned
 				break;
 			if (r_bit_out == 1)
-				_Dbg.printMsg(_Dbg.MT::INFO, "\t Wall %d: down", wall_n);
+				DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "\t Wall %d: down", wall_n);
 
 			// Check up pins
-			resp = CypCom.ioReadPin(C[cyp_i].addr, wms.ioUp[0][wall_n], wms.ioUp[1][wall_n], r_bit_out);
+			resp = CypCom.ioReadPin(C[cyp_i].addr, pgm_read_byte(&wms.ioUp[0][wall_n]), pgm_read_byte(&wms.ioUp[1][wall_n]), r_bit_out);
 			if (resp != 0) // break out of loop if error returned
 				break;
 			if (r_bit_out == 1)
-				_Dbg.printMsg(_Dbg.MT::INFO, "\t Wall %d: up", wall_n);
+				DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "\t Wall %d: up", wall_n);
 
 			// Add small delay
 			delay(10);
 		}
 	}
 	// Print failure message if while loop is broken out of because of I2C coms issues
-	_Dbg.printMsg(_Dbg.MT::ERROR, "Test IO switches: chamber[%d] walls%s", cyp_i, _Dbg.arrayStr(p_wi, s));
+	DB_PRINT_MSG(_Dbg, _Dbg.MT::ERROR, "Test IO switches: chamber[%d] walls%s", cyp_i, _Dbg.arrayStr(p_wi, s));
 	return resp;
 }
 
@@ -868,25 +1144,25 @@ uint8_t GateOperation::testWallPWM(uint8_t cyp_i, uint8_t p_wall_inc[], uint8_t
 	}
 
 	// Run each wall up then down for dt_run ms
-	_Dbg.printMsg(_Dbg.MT::HEAD1, "RUNNING: Test PWM: chamber[%d] walls%s", cyp_i, _Dbg.arrayStr(p_wi, s));
+	DB_PRINT_MSG(_Dbg, _Dbg.MT::HEAD1, "RUNNING: Test PWM: chamber[%d] walls%s", cyp_i, _Dbg.arrayStr(p_wi, s));
 	uint8_t resp = 0;
 	for (size_t i = 0; i < s; i++)
 	{ // loop walls
 		uint8_t wall_n = p_wi[i];
-		_Dbg.printMsg(_Dbg.MT::INFO, "\t Wall %d: Up", wall_n);
-		resp = CypCom.ioWritePin(C[cyp_i].addr, wms.pwmUp[0][wall_n], wms.pwmUp[1][wall_n], 1); // run wall up
+		DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "\t Wall %d: Up", wall_n);
+		resp = CypCom.ioWritePin(C[cyp_i].addr, pgm_read_byte(&wms.pwmUp[0][wall_n]), pgm_read_byte(&wms.pwmUp[1][wall_n]), 1); // run wall up
 		if (resp != 0)
 			return resp;
 		delay(dt_run);
-		_Dbg.printMsg(_Dbg.MT::INFO, "\t Wall %d: Down", wall_n);
-		resp = CypCom.ioWritePin(C[cyp_i].addr, wms.pwmDown[0][wall_n], wms.pwmDown[1][wall_n], 1); // run wall down (run before so motoro hard stops)
+		DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "\t Wall %d: Down", wall_n);
+		resp = CypCom.ioWritePin(C[cyp_i].addr, pgm_read_byte(&wms.pwmDown[0][wall_n]), pgm_read_byte(&wms.pwmDown[1][wall_n]), 1); // run wall down (run before so motoro hard stops)
 		if (resp != 0)
 			return resp;
-		resp = CypCom.ioWritePin(C[cyp_i].addr, wms.pwmUp[0][wall_n], wms.pwmUp[1][wall_n], 0); // stop wall up pwm
+		resp = CypCom.ioWritePin(C[cyp_i].addr, pgm_read_byte(&wms.pwmUp[0][wall_n]), pgm_read_byte(&wms.pwmUp[1][wall_n]), 0); // stop wall up pwm
 		if (resp != 0)
 			return resp;
 		delay(dt_run);
-		resp = CypCom.ioWritePin(C[cyp_i].addr, wms.pwmDown[0][wall_n], wms.pwmDown[1][wall_n], 0); // stop wall down pwm
+		resp = CypCom.ioWritePin(C[cyp_i].addr, pgm_read_byte(&wms.pwmDown[0][wall_n]), pgm_read_byte(&wms.pwmDown[1][wall_n]), 0); // stop wall down pwm
 		if (resp != 0)
 			return resp;
 	}
@@ -921,7 +1197,7 @@ uint8_t GateOperation::testWallOperation(uint8_t cyp_i, uint8_t p_wall_inc[], ui
 	}
 
 	// Test all walls
-	_Dbg.printMsg(_Dbg.MT::HEAD1, "RUNNING: Test move operation: chamber[%d] walls%s", cyp_i, _Dbg.arrayStr(p_wi, s));
+	DB_PRINT_MSG(_Dbg, _Dbg.MT::HEAD1, "RUNNING: Test move operation: chamber[%d] walls%s", cyp_i, _Dbg.arrayStr(p_wi, s));
 	uint8_t r_bit_out = 1;
 	uint16_t dt = 2000;
 	uint16_t ts;
@@ -929,61 +1205,61 @@ uint8_t GateOperation::testWallOperation(uint8_t cyp_i, uint8_t p_wall_inc[], ui
 	for (size_t i = 0; i < s; i++)
 	{ // loop walls
 		uint8_t wall_n = p_wi[i];
-		_Dbg.printMsg(_Dbg.MT::INFO, "\t Moving wall %d", wall_n);
+		DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "\t Moving wall %d", wall_n);
 
 		// Run up
-		_Dbg.printMsg(_Dbg.MT::INFO, "\t\t up start");
-		resp = CypCom.ioWritePin(C[cyp_i].addr, wms.pwmUp[0][wall_n], wms.pwmUp[1][wall_n], 1);
+		DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "\t\t up start");
+		resp = CypCom.ioWritePin(C[cyp_i].addr, pgm_read_byte(&wms.pwmUp[0][wall_n]), pgm_read_byte(&wms.pwmUp[1][wall_n]), 1);
 		if (resp != 0)
 			return resp;
 		ts = millis() + dt; // set timeout
 		_Dbg.dtTrack(1);	// start timer
 		while (true)
 		{ // check up switch
-			resp = CypCom.ioReadPin(C[cyp_i].addr, wms.ioUp[0][wall_n], wms.ioUp[1][wall_n], r_bit_out);
+			resp = CypCom.ioReadPin(C[cyp_i].addr, pgm_read_byte(&wms.ioUp[0][wall_n]), pgm_read_byte(&wms.ioUp[1][wall_n]), r_bit_out);
 			if (resp != 0)
 				return resp;
 			if (r_bit_out == 1)
 			{
-				_Dbg.printMsg(_Dbg.MT::INFO, "\t\t up end [%s]", _Dbg.dtTrack());
+				DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "\t\t up end [%s]", _Dbg.dtTrack());
 				break;
 			}
 			else if (millis() >= ts)
 			{
-				_Dbg.printMsg(_Dbg.MT::INFO, "\t\t !!up timedout [%s]", _Dbg.dtTrack());
+				DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "\t\t !!up timedout [%s]", _Dbg.dtTrack());
 				break;
 			}
 			delay(10);
 		}
 
 		// Run down
-		_Dbg.printMsg(_Dbg.MT::INFO, "\t\t down start");
-		resp = CypCom.ioWritePin(C[cyp_i].addr, wms.pwmDown[0][wall_n], wms.pwmDown[1][wall_n], 1);
+		DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "\t\t down start");
+		resp = CypCom.ioWritePin(C[cyp_i].addr, pgm_read_byte(&wms.pwmDown[0][wall_n]), pgm_read_byte(&wms.pwmDown[1][wall_n]), 1);
 		if (resp != 0)
 			return resp;
-		resp = CypCom.ioWritePin(C[cyp_i].addr, wms.pwmUp[0][wall_n], wms.pwmUp[1][wall_n], 0);
+		resp = CypCom.ioWritePin(C[cyp_i].addr, pgm_read_byte(&wms.pwmUp[0][wall_n]), pgm_read_byte(&wms.pwmUp[1][wall_n]), 0);
 		if (resp != 0)
 			return resp;
 		ts = millis() + dt; // set timeout
 		_Dbg.dtTrack(1);	// start timer
 		while (true)
 		{ // check up switch
-			resp = CypCom.ioReadPin(C[cyp_i].addr, wms.ioDown[0][wall_n], wms.ioDown[1][wall_n], r_bit_out);
+			resp = CypCom.ioReadPin(C[cyp_i].addr, pgm_read_byte(&wms.ioDown[0][wall_n]), pgm_read_byte(&wms.ioDown[1][wall_n]), r_bit_out);
 			if (resp != 0)
 				return resp;
 			if (r_bit_out == 1)
 			{
-				_Dbg.printMsg(_Dbg.MT::INFO, "\t\t down end [%s]", _Dbg.dtTrack());
+				DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "\t\t down end [%s]", _Dbg.dtTrack());
 				break;
 			}
 			else if (millis() >= ts)
 			{
-				_Dbg.printMsg(_Dbg.MT::INFO, "\t\t !!down timedout [%s]", _Dbg.dtTrack());
+				DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "\t\t !!down timedout [%s]", _Dbg.dtTrack());
 				break;
 			}
 			delay(10);
 		}
-		resp = CypCom.ioWritePin(C[cyp_i].addr, wms.pwmDown[0][wall_n], wms.pwmDown[1][wall_n], 0);
+		resp = CypCom.ioWritePin(C[cyp_i].addr, pgm_read_byte(&wms.pwmDown[0][wall_n]), pgm_read_byte(&wms.pwmDown[1][wall_n]), 0);
 		if (resp != 0)
 			return resp;
 
@@ -999,13 +1275,13 @@ uint8_t GateOperation::testWallOperation(uint8_t cyp_i, uint8_t p_wall_inc[], ui
 /// @param s: OPTIONAL: length of @param p_wall_inc array. DEFAULT: 8
 void GateOperation::_printPMS(PinMapStruct pms)
 {
-	_Dbg.printMsg(_Dbg.MT::DEBUG, "IO/PWM nPorts[%d]_____________________", pms.nPortsInc);
+	DB_PRINT_MSG(_Dbg, _Dbg.MT::DEBUG, "IO/PWM nPorts[%d]_____________________", pms.nPortsInc);
 	for (size_t prt_i = 0; prt_i < pms.nPortsInc; prt_i++)
 	{
-		_Dbg.printMsg(_Dbg.MT::DEBUG, "port[%d] nPins[%d] bitMask[%s]", pms.portInc[prt_i], pms.nPinsInc[prt_i], _Dbg.binStr(pms.byteMaskInc[prt_i]));
+		DB_PRINT_MSG(_Dbg, _Dbg.MT::DEBUG, "port[%d] nPins[%d] bitMask[%s]", pms.portInc[prt_i], pms.nPinsInc[prt_i], _Dbg.binStr(pms.byteMaskInc[prt_i]));
 		for (size_t pin_i = 0; pin_i < pms.nPinsInc[prt_i]; pin_i++)
 		{
-			_Dbg.printMsg(_Dbg.MT::DEBUG, "\t wall[%d] pin[%d]", pms.wallInc[prt_i][pin_i], pms.pinInc[prt_i][pin_i]);
+			DB_PRINT_MSG(_Dbg, _Dbg.MT::DEBUG, "\t wall[%d] pin[%d]", pms.wallInc[prt_i][pin_i], pms.pinInc[prt_i][pin_i]);
 		}
 	}
 }
\ No newline at end of file
@@ -9,12 +9,15 @@
 //============= INCLUDE ================
 #include "Arduino.h"
 #include "GateDebug.h"
+#include "GateProfile.h"
 #include "CypressCom.h"
+#include "GateSync.h"
+#include <EEPROM.h>
 
 /// @brief This class handles the actual operation of the maze walls and Ethercat coms.
 ///
 /// @remarks
-/// This class uses an instance of the GateDebug and CypressCom classes.
+/// This class uses an instance of the GateDebug, CypressCom and GateSync classes.
 /// This class also deals with the mapping of walls to associated Cypress pins.
 /// This class also deals with incoming and outgoing Ethercat communication.
 class GateOperation
@@ -22,33 +25,53 @@ class GateOperation
 
 	// --------------VARIABLES--------------
 public:
-	static const uint8_t maxCyp = 9; // Maximum number of cypress boards
+	static const uint8_t maxCyp = CYP_MAX_ADDR; // Maximum number of cypress boards
+	static const uint8_t maxConfig = 32; // Maximum number of maze configurations stored in EEPROM
+	static const uint8_t maxConfigCyp = 16; // Chips per configuration table entry, fixed so the table layout does not depend on CYP_MAX_ADDR
+	static const uint8_t eepromConfigVersion = 1; // Configuration table layout version, stored in the first table byte
+	static const uint16_t eepromConfigAddr = 0; // EEPROM address of the maze configuration table
+	static_assert(maxCyp <= maxConfigCyp, "CYP_MAX_ADDR does not fit the maze configuration table entries");
 
 	// Paramiters set by GUI
 	uint8_t pwmDuty;		   // pwm duty cycle
 	uint16_t dtMoveTimeout; // timeout for wall movement (ms)
 
+	// Move trigger tracking
+	bool isArmed = false;		// flag that the staged move has precomputed register images [0:not armed, 1:armed]
+	uint32_t tsMoveTrigger = 0; // micros() timestamp of the move trigger, set before calling moveWallsConductor() [0:use call time]
+	uint32_t dtTriggerToPwm = 0; // latency from the move trigger to the first PWM register write (us)
+
+	// Struct for move counters
+	struct MoveCountStruct
+	{
+		uint32_t nMoves;		// moves run by moveWallsConductor()
+		uint32_t nPollPasses;	// poll passes over all chambers, summed over all moves
+		uint16_t nPollLastMove; // poll passes in the last move
+		uint16_t nPollMax;		// most poll passes in a move
+	};
+	MoveCountStruct MoveCnt = {};			 // only one instance used
+	static const uint8_t moveCountSize = 12; // Bytes of packed counters [moves(4), polls(4), polls_last(2), polls_max(2)]
+
+	// Struct for the stage timestamps of the last move
+	struct MoveTimeStruct
+	{
+		uint32_t tsStart;	   // micros() when moveWallsConductor() started the move
+		uint32_t tsPwmOn;	   // micros() after the PWM start write of the last chamber
+		uint32_t tsLastSwitch; // micros() after the IO read that found the last limit switch
+		uint32_t tsPwmOff;	   // micros() after the last PWM cutoff write
+		uint32_t tsEnd;		   // micros() when moveWallsConductor() returned
+	};
+	MoveTimeStruct MoveTs = {};			   // only one instance used
+	static const uint8_t moveTimeSize = 20; // Bytes of packed timestamps [start(4), pwm_on(4), last_switch(4), pwm_off(4), end(4)]
+
 	// Pin mapping organized by wall with entries corresponding to the associated port or pin
 	struct WallMapStruct
 	{
-		uint8_t pwmSrc[8] =
-			{4, 6, 7, 5, 3, 1, 0, 2};
-		uint8_t ioDown[2][8] = {
-			{4, 1, 0, 0, 3, 3, 5, 4}, // port
-			{3, 3, 1, 7, 2, 4, 0, 7}  // pin/bit
-		};
-		uint8_t ioUp[2][8] = {
-			{4, 1, 0, 3, 3, 3, 4, 4}, // port
-			{0, 2, 2, 0, 3, 5, 5, 4}  // pin/bit
-		};
-		uint8_t pwmDown[2][8] = {
-			{1, 1, 0, 3, 5, 5, 5, 4}, // port
-			{1, 0, 0, 1, 2, 3, 1, 2}  // pin/bit
-		};
-		uint8_t pwmUp[2][8] = {
-			{4, 1, 0, 0, 3, 3, 2, 4}, // port
-			{1, 4, 4, 5, 6, 7, 2, 6}  // pin/bit
-		};
+		static const uint8_t pwmSrc[8];		// pwm source for each wall, stored in flash
+		static const uint8_t ioDown[2][8];	// io down port/pin for each wall, stored in flash
+		static const uint8_t ioUp[2][8];	// io up port/pin for each wall, stored in flash
+		static const uint8_t pwmDown[2][8]; // pwm down port/pin for each wall, stored in flash
+		static const uint8_t pwmUp[2][8];	// pwm up port/pin for each wall, stored in flash
 		uint8_t funMap[6][8] = {0}; // map of pin function [0:none, 1:io_down, 2:io_up, 3:pwm_down, 4:pwm_up]
 	};
 	WallMapStruct wms; // only one instance used
@@ -81,12 +104,14 @@ public:
 		uint8_t bitWallMoveUpFlag = 0;	 // bitwise variable, flag current walls that should be raised [0:inactive, 1:active]
 		uint8_t bitWallMoveDownFlag = 0; // bitwise variable, flag current walls that should be lowered [0:inactive, 1:active]
 		uint8_t bitWallErrorFlag = 1;	 // bitwise variable, flag wall move errors [0:no error, 1:error]
+		uint8_t regOutArm[6] = {0};		 // precomputed output register image used by armed moves
 		PinMapStruct pmsActvPWM;		 // reusable dynamic instance for active PWM
 		PinMapStruct pmsActvIO;			 // reusable dynamic instance for active IO
 	};
 	CypressStruct C[maxCyp]; // initialize with max number of chambers for 3x3
 
 	CypressCom CypCom; // local instance of CypressCom class
+	GateSync Sync;	   // local instance of GateSync class
 
 private:
 	GateDebug _Dbg;		// local instance of GateDebug class
@@ -97,14 +122,14 @@ public:
 	GateOperation(uint8_t, uint16_t);
 
 private:
-	void _makePMS(PinMapStruct &, uint8_t[], uint8_t[]);
-	void _makePMS(PinMapStruct &, uint8_t[], uint8_t[], uint8_t[], uint8_t[]);
+	void _makePMS(PinMapStruct &, const uint8_t[], const uint8_t[]);
+	void _makePMS(PinMapStruct &, const uint8_t[], const uint8_t[], const uint8_t[], const uint8_t[]);
 
 private:
-	void _addPortPMS(PinMapStruct &, uint8_t[], uint8_t[]);
+	void _addPortPMS(PinMapStruct &, const uint8_t[], const uint8_t[]);
 
 private:
-	void _addPinPMS(PinMapStruct &, uint8_t[], uint8_t[]);
+	void _addPinPMS(PinMapStruct &, const uint8_t[], const uint8_t[]);
 
 private:
 	void _sortArr(uint8_t[], size_t s, uint8_t[] = nullptr);
@@ -133,15 +158,42 @@ private:
 public:
 	uint8_t setWallsToMove(uint8_t, uint8_t);
 
+public:
+	void clearWallsMove();
+
+public:
+	uint8_t storeWallConfig(uint8_t, uint8_t[], uint8_t);
+
+public:
+	uint8_t setWallsToConfig(uint8_t);
+
+public:
+	uint8_t armWallsMove();
+
 public:
 	uint8_t moveWallsConductor();
 
+private:
+	uint16_t _configAddr(uint8_t);
+
+private:
+	void _stageWallsMove(uint8_t);
+
 private:
 	uint8_t _initWallsMove(uint8_t);
 
 private:
 	uint8_t _monitorWallsMove(uint8_t);
 
+public:
+	uint8_t getCounts(uint8_t[], uint8_t);
+
+public:
+	void resetCounts();
+
+public:
+	uint8_t getMoveTimes(uint8_t[], uint8_t);
+
 public:
 	uint8_t getWallState(uint8_t, uint8_t, uint8_t &);
 
@@ -0,0 +1,128 @@
+// ######################################
+
+//=========== GateSync.cpp ============
+
+// ######################################
+
+/// @file Used for the GateSync class
+
+//============= INCLUDE ================
+#include "GateSync.h"
+
+//===========CLASS: GateSync============
+
+/// @brief Constructor
+GateSync::GateSync() {}
+
+/// @brief Setup the sync output pins.
+///
+/// @param strobe_pin Output pin pulsed on every event [255:disabled].
+/// @param dt_pulse OPTIONAL: Strobe pulse width (us). DEFAULT: 10.
+/// @param p_code_pins OPTIONAL: Output pins for the event code bits, least significant bit first. DEFAULT: none (pulse mode).
+/// @param s OPTIONAL: Length of "p_code_pins" [0-maxCodePins]. DEFAULT: 0.
+void GateSync::setupSync(uint8_t strobe_pin, uint16_t dt_pulse, uint8_t p_code_pins[], uint8_t s)
+{
+	_strobePin = strobe_pin;
+	_dtPulse = dt_pulse;
+	_nCodePins = p_code_pins == nullptr ? 0 : s;
+	if (_nCodePins > maxCodePins)
+		_nCodePins = maxCodePins;
+
+	// Setup pins in low state
+	if (_strobePin == 255)
+		return;
+	if (pinWriter == digitalWrite)
+		pinMode(_strobePin, OUTPUT);
+	pinWriter(_strobePin, LOW);
+	for (size_t pin_i = 0; pin_i < _nCodePins; pin_i++)
+	{
+		_codePins[pin_i] = p_code_pins[pin_i];
+		if (pinWriter == digitalWrite)
+			pinMode(_codePins[pin_i], OUTPUT);
+		pinWriter(_codePins[pin_i], LOW);
+	}
+}
+
+/// @brief Timestamp an event, store it in the event log and output it on the sync pins.
+///
+/// @note The oldest event is overwritten when the log is full.
+///
+/// @param code Event code, see @ref GateSync::EV.
+/// @param cyp_i OPTIONAL: Chamber index of the event. DEFAULT: 255 (all).
+/// @param wall_i OPTIONAL: Wall index of the event. DEFAULT: 255 (all).
+void GateSync::logEvent(uint8_t code, uint8_t cyp_i, uint8_t wall_i)
+{
+	uint32_t ts = micros();
+
+	// Output event first to keep the pulse close to the timestamp
+	_pulseEvent(code);
+
+	// Store event, overwriting the oldest entry if full
+	if (_nEvents == maxEvents)
+	{
+		_eventHead = (_eventHead + 1) % maxEvents;
+		_nEvents--;
+		_nEventsDropped++;
+	}
+	EventStruct &r_ev = _events[(_eventHead + _nEvents) % maxEvents];
+	r_ev.ts = ts;
+	r_ev.code = code;
+	r_ev.cypInd = cyp_i;
+	r_ev.wallInd = wall_i;
+	_nEvents++;
+}
+
+/// @brief Pack and remove the oldest events from the event log.
+///
+/// @details Each event is packed as @ref GateSync::eventSize bytes: the micros() timestamp
+/// as 4 little endian bytes followed by the event code, chamber index and wall index.
+///
+/// @param p_byte_out_arr Byte array for the packed events (used as output).
+/// @param s Length of "p_byte_out_arr".
+///
+/// @return Number of events packed.
+uint8_t GateSync::readEvents(uint8_t p_byte_out_arr[], uint8_t s)
+{
+	uint8_t n_ev = 0;
+	while (_nEvents > 0 && (n_ev + 1) * eventSize <= s)
+	{
+		EventStruct &r_ev = _events[_eventHead];
+		uint8_t *p_out = &p_byte_out_arr[n_ev * eventSize];
+		for (size_t byte_i = 0; byte_i < 4; byte_i++)
+			p_out[byte_i] = (r_ev.ts >> (8 * byte_i)) & 0xFF;
+		p_out[4] = r_ev.code;
+		p_out[5] = r_ev.cypInd;
+		p_out[6] = r_ev.wallInd;
+
+		_eventHead = (_eventHead + 1) % maxEvents;
+		_nEvents--;
+		n_ev++;
+	}
+	return n_ev;
+}
+
+/// @brief Get the number of events overwritten before they were read.
+///
+/// @return Number of dropped events.
+uint16_t GateSync::getDroppedEvents()
+{
+	return _nEventsDropped;
+}
+
+/// @brief Output an event on the sync pins.
+///
+/// @param code Event code set on the code pins during the strobe pulse.
+void GateSync::_pulseEvent(uint8_t code)
+{
+	if (_strobePin == 255)
+		return;
+
+	// Set code pins then pulse strobe
+	for (size_t pin_i = 0; pin_i < _nCodePins; pin_i++)
+		pinWriter(_codePins[pin_i], bitRead(code, pin_i));
+	pinWriter(_strobePin, HIGH);
+	delayMicroseconds(_dtPulse);
+	pinWriter(_strobePin, LOW);
+	for (size_t pin_i = 0; pin_i < _nCodePins; pin_i++)
+		pinWriter(_codePins[pin_i], LOW);
+}
@@ -0,0 +1,80 @@
+// ######################################
+
+//=========== GateSync.h ==============
+
+// ######################################
+
+/// @file Used for the GateSync class
+
+#ifndef _GATE_SYNC_h
+#define _GATE_SYNC_h
+
+//============= INCLUDE ================
+#include "Arduino.h"
+
+/// @brief This class drives the digital sync outputs used to align wall events with external
+/// acquisition systems and keeps a log of the events with their device micros() timestamps.
+///
+/// @remarks In pulse mode every event pulses the strobe pin. In encode mode the event code is
+/// also set on the code pins for the duration of the strobe pulse.
+class GateSync
+{
+
+	// --------------VARIABLES--------------
+public:
+	static const uint8_t maxCodePins = 3;  // Maximum number of event code pins
+	static const uint8_t maxEvents = 32;   // Size of the event log
+	static const uint8_t eventSize = 7;	   // Bytes per event when packed for serial [ts(4), code, chamber, wall]
+
+	// Event codes
+	enum EV
+	{
+		MOVE_START = 1,
+		WALL_DOWN = 2,
+		WALL_UP = 3,
+		MOVE_END = 4,
+		MOVE_FAIL = 5
+	};
+
+	// Struct for logged events
+	struct EventStruct
+	{
+		uint32_t ts;	// micros() timestamp of the event
+		uint8_t code;	// event code
+		uint8_t cypInd; // chamber index [255:all]
+		uint8_t wallInd; // wall index [255:all]
+	};
+
+	void (*pinWriter)(uint8_t, uint8_t) = digitalWrite; // pin write function, can be replaced with a GPIO stand-in
+
+private:
+	uint8_t _strobePin = 255;		   // sync strobe output pin [255:disabled]
+	uint8_t _codePins[maxCodePins];	   // event code output pins, least significant bit first
+	uint8_t _nCodePins = 0;			   // number of event code pins [0:pulse mode]
+	uint16_t _dtPulse = 10;			   // strobe pulse width (us)
+	EventStruct _events[maxEvents];	   // event ring buffer
+	uint8_t _eventHead = 0;			   // index of the oldest event
+	uint8_t _nEvents = 0;			   // number of stored events
+	uint16_t _nEventsDropped = 0;	   // number of events overwritten before being read
+
+	// ---------------METHODS---------------
+public:
+	GateSync();
+
+public:
+	void setupSync(uint8_t, uint16_t = 10, uint8_t[] = nullptr, uint8_t = 0);
+
+public:
+	void logEvent(uint8_t, uint8_t = 255, uint8_t = 255);
+
+public:
+	uint8_t readEvents(uint8_t[], uint8_t);
+
+public:
+	uint16_t getDroppedEvents();
+
+private:
+	void _pulseEvent(uint8_t);
+};
+
+#endif
@@ -41,12 +41,31 @@ void SerialCom::initSerial(unsigned long baud)
 /// reads the message length, the message itself, and the checksum. If the checksum is valid,
 /// it acknowledges the receipt and returns true. Otherwise, it returns false.
 ///
+/// A single unframed GO_BYTE is reported as an empty message of type GO_MSG_TYPE so that
+/// armed moves can be started with one byte.
+///
 /// @return true if a valid message is received and checksum is correct, otherwise false.
 bool SerialCom::receiveMessage()
 {
     // Check if data is available on the serial port
-    if (serial.available())
+    uint16_t n_rx = serial.available();
+    Cnt.nRxHighWater = n_rx > Cnt.nRxHighWater ? n_rx : Cnt.nRxHighWater;
+    if (n_rx > 0)
     {
+        // Store receive timestamp
+        MD.ts = micros();
+
+        // Check for the single byte GO trigger without the read delay
+        if (serial.peek() == GO_BYTE)
+        {
+            serial.read();
+            MD.tsEnd = micros();
+            MD.msg_type = GO_MSG_TYPE;
+            MD.length = 0;
+            Cnt.nRxFrames++;
+            return true;
+        }
+
         // Read the start byte
         byte start_byte = _readByte();
 
@@ -82,34 +101,37 @@ bool SerialCom::receiveMessage()
                     // Validate the checksum
                     if (checksum_expected == checksum_calculated)
                     {
-                        _Dbg.printMsg(_Dbg.MT::INFO, "Received: start_byte[%s] msg_type[%d] length[%d] data%s checksum[%d|%d] end_byte[%s]",
-                                      _Dbg.hexStr(start_byte), MD.msg_type, MD.length, _Dbg.arrayStr(MD.data, MD.length), checksum_calculated, checksum_expected, _Dbg.hexStr(end_byte));
+                        MD.tsEnd = micros();
+                        DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "Received: start_byte[%s] msg_type[%d] length[%d] data%s checksum[%d|%d] end_byte[%s]",
+                                           _Dbg.hexStr(start_byte), MD.msg_type, MD.length, _Dbg.arrayStr(MD.data, MD.length), checksum_calculated, checksum_expected, _Dbg.hexStr(end_byte));
+                        Cnt.nRxFrames++;
                         return true; // Return true for a valid message
                     }
                     else
                     {
                         // Discard the received message if the checksum is incorrect
-                        _Dbg.printMsg(_Dbg.MT::WARNING, "Invalid checksum");
+                        DB_PRINT_MSG(_Dbg, _Dbg.MT::WARNING, "Invalid checksum");
                     }
                 }
                 else
                 {
                     // Discard the received byte if it is not the end byte
-                    _Dbg.printMsg(_Dbg.MT::WARNING, "Missing end byte");
+                    DB_PRINT_MSG(_Dbg, _Dbg.MT::WARNING, "Missing end byte");
                 }
 
                 // Print failed receive message
-                _Dbg.printMsg(_Dbg.MT::WARNING, "Failed receive: start_byte[%s] msg_type[%d] length[%d] data%s checksum[%d|%d] end_byte[%s]",
-                              _Dbg.hexStr(start_byte), MD.msg_type, MD.length, _Dbg.arrayStr(MD.data, MD.length), checksum_calculated, checksum_expected, _Dbg.hexStr(end_byte));
+                DB_PRINT_MSG(_Dbg, _Dbg.MT::WARNING, "Failed receive: start_byte[%s] msg_type[%d] length[%d] data%s checksum[%d|%d] end_byte[%s]",
+                                   _Dbg.hexStr(start_byte), MD.msg_type, MD.length, _Dbg.arrayStr(MD.data, MD.length), checksum_calculated, checksum_expected, _Dbg.hexStr(end_byte));
             }
         }
         else
         {
             // Discard the received byte if it is not the start byte
-            _Dbg.printMsg(_Dbg.MT::WARNING, "Missing start byte");
+            DB_PRINT_MSG(_Dbg, _Dbg.MT::WARNING, "Missing start byte");
         }
 
-        // Clear the buffer
+        // Count rejected frame and clear the buffer
+        Cnt.nRxRejected++;
         while (serial.available())
         {
             serial.read();
@@ -123,25 +145,107 @@ bool SerialCom::receiveMessage()
 /// @brief Sends a message over the serial port.
 ///
 /// This function constructs a message with a start byte, message type, message length,
-/// message content, and checksum, then sends it over the serial port.
+/// message content, device timestamp, and checksum, then sends it over the serial port.
+/// The timestamp is the micros() send time as 4 little endian bytes following the message
+/// content. It is not counted in the message length but is included in the checksum.
 ///
 /// @param msg_type: The type of the message to be sent.
 /// @param message_data: Pointer to the byte array containing the message to be sent.
 /// @param length: The length of the byte array.
 void SerialCom::sendMessage(byte msg_type, const byte *message_data, size_t length)
+{
+    uint32_t ts;
+    byte checksum = _writeFrame(msg_type, message_data, length, ts);
+
+    // Update counters
+    Cnt.nTxFrames++;
+    uint16_t n_tx = _txBuffSize - 1 - serial.availableForWrite();
+    Cnt.nTxHighWater = n_tx > Cnt.nTxHighWater ? n_tx : Cnt.nTxHighWater;
+
+    // Print sent message
+    DB_PRINT_MSG(_Dbg, _Dbg.MT::INFO, "Sent: msg_type[%d] length[%d] data%s ts[%lu] checksum[%d]",
+                       msg_type, length, _Dbg.arrayStr(message_data, length), ts, checksum);
+}
+
+/// @brief Sends a chunk of GateDebug log output as a LOG_MSG_TYPE frame.
+///
+/// Used as the GateDebug::logWriter so debug output can share the port with the protocol.
+/// Nothing is sent while DB_LOG_TX_INFLIGHT or more bytes wait in the transmit buffer or
+/// within 1/logFramesPerSec seconds of the last log frame, so this never blocks and protocol
+/// frames wait behind at most one log frame. The frame content is a piece of the log byte
+/// stream, the host joins the frames to get the text lines or binary records back.
+///
+/// @param log_data: Pointer to the log bytes.
+/// @param length: Number of log bytes available.
+///
+/// @return Number of log bytes sent [0:busy or rate limited, 1-LOG_CHUNK_SIZE].
+uint16_t SerialCom::sendLogMessage(const byte *log_data, size_t length)
+{
+    // Check the rate limit and the bytes already waiting to be sent
+    if (logFramesPerSec > 0 && millis() - _tsLogFrame < 1000UL / logFramesPerSec)
+        return 0;
+    uint16_t n_free = serial.availableForWrite();
+    if (_txBuffSize - 1 - n_free >= DB_LOG_TX_INFLIGHT || n_free <= 9)
+        return 0;
+
+    // Send as many bytes as fit in the transmit buffer with the 9 frame bytes
+    size_t n_send = length < LOG_CHUNK_SIZE ? length : LOG_CHUNK_SIZE;
+    n_send = n_send < n_free - 9U ? n_send : n_free - 9U;
+    uint32_t ts;
+    _writeFrame(LOG_MSG_TYPE, log_data, n_send, ts);
+    _tsLogFrame = millis();
+    Cnt.nTxFrames++;
+    return n_send;
+}
+
+/// @brief Pack the communication counters for sending over serial.
+///
+/// @param p_out: Array to store the counters as little endian values, see CountStruct.
+/// @param s: Length of "p_out".
+///
+/// @return Number of bytes stored [0:"p_out" too short, countSize].
+uint8_t SerialCom::getCounts(uint8_t p_out[], uint8_t s)
+{
+    if (s < countSize)
+        return 0;
+
+    uint8_t len = 0;
+    uint32_t vals[5] = {Cnt.nRxFrames, Cnt.nRxRejected, Cnt.nTxFrames, Cnt.nRxHighWater, Cnt.nTxHighWater};
+    for (size_t val_i = 0; val_i < 5; val_i++)
+        for (size_t byte_i = 0; byte_i < (val_i < 3 ? 4 : 2); byte_i++)
+            p_out[len++] = (vals[val_i] >> (8 * byte_i)) & 0xFF;
+    return len;
+}
+
+/// @brief Reset the communication counters.
+void SerialCom::resetCounts()
+{
+    Cnt = {};
+}
+
+/// @brief Writes a framed message to the serial port.
+///
+/// @param msg_type: The type of the message to be sent.
+/// @param message_data: Pointer to the byte array containing the message to be sent.
+/// @param length: The length of the byte array.
+/// @param ts: The micros() send timestamp written to the frame (used as output).
+///
+/// @return The frame checksum.
+byte SerialCom::_writeFrame(byte msg_type, const byte *message_data, size_t length, uint32_t &ts)
 {
     serial.write(START_BYTE);                                 // Write the start byte
     serial.write(msg_type);                                   // Write the message type
     serial.write(static_cast<byte>(length));                  // Write the length of the message
     serial.write(message_data, length);                       // Write the message content
+    ts = micros();                                            // Get the send timestamp
+    byte ts_arr[4] = {(byte)ts, (byte)(ts >> 8), (byte)(ts >> 16), (byte)(ts >> 24)};
+    serial.write(ts_arr, 4);                                  // Write the timestamp
     byte checksum = _calculateChecksum(message_data, length); // Compute the checksum
+    checksum += _calculateChecksum(ts_arr, 4);                // Include timestamp in checksum calculation
     checksum = (checksum + msg_type) % 256;                   // Include msg_type in checksum calculation
     serial.write(checksum);                                   // Write the checksum
     serial.write(END_BYTE);                                   // Write the end byte
-
-    // Print sent message
-    _Dbg.printMsg(_Dbg.MT::INFO, "Sent: msg_type[%d] length[%d] data%s checksum[%d]",
-                  msg_type, length, _Dbg.arrayStr(message_data, length), checksum);
+    return checksum;
 }
 
 /// @brief Calculates the checksum for a given message.
@@ -180,7 +284,7 @@ byte SerialCom::_readByte()
     {
         if (millis() - start_time >= TIMEOUT)
         {
-            _Dbg.printMsg(_Dbg.MT::WARNING, "Serial read timed out");
+            DB_PRINT_MSG(_Dbg, _Dbg.MT::WARNING, "Serial read timed out");
             return false; // Timeout occurred
         }
     }
@@ -21,19 +21,47 @@ private:
     HardwareSerial &serial;             // Reference to the serial port
     const byte START_BYTE = 0x02;       // Start byte for messages
     const byte END_BYTE = 0x03;         // End byte for messages
+    const byte GO_BYTE = 0x07;          // Unframed single byte used to start an armed move
     const unsigned long TIMEOUT = 1500; // Timeout for receiving messages (ms)
     GateDebug _Dbg; // Local instance of GateDebug class
 
 public:
+    static const byte GO_MSG_TYPE = 7;   // Message type reported for a received GO_BYTE
+    static const byte LOG_MSG_TYPE = 12; // Message type of frames carrying GateDebug log output
+    static const byte LOG_CHUNK_SIZE = 32; // Most log bytes sent per log frame
+    uint16_t logFramesPerSec = 0;        // Most log frames sent per second [0:no limit]
+
     // Struct for message data
     struct MessageData
     {
         byte msg_type; // Message type
         byte data[200];  // Message data
         byte length;   // Message length
+        uint32_t ts;   // micros() timestamp of the received start byte
+        uint32_t tsEnd; // micros() timestamp of the validated end byte
     };
     MessageData MD; // only one instance used
 
+    // Struct for communication counters
+    struct CountStruct
+    {
+        uint32_t nRxFrames;    // valid frames received, including GO bytes
+        uint32_t nRxRejected;  // frames rejected for a bad start byte, end byte or checksum
+        uint32_t nTxFrames;    // frames sent
+        uint16_t nRxHighWater; // most bytes seen waiting in the receive buffer
+        uint16_t nTxHighWater; // most bytes seen waiting in the transmit buffer
+    };
+    CountStruct Cnt = {}; // only one instance used
+    static const uint8_t countSize = 16; // Bytes of packed counters [rx(4), rejected(4), tx(4), rx_high(2), tx_high(2)]
+
+private:
+#ifdef SERIAL_TX_BUFFER_SIZE
+    static const uint16_t _txBuffSize = SERIAL_TX_BUFFER_SIZE; // Size of the HardwareSerial transmit buffer
+#else
+    static const uint16_t _txBuffSize = 64; // Size of the HardwareSerial transmit buffer
+#endif
+    uint32_t _tsLogFrame = 0; // millis() timestamp of the last log frame
+
     // ---------------METHODS---------------
 
 public:
@@ -48,6 +76,18 @@ public:
 public:
     void sendMessage(byte msg_type, const byte *message_data, size_t length);
 
+public:
+    uint16_t sendLogMessage(const byte *log_data, size_t length);
+
+public:
+    uint8_t getCounts(uint8_t p_out[], uint8_t s);
+
+public:
+    void resetCounts();
+
+private:
+    byte _writeFrame(byte msg_type, const byte *message_data, size_t length, uint32_t &ts);
+
 private:
     byte _calculateChecksum(const byte *data_array, size_t length);
 
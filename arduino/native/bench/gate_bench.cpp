@@ -0,0 +1,312 @@
+// ######################################
+
+//=========== gate_bench.cpp ==========
+
+// ######################################
+
+/// @file Benchmarks wall moves on the simulated rig versus chip count, wall count and move direction.
+///
+/// @details Each row is one move on a fresh rig: chips 1 to @ref GateOperation::maxCyp, walls 1 to 8
+/// per chip and "up", "down" or "mixed" (every other wall up, the rest down) moves. Moves run through
+/// setWallsToMove() and moveWallsConductor() as for message type 2; full chip up and down moves run
+/// through initWalls(). Travel times have no spread, so the numbers only change when the code or the
+/// bus timing does.
+///
+/// Results are written as CSV. With --check they are compared to a stored baseline and the run
+/// fails if any metric grows by more than the threshold.
+
+//============= INCLUDE ================
+#include "Arduino.h"
+#include "GateOperation.h"
+#include "GateRigSim.h"
+#include <getopt.h>
+#include <map>
+#include <string>
+
+bool DB_VERBOSE = 0;
+
+//============ VARIABLES ===============
+static GateOperation WallOper(255, 2000);
+
+// Results of one move
+struct ResultStruct
+{
+	const char *move;	// move type ["up", "down", "mixed"]
+	uint8_t nChips;		// chips moved
+	uint8_t nWalls;		// walls moved per chip
+	uint8_t status;		// moveWallsConductor() status
+	uint32_t moveUs;	// total move time (us)
+	uint32_t startUs;	// move call to the last motor start (us)
+	uint32_t skewUs;	// first to last motor start (us)
+	uint32_t pollUs;	// mean poll pass time after the last motor start (us)
+	uint32_t nPoll;		// poll passes
+	uint32_t i2cTrans;	// I2C transactions
+	uint32_t i2cBytes;	// I2C bytes
+};
+
+// Compared metrics with the smallest change counted as a regression
+static const struct
+{
+	const char *name;
+	uint32_t ResultStruct::*val;
+	uint32_t slack;
+} metrics[] = {
+	{"move_us", &ResultStruct::moveUs, 20},
+	{"start_us", &ResultStruct::startUs, 20},
+	{"skew_us", &ResultStruct::skewUs, 20},
+	{"poll_us", &ResultStruct::pollUs, 20},
+	{"i2c_trans", &ResultStruct::i2cTrans, 1},
+	{"i2c_bytes", &ResultStruct::i2cBytes, 1},
+};
+static const uint8_t nMetrics = sizeof(metrics) / sizeof(metrics[0]);
+
+//============ FUNCTIONS ===============
+
+// Run one move on a fresh rig
+static ResultStruct runMove(const GateRigSim::ConfigStruct &cfg, const char *p_move, uint8_t n_walls)
+{
+	uint8_t mask = (1 << n_walls) - 1;
+	uint8_t byte_start = strcmp(p_move, "up") == 0 ? 0 : strcmp(p_move, "down") == 0 ? mask : 0x55 & mask;
+	uint8_t byte_end = strcmp(p_move, "up") == 0 ? mask : strcmp(p_move, "down") == 0 ? 0 : 0xAA & mask;
+
+	// Build the rig with the walls in their start positions
+	NativeSim::reset();
+	GateRigSim rig(cfg);
+	for (uint8_t cyp_i = 0; cyp_i < cfg.nChips; cyp_i++)
+		for (uint8_t wall_i = 0; wall_i < 8; wall_i++)
+			rig.setWallPosition(cyp_i, wall_i, bitRead(byte_start, wall_i));
+	WallOper.CypCom.i2cScan();
+	WallOper.initGateOperation();
+	WallOper.initCypress();
+
+	// Run the move
+	ResultStruct r = {p_move, cfg.nChips, n_walls};
+	uint32_t n_trans = NativeSim::nI2cTrans;
+	uint32_t n_bytes = NativeSim::nI2cBytes;
+	uint64_t ts_start = NativeSim::nowUs;
+	if (n_walls == 8 && byte_start != byte_end && (byte_end == 0 || byte_end == 0xFF))
+		r.status = WallOper.initWalls(byte_end == 0xFF);
+	else
+	{
+		for (uint8_t cyp_i = 0; cyp_i < cfg.nChips; cyp_i++)
+			WallOper.setWallsToMove(cyp_i, byte_end);
+		r.status = WallOper.moveWallsConductor();
+	}
+	r.moveUs = NativeSim::nowUs - ts_start;
+	r.i2cTrans = NativeSim::nI2cTrans - n_trans;
+	r.i2cBytes = NativeSim::nI2cBytes - n_bytes;
+	r.nPoll = WallOper.MoveCnt.nPollLastMove;
+
+	// Motor start times of the moved walls
+	uint64_t ts_first = UINT64_MAX, ts_last = ts_start;
+	for (uint8_t cyp_i = 0; cyp_i < cfg.nChips; cyp_i++)
+		for (uint8_t wall_i = 0; wall_i < 8; wall_i++)
+		{
+			uint64_t ts = rig.wall(cyp_i, wall_i).tsStart;
+			if (!bitRead(byte_start ^ byte_end, wall_i) || ts < ts_start)
+				continue;
+			ts_first = ts < ts_first ? ts : ts_first;
+			ts_last = ts > ts_last ? ts : ts_last;
+		}
+	r.startUs = ts_last - ts_start;
+	r.skewUs = ts_first == UINT64_MAX ? 0 : ts_last - ts_first;
+	r.pollUs = r.nPoll > 0 ? (r.moveUs - r.startUs) / r.nPoll : 0;
+	return r;
+}
+
+// Write the results as CSV
+static void writeCsv(FILE *p_file, const std::vector<ResultStruct> &results)
+{
+	fprintf(p_file, "move,chips,walls,status,n_poll");
+	for (uint8_t met_i = 0; met_i < nMetrics; met_i++)
+		fprintf(p_file, ",%s", metrics[met_i].name);
+	fprintf(p_file, "\n");
+	for (const ResultStruct &r : results)
+	{
+		fprintf(p_file, "%s,%u,%u,%u,%u", r.move, r.nChips, r.nWalls, r.status, r.nPoll);
+		for (uint8_t met_i = 0; met_i < nMetrics; met_i++)
+			fprintf(p_file, ",%u", r.*metrics[met_i].val);
+		fprintf(p_file, "\n");
+	}
+}
+
+// Compare the results to a baseline CSV, returns the number of regressions or -1 if the file could not be read
+static int checkBaseline(const char *p_path, const std::vector<ResultStruct> &results, double threshold)
+{
+	FILE *p_file = fopen(p_path, "r");
+	if (p_file == nullptr)
+		return -1;
+
+	// Map the header columns
+	char line[512];
+	int col_ind[nMetrics];
+	int col_move = -1, col_chips = -1, col_walls = -1;
+	if (fgets(line, sizeof(line), p_file) == nullptr)
+	{
+		fclose(p_file);
+		return -1;
+	}
+	int col_i = 0;
+	for (char *p_tok = strtok(line, ",\r\n"); p_tok != nullptr; p_tok = strtok(nullptr, ",\r\n"), col_i++)
+	{
+		col_move = strcmp(p_tok, "move") == 0 ? col_i : col_move;
+		col_chips = strcmp(p_tok, "chips") == 0 ? col_i : col_chips;
+		col_walls = strcmp(p_tok, "walls") == 0 ? col_i : col_walls;
+		for (uint8_t met_i = 0; met_i < nMetrics; met_i++)
+			if (strcmp(p_tok, metrics[met_i].name) == 0)
+				col_ind[met_i] = col_i;
+	}
+
+	// Read the rows keyed by move, chips and walls
+	std::map<std::string, std::vector<uint32_t>> base;
+	while (fgets(line, sizeof(line), p_file) != nullptr)
+	{
+		std::vector<std::string> cols;
+		for (char *p_tok = strtok(line, ",\r\n"); p_tok != nullptr; p_tok = strtok(nullptr, ",\r\n"))
+			cols.push_back(p_tok);
+		if ((int)cols.size() < col_i)
+			continue;
+		std::vector<uint32_t> vals(nMetrics);
+		for (uint8_t met_i = 0; met_i < nMetrics; met_i++)
+			vals[met_i] = strtoul(cols[col_ind[met_i]].c_str(), nullptr, 10);
+		base[cols[col_move] + "," + cols[col_chips] + "," + cols[col_walls]] = vals;
+	}
+	fclose(p_file);
+
+	// Compare
+	int n_regress = 0, n_missing = 0;
+	for (const ResultStruct &r : results)
+	{
+		char key[32];
+		snprintf(key, sizeof(key), "%s,%u,%u", r.move, r.nChips, r.nWalls);
+		auto it = base.find(key);
+		if (it == base.end())
+		{
+			n_missing++;
+			continue;
+		}
+		for (uint8_t met_i = 0; met_i < nMetrics; met_i++)
+		{
+			uint32_t val = r.*metrics[met_i].val;
+			uint32_t val_base = it->second[met_i];
+			if (val > val_base * (1 + threshold / 100) && val > val_base + metrics[met_i].slack)
+			{
+				fprintf(stderr, "gate_bench: REGRESSION move[%s] %s base[%u] now[%u] (+%.1f%%)\n",
+						key, metrics[met_i].name, val_base, val, val_base > 0 ? 100.0 * (val - val_base) / val_base : 100.0);
+				n_regress++;
+			}
+		}
+	}
+	if (n_missing > 0)
+		fprintf(stderr, "gate_bench: %d moves not in the baseline\n", n_missing);
+	return n_regress;
+}
+
+static void printUsage(const char *p_name)
+{
+	printf("Usage: %s [options]\n"
+		   "  --chips N          largest chip count [default: %d]\n"
+		   "  --i2c-byte-us US   I2C time per byte [default: 90]\n"
+		   "  --i2c-trans-us US  I2C time per transaction [default: 10]\n"
+		   "  --out PATH         write the CSV results to PATH [default: stdout unless --check]\n"
+		   "  --check PATH       compare to a baseline CSV, exit 1 on regression\n"
+		   "  --threshold PCT    allowed growth of any metric [default: 5]\n",
+		   p_name, GateOperation::maxCyp);
+}
+
+int main(int argc, char *argv[])
+{
+	GateRigSim::ConfigStruct cfg;
+	uint8_t n_chips_max = GateOperation::maxCyp;
+	const char *p_out = nullptr;
+	const char *p_check = nullptr;
+	double threshold = 5;
+
+	static struct option opts[] = {
+		{"chips", required_argument, 0, 'c'},
+		{"i2c-byte-us", required_argument, 0, 'b'},
+		{"i2c-trans-us", required_argument, 0, 't'},
+		{"out", required_argument, 0, 'o'},
+		{"check", required_argument, 0, 'k'},
+		{"threshold", required_argument, 0, 'p'},
+		{"help", no_argument, 0, 'h'},
+		{0, 0, 0, 0}};
+	int opt;
+	while ((opt = getopt_long(argc, argv, "h", opts, nullptr)) != -1)
+	{
+		switch (opt)
+		{
+		case 'c':
+			n_chips_max = atoi(optarg);
+			break;
+		case 'b':
+			cfg.i2cUsPerByte = atoi(optarg);
+			break;
+		case 't':
+			cfg.i2cUsPerTrans = atoi(optarg);
+			break;
+		case 'o':
+			p_out = optarg;
+			break;
+		case 'k':
+			p_check = optarg;
+			break;
+		case 'p':
+			threshold = atof(optarg);
+			break;
+		default:
+			printUsage(argv[0]);
+			return opt == 'h' ? 0 : 2;
+		}
+	}
+	if (n_chips_max < 1 || n_chips_max > GateOperation::maxCyp)
+	{
+		fprintf(stderr, "gate_bench: --chips must be 1-%d\n", GateOperation::maxCyp);
+		return 2;
+	}
+
+	// Run the sweep
+	std::vector<ResultStruct> results;
+	const char *moves[] = {"up", "down", "mixed"};
+	int n_failed = 0;
+	for (uint8_t cyp_n = 1; cyp_n <= n_chips_max; cyp_n++)
+		for (const char *p_move : moves)
+			for (uint8_t wall_n = strcmp(p_move, "mixed") == 0 ? 2 : 1; wall_n <= 8; wall_n++)
+			{
+				cfg.nChips = cyp_n;
+				results.push_back(runMove(cfg, p_move, wall_n));
+				if (results.back().status != 1)
+				{
+					fprintf(stderr, "gate_bench: move[%s,%u,%u] failed status[%u]\n", p_move, cyp_n, wall_n, results.back().status);
+					n_failed++;
+				}
+			}
+
+	// Write the results
+	if (p_out != nullptr || p_check == nullptr)
+	{
+		FILE *p_file = p_out == nullptr || strcmp(p_out, "-") == 0 ? stdout : fopen(p_out, "w");
+		if (p_file == nullptr)
+		{
+			fprintf(stderr, "gate_bench: failed to open [%s]\n", p_out);
+			return 1;
+		}
+		writeCsv(p_file, results);
+		if (p_file != stdout)
+			fclose(p_file);
+	}
+
+	// Compare to the baseline
+	int n_regress = 0;
+	if (p_check != nullptr)
+	{
+		n_regress = checkBaseline(p_check, results, threshold);
+		if (n_regress < 0)
+		{
+			fprintf(stderr, "gate_bench: failed to read the baseline [%s]\n", p_check);
+			return 1;
+		}
+		fprintf(stderr, "gate_bench: %zu moves, %d regressions over %.1f%% against [%s]\n", results.size(), n_regress, threshold, p_check);
+	}
+	return n_failed > 0 || n_regress > 0 ? 1 : 0;
+}
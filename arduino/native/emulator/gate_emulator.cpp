@@ -0,0 +1,265 @@
+// ######################################
+
+//========= gate_emulator.cpp =========
+
+// ######################################
+
+/// @file Runs the cypress_gate_controller firmware on a simulated rig with its serial port on a pseudo-terminal.
+///
+/// @details The firmware's setup() and loop() run unchanged against @ref GateRigSim. Simulated
+/// time follows the wall clock, or runs ahead of it with --fast so moves finish as fast as the
+/// host can compute them. Connect the GUI or the gui/ tools to the printed port or to --link.
+/// With --timeline the GateProfile span records are copied from the firmware ring to a file after
+/// every loop() pass, in the dump format read by gui/gate_timeline.py. The native build keeps a
+/// span ring large enough for a whole move, and the ring is left as it is for message type 15.
+
+//============= INCLUDE ================
+#include "Arduino.h"
+#include "GateProfile.h"
+#include "GateRigSim.h"
+#include "PtyBridge.h"
+#include <chrono>
+#include <getopt.h>
+#include <signal.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+// Firmware entry points (cypress_gate_controller/src/main.cpp)
+void setup();
+void loop();
+
+//============ VARIABLES ===============
+static volatile sig_atomic_t isStopped = 0;
+static PtyBridge Bridge;
+static bool isRealTime = true;
+static std::chrono::steady_clock::time_point tsWall0;
+static uint64_t tsPump = 0; // simulated time of the last pty pump (us)
+static FILE *pTimeline = nullptr;
+static uint8_t spanLast[GateProfile::spanRecSize]; // last span record written to the timeline file
+static uint32_t nSpans = 0;						   // span records written to the timeline file
+static uint32_t nSpansLost = 0;					   // copies that missed records overwritten in the full ring
+
+//============ FUNCTIONS ===============
+
+static void onSignal(int) { isStopped = 1; }
+
+// Wall clock time since start (us)
+static uint64_t wallUs()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tsWall0).count();
+}
+
+// Append the span records added to the firmware timeline since the last call to the timeline file, oldest first
+static void copyTimeline()
+{
+	uint8_t sp_arr[3 + GateProfile::spanFrameRecs * GateProfile::spanRecSize];
+	if (pTimeline == nullptr || GateProfile::getSpanBytes(0, sp_arr, sizeof(sp_arr)) == 0 || sp_arr[1] == 0)
+		return;
+
+	// Search back from the newest record for the last one written, timestamps make records unique
+	std::vector<uint8_t> recs;
+	bool is_found = false;
+	uint16_t n_stored = 0;
+	for (int frame_i = sp_arr[1] - 1; frame_i >= 0 && !is_found; frame_i--)
+	{
+		GateProfile::getSpanBytes(frame_i, sp_arr, sizeof(sp_arr));
+		n_stored += sp_arr[2];
+		int rec_i = sp_arr[2] - 1;
+		for (; rec_i >= 0 && !is_found; rec_i--)
+			is_found = nSpans > 0 && memcmp(&sp_arr[3 + rec_i * GateProfile::spanRecSize], spanLast, GateProfile::spanRecSize) == 0;
+		int rec_new = is_found ? rec_i + 2 : 0;
+		recs.insert(recs.begin(), &sp_arr[3 + rec_new * GateProfile::spanRecSize], &sp_arr[3 + sp_arr[2] * GateProfile::spanRecSize]);
+	}
+	if (!is_found && nSpans > 0 && n_stored >= DB_SPAN_SIZE)
+		nSpansLost++;
+	if (recs.empty())
+		return;
+	fwrite(recs.data(), 1, recs.size(), pTimeline);
+	memcpy(spanLast, &recs[recs.size() - GateProfile::spanRecSize], GateProfile::spanRecSize);
+	nSpans += recs.size() / GateProfile::spanRecSize;
+}
+
+// Move serial data and keep simulated time from running ahead of the wall clock, also during blocking firmware calls
+static void onAdvance()
+{
+	if (NativeSim::nowUs - tsPump < 250)
+		return;
+	tsPump = NativeSim::nowUs;
+	Bridge.pump(Serial);
+	if (!isRealTime)
+		return;
+	uint64_t ts_wall = wallUs();
+	if (NativeSim::nowUs > ts_wall + 1000)
+		std::this_thread::sleep_for(std::chrono::microseconds(NativeSim::nowUs - ts_wall));
+}
+
+static void printUsage(const char *p_name)
+{
+	printf("Usage: %s [options]\n"
+		   "  --chips N          number of chips [default: 4]\n"
+		   "  --up-ms MS         mean wall up travel time [default: 600]\n"
+		   "  --down-ms MS       mean wall down travel time [default: 500]\n"
+		   "  --sd-ms MS         travel time standard deviation [default: 30]\n"
+		   "  --stuck C.W        make wall W of chip C stuck (repeatable)\n"
+		   "  --i2c-byte-us US   I2C time per byte [default: 90]\n"
+		   "  --i2c-trans-us US  I2C time per transaction [default: 10]\n"
+		   "  --seed N           travel time random seed [default: 1]\n"
+		   "  --link PATH        create a symlink to the serial port\n"
+		   "  --fast             do not pace simulated time to the wall clock\n"
+		   "  --timeline FILE    copy the span timeline to FILE\n"
+		   "  --exit-after S     exit after S seconds of wall clock time\n",
+		   p_name);
+}
+
+int main(int argc, char *argv[])
+{
+	GateRigSim::ConfigStruct cfg;
+	cfg.nChips = 4;
+	cfg.travelUp = {600000, 30000, 1000};
+	cfg.travelDown = {500000, 30000, 1000};
+	const char *p_link = nullptr;
+	const char *p_timeline = nullptr;
+	double dt_exit = 0;
+	uint8_t stuck[64][2];
+	uint8_t n_stuck = 0;
+
+	static struct option opts[] = {
+		{"chips", required_argument, 0, 'c'},
+		{"up-ms", required_argument, 0, 'u'},
+		{"down-ms", required_argument, 0, 'd'},
+		{"sd-ms", required_argument, 0, 's'},
+		{"stuck", required_argument, 0, 'k'},
+		{"i2c-byte-us", required_argument, 0, 'b'},
+		{"i2c-trans-us", required_argument, 0, 't'},
+		{"seed", required_argument, 0, 'r'},
+		{"link", required_argument, 0, 'l'},
+		{"fast", no_argument, 0, 'f'},
+		{"timeline", required_argument, 0, 'm'},
+		{"exit-after", required_argument, 0, 'x'},
+		{"help", no_argument, 0, 'h'},
+		{0, 0, 0, 0}};
+	int opt;
+	while ((opt = getopt_long(argc, argv, "h", opts, nullptr)) != -1)
+	{
+		switch (opt)
+		{
+		case 'c':
+			cfg.nChips = atoi(optarg);
+			break;
+		case 'u':
+			cfg.travelUp.meanUs = atof(optarg) * 1000;
+			break;
+		case 'd':
+			cfg.travelDown.meanUs = atof(optarg) * 1000;
+			break;
+		case 's':
+			cfg.travelUp.sdUs = cfg.travelDown.sdUs = atof(optarg) * 1000;
+			break;
+		case 'k':
+		{
+			unsigned int cyp_i, wall_i;
+			if (sscanf(optarg, "%u.%u", &cyp_i, &wall_i) != 2 || wall_i > 7 || n_stuck >= 64)
+			{
+				fprintf(stderr, "gate_emulator: bad --stuck value [%s], expected CHIP.WALL\n", optarg);
+				return 2;
+			}
+			stuck[n_stuck][0] = cyp_i;
+			stuck[n_stuck++][1] = wall_i;
+			break;
+		}
+		case 'b':
+			cfg.i2cUsPerByte = atoi(optarg);
+			break;
+		case 't':
+			cfg.i2cUsPerTrans = atoi(optarg);
+			break;
+		case 'r':
+			cfg.seed = atoi(optarg);
+			break;
+		case 'l':
+			p_link = optarg;
+			break;
+		case 'f':
+			isRealTime = false;
+			break;
+		case 'm':
+			p_timeline = optarg;
+			break;
+		case 'x':
+			dt_exit = atof(optarg);
+			break;
+		default:
+			printUsage(argv[0]);
+			return opt == 'h' ? 0 : 2;
+		}
+	}
+	if (cfg.nChips < 1 || cfg.nChips > 64)
+	{
+		fprintf(stderr, "gate_emulator: --chips must be 1-64\n");
+		return 2;
+	}
+
+	// Build the rig
+	NativeSim::reset();
+	GateRigSim rig(cfg);
+	for (uint8_t stk_i = 0; stk_i < n_stuck; stk_i++)
+		if (stuck[stk_i][0] < cfg.nChips)
+			rig.setStuck(stuck[stk_i][0], stuck[stk_i][1]);
+
+	// Open the timeline file
+	if (p_timeline != nullptr && (pTimeline = fopen(p_timeline, "wb")) == nullptr)
+	{
+		fprintf(stderr, "gate_emulator: failed to open --timeline file %s\n", p_timeline);
+		return 1;
+	}
+
+	// Open the serial port
+	if (!Bridge.open(p_link))
+	{
+		fprintf(stderr, "gate_emulator: failed to create the pseudo-terminal%s%s\n", p_link ? " or link " : "", p_link ? p_link : "");
+		return 1;
+	}
+	printf("gate_emulator: serial port %s chips[%d]%s\n", p_link ? p_link : Bridge.path(), cfg.nChips, isRealTime ? "" : " fast");
+	fflush(stdout);
+	signal(SIGINT, onSignal);
+	signal(SIGTERM, onSignal);
+
+	// Run the firmware
+	tsWall0 = std::chrono::steady_clock::now();
+	NativeSim::onAdvance = onAdvance;
+	setup();
+	uint64_t ts_wall_last = wallUs();
+	while (!isStopped && (dt_exit <= 0 || wallUs() < dt_exit * 1e6))
+	{
+		loop();
+		Bridge.pump(Serial);
+		copyTimeline();
+
+		// Let time pass while the firmware is idle
+		if (Serial.available() == 0 && Serial.hostPending() == 0)
+			Bridge.waitReadable(1);
+		uint64_t ts_wall = wallUs();
+		if (isRealTime)
+			NativeSim::advanceTo(ts_wall);
+		else
+			NativeSim::advance(ts_wall - ts_wall_last);
+		ts_wall_last = ts_wall;
+	}
+
+	NativeSim::onAdvance = nullptr;
+	uint32_t n_moves = 0;
+	for (uint8_t cyp_i = 0; cyp_i < rig.nChips(); cyp_i++)
+		for (uint8_t wall_i = 0; wall_i < 8; wall_i++)
+			n_moves += rig.wall(cyp_i, wall_i).nMoves;
+	printf("gate_emulator: stopped rx[%u] tx[%u] tx_dropped[%u] wall_moves[%u] sim_time_ms[%llu]\n",
+		   Bridge.nRx, Bridge.nTx, Bridge.nTxDropped, n_moves, (unsigned long long)(NativeSim::nowUs / 1000));
+	if (pTimeline != nullptr)
+	{
+		copyTimeline();
+		fclose(pTimeline);
+		printf("gate_emulator: timeline %s spans[%u]%s\n", p_timeline, nSpans, nSpansLost ? " ring full, some spans lost" : "");
+	}
+	Bridge.close();
+	return 0;
+}
@@ -0,0 +1,139 @@
+// ######################################
+
+//======== Arduino.h (native) =========
+
+// ######################################
+
+/// @file Host stand-in for the Arduino core used to build the gate libraries off-target.
+///
+/// @details Only the parts of the core used by the libraries and cypress_gate_controller are
+/// provided. Time, pins and interrupts are backed by @ref NativeSim.
+
+#ifndef _NATIVE_ARDUINO_h
+#define _NATIVE_ARDUINO_h
+
+//============= INCLUDE ================
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+// Binary constants used by the libraries (see Arduino binary.h)
+#define B0100000 32
+#define B1010000 80
+
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+
+// Program memory is ordinary memory on the host
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define vsnprintf_P vsnprintf
+#define snprintf_P snprintf
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strlen_P strlen
+#define memcpy_P memcpy
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+
+// Time
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long);
+void delayMicroseconds(unsigned int);
+
+// Digital pins and interrupts
+void pinMode(uint8_t, uint8_t);
+void digitalWrite(uint8_t, uint8_t);
+int digitalRead(uint8_t);
+int digitalPinToInterrupt(uint8_t);
+void attachInterrupt(uint8_t, void (*)(void), int);
+void detachInterrupt(uint8_t);
+void noInterrupts();
+void interrupts();
+
+/// @brief Base class for byte output, as in the Arduino core.
+class Print
+{
+public:
+	virtual ~Print() {}
+	virtual size_t write(uint8_t) = 0;
+	virtual size_t write(const uint8_t *p_buff, size_t s)
+	{
+		size_t n = 0;
+		while (s-- > 0)
+			n += write(*p_buff++);
+		return n;
+	}
+	size_t write(const char *p_str) { return p_str == nullptr ? 0 : write((const uint8_t *)p_str, strlen(p_str)); }
+	virtual int availableForWrite() { return 0; }
+	virtual void flush() {}
+
+	size_t print(const char *p_str) { return write(p_str); }
+	size_t print(const __FlashStringHelper *p_str) { return write(reinterpret_cast<const char *>(p_str)); }
+	size_t print(char c) { return write((uint8_t)c); }
+	size_t print(long val, int base = DEC) { return _printNumber(val < 0 ? -(unsigned long)val : val, base, val < 0); }
+	size_t print(int val, int base = DEC) { return print((long)val, base); }
+	size_t print(unsigned long val, int base = DEC) { return _printNumber(val, base, false); }
+	size_t print(unsigned int val, int base = DEC) { return print((unsigned long)val, base); }
+	size_t println() { return write("\r\n"); }
+	template <typename T>
+	size_t println(T val) { return print(val) + println(); }
+
+private:
+	size_t _printNumber(unsigned long val, int base, bool is_neg)
+	{
+		char buff[36];
+		char *p_c = &buff[sizeof(buff) - 1];
+		*p_c = '\0';
+		base = base < 2 ? DEC : base;
+		do
+		{
+			uint8_t digit = val % base;
+			*--p_c = digit < 10 ? '0' + digit : 'A' + digit - 10;
+			val /= base;
+		} while (val > 0);
+		if (is_neg)
+			*--p_c = '-';
+		return write(p_c);
+	}
+};
+
+/// @brief Base class for byte input and output, as in the Arduino core.
+class Stream : public Print
+{
+public:
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+	void setTimeout(unsigned long) {}
+};
+
+#include "HardwareSerial.h"
+
+#endif
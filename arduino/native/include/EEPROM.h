@@ -0,0 +1,38 @@
+// ######################################
+
+//========= EEPROM.h (native) =========
+
+// ######################################
+
+/// @file Host stand-in for the Arduino EEPROM library, backed by @ref NativeSim::eeprom.
+
+#ifndef _NATIVE_EEPROM_h
+#define _NATIVE_EEPROM_h
+
+//============= INCLUDE ================
+#include "Arduino.h"
+#include "NativeSim.h"
+
+/// @brief Byte access to the simulated EEPROM.
+class EEPROMClass
+{
+public:
+	uint8_t read(int i) { return i >= 0 && i < NativeSim::eepromSize ? NativeSim::eeprom[i] : 0xFF; }
+
+public:
+	void write(int i, uint8_t val)
+	{
+		if (i >= 0 && i < NativeSim::eepromSize)
+			NativeSim::eeprom[i] = val;
+	}
+
+public:
+	void update(int i, uint8_t val) { write(i, val); }
+
+public:
+	uint16_t length() { return NativeSim::eepromSize; }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,93 @@
+// ######################################
+
+//===== HardwareSerial.h (native) =====
+
+// ######################################
+
+/// @file Host stand-in for the Arduino HardwareSerial class.
+
+#ifndef _NATIVE_HARDWARE_SERIAL_h
+#define _NATIVE_HARDWARE_SERIAL_h
+
+//============= INCLUDE ================
+#include <deque>
+
+#ifndef SERIAL_TX_BUFFER_SIZE
+#define SERIAL_TX_BUFFER_SIZE 64
+#endif
+#ifndef SERIAL_RX_BUFFER_SIZE
+#define SERIAL_RX_BUFFER_SIZE 64
+#endif
+
+/// @brief Simulated UART with the AVR core's buffer behavior in simulated time.
+///
+/// @details Written bytes wait in a SERIAL_TX_BUFFER_SIZE transmit buffer and leave it one
+/// byte time (10 bits at the baud rate) apart, write() blocks while the buffer is full, and
+/// availableForWrite() reports the free space. The host side reads bytes once they have left
+/// the buffer with hostRead(). Bytes sent by the host with hostWrite() arrive one byte time
+/// apart and are dropped if the SERIAL_RX_BUFFER_SIZE receive buffer is full.
+class HardwareSerial : public Stream
+{
+
+	// --------------VARIABLES--------------
+public:
+	uint32_t nRxDropped = 0; // bytes dropped because the receive buffer was full
+
+private:
+	bool _isBegun = false;
+	uint32_t _usPerByte = 0;		  // byte time at the baud rate (us) [0:instant]
+	std::deque<uint8_t> _rx;		  // receive buffer
+	std::deque<uint8_t> _tx;		  // transmit buffer and sent bytes not yet read by the host
+	std::deque<uint64_t> _txDone;	  // simulated time each byte in "_tx" has left the transmit buffer (us)
+	uint64_t _tsTxLast = 0;			  // simulated time the last written byte leaves the transmit buffer (us)
+	uint64_t _tsRxLast = 0;			  // simulated time the last host byte arrives (us)
+
+	// ---------------METHODS---------------
+public:
+	void begin(unsigned long);
+
+public:
+	void end();
+
+public:
+	int available() override;
+
+public:
+	int peek() override;
+
+public:
+	int read() override;
+
+public:
+	size_t write(uint8_t) override;
+	using Print::write;
+
+public:
+	int availableForWrite() override;
+
+public:
+	void flush() override;
+
+public:
+	operator bool() { return true; }
+
+public:
+	void hostWrite(const uint8_t[], size_t);
+
+public:
+	size_t hostRead(uint8_t[], size_t);
+
+public:
+	size_t hostPending();
+
+public:
+	void reset();
+
+private:
+	size_t _txQueued();
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+
+#endif
@@ -0,0 +1,114 @@
+// ######################################
+
+//============ NativeSim.h ============
+
+// ######################################
+
+/// @file Simulated time, pins, I2C bus and EEPROM behind the native Arduino stand-ins.
+
+#ifndef _NATIVE_SIM_h
+#define _NATIVE_SIM_h
+
+//============= INCLUDE ================
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+#include <map>
+
+/// @brief Interface of a simulated device on the I2C bus.
+class I2cDevice
+{
+public:
+	virtual ~I2cDevice() {}
+
+	/// @brief Handle a master write transaction.
+	/// @param p_data Bytes written after the address.
+	/// @param s Number of bytes, 0 for an address-only probe.
+	/// @param is_stop Transaction ends with a stop condition.
+	/// @return Wire::endTransmission() status [0:ack, 2:address nack, 3:data nack, 4:other, 5:timeout].
+	virtual uint8_t i2cWrite(const uint8_t p_data[], uint8_t s, bool is_stop) = 0;
+
+	/// @brief Handle a master read transaction.
+	/// @param p_data Buffer to fill.
+	/// @param s Number of bytes requested.
+	/// @return Number of bytes returned.
+	virtual uint8_t i2cRead(uint8_t p_data[], uint8_t s) = 0;
+};
+
+/// @brief Global state of the simulated board.
+///
+/// @details Time only moves forward when the firmware calls millis()/micros() (by @ref tickUs,
+/// so busy wait loops end), delay()/delayMicroseconds(), spends time on the I2C bus or serial
+/// port, or when the caller uses @ref advance(). Callbacks added with @ref schedule() run as
+/// soon as time passes their timestamp, which is how tests and emulators script the hardware.
+/// @ref onAdvance runs after each time step, so an emulator can pace simulated time to the
+/// wall clock and move serial data while the firmware is blocked in a long call.
+class NativeSim
+{
+
+	// --------------VARIABLES--------------
+public:
+	static const uint8_t nPins = 70;		 // Arduino Mega pin count
+	static const uint16_t eepromSize = 4096; // Arduino Mega EEPROM size
+
+	static uint64_t nowUs;			 // simulated time (us)
+	static uint32_t tickUs;			 // time each millis()/micros() call takes (us)
+	static uint32_t i2cUsPerByte;	 // I2C bus time per byte including address byte (us) [90:100 kHz]
+	static uint32_t i2cUsPerTrans;	 // I2C bus time per transaction for start/stop (us)
+	static uint32_t nI2cTrans;		 // I2C transactions (writes, reads and probes) since reset
+	static uint32_t nI2cBytes;		 // I2C data bytes since reset (address bytes excluded)
+	static uint8_t pinLevel[nPins];	 // current level of each pin
+	static uint8_t pinModeArr[nPins]; // pin mode set with pinMode()
+	static uint8_t eeprom[eepromSize];
+	static I2cDevice *i2cDev[128];								   // devices by 7-bit address
+	static std::function<void(uint8_t, uint8_t)> onPinWrite;	   // called on digitalWrite() [pin, level]
+	static std::function<void()> onAdvance;						   // called after time moves forward, not nested (e.g. to pace to the wall clock)
+
+private:
+	static std::multimap<uint64_t, std::function<void()>> _events;
+	static void (*_isr[nPins])(void);
+	static int _isrMode[nPins];
+	static bool _isInterruptsOn;
+	static bool _isPendingIsr[nPins];
+	static bool _isRunningEvents;
+	static bool _isInAdvanceHook;
+
+	// ---------------METHODS---------------
+public:
+	static void reset();
+
+public:
+	static void advance(uint64_t);
+
+public:
+	static void advanceTo(uint64_t);
+
+public:
+	static void schedule(uint64_t, std::function<void()>);
+
+public:
+	static void clearSchedule();
+
+public:
+	static size_t nScheduled();
+
+public:
+	static void setPin(uint8_t, uint8_t);
+
+public:
+	static void attachI2c(uint8_t, I2cDevice *);
+
+public:
+	static void writePin(uint8_t, uint8_t);
+
+public:
+	static void attachIsr(uint8_t, void (*)(void), int);
+
+public:
+	static void setInterrupts(bool);
+
+private:
+	static void _runIsr(uint8_t);
+};
+
+#endif
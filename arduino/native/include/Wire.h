@@ -0,0 +1,69 @@
+// ######################################
+
+//========== Wire.h (native) ==========
+
+// ######################################
+
+/// @file Host stand-in for the Arduino Wire (I2C master) library.
+
+#ifndef _NATIVE_WIRE_h
+#define _NATIVE_WIRE_h
+
+//============= INCLUDE ================
+#include "Arduino.h"
+
+#define BUFFER_LENGTH 32
+
+/// @brief I2C master that routes transactions to the devices attached to @ref NativeSim.
+///
+/// @details Status codes match the AVR core: 0 success, 1 data too long, 2 address NACK,
+/// 3 data NACK, 4 other error, 5 timeout.
+class TwoWire : public Stream
+{
+
+	// --------------VARIABLES--------------
+private:
+	uint8_t _txAddr = 0;
+	uint8_t _txBuff[BUFFER_LENGTH];
+	uint8_t _txLen = 0;
+	bool _isTxOverflow = false;
+	uint8_t _rxBuff[BUFFER_LENGTH];
+	uint8_t _rxLen = 0;
+	uint8_t _rxInd = 0;
+
+	// ---------------METHODS---------------
+public:
+	void begin() {}
+
+public:
+	void setClock(uint32_t) {}
+
+public:
+	void setWireTimeout(uint32_t = 25000, bool = false) {}
+
+public:
+	void beginTransmission(uint8_t);
+
+public:
+	uint8_t endTransmission(uint8_t = true);
+
+public:
+	uint8_t requestFrom(uint8_t, uint8_t, uint8_t = true);
+
+public:
+	size_t write(uint8_t) override;
+	using Print::write;
+
+public:
+	int available() override { return _rxLen - _rxInd; }
+
+public:
+	int read() override { return _rxInd < _rxLen ? _rxBuff[_rxInd++] : -1; }
+
+public:
+	int peek() override { return _rxInd < _rxLen ? _rxBuff[_rxInd] : -1; }
+};
+
+extern TwoWire Wire;
+
+#endif
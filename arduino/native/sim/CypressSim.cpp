@@ -0,0 +1,282 @@
+// ######################################
+
+//========== CypressSim.cpp ===========
+
+// ######################################
+
+//============= INCLUDE ================
+#include "CypressSim.h"
+
+//========CLASS: CypressSim==========
+
+/// @brief CONSTUCTOR: Create a chip with default registers and attach it to the simulated I2C bus.
+///
+/// @param _address 7-bit I2C address [default: CY8C95X0_ADDR].
+CypressSim::CypressSim(uint8_t _address)
+{
+	address = _address;
+	restoreDefaults();
+	NativeSim::attachI2c(address, this);
+}
+
+/// @brief DESTRUCTOR: Detach the chip from the simulated I2C bus.
+CypressSim::~CypressSim()
+{
+	if (NativeSim::i2cDev[address] == this)
+		NativeSim::attachI2c(address, nullptr);
+}
+
+/// @brief Set the factory defaults, as REG_CMD_RESTORE followed by REG_CMD_RECONF does.
+///
+/// @note Defaults are outputs driven high with pull-up drive, all interrupts masked and no PWM output.
+void CypressSim::restoreDefaults()
+{
+	for (uint8_t prt_i = 0; prt_i < nPorts; prt_i++)
+	{
+		out[prt_i] = 0xFF;
+		intStat[prt_i] = 0;
+		intMask[prt_i] = 0xFF;
+		selPwm[prt_i] = 0;
+		inv[prt_i] = 0;
+		dir[prt_i] = 0;
+		for (uint8_t drv_i = 0; drv_i < nDrive; drv_i++)
+			drive[drv_i][prt_i] = drv_i == 0 ? 0xFF : 0;
+	}
+	for (uint8_t pwm_i = 0; pwm_i < nPwm; pwm_i++)
+	{
+		pwmConf[pwm_i] = 0;
+		pwmPeri[pwm_i] = 0xFF;
+		pwmWidth[pwm_i] = 0x80;
+	}
+	portSel = 0;
+	pwmSel = 0;
+	progDiv = 0xFF;
+	enable = 0;
+	watchdog = 0;
+}
+
+/// @brief Set the external level of all pins of a port, latching interrupts for changed input pins.
+///
+/// @param port Port number [0-5].
+/// @param byte_val Pin levels.
+void CypressSim::setInput(uint8_t port, uint8_t byte_val)
+{
+	if (port >= nPorts)
+		return;
+	intStat[port] |= (ext[port] ^ byte_val) & dir[port] & ~intMask[port];
+	ext[port] = byte_val;
+}
+
+/// @brief Set the external level of a single pin.
+///
+/// @param port Port number [0-5].
+/// @param pin Pin number [0-7].
+/// @param bit_val Pin level [0,1].
+void CypressSim::setInputPin(uint8_t port, uint8_t pin, uint8_t bit_val)
+{
+	if (port >= nPorts)
+		return;
+	uint8_t byte_val = ext[port];
+	bitWrite(byte_val, pin, bit_val);
+	setInput(port, byte_val);
+}
+
+/// @brief Get the output register bit of a pin.
+///
+/// @param port Port number [0-5].
+/// @param pin Pin number [0-7].
+/// @return Output bit [0,1].
+uint8_t CypressSim::getOutputPin(uint8_t port, uint8_t pin)
+{
+	return port < nPorts ? bitRead(out[port], pin) : 0;
+}
+
+/// @brief Read a register without side effects (no pointer move, no interrupt clear, not counted).
+///
+/// @param reg Register address.
+/// @return Register value [0 for unmodeled registers].
+uint8_t CypressSim::peekReg(uint8_t reg)
+{
+	uint8_t int_stat[nPorts];
+	memcpy(int_stat, intStat, nPorts);
+	uint8_t byte_val = _readReg(reg);
+	memcpy(intStat, int_stat, nPorts);
+	return byte_val;
+}
+
+/// @brief Zero the transaction counters.
+void CypressSim::resetCounters()
+{
+	nWrites = 0;
+	nReads = 0;
+	nRegWrites = 0;
+	nRegReads = 0;
+	nCommands = 0;
+}
+
+/// @brief Handle a master write: the first byte sets the register pointer, the rest are written with auto-increment.
+uint8_t CypressSim::i2cWrite(const uint8_t p_data[], uint8_t s, bool)
+{
+	if (!isPresent)
+		return 2;
+	nWrites++;
+	if (_takeFail())
+		return failStatus;
+	if (s == 0)
+		return 0;
+
+	regPtr = p_data[0];
+	for (uint8_t i = 1; i < s; i++)
+	{
+		_writeReg(regPtr, p_data[i]);
+		nRegWrites++;
+		if (onWrite)
+			onWrite(*this, regPtr, p_data[i]);
+		regPtr++;
+	}
+	return 0;
+}
+
+/// @brief Handle a master read from the register pointer with auto-increment.
+uint8_t CypressSim::i2cRead(uint8_t p_data[], uint8_t s)
+{
+	if (!isPresent)
+		return 0;
+	nReads++;
+	if (_takeFail())
+		return 0;
+	if (failNextRead > 0)
+	{
+		failNextRead--;
+		return 0;
+	}
+	for (uint8_t i = 0; i < s; i++)
+		p_data[i] = _readReg(regPtr++);
+	nRegReads += s;
+	return s;
+}
+
+/// @brief Get a register value, clearing interrupt status registers that are read.
+uint8_t CypressSim::_readReg(uint8_t reg)
+{
+	if (reg < nPorts)
+		return _portIn(reg);
+	if (reg >= REG_GO0 && reg <= REG_GO5)
+		return out[reg - REG_GO0];
+	if (reg >= REG_INT_STAT_0 && reg < REG_INT_STAT_0 + nPorts)
+	{
+		uint8_t byte_val = intStat[reg - REG_INT_STAT_0];
+		intStat[reg - REG_INT_STAT_0] = 0;
+		return byte_val;
+	}
+	if (reg >= DRIVE_PULLUP && reg <= DRIVE_HIZ)
+		return drive[reg - DRIVE_PULLUP][portSel];
+	switch (reg)
+	{
+	case REG_PORT_SEL:
+		return portSel;
+	case REG_INT_MASK:
+		return intMask[portSel];
+	case REG_SEL_PWM_PORT_OUT:
+		return selPwm[portSel];
+	case REG_INVERSION:
+		return inv[portSel];
+	case REG_PIN_DIR:
+		return dir[portSel];
+	case REG_SEL_PWM:
+		return pwmSel;
+	case REG_CONF_PWM:
+		return pwmConf[pwmSel];
+	case REG_PERI_PWM:
+		return pwmPeri[pwmSel];
+	case REG_PW_PWM:
+		return pwmWidth[pwmSel];
+	case REG_PROG_DIV:
+		return progDiv;
+	case REG_ENABLE:
+		return enable;
+	case REG_DEV_STATUS:
+		return devId;
+	case REG_WATCHDOG:
+		return watchdog;
+	default:
+		return 0;
+	}
+}
+
+/// @brief Set a register value; read-only and unmodeled registers are ignored.
+void CypressSim::_writeReg(uint8_t reg, uint8_t byte_val)
+{
+	if (reg >= REG_GO0 && reg <= REG_GO5)
+	{
+		out[reg - REG_GO0] = byte_val;
+		return;
+	}
+	if (reg >= DRIVE_PULLUP && reg <= DRIVE_HIZ)
+	{ // setting a pin's bit in one drive mode register clears it in the others
+		for (uint8_t drv_i = 0; drv_i < nDrive; drv_i++)
+			drive[drv_i][portSel] = drv_i == reg - DRIVE_PULLUP ? drive[drv_i][portSel] | byte_val : drive[drv_i][portSel] & ~byte_val;
+		return;
+	}
+	switch (reg)
+	{
+	case REG_PORT_SEL:
+		portSel = byte_val < nPorts ? byte_val : portSel;
+		break;
+	case REG_INT_MASK:
+		intMask[portSel] = byte_val;
+		break;
+	case REG_SEL_PWM_PORT_OUT:
+		selPwm[portSel] = byte_val;
+		break;
+	case REG_INVERSION:
+		inv[portSel] = byte_val;
+		break;
+	case REG_PIN_DIR:
+		dir[portSel] = byte_val;
+		break;
+	case REG_SEL_PWM:
+		pwmSel = byte_val < nPwm ? byte_val : pwmSel;
+		break;
+	case REG_CONF_PWM:
+		pwmConf[pwmSel] = byte_val;
+		break;
+	case REG_PERI_PWM:
+		pwmPeri[pwmSel] = byte_val;
+		break;
+	case REG_PW_PWM:
+		pwmWidth[pwmSel] = byte_val;
+		break;
+	case REG_PROG_DIV:
+		progDiv = byte_val;
+		break;
+	case REG_ENABLE:
+		enable = byte_val;
+		break;
+	case REG_WATCHDOG:
+		watchdog = byte_val;
+		break;
+	case REG_CMD:
+		nCommands++;
+		if (byte_val == REG_CMD_RESTORE)
+			restoreDefaults();
+		break;
+	default:
+		break;
+	}
+}
+
+/// @brief Get the input port value: external level for input pins and output register for output pins.
+uint8_t CypressSim::_portIn(uint8_t port)
+{
+	return (((ext[port] & dir[port]) | (out[port] & ~dir[port])) ^ inv[port]);
+}
+
+/// @brief Use up one pending failure.
+bool CypressSim::_takeFail()
+{
+	if (failNext == 0)
+		return false;
+	failNext--;
+	return true;
+}
@@ -0,0 +1,115 @@
+// ######################################
+
+//=========== CypressSim.h ============
+
+// ######################################
+
+/// @file Register model of the CY8C9540A I/O expander for the native build.
+
+#ifndef _CYPRESS_SIM_h
+#define _CYPRESS_SIM_h
+
+//============= INCLUDE ================
+#include "Arduino.h"
+#include "NativeSim.h"
+#include "CypressComBase.h"
+#include <functional>
+
+/// @brief Simulated CY8C9540A on the I2C bus.
+///
+/// @details Models the registers used by CypressCom and GateOperation: input/output ports,
+/// interrupt status, the port-select indexed registers (interrupt mask, PWM select, inversion,
+/// pin direction, drive modes), the PWM-select indexed registers, the device ID/status register
+/// and the restore-defaults command. The register pointer auto-increments on reads and writes.
+///
+/// An input port reads back the external pin level for input pins (pin direction 1) and the
+/// output register for output pins. Tests drive external levels with setInput()/setInputPin()
+/// and follow writes with @ref onWrite. @ref failNext makes the next transactions fail and
+/// @ref failNextRead makes the next reads return no data.
+class CypressSim : public I2cDevice
+{
+
+	// --------------VARIABLES--------------
+public:
+	static const uint8_t nPorts = 6;
+	static const uint8_t nPwm = 8;
+	static const uint8_t nDrive = 7; // drive modes DRIVE_PULLUP to DRIVE_HIZ
+	static const uint8_t devId = 0x40; // upper nibble of REG_DEV_STATUS for the CY8C9540A
+
+	uint8_t address;			  // 7-bit I2C address
+	uint8_t ext[nPorts] = {0};	  // external level of each pin
+	uint8_t out[nPorts];		  // output port registers (REG_GO0-REG_GO5)
+	uint8_t intStat[nPorts];	  // interrupt status (cleared on read)
+	uint8_t intMask[nPorts];	  // interrupt mask
+	uint8_t selPwm[nPorts];		  // PWM select for port output
+	uint8_t inv[nPorts];		  // input inversion
+	uint8_t dir[nPorts];		  // pin direction [0:output, 1:input]
+	uint8_t drive[nDrive][nPorts]; // drive mode registers, each pin in exactly one
+	uint8_t pwmConf[nPwm];		  // PWM clock select
+	uint8_t pwmPeri[nPwm];		  // PWM period
+	uint8_t pwmWidth[nPwm];		  // PWM pulse width
+	uint8_t portSel;			  // port select
+	uint8_t pwmSel;				  // PWM select
+	uint8_t progDiv;			  // programmable divider
+	uint8_t enable;				  // enable register
+	uint8_t watchdog;			  // watchdog register
+	uint8_t regPtr = 0;			  // register pointer
+
+	uint8_t failStatus = 4;	 // Wire status returned by failing transactions [2:address nack, 3:data nack, 4:other, 5:timeout]
+	uint16_t failNext = 0;	 // number of upcoming transactions to fail
+	uint16_t failNextRead = 0; // number of upcoming read transactions to return no data
+	bool isPresent = true;	 // device answers its address
+
+	uint32_t nWrites = 0;	  // write transactions (including address probes)
+	uint32_t nReads = 0;	  // read transactions
+	uint32_t nRegWrites = 0;  // register bytes written
+	uint32_t nRegReads = 0;	  // register bytes read
+	uint32_t nCommands = 0;	  // bytes written to REG_CMD
+
+	std::function<void(CypressSim &, uint8_t, uint8_t)> onWrite; // called after each register byte write [sim, reg, value]
+
+	// ---------------METHODS---------------
+public:
+	CypressSim(uint8_t = CY8C95X0_ADDR);
+
+public:
+	~CypressSim();
+
+public:
+	void restoreDefaults();
+
+public:
+	void setInput(uint8_t, uint8_t);
+
+public:
+	void setInputPin(uint8_t, uint8_t, uint8_t);
+
+public:
+	uint8_t getOutputPin(uint8_t, uint8_t);
+
+public:
+	uint8_t peekReg(uint8_t);
+
+public:
+	void resetCounters();
+
+public:
+	uint8_t i2cWrite(const uint8_t[], uint8_t, bool) override;
+
+public:
+	uint8_t i2cRead(uint8_t[], uint8_t) override;
+
+private:
+	uint8_t _readReg(uint8_t);
+
+private:
+	void _writeReg(uint8_t, uint8_t);
+
+private:
+	uint8_t _portIn(uint8_t);
+
+private:
+	bool _takeFail();
+};
+
+#endif
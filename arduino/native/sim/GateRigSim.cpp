@@ -0,0 +1,222 @@
+// ######################################
+
+//=========== GateRigSim.cpp ==========
+
+// ######################################
+
+//============= INCLUDE ================
+#include "GateRigSim.h"
+#include "GateOperation.h"
+#include <math.h>
+
+typedef GateOperation::WallMapStruct WMS;
+
+//========CLASS: GateRigSim==========
+
+/// @brief CONSTUCTOR: Create the chips on the simulated I2C bus with all walls down.
+///
+/// @param _Cfg Rig configuration.
+GateRigSim::GateRigSim(const ConfigStruct &_Cfg) : Cfg(_Cfg), _rng(_Cfg.seed)
+{
+	NativeSim::i2cUsPerByte = Cfg.i2cUsPerByte;
+	NativeSim::i2cUsPerTrans = Cfg.i2cUsPerTrans;
+	_isAlive = std::make_shared<bool>(true);
+
+	for (uint8_t cyp_i = 0; cyp_i < Cfg.nChips; cyp_i++)
+	{
+		_cyp.emplace_back(new CypressSim(Cfg.addr0 + cyp_i));
+		_wall.emplace_back(8);
+		_cyp[cyp_i]->onWrite = [this, cyp_i](CypressSim &, uint8_t, uint8_t)
+		{ _onRegWrite(cyp_i); };
+		for (uint8_t wall_i = 0; wall_i < 8; wall_i++)
+		{
+			_wall[cyp_i][wall_i].tsUpdate = NativeSim::nowUs;
+			_setSwitches(cyp_i, wall_i);
+		}
+	}
+}
+
+/// @brief DESTRUCTOR: Remove the chips from the bus; pending switch events are ignored.
+GateRigSim::~GateRigSim()
+{
+	*_isAlive = false;
+}
+
+/// @brief Make a wall stuck or free it.
+///
+/// @param cyp_i Chip index.
+/// @param wall_i Wall index [0-7].
+/// @param is_stuck Wall does not move [default: true].
+void GateRigSim::setStuck(uint8_t cyp_i, uint8_t wall_i, bool is_stuck)
+{
+	_wall[cyp_i][wall_i].isStuck = is_stuck;
+	_updateWall(cyp_i, wall_i, true);
+}
+
+/// @brief Place a wall, updating its limit switches.
+///
+/// @param cyp_i Chip index.
+/// @param wall_i Wall index [0-7].
+/// @param pos Position [0:down, 1:up].
+void GateRigSim::setWallPosition(uint8_t cyp_i, uint8_t wall_i, double pos)
+{
+	WallStruct &r_wall = _wall[cyp_i][wall_i];
+	_integrate(r_wall);
+	r_wall.pos = pos < 0 ? 0 : pos > 1 ? 1 : pos;
+	_setSwitches(cyp_i, wall_i);
+	_updateWall(cyp_i, wall_i, true);
+}
+
+/// @brief Get the walls with a closed up switch.
+///
+/// @param cyp_i Chip index.
+/// @return Bitwise wall state [0:not up, 1:up].
+uint8_t GateRigSim::getWallsUp(uint8_t cyp_i)
+{
+	uint8_t byte_up = 0;
+	for (uint8_t wall_i = 0; wall_i < 8; wall_i++)
+		bitWrite(byte_up, wall_i, _cyp[cyp_i]->ext[WMS::ioUp[0][wall_i]] >> WMS::ioUp[1][wall_i] & 1);
+	return byte_up;
+}
+
+/// @brief Get the walls with a running motor.
+///
+/// @param cyp_i Chip index.
+/// @return Bitwise motor state [0:braked, 1:driven up or down].
+uint8_t GateRigSim::getWallsDriven(uint8_t cyp_i)
+{
+	uint8_t byte_driven = 0;
+	for (uint8_t wall_i = 0; wall_i < 8; wall_i++)
+		bitWrite(byte_driven, wall_i, _wall[cyp_i][wall_i].dirDriven != 0);
+	return byte_driven;
+}
+
+/// @brief Update the motors of a chip after any register write.
+void GateRigSim::_onRegWrite(uint8_t cyp_i)
+{
+	for (uint8_t wall_i = 0; wall_i < 8; wall_i++)
+		_updateWall(cyp_i, wall_i, false);
+}
+
+/// @brief Update the motor drive of a wall from the output pins and reschedule its switch events.
+///
+/// @param cyp_i Chip index.
+/// @param wall_i Wall index [0-7].
+/// @param do_force Reschedule even if the drive did not change.
+void GateRigSim::_updateWall(uint8_t cyp_i, uint8_t wall_i, bool do_force)
+{
+	WallStruct &r_wall = _wall[cyp_i][wall_i];
+	uint8_t src = WMS::pwmSrc[wall_i];
+	double duty_up = _pinDuty(cyp_i, WMS::pwmUp[0][wall_i], WMS::pwmUp[1][wall_i], src);
+	double duty_down = _pinDuty(cyp_i, WMS::pwmDown[0][wall_i], WMS::pwmDown[1][wall_i], src);
+	int8_t dir = duty_up > 0 && duty_down == 0 ? 1 : duty_down > 0 && duty_up == 0 ? -1 : 0;
+	double duty = dir > 0 ? duty_up : dir < 0 ? duty_down : 0;
+	if (!do_force && dir == r_wall.dirDriven && duty == r_wall.dutyDriven)
+		return;
+
+	// Draw the travel time when the motor starts or reverses
+	_integrate(r_wall);
+	if (dir != 0 && dir != r_wall.dirDriven)
+	{
+		r_wall.dtTravel = _drawTravel(dir > 0 ? Cfg.travelUp : Cfg.travelDown);
+		r_wall.tsStart = NativeSim::nowUs;
+		r_wall.nMoves++;
+	}
+	r_wall.dirDriven = dir;
+	r_wall.dutyDriven = duty;
+	r_wall.speed = r_wall.isStuck || dir == 0 ? 0 : dir * duty * (1 - Cfg.switchZone) / r_wall.dtTravel;
+	r_wall.gen++;
+	_scheduleNext(cyp_i, wall_i);
+}
+
+/// @brief Move a wall to its position at the current simulated time.
+void GateRigSim::_integrate(WallStruct &r_wall)
+{
+	r_wall.pos += r_wall.speed * (double)(NativeSim::nowUs - r_wall.tsUpdate);
+	r_wall.pos = r_wall.pos < 0 ? 0 : r_wall.pos > 1 ? 1 : r_wall.pos;
+	r_wall.tsUpdate = NativeSim::nowUs;
+}
+
+/// @brief Schedule the next time a moving wall crosses a switch zone boundary or reaches its end.
+void GateRigSim::_scheduleNext(uint8_t cyp_i, uint8_t wall_i)
+{
+	WallStruct &r_wall = _wall[cyp_i][wall_i];
+	if (r_wall.speed == 0)
+		return;
+
+	// Find the next boundary in the direction of travel
+	const double eps = 1e-9;
+	double bounds[4] = {0, Cfg.switchZone, 1 - Cfg.switchZone, 1};
+	double pos_next = -1;
+	for (uint8_t b_i = 0; b_i < 4; b_i++)
+	{
+		double b = r_wall.speed > 0 ? bounds[b_i] : bounds[3 - b_i];
+		if ((r_wall.speed > 0 && b > r_wall.pos + eps) || (r_wall.speed < 0 && b < r_wall.pos - eps))
+		{
+			pos_next = b;
+			break;
+		}
+	}
+	if (pos_next < 0)
+		return;
+
+	uint64_t dt = (uint64_t)ceil((pos_next - r_wall.pos) / r_wall.speed);
+	uint32_t gen = r_wall.gen;
+	std::shared_ptr<bool> is_alive = _isAlive;
+	NativeSim::schedule(NativeSim::nowUs + (dt > 0 ? dt : 1), [this, is_alive, cyp_i, wall_i, gen, pos_next]()
+						{
+		if (!*is_alive || _wall[cyp_i][wall_i].gen != gen)
+			return;
+		WallStruct &r_wall = _wall[cyp_i][wall_i];
+		_integrate(r_wall);
+		if (fabs(r_wall.pos - pos_next) < 1e-6)
+			r_wall.pos = pos_next;
+		_setSwitches(cyp_i, wall_i);
+		_scheduleNext(cyp_i, wall_i); });
+}
+
+/// @brief Set the limit switch inputs of a wall from its position.
+void GateRigSim::_setSwitches(uint8_t cyp_i, uint8_t wall_i)
+{
+	const double eps = 1e-9;
+	WallStruct &r_wall = _wall[cyp_i][wall_i];
+	CypressSim &r_cyp = *_cyp[cyp_i];
+	uint8_t is_up = r_wall.pos >= 1 - Cfg.switchZone - eps;
+	uint8_t is_down = r_wall.pos <= Cfg.switchZone + eps;
+	uint8_t port_up = WMS::ioUp[0][wall_i], pin_up = WMS::ioUp[1][wall_i];
+	uint8_t port_down = WMS::ioDown[0][wall_i], pin_down = WMS::ioDown[1][wall_i];
+
+	// Count closures of the switch the wall is driven towards
+	bool was_up = bitRead(r_cyp.ext[port_up], pin_up);
+	bool was_down = bitRead(r_cyp.ext[port_down], pin_down);
+	nSwitchHits += (is_up && !was_up && r_wall.dirDriven > 0) || (is_down && !was_down && r_wall.dirDriven < 0);
+
+	r_cyp.setInputPin(port_up, pin_up, is_up);
+	r_cyp.setInputPin(port_down, pin_down, is_down);
+}
+
+/// @brief Get the motor duty cycle of a pwm output pin.
+///
+/// @return Duty cycle [0:off, 0-1:pin routed to its pwm source, 1:pin driven high].
+double GateRigSim::_pinDuty(uint8_t cyp_i, uint8_t port, uint8_t pin, uint8_t src)
+{
+	CypressSim &r_cyp = *_cyp[cyp_i];
+	if (bitRead(r_cyp.dir[port], pin) || !bitRead(r_cyp.out[port], pin))
+		return 0;
+	if (!bitRead(r_cyp.selPwm[port], pin))
+		return 1;
+	if (r_cyp.pwmPeri[src] == 0)
+		return 0;
+	double duty = (double)r_cyp.pwmWidth[src] / r_cyp.pwmPeri[src];
+	return duty > 1 ? 1 : duty;
+}
+
+/// @brief Draw a travel time from a truncated normal distribution.
+uint32_t GateRigSim::_drawTravel(const TravelStruct &r_travel)
+{
+	if (r_travel.sdUs == 0)
+		return r_travel.meanUs > r_travel.minUs ? r_travel.meanUs : r_travel.minUs;
+	std::normal_distribution<double> dist(r_travel.meanUs, r_travel.sdUs);
+	double dt = dist(_rng);
+	return dt > r_travel.minUs ? (uint32_t)dt : r_travel.minUs;
+}
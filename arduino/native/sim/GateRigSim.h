@@ -0,0 +1,131 @@
+// ######################################
+
+//=========== GateRigSim.h ============
+
+// ######################################
+
+/// @file Physics model of a gate rig (chips, wall motors and limit switches) for the native build.
+
+#ifndef _GATE_RIG_SIM_h
+#define _GATE_RIG_SIM_h
+
+//============= INCLUDE ================
+#include "CypressSim.h"
+#include <memory>
+#include <random>
+#include <vector>
+
+/// @brief Simulated rig of CY8C9540A chips, each with 8 walls.
+///
+/// @details Each wall has a motor driven by its up and down PWM output pins (see
+/// @ref GateOperation::WallMapStruct). A pin drives its motor while its output register bit is 1
+/// and the pin is an output; a pin routed to a PWM source runs the motor at the source duty cycle
+/// (pulse width / period). Driving both pins or neither brakes the wall.
+///
+/// Wall position runs from 0 (down) to 1 (up). The down and up limit switches close (input bit 1)
+/// within @ref ConfigStruct::switchZone of their end. Travel times, from motor start to the far
+/// switch closing at full duty, are drawn per move from a truncated normal distribution for each
+/// direction. Stuck walls never move.
+///
+/// The I2C bus timing of @ref NativeSim is set from the configuration.
+class GateRigSim
+{
+
+	// --------------VARIABLES--------------
+public:
+	// Travel time distribution of one direction
+	struct TravelStruct
+	{
+		uint32_t meanUs; // mean travel time (us)
+		uint32_t sdUs;	 // standard deviation (us)
+		uint32_t minUs;	 // shortest travel time (us)
+	};
+
+	// Rig configuration
+	struct ConfigStruct
+	{
+		uint8_t nChips = 1;						   // number of chips
+		uint8_t addr0 = CY8C95X0_ADDR;			   // I2C address of the first chip, the others follow
+		TravelStruct travelUp = {600000, 0, 1000};   // wall up travel time
+		TravelStruct travelDown = {500000, 0, 1000}; // wall down travel time
+		double switchZone = 0.02;				   // fraction of travel at each end with the switch closed
+		uint32_t i2cUsPerByte = 90;				   // I2C bus time per byte (us)
+		uint32_t i2cUsPerTrans = 10;			   // I2C bus time per transaction (us)
+		uint32_t seed = 1;						   // random seed for travel times
+	};
+
+	// State of one wall
+	struct WallStruct
+	{
+		double pos = 0;			// position [0:down, 1:up]
+		double speed = 0;		// signed speed (position per us)
+		uint64_t tsUpdate = 0;	// simulated time "pos" was last updated (us)
+		int8_t dirDriven = 0;	// motor drive [-1:down, 0:brake, 1:up]
+		double dutyDriven = 0;	// motor duty cycle [0-1]
+		uint32_t dtTravel = 0;	// travel time of the current move at full duty (us)
+		uint64_t tsStart = 0;	// simulated time the motor last started or reversed (us)
+		bool isStuck = false;	// wall does not move
+		uint32_t gen = 0;		// drive change count, cancels stale switch events
+		uint32_t nMoves = 0;	// moves started
+	};
+
+	ConfigStruct Cfg;
+	uint32_t nSwitchHits = 0; // far switch closures
+
+private:
+	std::vector<std::unique_ptr<CypressSim>> _cyp;
+	std::vector<std::vector<WallStruct>> _wall;
+	std::mt19937 _rng;
+	std::shared_ptr<bool> _isAlive; // cleared on destruction so pending switch events are ignored
+
+	// ---------------METHODS---------------
+public:
+	GateRigSim(const ConfigStruct &);
+
+public:
+	~GateRigSim();
+
+public:
+	uint8_t nChips() { return (uint8_t)_cyp.size(); }
+
+public:
+	CypressSim &chip(uint8_t cyp_i) { return *_cyp[cyp_i]; }
+
+public:
+	WallStruct &wall(uint8_t cyp_i, uint8_t wall_i) { return _wall[cyp_i][wall_i]; }
+
+public:
+	void setStuck(uint8_t, uint8_t, bool = true);
+
+public:
+	void setWallPosition(uint8_t, uint8_t, double);
+
+public:
+	uint8_t getWallsUp(uint8_t);
+
+public:
+	uint8_t getWallsDriven(uint8_t);
+
+private:
+	void _onRegWrite(uint8_t);
+
+private:
+	void _updateWall(uint8_t, uint8_t, bool);
+
+private:
+	void _integrate(WallStruct &);
+
+private:
+	void _scheduleNext(uint8_t, uint8_t);
+
+private:
+	void _setSwitches(uint8_t, uint8_t);
+
+private:
+	double _pinDuty(uint8_t, uint8_t, uint8_t, uint8_t);
+
+private:
+	uint32_t _drawTravel(const TravelStruct &);
+};
+
+#endif
@@ -0,0 +1,121 @@
+// ######################################
+
+//=========== PtyBridge.cpp ===========
+
+// ######################################
+
+//============= INCLUDE ================
+#include "PtyBridge.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+//========CLASS: PtyBridge==========
+
+/// @brief DESTRUCTOR: Close the terminal and remove the link.
+PtyBridge::~PtyBridge()
+{
+	close();
+}
+
+/// @brief Create the pseudo-terminal.
+///
+/// @param p_link Path of a symlink to create to the terminal (e.g. /tmp/gate_emulator) [default: none].
+/// @return Success [false: terminal or link could not be created].
+bool PtyBridge::open(const char *p_link)
+{
+	close();
+	_fdMaster = posix_openpt(O_RDWR | O_NOCTTY);
+	if (_fdMaster < 0 || grantpt(_fdMaster) != 0 || unlockpt(_fdMaster) != 0)
+	{
+		close();
+		return false;
+	}
+	_pathSlave = ptsname(_fdMaster);
+
+	// Keep the terminal side open and raw
+	_fdSlave = ::open(_pathSlave.c_str(), O_RDWR | O_NOCTTY);
+	if (_fdSlave < 0)
+	{
+		close();
+		return false;
+	}
+	struct termios tio;
+	tcgetattr(_fdSlave, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(_fdSlave, TCSANOW, &tio);
+	fcntl(_fdMaster, F_SETFL, fcntl(_fdMaster, F_GETFL) | O_NONBLOCK);
+
+	if (p_link != nullptr)
+	{
+		unlink(p_link);
+		if (symlink(_pathSlave.c_str(), p_link) != 0)
+		{
+			close();
+			return false;
+		}
+		_pathLink = p_link;
+	}
+	return true;
+}
+
+/// @brief Close the terminal and remove the link.
+void PtyBridge::close()
+{
+	if (_fdSlave >= 0)
+		::close(_fdSlave);
+	if (_fdMaster >= 0)
+		::close(_fdMaster);
+	if (!_pathLink.empty())
+		unlink(_pathLink.c_str());
+	_fdSlave = -1;
+	_fdMaster = -1;
+	_pathLink.clear();
+}
+
+/// @brief Move bytes between the terminal and the simulated serial port.
+///
+/// @param r_serial Simulated serial port.
+/// @return Any bytes were moved.
+bool PtyBridge::pump(HardwareSerial &r_serial)
+{
+	if (_fdMaster < 0)
+		return false;
+	bool is_moved = false;
+	uint8_t buff[256];
+
+	// Host to firmware
+	ssize_t n = ::read(_fdMaster, buff, sizeof(buff));
+	if (n > 0)
+	{
+		r_serial.hostWrite(buff, n);
+		nRx += n;
+		is_moved = true;
+	}
+
+	// Firmware to host
+	size_t n_tx;
+	while ((n_tx = r_serial.hostRead(buff, sizeof(buff))) > 0)
+	{
+		ssize_t n_written = ::write(_fdMaster, buff, n_tx);
+		n_written = n_written < 0 ? 0 : n_written;
+		nTx += n_written;
+		nTxDropped += n_tx - n_written;
+		is_moved = true;
+	}
+	return is_moved;
+}
+
+/// @brief Wait for host bytes.
+///
+/// @param timeout_ms Longest wait (ms).
+/// @return Host bytes are waiting.
+bool PtyBridge::waitReadable(int timeout_ms)
+{
+	if (_fdMaster < 0)
+		return false;
+	struct pollfd pfd = {_fdMaster, POLLIN, 0};
+	return poll(&pfd, 1, timeout_ms) > 0 && (pfd.revents & POLLIN);
+}
@@ -0,0 +1,59 @@
+// ######################################
+
+//=========== PtyBridge.h =============
+
+// ######################################
+
+/// @file Exposes a simulated serial port as a Linux pseudo-terminal.
+
+#ifndef _PTY_BRIDGE_h
+#define _PTY_BRIDGE_h
+
+//============= INCLUDE ================
+#include "Arduino.h"
+#include <string>
+
+/// @brief Connects a simulated HardwareSerial port to a pseudo-terminal so host tools can open it like a USB serial port.
+///
+/// @details The terminal is raw (no echo or line editing). A copy of the terminal side stays open
+/// so clients can close and reopen the port. Bytes the firmware sends while no client is reading
+/// are dropped once the terminal buffer is full, as on a real USB serial port.
+class PtyBridge
+{
+
+	// --------------VARIABLES--------------
+public:
+	uint32_t nRx = 0;		 // bytes passed from the host to the firmware
+	uint32_t nTx = 0;		 // bytes passed from the firmware to the host
+	uint32_t nTxDropped = 0; // firmware bytes dropped because the terminal buffer was full
+
+private:
+	int _fdMaster = -1;
+	int _fdSlave = -1;
+	std::string _pathSlave;
+	std::string _pathLink;
+
+	// ---------------METHODS---------------
+public:
+	~PtyBridge();
+
+public:
+	bool open(const char * = nullptr);
+
+public:
+	void close();
+
+public:
+	const char *path() { return _pathSlave.c_str(); }
+
+public:
+	int fd() { return _fdMaster; }
+
+public:
+	bool pump(HardwareSerial &);
+
+public:
+	bool waitReadable(int);
+};
+
+#endif
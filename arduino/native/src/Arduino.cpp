@@ -0,0 +1,78 @@
+// ######################################
+
+//======= Arduino.cpp (native) ========
+
+// ######################################
+
+//============= INCLUDE ================
+#include "Arduino.h"
+#include "NativeSim.h"
+
+//============ FUNCTIONS ===============
+
+unsigned long millis()
+{
+	NativeSim::advance(NativeSim::tickUs);
+	return (unsigned long)(NativeSim::nowUs / 1000);
+}
+
+unsigned long micros()
+{
+	NativeSim::advance(NativeSim::tickUs);
+	return (unsigned long)(uint32_t)NativeSim::nowUs;
+}
+
+void delay(unsigned long ms)
+{
+	NativeSim::advance((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+	NativeSim::advance(us);
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+	if (pin >= NativeSim::nPins)
+		return;
+	NativeSim::pinModeArr[pin] = mode;
+	if (mode == INPUT_PULLUP)
+		NativeSim::pinLevel[pin] = HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t level)
+{
+	NativeSim::writePin(pin, level);
+}
+
+int digitalRead(uint8_t pin)
+{
+	return pin < NativeSim::nPins ? NativeSim::pinLevel[pin] : LOW;
+}
+
+// Interrupt numbers are pin numbers on the native build
+int digitalPinToInterrupt(uint8_t pin)
+{
+	return pin;
+}
+
+void attachInterrupt(uint8_t interrupt, void (*p_isr)(void), int mode)
+{
+	NativeSim::attachIsr(interrupt, p_isr, mode);
+}
+
+void detachInterrupt(uint8_t interrupt)
+{
+	NativeSim::attachIsr(interrupt, nullptr, 0);
+}
+
+void noInterrupts()
+{
+	NativeSim::setInterrupts(false);
+}
+
+void interrupts()
+{
+	NativeSim::setInterrupts(true);
+}
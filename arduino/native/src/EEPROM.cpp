@@ -0,0 +1,11 @@
+// ######################################
+
+//======== EEPROM.cpp (native) ========
+
+// ######################################
+
+//============= INCLUDE ================
+#include "EEPROM.h"
+
+//============ VARIABLES ===============
+EEPROMClass EEPROM;
@@ -0,0 +1,140 @@
+// ######################################
+
+//=== HardwareSerial.cpp (native) =====
+
+// ######################################
+
+//============= INCLUDE ================
+#include "Arduino.h"
+#include "NativeSim.h"
+
+//============ VARIABLES ===============
+HardwareSerial Serial;
+HardwareSerial Serial1;
+
+//========CLASS: HardwareSerial==========
+
+/// @brief Open the port. Byte time is 10 bits at the baud rate.
+void HardwareSerial::begin(unsigned long baud)
+{
+	_isBegun = true;
+	_usPerByte = baud == 0 ? 0 : (uint32_t)((10000000ULL + baud - 1) / baud);
+}
+
+void HardwareSerial::end()
+{
+	_isBegun = false;
+}
+
+int HardwareSerial::available()
+{
+	return (int)_rx.size();
+}
+
+int HardwareSerial::peek()
+{
+	return _rx.empty() ? -1 : _rx.front();
+}
+
+int HardwareSerial::read()
+{
+	if (_rx.empty())
+		return -1;
+	uint8_t b = _rx.front();
+	_rx.pop_front();
+	return b;
+}
+
+/// @brief Queue a byte for transmission, waiting in simulated time while the transmit buffer is full.
+size_t HardwareSerial::write(uint8_t b)
+{
+	while (_txQueued() >= SERIAL_TX_BUFFER_SIZE - 1)
+		NativeSim::advanceTo(_txDone[_tx.size() - _txQueued()]);
+
+	uint64_t ts_start = _tsTxLast > NativeSim::nowUs ? _tsTxLast : NativeSim::nowUs;
+	_tsTxLast = ts_start + _usPerByte;
+	_tx.push_back(b);
+	_txDone.push_back(_tsTxLast);
+	return 1;
+}
+
+int HardwareSerial::availableForWrite()
+{
+	return (int)(SERIAL_TX_BUFFER_SIZE - 1 - _txQueued());
+}
+
+/// @brief Wait in simulated time until the transmit buffer is empty.
+void HardwareSerial::flush()
+{
+	NativeSim::advanceTo(_tsTxLast);
+}
+
+/// @brief Send bytes from the host, arriving one byte time apart after the last host byte.
+///
+/// @param p_data Bytes to send.
+/// @param s Number of bytes.
+void HardwareSerial::hostWrite(const uint8_t p_data[], size_t s)
+{
+	for (size_t i = 0; i < s; i++)
+	{
+		uint64_t ts_start = _tsRxLast > NativeSim::nowUs ? _tsRxLast : NativeSim::nowUs;
+		_tsRxLast = ts_start + _usPerByte;
+		uint8_t b = p_data[i];
+		NativeSim::schedule(_tsRxLast, [this, b]()
+							{
+			if (_rx.size() >= SERIAL_RX_BUFFER_SIZE - 1)
+				nRxDropped++;
+			else
+				_rx.push_back(b); });
+	}
+
+	// Deliver now when there is no byte time
+	if (_usPerByte == 0)
+		NativeSim::advance(0);
+}
+
+/// @brief Read bytes the firmware has finished transmitting.
+///
+/// @param p_data Buffer to fill.
+/// @param s Buffer size.
+/// @return Number of bytes read.
+size_t HardwareSerial::hostRead(uint8_t p_data[], size_t s)
+{
+	size_t n = 0;
+	while (n < s && !_tx.empty() && _txDone.front() <= NativeSim::nowUs)
+	{
+		p_data[n++] = _tx.front();
+		_tx.pop_front();
+		_txDone.pop_front();
+	}
+	return n;
+}
+
+/// @brief Get the number of bytes written by the firmware and not read by the host yet, including bytes still in the transmit buffer.
+///
+/// @return Number of bytes.
+size_t HardwareSerial::hostPending()
+{
+	return _tx.size();
+}
+
+/// @brief Drop all buffered bytes on both sides.
+void HardwareSerial::reset()
+{
+	_rx.clear();
+	_tx.clear();
+	_txDone.clear();
+	_tsTxLast = 0;
+	_tsRxLast = 0;
+	nRxDropped = 0;
+}
+
+/// @brief Get the number of bytes still in the transmit buffer.
+size_t HardwareSerial::_txQueued()
+{
+	// Bytes finish in order, so only the tail can still be queued
+	size_t n = 0;
+	while (n < _txDone.size() && _txDone[_txDone.size() - 1 - n] > NativeSim::nowUs)
+		n++;
+	return n;
+}
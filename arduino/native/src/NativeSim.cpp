@@ -0,0 +1,207 @@
+// ######################################
+
+//=========== NativeSim.cpp ===========
+
+// ######################################
+
+//============= INCLUDE ================
+#include "NativeSim.h"
+#include "Arduino.h"
+
+//============ VARIABLES ===============
+uint64_t NativeSim::nowUs = 0;
+uint32_t NativeSim::tickUs = 1;
+uint32_t NativeSim::i2cUsPerByte = 90;
+uint32_t NativeSim::i2cUsPerTrans = 10;
+uint32_t NativeSim::nI2cTrans = 0;
+uint32_t NativeSim::nI2cBytes = 0;
+uint8_t NativeSim::pinLevel[NativeSim::nPins];
+uint8_t NativeSim::pinModeArr[NativeSim::nPins];
+uint8_t NativeSim::eeprom[NativeSim::eepromSize];
+I2cDevice *NativeSim::i2cDev[128];
+std::function<void(uint8_t, uint8_t)> NativeSim::onPinWrite;
+std::function<void()> NativeSim::onAdvance;
+std::multimap<uint64_t, std::function<void()>> NativeSim::_events;
+void (*NativeSim::_isr[NativeSim::nPins])(void);
+int NativeSim::_isrMode[NativeSim::nPins];
+bool NativeSim::_isInterruptsOn = true;
+bool NativeSim::_isPendingIsr[NativeSim::nPins];
+bool NativeSim::_isRunningEvents = false;
+bool NativeSim::_isInAdvanceHook = false;
+
+//========CLASS: NativeSim==========
+
+/// @brief Reset time, pins, interrupts, the I2C bus and scheduled callbacks. EEPROM is erased to 0xFF.
+///
+/// @note Attached I2C devices are detached but not deleted.
+void NativeSim::reset()
+{
+	nowUs = 0;
+	nI2cTrans = 0;
+	nI2cBytes = 0;
+	_events.clear();
+	_isInterruptsOn = true;
+	_isRunningEvents = false;
+	onPinWrite = nullptr;
+	onAdvance = nullptr;
+	for (uint8_t pin = 0; pin < nPins; pin++)
+	{
+		pinLevel[pin] = LOW;
+		pinModeArr[pin] = INPUT;
+		_isr[pin] = nullptr;
+		_isrMode[pin] = 0;
+		_isPendingIsr[pin] = false;
+	}
+	for (uint8_t addr = 0; addr < 128; addr++)
+		i2cDev[addr] = nullptr;
+	memset(eeprom, 0xFF, eepromSize);
+}
+
+/// @brief Move simulated time forward, running scheduled callbacks as their time passes.
+///
+/// @param dt Time to advance (us).
+void NativeSim::advance(uint64_t dt)
+{
+	advanceTo(nowUs + dt);
+}
+
+/// @brief Move simulated time forward to a given time, running scheduled callbacks as their time passes.
+///
+/// @details Callbacks run at their own timestamp, so time read inside a callback is exact.
+/// Callbacks that use time themselves do not run nested callbacks.
+///
+/// @param ts Time to advance to (us); earlier times are ignored.
+void NativeSim::advanceTo(uint64_t ts)
+{
+	if (ts < nowUs)
+		return;
+	if (_isRunningEvents)
+	{
+		nowUs = ts;
+		return;
+	}
+
+	_isRunningEvents = true;
+	while (!_events.empty() && _events.begin()->first <= ts)
+	{
+		auto it = _events.begin();
+		std::function<void()> fn = it->second;
+		nowUs = it->first > nowUs ? it->first : nowUs;
+		_events.erase(it);
+		fn();
+	}
+	_isRunningEvents = false;
+	nowUs = ts > nowUs ? ts : nowUs;
+
+	if (onAdvance && !_isInAdvanceHook)
+	{
+		_isInAdvanceHook = true;
+		onAdvance();
+		_isInAdvanceHook = false;
+	}
+}
+
+/// @brief Run a callback once simulated time reaches a given time.
+///
+/// @param ts Time to run the callback (us); times in the past run on the next time step.
+/// @param fn Callback.
+void NativeSim::schedule(uint64_t ts, std::function<void()> fn)
+{
+	_events.emplace(ts, fn);
+}
+
+/// @brief Drop all scheduled callbacks.
+void NativeSim::clearSchedule()
+{
+	_events.clear();
+}
+
+/// @brief Get the number of scheduled callbacks not run yet.
+///
+/// @return Number of callbacks.
+size_t NativeSim::nScheduled()
+{
+	return _events.size();
+}
+
+/// @brief Drive a pin from outside the board, running the attached interrupt on a matching edge.
+///
+/// @param pin Pin number.
+/// @param level New level [LOW, HIGH].
+void NativeSim::setPin(uint8_t pin, uint8_t level)
+{
+	if (pin >= nPins)
+		return;
+	uint8_t level_last = pinLevel[pin];
+	pinLevel[pin] = level ? HIGH : LOW;
+	if (_isr[pin] == nullptr || level_last == pinLevel[pin])
+		return;
+	if (_isrMode[pin] == CHANGE ||
+		(_isrMode[pin] == RISING && pinLevel[pin] == HIGH) ||
+		(_isrMode[pin] == FALLING && pinLevel[pin] == LOW))
+		_runIsr(pin);
+}
+
+/// @brief Attach a simulated device to the I2C bus.
+///
+/// @param addr 7-bit I2C address.
+/// @param p_dev Device, or nullptr to detach.
+void NativeSim::attachI2c(uint8_t addr, I2cDevice *p_dev)
+{
+	i2cDev[addr & 0x7F] = p_dev;
+}
+
+/// @brief Set a pin level from the firmware side (digitalWrite()).
+///
+/// @param pin Pin number.
+/// @param level New level [LOW, HIGH].
+void NativeSim::writePin(uint8_t pin, uint8_t level)
+{
+	if (pin >= nPins)
+		return;
+	pinLevel[pin] = level ? HIGH : LOW;
+	if (onPinWrite)
+		onPinWrite(pin, pinLevel[pin]);
+}
+
+/// @brief Attach an interrupt service routine to a pin.
+///
+/// @param pin Pin number.
+/// @param p_isr Routine, or nullptr to detach.
+/// @param mode Trigger [CHANGE, FALLING, RISING].
+void NativeSim::attachIsr(uint8_t pin, void (*p_isr)(void), int mode)
+{
+	if (pin >= nPins)
+		return;
+	_isr[pin] = p_isr;
+	_isrMode[pin] = mode;
+}
+
+/// @brief Enable or disable interrupts, running interrupts that were held while disabled.
+///
+/// @param is_on Interrupts enabled.
+void NativeSim::setInterrupts(bool is_on)
+{
+	_isInterruptsOn = is_on;
+	if (!is_on)
+		return;
+	for (uint8_t pin = 0; pin < nPins; pin++)
+		if (_isPendingIsr[pin])
+			_runIsr(pin);
+}
+
+/// @brief Run the interrupt of a pin now, or hold it until interrupts are enabled.
+///
+/// @param pin Pin number.
+void NativeSim::_runIsr(uint8_t pin)
+{
+	if (!_isInterruptsOn)
+	{
+		_isPendingIsr[pin] = true;
+		return;
+	}
+	_isPendingIsr[pin] = false;
+	_isInterruptsOn = false;
+	_isr[pin]();
+	_isInterruptsOn = true;
+}
@@ -0,0 +1,64 @@
+// ######################################
+
+//========= Wire.cpp (native) =========
+
+// ######################################
+
+//============= INCLUDE ================
+#include "Wire.h"
+#include "NativeSim.h"
+
+//============ VARIABLES ===============
+TwoWire Wire;
+
+//========CLASS: TwoWire==========
+
+void TwoWire::beginTransmission(uint8_t addr)
+{
+	_txAddr = addr & 0x7F;
+	_txLen = 0;
+	_isTxOverflow = false;
+}
+
+size_t TwoWire::write(uint8_t b)
+{
+	if (_txLen >= BUFFER_LENGTH)
+	{
+		_isTxOverflow = true;
+		return 0;
+	}
+	_txBuff[_txLen++] = b;
+	return 1;
+}
+
+uint8_t TwoWire::endTransmission(uint8_t send_stop)
+{
+	if (_isTxOverflow)
+		return 1;
+
+	// Address byte is always clocked out, data bytes only if the address is acknowledged
+	I2cDevice *p_dev = NativeSim::i2cDev[_txAddr];
+	uint8_t status = p_dev == nullptr ? 2 : p_dev->i2cWrite(_txBuff, _txLen, send_stop);
+	uint8_t n_data = status == 2 ? 0 : _txLen;
+	NativeSim::nI2cTrans++;
+	NativeSim::nI2cBytes += n_data;
+	NativeSim::advance(NativeSim::i2cUsPerTrans + (uint64_t)NativeSim::i2cUsPerByte * (1 + n_data));
+	_txLen = 0;
+	return status;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t addr, uint8_t s, uint8_t)
+{
+	_rxLen = 0;
+	_rxInd = 0;
+	s = s > BUFFER_LENGTH ? BUFFER_LENGTH : s;
+
+	I2cDevice *p_dev = NativeSim::i2cDev[addr & 0x7F];
+	if (p_dev != nullptr && s > 0)
+		_rxLen = p_dev->i2cRead(_rxBuff, s);
+	_rxLen = _rxLen > s ? s : _rxLen;
+	NativeSim::nI2cTrans++;
+	NativeSim::nI2cBytes += _rxLen;
+	NativeSim::advance(NativeSim::i2cUsPerTrans + (uint64_t)NativeSim::i2cUsPerByte * (1 + _rxLen));
+	return _rxLen;
+}
@@ -0,0 +1,53 @@
+// ######################################
+
+//============ NativeTest.h ===========
+
+// ######################################
+
+/// @file Minimal check macros for the native tests, each test is one executable run by ctest.
+
+#ifndef _NATIVE_TEST_h
+#define _NATIVE_TEST_h
+
+//============= INCLUDE ================
+#include <stdio.h>
+
+static int nativeTestFails = 0;
+
+/// @brief Record a failure if "cond" is false.
+#define CHECK(cond)                                                           \
+	do                                                                        \
+	{                                                                         \
+		if (!(cond))                                                          \
+		{                                                                     \
+			printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond);   \
+			nativeTestFails++;                                                \
+		}                                                                     \
+	} while (0)
+
+/// @brief Record a failure if "a" != "b", printing both values as integers.
+#define CHECK_EQ(a, b)                                                                    \
+	do                                                                                    \
+	{                                                                                     \
+		long long _a = (long long)(a);                                                    \
+		long long _b = (long long)(b);                                                    \
+		if (_a != _b)                                                                     \
+		{                                                                                 \
+			printf("%s:%d: CHECK_EQ failed: %s == %s (%lld != %lld)\n", __FILE__, __LINE__, \
+				   #a, #b, _a, _b);                                                       \
+			nativeTestFails++;                                                            \
+		}                                                                                 \
+	} while (0)
+
+/// @brief Run a test function and print its name.
+#define RUN_TEST(fn)            \
+	do                          \
+	{                           \
+		printf("[ RUN ] %s\n", #fn); \
+		fn();                   \
+	} while (0)
+
+/// @brief Exit code of the test executable.
+#define TEST_RESULT() (nativeTestFails == 0 ? (printf("[ PASS ]\n"), 0) : (printf("[ FAIL ] %d checks\n", nativeTestFails), 1))
+
+#endif
@@ -0,0 +1,122 @@
+// Native build: CypressCom against the simulated CY8C9540A
+
+#include "Arduino.h"
+#include "CypressCom.h"
+#include "CypressSim.h"
+#include "NativeTest.h"
+
+bool DB_VERBOSE = 0;
+
+void testScan()
+{
+	NativeSim::reset();
+	CypressSim cyp_a(0x20);
+	CypressSim cyp_b(0x23);
+	CypressCom cyp_com;
+	cyp_com.i2cInit();
+	cyp_com.i2cScan();
+	CHECK_EQ(cyp_com.nAddr, 2);
+	CHECK_EQ(cyp_com.listAddr[0], 0x20);
+	CHECK_EQ(cyp_com.listAddr[1], 0x23);
+	CHECK_EQ(cyp_a.nWrites, 1);
+}
+
+void testRegisters()
+{
+	NativeSim::reset();
+	CypressSim cyp(0x20);
+	CypressCom cyp_com;
+	cyp.out[2] = 0x00;
+	CHECK_EQ(cyp_com.setupCypress(0x20), 0);
+	CHECK_EQ(cyp.out[2], 0xFF); // restored
+	CHECK_EQ(cyp.nCommands, 2);
+
+	// Port-select indexed registers
+	CHECK_EQ(cyp_com.setPortRegister(0x20, REG_PIN_DIR, 3, 0x0F, 1), 0);
+	CHECK_EQ(cyp.dir[3], 0x0F);
+	CHECK_EQ(cyp_com.setPortRegister(0x20, DRIVE_PULLDOWN, 3, 0x0F, 1), 0);
+	CHECK_EQ(cyp.drive[DRIVE_PULLDOWN - DRIVE_PULLUP][3], 0x0F);
+	CHECK_EQ(cyp.drive[0][3], 0xF0);
+
+	// PWM-select indexed registers
+	CHECK_EQ(cyp_com.setupSourcePWM(0x20, 5, 255), 0);
+	CHECK_EQ(cyp.pwmPeri[5], cyp_com.pwmPeriodVal);
+	CHECK_EQ(cyp.pwmWidth[5], cyp_com.pwmPeriodVal);
+
+	// Auto-increment across the output ports
+	uint8_t mask[6] = {0xFF, 0, 0, 0x0F, 0, 0};
+	CHECK_EQ(cyp_com.ioWriteReg(0x20, mask, 6, 0), 0);
+	CHECK_EQ(cyp.out[0], 0x00);
+	CHECK_EQ(cyp.out[1], 0xFF);
+	CHECK_EQ(cyp.out[3], 0xF0);
+
+	// Inputs read external levels for input pins and the output register otherwise
+	cyp.setInput(3, 0x05);
+	uint8_t io_all[14];
+	CHECK_EQ(cyp_com.ioReadReg(0x20, REG_GI0, io_all, 14), 0);
+	CHECK_EQ(io_all[3], 0xF5);
+	CHECK_EQ(io_all[8], 0x00);
+	CHECK_EQ(io_all[9], 0xFF);
+	uint8_t bit_val;
+	CHECK_EQ(cyp_com.ioReadPin(0x20, 3, 2, bit_val), 0);
+	CHECK_EQ(bit_val, 1);
+	CHECK_EQ(cyp.peekReg(REG_DEV_STATUS), CypressSim::devId);
+}
+
+void testFaults()
+{
+	NativeSim::reset();
+	CypressSim cyp(0x20);
+	CypressCom cyp_com;
+	uint8_t byte_val;
+
+	cyp.failNext = 1;
+	cyp.failStatus = 3;
+	CHECK_EQ(cyp_com.i2cWrite(0x20, REG_GO0, 0x12), 3);
+	CHECK_EQ(cyp_com.i2cWrite(0x20, REG_GO0, 0x12), 0);
+
+	// Failed register pointer write, then a read with no data (short read)
+	cyp.failNext = 1;
+	CHECK_EQ(cyp_com.i2cRead(0x20, REG_GO0, &byte_val, 1), 3);
+	cyp.failNextRead = 1;
+	CHECK_EQ(cyp_com.i2cRead(0x20, REG_GO0, &byte_val, 1), 1);
+	CHECK_EQ(cyp_com.i2cRead(0x20, REG_GO0, &byte_val, 1), 0);
+	CHECK_EQ(byte_val, 0x12);
+
+	// Missing device
+	cyp.isPresent = false;
+	CHECK_EQ(cyp_com.i2cWrite(0x20, REG_GO0, 0x12), 2);
+	CHECK_EQ(cyp_com.i2cWrite(0x21, REG_GO0, 0x12), 2);
+}
+
+void testOnWriteAndTiming()
+{
+	NativeSim::reset();
+	CypressSim cyp(0x20);
+	CypressCom cyp_com;
+	int n_go = 0;
+	cyp.onWrite = [&](CypressSim &, uint8_t reg, uint8_t)
+	{ n_go += reg >= REG_GO0 && reg <= REG_GO5; };
+	uint8_t mask[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+	cyp_com.ioWriteReg(0x20, mask, 6, 0);
+	CHECK_EQ(n_go, 6);
+
+	// Bus time: start/stop plus address and data bytes
+	uint64_t ts_start = NativeSim::nowUs;
+	uint32_t n_trans = NativeSim::nI2cTrans;
+	uint8_t io_all[14];
+	cyp_com.ioReadReg(0x20, REG_GI0, io_all, 14);
+	CHECK_EQ(NativeSim::nI2cTrans - n_trans, 2);
+	uint64_t dt_bus = 2 * NativeSim::i2cUsPerTrans + NativeSim::i2cUsPerByte * (2 + 15);
+	CHECK(NativeSim::nowUs - ts_start >= dt_bus);
+	CHECK(NativeSim::nowUs - ts_start < dt_bus + 50);
+}
+
+int main()
+{
+	RUN_TEST(testScan);
+	RUN_TEST(testRegisters);
+	RUN_TEST(testFaults);
+	RUN_TEST(testOnWriteAndTiming);
+	return TEST_RESULT();
+}
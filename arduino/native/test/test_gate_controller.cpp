@@ -0,0 +1,253 @@
+// Native build: cypress_gate_controller message handlers driven through the simulated serial port on the physics rig
+
+#include "Arduino.h"
+#include "GateOperation.h"
+#include "GateRigSim.h"
+#include "NativeTest.h"
+#include <vector>
+
+// Firmware entry points and wall operation instance from main.cpp
+void setup();
+void loop();
+extern GateOperation WallOper;
+extern uint8_t triggerPin;
+
+// Device bytes read so far and not yet decoded
+static std::vector<uint8_t> rxBytes;
+
+// Send a host frame [start, type, len, data, checksum, end]
+static void hostSend(uint8_t msg_type, const std::vector<uint8_t> &r_data)
+{
+	std::vector<uint8_t> frame = {0x02, msg_type, (uint8_t)r_data.size()};
+	uint8_t sum = 0;
+	for (uint8_t b : r_data)
+	{
+		frame.push_back(b);
+		sum += b;
+	}
+	frame.push_back(sum);
+	frame.push_back(0x03);
+	Serial.hostWrite(frame.data(), frame.size());
+}
+
+// Decode the next device frame [start, type, len, data, ts(4), checksum, end], false if none is complete
+static bool nextFrame(uint8_t &r_type, std::vector<uint8_t> &r_data)
+{
+	while (!rxBytes.empty() && rxBytes[0] != 0x02)
+		rxBytes.erase(rxBytes.begin());
+	if (rxBytes.size() < 3 || rxBytes.size() < (size_t)rxBytes[2] + 9)
+		return false;
+	r_type = rxBytes[1];
+	r_data.assign(rxBytes.begin() + 3, rxBytes.begin() + 3 + rxBytes[2]);
+	rxBytes.erase(rxBytes.begin(), rxBytes.begin() + rxBytes[2] + 9);
+	return true;
+}
+
+// Run loop() until a reply of this type, skipping log frames
+static bool waitReply(uint8_t msg_type, std::vector<uint8_t> &r_reply)
+{
+	for (int loop_i = 0; loop_i < 1000; loop_i++)
+	{
+		loop();
+		NativeSim::advance(1000);
+		uint8_t buff[256];
+		size_t n;
+		while ((n = Serial.hostRead(buff, sizeof(buff))) > 0)
+			rxBytes.insert(rxBytes.end(), buff, buff + n);
+		uint8_t type;
+		while (nextFrame(type, r_reply))
+			if (type == msg_type)
+				return true;
+	}
+	return false;
+}
+
+// Send a message and run loop() until its reply
+static bool request(uint8_t msg_type, const std::vector<uint8_t> &r_data, std::vector<uint8_t> &r_reply)
+{
+	hostSend(msg_type, r_data);
+	return waitReply(msg_type, r_reply);
+}
+
+// Reset the simulator, build a rig and run the firmware setup and chip initialization
+static void startController(GateRigSim &r_rig)
+{
+	Serial.reset();
+	rxBytes.clear();
+	setup();
+	std::vector<uint8_t> reply;
+	CHECK(request(0, {}, reply));
+	CHECK_EQ(reply.size(), r_rig.nChips());
+}
+
+void testArmThenCompactMove()
+{
+	NativeSim::reset();
+	GateRigSim::ConfigStruct cfg;
+	cfg.nChips = 3;
+	GateRigSim rig(cfg);
+	startController(rig);
+
+	// Arm chips 0 and 1, then a compact move of chip 2 moves only chip 2 and disarms
+	std::vector<uint8_t> reply;
+	CHECK(request(6, {0x03, 0x0F, 0xF0}, reply));
+	CHECK(reply == std::vector<uint8_t>({1}));
+	CHECK(WallOper.isArmed);
+	CHECK(request(3, {0x04, 0x81}, reply));
+	CHECK(reply == std::vector<uint8_t>({0x04, 0x81}));
+	CHECK_EQ(rig.getWallsUp(0), 0x00);
+	CHECK_EQ(rig.getWallsUp(1), 0x00);
+	CHECK_EQ(rig.getWallsUp(2), 0x81);
+	CHECK(!WallOper.isArmed);
+
+	// Same after arming from a stored configuration
+	CHECK(request(4, {0, 0xFF, 0xFF, 0xFF}, reply));
+	CHECK(reply == std::vector<uint8_t>({0, 0}));
+	CHECK(request(5, {0, 1}, reply));
+	CHECK(reply == std::vector<uint8_t>({1}));
+	CHECK(request(3, {0x01, 0x3C}, reply));
+	CHECK(reply == std::vector<uint8_t>({0x01, 0x3C}));
+	CHECK_EQ(rig.getWallsUp(0), 0x3C);
+	CHECK_EQ(rig.getWallsUp(1), 0x00);
+	CHECK_EQ(rig.getWallsUp(2), 0x81);
+
+	// A full move of fewer chips than the rig leaves the others where they are
+	CHECK(request(6, {0x04, 0x00}, reply));
+	CHECK(request(2, {0x3C, 0x01}, reply));
+	CHECK(reply == std::vector<uint8_t>({0x3C, 0x01, 0x81}));
+	CHECK_EQ(rig.getWallsUp(2), 0x81);
+}
+
+void testFailedArm()
+{
+	NativeSim::reset();
+	GateRigSim::ConfigStruct cfg;
+	cfg.nChips = 3;
+	GateRigSim rig(cfg);
+	startController(rig);
+
+	// An I2C error on chip 1 fails the arm and clears the flags of chip 0 too
+	std::vector<uint8_t> reply;
+	rig.chip(1).failNext = 1;
+	CHECK(request(6, {0x03, 0x0F, 0xF0}, reply));
+	CHECK(reply == std::vector<uint8_t>({2}));
+	CHECK(!WallOper.isArmed);
+	for (uint8_t cyp_i = 0; cyp_i < 3; cyp_i++)
+		CHECK_EQ(WallOper.C[cyp_i].bitWallMoveUpFlag | WallOper.C[cyp_i].bitWallMoveDownFlag, 0);
+	CHECK(request(3, {0x04, 0x18}, reply));
+	CHECK(reply == std::vector<uint8_t>({0x04, 0x18}));
+	CHECK_EQ(rig.getWallsUp(0), 0x00);
+	CHECK_EQ(rig.getWallsUp(1), 0x00);
+	CHECK_EQ(rig.getWallsUp(2), 0x18);
+
+	// Compact moves and arms with a bad length are answered with an error and keep the armed move
+	CHECK(request(6, {0x01, 0x0F}, reply));
+	CHECK(reply == std::vector<uint8_t>({1}));
+	CHECK(request(6, {0x01}, reply));
+	CHECK(reply == std::vector<uint8_t>({0xFF}));
+	CHECK(WallOper.isArmed);
+	CHECK(request(3, {0x02}, reply));
+	CHECK(reply == std::vector<uint8_t>({0xFF}));
+	CHECK(request(3, {0x02, 0x42, 0x01}, reply));
+	CHECK(reply == std::vector<uint8_t>({0xFF}));
+	CHECK(request(3, {}, reply));
+	CHECK(reply == std::vector<uint8_t>({0xFF}));
+	CHECK(WallOper.isArmed);
+	CHECK_EQ(WallOper.C[0].bitWallMoveUpFlag, 0x0F);
+	CHECK_EQ(rig.getWallsUp(1), 0x00);
+	CHECK(request(7, {}, reply));
+	CHECK_EQ(reply[0], 1);
+	CHECK_EQ(rig.getWallsUp(0), 0x0F);
+	CHECK_EQ(rig.getWallsUp(2), 0x18);
+}
+
+void testGo()
+{
+	NativeSim::reset();
+	GateRigSim::ConfigStruct cfg;
+	cfg.nChips = 2;
+	GateRigSim rig(cfg);
+	startController(rig);
+
+	// GO with nothing armed says so instead of looking like a move that changed nothing
+	std::vector<uint8_t> reply;
+	CHECK(request(7, {}, reply));
+	CHECK(reply == std::vector<uint8_t>({0, 0, 0, 0, 0, 0x00}));
+
+	// Armed move started by the unframed GO byte: status, latency, then the changed walls
+	CHECK(request(6, {0x02, 0x24}, reply));
+	CHECK(reply == std::vector<uint8_t>({1}));
+	uint8_t go_byte = 0x07;
+	Serial.hostWrite(&go_byte, 1);
+	CHECK(waitReply(7, reply));
+	CHECK_EQ(reply.size(), 5 + 1 + 1);
+	CHECK_EQ(reply[0], 1);
+	CHECK_EQ(reply[5], 0x02);
+	CHECK_EQ(reply[6], 0x24);
+	CHECK_EQ(rig.getWallsUp(1), 0x24);
+
+	// A compact move after arming disarms, the following GO reports it
+	CHECK(request(6, {0x01, 0x11}, reply));
+	CHECK(request(3, {0x02, 0x00}, reply));
+	CHECK(request(7, {}, reply));
+	CHECK_EQ(reply.size(), 6);
+	CHECK_EQ(reply[0], 0);
+	CHECK_EQ(rig.getWallsUp(0), 0x00);
+}
+
+void testTriggerBeforeArm()
+{
+	NativeSim::reset();
+	GateRigSim::ConfigStruct cfg;
+	cfg.nChips = 2;
+	GateRigSim rig(cfg);
+	triggerPin = 2;
+	startController(rig);
+
+	// A trigger edge that comes in after the arm message, before loop() reads it, does not start the new move
+	std::vector<uint8_t> reply;
+	hostSend(6, {0x01, 0x0F});
+	NativeSim::advance(1000);
+	NativeSim::setPin(triggerPin, HIGH);
+	CHECK(waitReply(6, reply));
+	CHECK(reply == std::vector<uint8_t>({1}));
+	for (int loop_i = 0; loop_i < 10; loop_i++)
+		loop();
+	CHECK(WallOper.isArmed);
+	CHECK_EQ(rig.getWallsUp(0), 0x00);
+
+	// The next edge does
+	NativeSim::setPin(triggerPin, LOW);
+	NativeSim::setPin(triggerPin, HIGH);
+	CHECK(waitReply(7, reply));
+	CHECK_EQ(reply[0], 1);
+	CHECK_EQ(rig.getWallsUp(0), 0x0F);
+	CHECK(!WallOper.isArmed);
+
+	// Same when arming a stored configuration
+	CHECK(request(4, {0, 0x0F, 0x30}, reply));
+	NativeSim::setPin(triggerPin, LOW);
+	hostSend(5, {0, 1});
+	NativeSim::advance(1000);
+	NativeSim::setPin(triggerPin, HIGH);
+	CHECK(waitReply(5, reply));
+	CHECK(reply == std::vector<uint8_t>({1}));
+	for (int loop_i = 0; loop_i < 10; loop_i++)
+		loop();
+	CHECK(WallOper.isArmed);
+	CHECK_EQ(rig.getWallsUp(1), 0x00);
+	NativeSim::setPin(triggerPin, LOW);
+	NativeSim::setPin(triggerPin, HIGH);
+	CHECK(waitReply(7, reply));
+	CHECK_EQ(rig.getWallsUp(1), 0x30);
+	triggerPin = 255;
+}
+
+int main()
+{
+	RUN_TEST(testArmThenCompactMove);
+	RUN_TEST(testFailedArm);
+	RUN_TEST(testGo);
+	RUN_TEST(testTriggerBeforeArm);
+	return TEST_RESULT();
+}
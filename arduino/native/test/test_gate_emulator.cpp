@@ -0,0 +1,155 @@
+// Native build: gate_emulator run as a child process, its serial port on a pseudo-terminal and the --timeline file
+
+#include "NativeTest.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+
+// Start gate_emulator (path from GATE_EMULATOR_PATH) and wait for its link, 0 if it did not start
+static pid_t startEmulator(std::vector<std::string> args, const std::string &r_link)
+{
+	unlink(r_link.c_str());
+	args.insert(args.begin(), GATE_EMULATOR_PATH);
+	args.push_back("--link");
+	args.push_back(r_link);
+	pid_t pid = fork();
+	if (pid == 0)
+	{
+		int fd_null = open("/dev/null", O_WRONLY);
+		dup2(fd_null, STDOUT_FILENO);
+		std::vector<char *> argv;
+		for (std::string &r_arg : args)
+			argv.push_back(&r_arg[0]);
+		argv.push_back(nullptr);
+		execv(argv[0], argv.data());
+		_exit(127);
+	}
+	for (int wait_i = 0; wait_i < 500; wait_i++)
+	{
+		struct stat st;
+		if (stat(r_link.c_str(), &st) == 0)
+			return pid;
+		usleep(10000);
+	}
+	kill(pid, SIGTERM);
+	waitpid(pid, nullptr, 0);
+	return 0;
+}
+
+// Open the emulator serial port in raw mode
+static int openPort(const std::string &r_link)
+{
+	int fd = open(r_link.c_str(), O_RDWR | O_NOCTTY);
+	if (fd < 0)
+		return -1;
+	struct termios tio;
+	tcgetattr(fd, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(fd, TCSANOW, &tio);
+	return fd;
+}
+
+// Send a host frame and wait for the device frame of the same type, skipping log frames
+static bool request(int fd, uint8_t msg_type, const std::vector<uint8_t> &r_data, std::vector<uint8_t> &r_reply)
+{
+	std::vector<uint8_t> frame = {0x02, msg_type, (uint8_t)r_data.size()};
+	uint8_t sum = 0;
+	for (uint8_t b : r_data)
+	{
+		frame.push_back(b);
+		sum += b;
+	}
+	frame.push_back(sum);
+	frame.push_back(0x03);
+	if (write(fd, frame.data(), frame.size()) != (ssize_t)frame.size())
+		return false;
+
+	// Device frames are [start, type, len, data, ts(4), checksum, end]
+	std::vector<uint8_t> rx;
+	struct pollfd pfd = {fd, POLLIN, 0};
+	while (poll(&pfd, 1, 20000) > 0)
+	{
+		uint8_t buff[256];
+		ssize_t n = read(fd, buff, sizeof(buff));
+		if (n <= 0)
+			return false;
+		rx.insert(rx.end(), buff, buff + n);
+		while (!rx.empty() && rx[0] != 0x02)
+			rx.erase(rx.begin());
+		while (rx.size() >= 3 && rx.size() >= (size_t)rx[2] + 9)
+		{
+			uint8_t type = rx[1];
+			r_reply.assign(rx.begin() + 3, rx.begin() + 3 + rx[2]);
+			rx.erase(rx.begin(), rx.begin() + r_reply.size() + 9);
+			if (type == msg_type)
+				return true;
+		}
+	}
+	return false;
+}
+
+void testTimelineFile()
+{
+	std::string path = "/tmp/gate_native_test_" + std::to_string(getpid()) + "_timeline.bin";
+	std::string link = "/tmp/gate_native_test_" + std::to_string(getpid()) + "_emulator";
+	pid_t pid = startEmulator({"--fast", "--chips", "3", "--timeline", path}, link);
+	CHECK(pid > 0);
+	if (pid <= 0)
+		return;
+	int fd = openPort(link);
+	CHECK(fd >= 0);
+	std::vector<uint8_t> reply;
+	CHECK(request(fd, 0, {}, reply));
+	CHECK(request(fd, 2, {0x0F, 0xF0, 0x81}, reply));
+	CHECK(reply == std::vector<uint8_t>({0x0F, 0xF0, 0x81}));
+
+	// The firmware timeline is still there for message type 15
+	CHECK(request(fd, 15, {}, reply));
+	CHECK(reply.size() > 3 && reply[2] > 0);
+	close(fd);
+	kill(pid, SIGTERM);
+	waitpid(pid, nullptr, 0);
+
+	// Span records [ts(4), kind << 6 | span, arg] as read by gui/gate_timeline.py, a whole move even past the firmware ring size
+	FILE *p_file = fopen(path.c_str(), "rb");
+	CHECK(p_file != nullptr);
+	if (p_file == nullptr)
+		return;
+	std::vector<uint8_t> raw(1 << 20);
+	raw.resize(fread(raw.data(), 1, raw.size(), p_file));
+	fclose(p_file);
+	unlink(path.c_str());
+	CHECK_EQ(raw.size() % 6, 0);
+	CHECK(raw.size() / 6 > 96);
+	uint32_t n_move[2] = {0, 0}, n_travel[2] = {0, 0};
+	uint32_t ts_last = 0;
+	for (size_t pos = 0; pos + 6 <= raw.size(); pos += 6)
+	{
+		uint32_t ts = raw[pos] | (raw[pos + 1] << 8) | (raw[pos + 2] << 16) | ((uint32_t)raw[pos + 3] << 24);
+		uint8_t kind = raw[pos + 4] >> 6, span = raw[pos + 4] & 0x3F;
+		CHECK(ts > ts_last);
+		ts_last = ts;
+		if (span == 0)
+			n_move[kind]++;
+		if (span == 4)
+			n_travel[kind]++;
+	}
+	CHECK_EQ(n_move[0], 1);
+	CHECK_EQ(n_move[1], 1);
+	CHECK_EQ(n_travel[0], 10);
+	CHECK_EQ(n_travel[1], 10);
+}
+
+int main()
+{
+	signal(SIGPIPE, SIG_IGN);
+	RUN_TEST(testTimelineFile);
+	return TEST_RESULT();
+}
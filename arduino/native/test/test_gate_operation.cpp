@@ -0,0 +1,181 @@
+// Native build: GateOperation setup and moves against simulated chips with a simple wall rig
+
+#include "Arduino.h"
+#include "GateOperation.h"
+#include "CypressSim.h"
+#include "NativeTest.h"
+
+bool DB_VERBOSE = 0;
+
+typedef GateOperation::WallMapStruct WMS;
+
+/// @brief Walls that reach their limit switch a fixed time after their pwm pin is driven.
+struct WallRig
+{
+	CypressSim &r_cyp;
+	uint32_t dtTravel;				  // wall travel time (us)
+	uint8_t bitStuck = 0;			  // walls that never reach a switch
+	uint8_t dirDriven[8];			  // current drive direction [0:down, 1:up, 255:none]
+	uint32_t genMove[8] = {0};		  // drive change count, cancels stale switch events
+
+	WallRig(CypressSim &_r_cyp, uint32_t _dtTravel) : r_cyp(_r_cyp), dtTravel(_dtTravel)
+	{
+		memset(dirDriven, 255, sizeof(dirDriven));
+		r_cyp.onWrite = [this](CypressSim &, uint8_t reg, uint8_t)
+		{
+			if (reg >= REG_GO0 && reg <= REG_GO5)
+				update();
+		};
+	}
+
+	void update()
+	{
+		for (uint8_t wall_i = 0; wall_i < 8; wall_i++)
+		{
+			uint8_t is_up = r_cyp.getOutputPin(WMS::pwmUp[0][wall_i], WMS::pwmUp[1][wall_i]);
+			uint8_t is_down = r_cyp.getOutputPin(WMS::pwmDown[0][wall_i], WMS::pwmDown[1][wall_i]);
+			uint8_t dir = is_up == is_down ? 255 : is_up;
+			if (dir == dirDriven[wall_i])
+				continue;
+			dirDriven[wall_i] = dir;
+			uint32_t gen = ++genMove[wall_i];
+			if (dir == 255 || bitRead(bitStuck, wall_i))
+				continue;
+
+			// Leave the current switch now and reach the other one after the travel time
+			r_cyp.setInputPin(WMS::ioUp[0][wall_i], WMS::ioUp[1][wall_i], 0);
+			r_cyp.setInputPin(WMS::ioDown[0][wall_i], WMS::ioDown[1][wall_i], 0);
+			NativeSim::schedule(NativeSim::nowUs + dtTravel, [this, wall_i, dir, gen]()
+								{
+				if (genMove[wall_i] != gen)
+					return;
+				if (dir == 1)
+					r_cyp.setInputPin(WMS::ioUp[0][wall_i], WMS::ioUp[1][wall_i], 1);
+				else
+					r_cyp.setInputPin(WMS::ioDown[0][wall_i], WMS::ioDown[1][wall_i], 1); });
+		}
+	}
+};
+
+static GateOperation WallOper(255, 500);
+
+void testInit()
+{
+	NativeSim::reset();
+	CypressSim cyp_a(0x20);
+	CypressSim cyp_b(0x21);
+	WallOper.CypCom.i2cScan();
+	CHECK_EQ(WallOper.CypCom.nAddr, 2);
+	WallOper.initGateOperation();
+	CHECK_EQ(WallOper.initCypress(), 0);
+
+	// Switch pins are inputs with pull-down drive, pwm pins are strong outputs starting off
+	for (uint8_t wall_i = 0; wall_i < 8; wall_i++)
+	{
+		uint8_t port = WMS::ioUp[0][wall_i];
+		CHECK(bitRead(cyp_a.dir[port], WMS::ioUp[1][wall_i]));
+		CHECK(bitRead(cyp_a.drive[DRIVE_PULLDOWN - DRIVE_PULLUP][port], WMS::ioUp[1][wall_i]));
+		port = WMS::pwmDown[0][wall_i];
+		CHECK(!bitRead(cyp_b.dir[port], WMS::pwmDown[1][wall_i]));
+		CHECK(bitRead(cyp_b.selPwm[port], WMS::pwmDown[1][wall_i]));
+		CHECK(bitRead(cyp_b.drive[DRIVE_STRONG - DRIVE_PULLUP][port], WMS::pwmDown[1][wall_i]));
+		CHECK_EQ(cyp_b.getOutputPin(port, WMS::pwmDown[1][wall_i]), 0);
+	}
+}
+
+void testMove()
+{
+	NativeSim::reset();
+	CypressSim cyp_a(0x20);
+	CypressSim cyp_b(0x21);
+	WallRig rig_a(cyp_a, 150000);
+	WallRig rig_b(cyp_b, 150000);
+	WallOper.CypCom.i2cScan();
+	WallOper.initGateOperation();
+	WallOper.initCypress();
+
+	// Raise some walls on both chips
+	WallOper.setWallsToMove(0, 0x0F);
+	WallOper.setWallsToMove(1, 0x81);
+	uint64_t ts_start = NativeSim::nowUs;
+	CHECK_EQ(WallOper.moveWallsConductor(), 1);
+	uint64_t dt_move = NativeSim::nowUs - ts_start;
+	CHECK(dt_move >= 150000 && dt_move < 170000);
+	CHECK_EQ(WallOper.C[0].bitWallPosition, 0x0F);
+	CHECK_EQ(WallOper.C[1].bitWallPosition, 0x81);
+	CHECK_EQ(WallOper.C[0].bitWallErrorFlag, 0);
+
+	// All pwm output is off after the move
+	for (uint8_t prt_i = 0; prt_i < 6; prt_i++)
+		CHECK_EQ(cyp_a.out[prt_i] & WallOper.pmsAllPWM.byteMaskAll[prt_i], 0);
+
+	// Lower one wall
+	WallOper.setWallsToMove(0, 0x0E);
+	CHECK_EQ(WallOper.moveWallsConductor(), 1);
+	CHECK_EQ(WallOper.C[0].bitWallPosition, 0x0E);
+	CHECK_EQ(rig_a.dirDriven[0], 255);
+}
+
+void testStuckWall()
+{
+	NativeSim::reset();
+	CypressSim cyp(0x20);
+	WallRig rig(cyp, 100000);
+	rig.bitStuck = 0x20;
+	WallOper.CypCom.i2cScan();
+	WallOper.initGateOperation();
+	WallOper.initCypress();
+
+	WallOper.setWallsToMove(0, 0x21);
+	uint64_t ts_start = NativeSim::nowUs;
+	CHECK_EQ(WallOper.moveWallsConductor(), 3);
+	CHECK(NativeSim::nowUs - ts_start >= 500000);
+	CHECK_EQ(WallOper.C[0].bitWallPosition, 0x01);
+	CHECK_EQ(WallOper.C[0].bitWallErrorFlag & 0x20, 0x20);
+
+	// Pwm of the stuck wall is cut after the timeout
+	CHECK_EQ(rig.dirDriven[5], 255);
+}
+
+void testConfigTable()
+{
+	NativeSim::reset();
+	CypressSim cyp_a(0x20);
+	CypressSim cyp_b(0x21);
+	WallOper.CypCom.i2cScan();
+	WallOper.initGateOperation();
+
+	// A never written table reads as empty
+	CHECK_EQ(WallOper.setWallsToConfig(0), 2);
+
+	// Entries have a fixed size, independent of CYP_MAX_ADDR, after the layout version byte
+	uint8_t cfg_arr[2] = {0x0F, 0x81};
+	CHECK_EQ(WallOper.storeWallConfig(1, cfg_arr, 2), 0);
+	uint16_t addr = GateOperation::eepromConfigAddr;
+	CHECK_EQ(NativeSim::eeprom[addr], GateOperation::eepromConfigVersion);
+	CHECK_EQ(NativeSim::eeprom[addr + 1], 0xFF);
+	CHECK_EQ(NativeSim::eeprom[addr + 1 + GateOperation::maxConfigCyp + 1], 2);
+	CHECK_EQ(NativeSim::eeprom[addr + 1 + GateOperation::maxConfigCyp + 3], 0x81);
+	CHECK_EQ(WallOper.setWallsToConfig(0), 2);
+	CHECK_EQ(WallOper.setWallsToConfig(1), 1);
+	CHECK_EQ(WallOper.C[1].bitWallMoveUpFlag, 0x81);
+
+	// A table written with another layout is rejected and replaced on the next store
+	NativeSim::eeprom[addr] = GateOperation::eepromConfigVersion + 1;
+	CHECK_EQ(WallOper.setWallsToConfig(1), 3);
+	CHECK_EQ(WallOper.C[1].bitWallMoveUpFlag, 0);
+	CHECK_EQ(WallOper.storeWallConfig(0, cfg_arr, 1), 0);
+	CHECK_EQ(WallOper.setWallsToConfig(1), 2);
+	CHECK_EQ(WallOper.setWallsToConfig(0), 1);
+	CHECK_EQ(WallOper.C[0].bitWallMoveUpFlag, 0x0F);
+	CHECK_EQ(WallOper.setWallsToConfig(GateOperation::maxConfig), 255);
+}
+
+int main()
+{
+	RUN_TEST(testInit);
+	RUN_TEST(testMove);
+	RUN_TEST(testStuckWall);
+	RUN_TEST(testConfigTable);
+	return TEST_RESULT();
+}
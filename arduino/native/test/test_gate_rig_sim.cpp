@@ -0,0 +1,230 @@
+// Native build: GateOperation moves on the physics rig model and the pseudo-terminal bridge
+
+#include "Arduino.h"
+#include "GateOperation.h"
+#include "GateRigSim.h"
+#include "PtyBridge.h"
+#include "NativeTest.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+bool DB_VERBOSE = 0;
+
+static GateOperation WallOper(255, 2000);
+
+// Reset the simulator, build a rig and initialize GateOperation on it
+static void setupRig(GateRigSim &r_rig)
+{
+	WallOper.CypCom.i2cScan();
+	WallOper.initGateOperation();
+	WallOper.initCypress();
+	(void)r_rig;
+}
+
+// Run a move and get its duration (us)
+static uint64_t timeMove(uint8_t &r_status)
+{
+	uint64_t ts_start = NativeSim::nowUs;
+	r_status = WallOper.moveWallsConductor();
+	return NativeSim::nowUs - ts_start;
+}
+
+void testInitWalls()
+{
+	NativeSim::reset();
+	GateRigSim::ConfigStruct cfg;
+	cfg.nChips = 3;
+	GateRigSim rig(cfg);
+	setupRig(rig);
+	CHECK_EQ(WallOper.CypCom.nAddr, 3);
+
+	// All walls up then down with the real GateOperation path
+	uint64_t ts_start = NativeSim::nowUs;
+	CHECK_EQ(WallOper.initWalls(1), 1);
+	uint64_t dt_up = NativeSim::nowUs - ts_start;
+	CHECK(dt_up >= 600000 && dt_up < 620000);
+	for (uint8_t cyp_i = 0; cyp_i < 3; cyp_i++)
+	{
+		CHECK_EQ(WallOper.C[cyp_i].bitWallPosition, 0xFF);
+		CHECK_EQ(rig.getWallsUp(cyp_i), 0xFF);
+		CHECK_EQ(rig.getWallsDriven(cyp_i), 0);
+	}
+	CHECK_EQ(rig.nSwitchHits, 24);
+
+	uint8_t status;
+	for (uint8_t cyp_i = 0; cyp_i < 3; cyp_i++)
+		WallOper.setWallsToMove(cyp_i, 0x00);
+	uint64_t dt_down = timeMove(status);
+	CHECK_EQ(status, 1);
+	CHECK(dt_down >= 500000 && dt_down < 520000);
+	CHECK_EQ(rig.getWallsUp(0), 0);
+}
+
+void testMixedMove()
+{
+	// Up and down walls on several chips in one move
+	NativeSim::reset();
+	GateRigSim::ConfigStruct cfg;
+	cfg.nChips = 3;
+	GateRigSim rig(cfg);
+	setupRig(rig);
+	CHECK_EQ(WallOper.initWalls(1), 1);
+	CHECK_EQ(WallOper.initWalls(0), 1);
+
+	uint8_t wall_state[3] = {0x0F, 0xF0, 0x81};
+	for (uint8_t cyp_i = 0; cyp_i < 3; cyp_i++)
+		WallOper.setWallsToMove(cyp_i, wall_state[cyp_i]);
+	uint8_t status;
+	timeMove(status);
+	CHECK_EQ(status, 1);
+	for (uint8_t cyp_i = 0; cyp_i < 3; cyp_i++)
+	{
+		CHECK_EQ(WallOper.C[cyp_i].bitWallPosition, wall_state[cyp_i]);
+		CHECK_EQ(WallOper.C[cyp_i].bitWallErrorFlag, 0);
+		CHECK_EQ(rig.getWallsUp(cyp_i), wall_state[cyp_i]);
+	}
+}
+
+void testMoveTimes()
+{
+	NativeSim::reset();
+	GateRigSim::ConfigStruct cfg;
+	cfg.nChips = 2;
+	GateRigSim rig(cfg);
+	setupRig(rig);
+
+	// Stage timestamps are in order and travel dominates
+	uint8_t status;
+	WallOper.setWallsToMove(0, 0xFF);
+	WallOper.setWallsToMove(1, 0x0F);
+	uint32_t ts_call = micros();
+	timeMove(status);
+	CHECK_EQ(status, 1);
+	GateOperation::MoveTimeStruct ts = WallOper.MoveTs;
+	CHECK(ts.tsStart > ts_call && ts.tsStart < ts.tsPwmOn);
+	CHECK(ts.tsPwmOn < ts.tsLastSwitch && ts.tsLastSwitch < ts.tsPwmOff && ts.tsPwmOff < ts.tsEnd);
+	CHECK(ts.tsLastSwitch - ts.tsPwmOn >= 600000 && ts.tsLastSwitch - ts.tsPwmOn < 610000);
+	CHECK(ts.tsPwmOff - ts.tsLastSwitch < 2000);
+
+	// Packed little endian
+	uint8_t ts_arr[GateOperation::moveTimeSize];
+	CHECK_EQ(WallOper.getMoveTimes(ts_arr, sizeof(ts_arr) - 1), 0);
+	CHECK_EQ(WallOper.getMoveTimes(ts_arr, sizeof(ts_arr)), GateOperation::moveTimeSize);
+	CHECK_EQ(ts_arr[8] | ts_arr[9] << 8 | ts_arr[10] << 16 | (uint32_t)ts_arr[11] << 24, ts.tsLastSwitch);
+
+	// Nothing to move keeps the stamps of the last move
+	timeMove(status);
+	CHECK_EQ(status, 0);
+	CHECK_EQ(WallOper.MoveTs.tsEnd, ts.tsEnd);
+}
+
+void testDutyAndSpread()
+{
+	NativeSim::reset();
+	GateRigSim::ConfigStruct cfg;
+	cfg.travelUp = {500000, 50000, 100000};
+	GateRigSim rig(cfg);
+	WallOper.pwmDuty = 128; // half speed
+	setupRig(rig);
+	WallOper.pwmDuty = 255;
+
+	uint8_t status;
+	WallOper.setWallsToMove(0, 0xFF);
+	uint64_t dt_move = timeMove(status);
+	CHECK_EQ(status, 1);
+	CHECK(dt_move > 1000000 && dt_move < 1800000);
+
+	// Walls arrive at different times
+	uint32_t dt_min = UINT32_MAX, dt_max = 0;
+	for (uint8_t wall_i = 0; wall_i < 8; wall_i++)
+	{
+		uint32_t dt = rig.wall(0, wall_i).dtTravel;
+		dt_min = dt < dt_min ? dt : dt_min;
+		dt_max = dt > dt_max ? dt : dt_max;
+	}
+	CHECK(dt_max - dt_min > 10000);
+}
+
+void testStuckWall()
+{
+	NativeSim::reset();
+	GateRigSim::ConfigStruct cfg;
+	cfg.nChips = 2;
+	GateRigSim rig(cfg);
+	rig.setStuck(1, 3);
+	setupRig(rig);
+
+	uint8_t status;
+	WallOper.setWallsToMove(0, 0x0F);
+	WallOper.setWallsToMove(1, 0x0F);
+	uint64_t dt_move = timeMove(status);
+	CHECK_EQ(status, 3);
+	CHECK(dt_move >= 2000000);
+	CHECK_EQ(WallOper.C[0].bitWallPosition, 0x0F);
+	CHECK_EQ(WallOper.C[1].bitWallPosition, 0x07);
+	CHECK_EQ(WallOper.C[1].bitWallErrorFlag & 0x08, 0x08);
+	CHECK_EQ(rig.getWallsDriven(1), 0);
+}
+
+void testBusTiming()
+{
+	// A slower bus means fewer poll passes in the same move
+	uint16_t n_poll[2];
+	for (uint8_t run_i = 0; run_i < 2; run_i++)
+	{
+		NativeSim::reset();
+		GateRigSim::ConfigStruct cfg;
+		cfg.nChips = 4;
+		cfg.i2cUsPerByte = run_i == 0 ? 22 : 90; // 400 kHz, 100 kHz
+		GateRigSim rig(cfg);
+		setupRig(rig);
+		for (uint8_t cyp_i = 0; cyp_i < 4; cyp_i++)
+			WallOper.setWallsToMove(cyp_i, 0xFF);
+		uint8_t status;
+		timeMove(status);
+		CHECK_EQ(status, 1);
+		n_poll[run_i] = WallOper.MoveCnt.nPollLastMove;
+	}
+	CHECK(n_poll[0] > 2 * n_poll[1]);
+}
+
+void testPtyBridge()
+{
+	NativeSim::reset();
+	Serial.reset();
+	Serial.begin(115200);
+	PtyBridge bridge;
+	CHECK(bridge.open());
+	int fd = open(bridge.path(), O_RDWR | O_NOCTTY);
+	CHECK(fd >= 0);
+
+	// Host to firmware
+	CHECK_EQ(write(fd, "abc", 3), 3);
+	usleep(10000);
+	bridge.pump(Serial);
+	delay(1);
+	CHECK_EQ(Serial.available(), 3);
+	CHECK_EQ(Serial.read(), 'a');
+
+	// Firmware to host
+	Serial.write((const uint8_t *)"xyz", 3);
+	Serial.flush();
+	bridge.pump(Serial);
+	char buff[8] = {0};
+	usleep(10000);
+	CHECK_EQ(read(fd, buff, sizeof(buff)), 3);
+	CHECK(strcmp(buff, "xyz") == 0);
+	close(fd);
+}
+
+int main()
+{
+	RUN_TEST(testInitWalls);
+	RUN_TEST(testMixedMove);
+	RUN_TEST(testMoveTimes);
+	RUN_TEST(testDutyAndSpread);
+	RUN_TEST(testStuckWall);
+	RUN_TEST(testBusTiming);
+	RUN_TEST(testPtyBridge);
+	return TEST_RESULT();
+}
@@ -0,0 +1,141 @@
+// Native build: GateSync strobe and code pin output through a captured pinWriter, event ring and serial packing
+
+#include "Arduino.h"
+#include "GateSync.h"
+#include "NativeSim.h"
+#include "NativeTest.h"
+#include <vector>
+
+bool DB_VERBOSE = 0;
+
+// One captured pin write
+struct PinWrite
+{
+	uint8_t pin;
+	uint8_t level;
+	uint64_t ts; // simulated time of the write (us)
+};
+
+static std::vector<PinWrite> pinWrites;
+
+// GPIO stand-in installed as GateSync::pinWriter
+static void capturePin(uint8_t pin, uint8_t level)
+{
+	pinWrites.push_back({pin, level, NativeSim::nowUs});
+}
+
+void testPulseMode()
+{
+	NativeSim::reset();
+	pinWrites.clear();
+	GateSync sync;
+	sync.pinWriter = capturePin;
+	sync.setupSync(30, 20);
+
+	// Strobe set low at setup, then one high/low pulse per event
+	CHECK_EQ(pinWrites.size(), 1);
+	CHECK_EQ(pinWrites[0].pin, 30);
+	CHECK_EQ(pinWrites[0].level, LOW);
+	pinWrites.clear();
+	sync.logEvent(GateSync::MOVE_START);
+	CHECK_EQ(pinWrites.size(), 2);
+	CHECK_EQ(pinWrites[0].pin, 30);
+	CHECK_EQ(pinWrites[0].level, HIGH);
+	CHECK_EQ(pinWrites[1].pin, 30);
+	CHECK_EQ(pinWrites[1].level, LOW);
+	CHECK(pinWrites[1].ts - pinWrites[0].ts >= 20);
+
+	// No strobe pin: events are logged without any pin output
+	pinWrites.clear();
+	GateSync quiet;
+	quiet.pinWriter = capturePin;
+	quiet.setupSync(255);
+	quiet.logEvent(GateSync::MOVE_END);
+	CHECK(pinWrites.empty());
+	uint8_t buff[GateSync::eventSize];
+	CHECK_EQ(quiet.readEvents(buff, sizeof(buff)), 1);
+	CHECK_EQ(buff[4], GateSync::MOVE_END);
+}
+
+void testEncodeMode()
+{
+	NativeSim::reset();
+	pinWrites.clear();
+	GateSync sync;
+	sync.pinWriter = capturePin;
+	uint8_t code_pins[4] = {40, 41, 42, 43};
+	sync.setupSync(30, 10, code_pins, 4);
+
+	// Only maxCodePins code pins are used, all set low at setup
+	CHECK_EQ(pinWrites.size(), 1 + GateSync::maxCodePins);
+	for (const PinWrite &r_write : pinWrites)
+		CHECK_EQ(r_write.level, LOW);
+	CHECK_EQ(pinWrites.back().pin, 42);
+
+	// Code bits (least significant first) are set before the strobe rises and cleared after it falls
+	pinWrites.clear();
+	sync.logEvent(GateSync::MOVE_FAIL, 2, 5);
+	std::vector<PinWrite> expect = {{40, 1, 0}, {41, 0, 0}, {42, 1, 0}, {30, HIGH, 0}, {30, LOW, 0}, {40, LOW, 0}, {41, LOW, 0}, {42, LOW, 0}};
+	CHECK_EQ(pinWrites.size(), expect.size());
+	for (size_t write_i = 0; write_i < expect.size() && write_i < pinWrites.size(); write_i++)
+	{
+		CHECK_EQ(pinWrites[write_i].pin, expect[write_i].pin);
+		CHECK_EQ(pinWrites[write_i].level, expect[write_i].level);
+	}
+	CHECK(pinWrites[4].ts - pinWrites[3].ts >= 10);
+	CHECK_EQ(pinWrites[2].ts, pinWrites[3].ts);
+}
+
+void testEventRing()
+{
+	NativeSim::reset();
+	GateSync sync;
+	sync.pinWriter = capturePin;
+	sync.setupSync(255);
+
+	// Packing: ts(4, little endian), code, chamber, wall
+	NativeSim::advanceTo(0x12345678);
+	sync.logEvent(GateSync::WALL_UP, 3, 6);
+	uint8_t buff[GateSync::maxEvents * GateSync::eventSize];
+	CHECK_EQ(sync.readEvents(buff, sizeof(buff)), 1);
+	uint32_t ts = buff[0] | (buff[1] << 8) | (buff[2] << 16) | ((uint32_t)buff[3] << 24);
+	CHECK(ts >= 0x12345678 && ts < 0x12345678 + 100);
+	CHECK_EQ(buff[4], GateSync::WALL_UP);
+	CHECK_EQ(buff[5], 3);
+	CHECK_EQ(buff[6], 6);
+	CHECK_EQ(sync.readEvents(buff, sizeof(buff)), 0);
+
+	// Overflow drops the oldest events and counts them
+	uint8_t n_logged = GateSync::maxEvents + 5;
+	for (uint8_t ev_i = 0; ev_i < n_logged; ev_i++)
+		sync.logEvent(GateSync::WALL_DOWN, ev_i, ev_i % 8);
+	CHECK_EQ(sync.getDroppedEvents(), 5);
+
+	// A buffer shorter than the log reads the oldest whole events only, the rest stays queued
+	CHECK_EQ(sync.readEvents(buff, 3 * GateSync::eventSize + 2), 3);
+	CHECK_EQ(buff[5], 5);
+	CHECK_EQ(buff[2 * GateSync::eventSize + 5], 7);
+	CHECK_EQ(sync.readEvents(buff, sizeof(buff)), GateSync::maxEvents - 3);
+	CHECK_EQ(buff[5], 8);
+	CHECK_EQ(buff[(GateSync::maxEvents - 4) * GateSync::eventSize + 5], n_logged - 1);
+	CHECK_EQ(buff[(GateSync::maxEvents - 4) * GateSync::eventSize + 6], (n_logged - 1) % 8);
+
+	// Timestamps are in log order
+	uint32_t ts_last = 0;
+	for (uint8_t ev_i = 0; ev_i < GateSync::maxEvents - 3; ev_i++)
+	{
+		uint8_t *p_ev = &buff[ev_i * GateSync::eventSize];
+		uint32_t ts_ev = p_ev[0] | (p_ev[1] << 8) | (p_ev[2] << 16) | ((uint32_t)p_ev[3] << 24);
+		CHECK(ts_ev >= ts_last);
+		ts_last = ts_ev;
+	}
+	CHECK_EQ(sync.readEvents(buff, GateSync::eventSize - 1), 0);
+}
+
+int main()
+{
+	RUN_TEST(testPulseMode);
+	RUN_TEST(testEncodeMode);
+	RUN_TEST(testEventRing);
+	return TEST_RESULT();
+}
@@ -0,0 +1,217 @@
+// Native build: exact I2C transaction and byte budgets of the public CypressCom and GateOperation operations
+//
+// Budgets count Wire calls on the bus (endTransmission() or requestFrom(), so a register read is
+// two) and data bytes (no address bytes). A failing budget means an operation now uses the bus differently: update the budget only
+// if the change is intended.
+
+#include "Arduino.h"
+#include "CypressCom.h"
+#include "GateOperation.h"
+#include "GateRigSim.h"
+#include "NativeTest.h"
+
+bool DB_VERBOSE = 0;
+
+/// @brief Check the return value and the bus traffic of one call.
+#define CHECK_BUS(call, status, n_trans, n_bytes)            \
+	do                                                       \
+	{                                                        \
+		uint32_t _n_trans = NativeSim::nI2cTrans;            \
+		uint32_t _n_bytes = NativeSim::nI2cBytes;            \
+		CHECK_EQ(call, status);                              \
+		CHECK_EQ(NativeSim::nI2cTrans - _n_trans, n_trans);  \
+		CHECK_EQ(NativeSim::nI2cBytes - _n_bytes, n_bytes);  \
+	} while (0)
+
+static GateOperation WallOper(255, 2000);
+
+void testCypressLowLevel()
+{
+	NativeSim::reset();
+	CypressSim cyp_a(0x20);
+	CypressSim cyp_b(0x21);
+	CypressCom cyp_com;
+	uint8_t byte_arr[16] = {0};
+
+	CHECK_BUS(cyp_com.i2cInit(), 0, 0, 0);
+	CHECK_BUS(cyp_com.i2cScan(), 0, 127, 0); // one probe per address
+	CHECK_BUS(cyp_com.i2cRead(0x20, REG_GO0, byte_arr, 1), 0, 2, 2);
+	CHECK_BUS(cyp_com.i2cRead(0x20, REG_GI0, byte_arr, 14), 0, 2, 15);
+	CHECK_BUS(cyp_com.i2cWrite(0x20, REG_GO0, 0x00), 0, 1, 2);
+	CHECK_BUS(cyp_com.i2cWrite(0x20, REG_GO0, byte_arr, 6), 0, 1, 7);
+
+	// Argument errors never touch the bus
+	CHECK_BUS(cyp_com.i2cRead(0x20, REG_GO0, byte_arr, 17), 255, 0, 0);
+	CHECK_BUS(cyp_com.i2cWrite(0x20, REG_GO0, byte_arr, 17), 255, 0, 0);
+
+	// Counters and trace are bookkeeping only
+	uint8_t cnt_arr[1 + (CYP_MAX_ADDR + 1) * CypressCom::i2cCountSize];
+	CHECK_BUS(cyp_com.getCounts(cnt_arr, sizeof(cnt_arr)) > 0, 1, 0, 0);
+	cyp_com.resetCounts();
+	uint8_t tr_arr[3 + CypressCom::traceFrameEntries * CypressCom::traceEntrySize];
+	CHECK_BUS(cyp_com.getTraceBytes(0, tr_arr, sizeof(tr_arr)) > 0, 1, 0, 0);
+	cyp_com.resetTrace();
+	CHECK_EQ(NativeSim::nI2cTrans, 127 + 2 + 2 + 1 + 1);
+}
+
+void testCypressMidLevel()
+{
+	NativeSim::reset();
+	CypressSim cyp(0x20);
+	CypressCom cyp_com;
+	cyp_com.i2cScan();
+	uint8_t byte_val;
+	uint8_t mask[6] = {0xFF, 0, 0, 0x0F, 0, 0};
+	uint8_t reg_last[6] = {0};
+	uint8_t io_all[14];
+
+	CHECK_BUS(cyp_com.ioReadPin(0x20, 3, 2, byte_val), 0, 2, 2);
+	CHECK_BUS(cyp_com.ioWritePin(0x20, 3, 2, 1), 0, 3, 4);				// read-modify-write
+	CHECK_BUS(cyp_com.ioReadPort(0x20, REG_GO0, 3, byte_val), 0, 2, 2);
+	CHECK_BUS(cyp_com.ioReadPort(0x20, REG_PIN_DIR, 3, byte_val), 0, 3, 4); // port select first
+	CHECK_BUS(cyp_com.ioWritePort(0x20, 3, 0x0F, 1), 0, 3, 4);			// read-modify-write
+	CHECK_BUS(cyp_com.ioReadReg(0x20, REG_GI0, io_all, 14), 0, 2, 15);
+	CHECK_BUS(cyp_com.ioWriteReg(0x20, mask, 6, 0), 0, 3, 14);			// reads the output registers first
+	CHECK_BUS(cyp_com.ioWriteReg(0x20, mask, 6, 0, reg_last), 0, 1, 7);	// last register values given
+
+	// Argument errors never touch the bus
+	CHECK_BUS(cyp_com.ioReadPin(0x20, 6, 0, byte_val), 255, 0, 0);
+	CHECK_BUS(cyp_com.ioWritePin(0x20, 0, 8, 1), 255, 0, 0);
+	CHECK_BUS(cyp_com.ioReadPort(0x20, REG_GO0, 6, byte_val), 255, 0, 0);
+	CHECK_BUS(cyp_com.ioWritePort(0x20, 6, 0xFF, 1), 255, 0, 0);
+	CHECK_BUS(cyp_com.ioWriteReg(0x20, mask, 17, 0), 255, 0, 0);
+
+	// Read-modify-writes stop after a failed read
+	cyp.failStatus = 3;
+	cyp.failNext = 1;
+	CHECK_BUS(cyp_com.ioWritePin(0x20, 3, 2, 1), 3, 1, 1);
+	cyp.failNext = 1;
+	CHECK_BUS(cyp_com.ioWritePort(0x20, 3, 0x0F, 1), 3, 1, 1);
+	cyp.failNext = 1;
+	CHECK_BUS(cyp_com.ioWriteReg(0x20, mask, 6, 0), 3, 1, 1);
+
+	// Missing device: the address is not acknowledged and no data bytes are sent
+	CHECK_BUS(cyp_com.ioReadReg(0x22, REG_GI0, io_all, 14), 2, 1, 0);
+	CHECK_BUS(cyp_com.ioWritePort(0x22, 3, 0x0F, 1), 2, 1, 0);
+}
+
+void testCypressHighLevel()
+{
+	NativeSim::reset();
+	CypressSim cyp(0x20);
+	CypressCom cyp_com;
+	cyp_com.i2cScan();
+
+	CHECK_BUS(cyp_com.setupCypress(0x20), 0, 3, 5);				  // probe, restore, reconfigure
+	CHECK_BUS(cyp_com.setupSourcePWM(0x20, 5, 255), 0, 4, 8);		  // select, clock, period, width
+	CHECK_BUS(cyp_com.setSourceDutyPWM(0x20, 5, 128), 0, 1, 2);
+	CHECK_BUS(cyp_com.setPortRegister(0x20, REG_PIN_DIR, 3, 0x0F, 1), 0, 4, 6); // select, read, write
+
+	CHECK_BUS(cyp_com.setupSourcePWM(0x20, 8, 255), 255, 0, 0);
+	CHECK_BUS(cyp_com.setPortRegister(0x20, REG_PIN_DIR, 6, 0x0F, 1), 255, 0, 0);
+	cyp.failStatus = 3;
+	cyp.failNext = 1;
+	CHECK_BUS(cyp_com.setPortRegister(0x20, REG_PIN_DIR, 3, 0x0F, 1), 3, 1, 2);
+
+	// Library counters agree with the bus, they count a read (repeated start) as one transaction
+	CHECK_EQ(cyp_com.I2cCnt[0].nTrans + 1, NativeSim::nI2cTrans - 127);
+	CHECK_EQ(cyp_com.I2cCnt[0].nBytes, NativeSim::nI2cBytes);
+}
+
+void testGateOperationSetup()
+{
+	NativeSim::reset();
+	GateRigSim::ConfigStruct cfg;
+	cfg.nChips = 2;
+	GateRigSim rig(cfg);
+	WallOper.CypCom.i2cScan();
+
+	// Per chip:
+	//   setupCypress             3 trans   5 bytes
+	//   outputs off (read+write) 3        14
+	//   5 io ports x (2 setPortRegister + ioWritePort)  55  80
+	//   8 pwm sources x setupSourcePWM                  32  64
+	//   6 pwm ports x 2 setPortRegister                 48  72
+	//   getWallState             2         7
+	CHECK_BUS((WallOper.initGateOperation(), 0), 0, 0, 0);
+	CHECK_BUS(WallOper.initCypress(), 0, 2 * 143, 2 * 242);
+
+	uint8_t byte_state;
+	CHECK_BUS(WallOper.getWallState(0, 1, byte_state), 0, 2, 7);
+	CHECK_BUS(WallOper.getWallState(2 + CYP_MAX_ADDR, 1, byte_state), 255, 0, 0);
+
+	// Staging and configurations are bus free
+	CHECK_BUS(WallOper.setWallsToMove(0, 0xFF), 1, 0, 0);
+	uint8_t cfg_arr[2] = {0x0F, 0xF0};
+	CHECK_BUS(WallOper.storeWallConfig(0, cfg_arr, 2), 0, 0, 0);
+	CHECK_BUS(WallOper.setWallsToConfig(0), 1, 0, 0);
+	uint8_t cnt_arr[GateOperation::moveCountSize];
+	CHECK_BUS(WallOper.getCounts(cnt_arr, sizeof(cnt_arr)), GateOperation::moveCountSize, 0, 0);
+	WallOper.resetCounts();
+}
+
+void testGateOperationMove()
+{
+	NativeSim::reset();
+	GateRigSim::ConfigStruct cfg;
+	cfg.nChips = 3;
+	GateRigSim rig(cfg);
+	WallOper.CypCom.i2cScan();
+	WallOper.initGateOperation();
+	WallOper.initCypress();
+
+	// Walls of a chip reach their switches together, so each chip is polled on every pass and
+	// has one pwm cutoff write. Per chip:
+	//   start (read+write outputs)  3 trans  14 bytes
+	//   poll pass (read 14 regs)    2        15
+	//   pwm cutoff (write)          1         7
+	uint32_t n_trans = NativeSim::nI2cTrans;
+	uint32_t n_bytes = NativeSim::nI2cBytes;
+	CHECK_EQ(WallOper.initWalls(1), 1);
+	uint32_t n_poll = WallOper.MoveCnt.nPollLastMove;
+	CHECK(n_poll > 0);
+	CHECK_EQ(NativeSim::nI2cTrans - n_trans, 3 * (3 + 2 * n_poll + 1));
+	CHECK_EQ(NativeSim::nI2cBytes - n_bytes, 3 * (14 + 15 * n_poll + 7));
+
+	// Only chips with walls to move are touched
+	WallOper.setWallsToMove(1, 0x00);
+	n_trans = NativeSim::nI2cTrans;
+	n_bytes = NativeSim::nI2cBytes;
+	CHECK_EQ(WallOper.moveWallsConductor(), 1);
+	n_poll = WallOper.MoveCnt.nPollLastMove;
+	CHECK_EQ(NativeSim::nI2cTrans - n_trans, 3 + 2 * n_poll + 1);
+	CHECK_EQ(NativeSim::nI2cBytes - n_bytes, 14 + 15 * n_poll + 7);
+
+	// Nothing to move
+	CHECK_BUS(WallOper.moveWallsConductor(), 0, 0, 0);
+
+	// Armed move: the output registers are read when arming and written once to start
+	WallOper.setWallsToMove(1, 0xFF);
+	CHECK_BUS(WallOper.armWallsMove(), 1, 2, 7);
+	n_trans = NativeSim::nI2cTrans;
+	n_bytes = NativeSim::nI2cBytes;
+	CHECK_EQ(WallOper.moveWallsConductor(), 1);
+	n_poll = WallOper.MoveCnt.nPollLastMove;
+	CHECK_EQ(NativeSim::nI2cTrans - n_trans, 1 + 2 * n_poll + 1);
+	CHECK_EQ(NativeSim::nI2cBytes - n_bytes, 7 + 15 * n_poll + 7);
+
+	// Timed out chip: all its pwm outputs are turned off with a read-modify-write
+	rig.setStuck(2, 0);
+	WallOper.setWallsToMove(2, 0x00);
+	n_trans = NativeSim::nI2cTrans;
+	n_bytes = NativeSim::nI2cBytes;
+	CHECK_EQ(WallOper.moveWallsConductor(), 3);
+	n_poll = WallOper.MoveCnt.nPollLastMove;
+	CHECK_EQ(NativeSim::nI2cTrans - n_trans, 3 + 2 * n_poll + 1 + 3);
+	CHECK_EQ(NativeSim::nI2cBytes - n_bytes, 14 + 15 * n_poll + 7 + 14);
+}
+
+int main()
+{
+	RUN_TEST(testCypressLowLevel);
+	RUN_TEST(testCypressMidLevel);
+	RUN_TEST(testCypressHighLevel);
+	RUN_TEST(testGateOperationSetup);
+	RUN_TEST(testGateOperationMove);
+	return TEST_RESULT();
+}
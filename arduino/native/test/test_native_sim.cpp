@@ -0,0 +1,124 @@
+// Native build: simulated time, pins, interrupts, EEPROM and serial port
+
+#include "Arduino.h"
+#include "EEPROM.h"
+#include "NativeSim.h"
+#include "NativeTest.h"
+
+bool DB_VERBOSE = 0;
+
+static int nIsr = 0;
+static void countIsr() { nIsr++; }
+
+void testTime()
+{
+	NativeSim::reset();
+	delay(5);
+	CHECK_EQ(NativeSim::nowUs, 5000);
+	delayMicroseconds(250);
+	CHECK_EQ(NativeSim::nowUs, 5250);
+	uint32_t ts = micros();
+	CHECK_EQ(ts, 5250 + NativeSim::tickUs);
+
+	// Busy wait loops end
+	uint32_t ts_start = millis();
+	while (millis() - ts_start < 10)
+		;
+	CHECK(NativeSim::nowUs >= 15000);
+}
+
+void testSchedule()
+{
+	NativeSim::reset();
+	int n_run = 0;
+	uint64_t ts_run = 0;
+	NativeSim::schedule(300, [&]()
+						{ n_run++; ts_run = NativeSim::nowUs; });
+	NativeSim::schedule(100, [&]()
+						{ n_run += 10; });
+	delayMicroseconds(200);
+	CHECK_EQ(n_run, 10);
+	delay(1);
+	CHECK_EQ(n_run, 11);
+	CHECK_EQ(ts_run, 300);
+	CHECK_EQ(NativeSim::nScheduled(), 0);
+}
+
+void testPinsAndInterrupts()
+{
+	NativeSim::reset();
+	nIsr = 0;
+	int n_write = 0;
+	NativeSim::onPinWrite = [&](uint8_t pin, uint8_t level)
+	{ n_write += pin == 13 && level == HIGH; };
+	pinMode(13, OUTPUT);
+	digitalWrite(13, HIGH);
+	CHECK_EQ(digitalRead(13), HIGH);
+	CHECK_EQ(n_write, 1);
+
+	attachInterrupt(digitalPinToInterrupt(2), countIsr, RISING);
+	NativeSim::setPin(2, HIGH);
+	NativeSim::setPin(2, LOW);
+	CHECK_EQ(nIsr, 1);
+
+	// Interrupts held while disabled
+	noInterrupts();
+	NativeSim::setPin(2, HIGH);
+	CHECK_EQ(nIsr, 1);
+	interrupts();
+	CHECK_EQ(nIsr, 2);
+}
+
+void testEeprom()
+{
+	NativeSim::reset();
+	CHECK_EQ(EEPROM.read(10), 0xFF);
+	EEPROM.update(10, 42);
+	CHECK_EQ(EEPROM.read(10), 42);
+}
+
+void testSerialTiming()
+{
+	NativeSim::reset();
+	Serial.reset();
+	Serial.begin(115200); // 87 us per byte
+	CHECK_EQ(Serial.availableForWrite(), SERIAL_TX_BUFFER_SIZE - 1);
+
+	// Bytes leave the transmit buffer at the baud rate
+	uint8_t msg[10] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+	Serial.write(msg, 10);
+	CHECK_EQ(Serial.availableForWrite(), SERIAL_TX_BUFFER_SIZE - 11);
+	uint8_t buff[16];
+	CHECK_EQ(Serial.hostRead(buff, 16), 0);
+	delayMicroseconds(200);
+	CHECK_EQ(Serial.hostRead(buff, 16), 2);
+	Serial.flush();
+	CHECK_EQ(Serial.hostRead(buff, 16), 8);
+	CHECK_EQ(buff[7], 10);
+
+	// Writes block while the transmit buffer is full
+	uint64_t ts_start = NativeSim::nowUs;
+	for (int i = 0; i < 200; i++)
+		Serial.write((uint8_t)i);
+	CHECK(NativeSim::nowUs - ts_start >= (200 - SERIAL_TX_BUFFER_SIZE) * 86);
+
+	// Host bytes arrive one byte time apart
+	Serial.flush();
+	Serial.hostWrite(msg, 3);
+	CHECK_EQ(Serial.available(), 0);
+	delayMicroseconds(90);
+	CHECK_EQ(Serial.available(), 1);
+	delay(1);
+	CHECK_EQ(Serial.available(), 3);
+	CHECK_EQ(Serial.read(), 1);
+}
+
+int main()
+{
+	RUN_TEST(testTime);
+	RUN_TEST(testSchedule);
+	RUN_TEST(testPinsAndInterrupts);
+	RUN_TEST(testEeprom);
+	RUN_TEST(testSerialTiming);
+	return TEST_RESULT();
+}
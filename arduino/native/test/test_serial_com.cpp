@@ -0,0 +1,87 @@
+// Native build: SerialCom framing over the simulated serial port
+
+#include "Arduino.h"
+#include "NativeSim.h"
+#include "SerialCom.h"
+#include "NativeTest.h"
+
+bool DB_VERBOSE = 0;
+
+static SerialCom SerCom(Serial);
+
+// Send a host frame [start, type, len, data, checksum, end]
+static void hostSend(uint8_t msg_type, const uint8_t p_data[], uint8_t s)
+{
+	uint8_t frame[64] = {0x02, msg_type, s};
+	uint8_t sum = 0;
+	for (uint8_t i = 0; i < s; i++)
+	{
+		frame[3 + i] = p_data[i];
+		sum += p_data[i];
+	}
+	frame[3 + s] = sum;
+	frame[4 + s] = 0x03;
+	Serial.hostWrite(frame, s + 5);
+}
+
+void testReceive()
+{
+	NativeSim::reset();
+	Serial.reset();
+	SerCom.initSerial(115200);
+	SerCom.resetCounts();
+
+	uint8_t data[3] = {7, 8, 9};
+	hostSend(2, data, 3);
+	delay(2);
+	CHECK(SerCom.receiveMessage());
+	CHECK_EQ(SerCom.MD.msg_type, 2);
+	CHECK_EQ(SerCom.MD.length, 3);
+	CHECK_EQ(SerCom.MD.data[2], 9);
+
+	// Bad checksum is rejected
+	uint8_t frame[7] = {0x02, 2, 2, 1, 1, 9, 0x03};
+	Serial.hostWrite(frame, 7);
+	delay(2);
+	CHECK(!SerCom.receiveMessage());
+	CHECK_EQ(SerCom.Cnt.nRxFrames, 1);
+}
+
+void testSend()
+{
+	NativeSim::reset();
+	Serial.reset();
+	SerCom.initSerial(115200);
+
+	uint8_t data[2] = {0x11, 0x22};
+	SerCom.sendMessage(9, data, 2);
+	Serial.flush();
+	uint8_t buff[32];
+	size_t n = Serial.hostRead(buff, sizeof(buff));
+	CHECK_EQ(n, 2 + 3 + 4 + 2);
+	CHECK_EQ(buff[0], 0x02);
+	CHECK_EQ(buff[1], 9);
+	CHECK_EQ(buff[2], 2);
+	CHECK_EQ(buff[4], 0x22);
+	uint8_t sum = 9;
+	for (size_t i = 3; i < 9; i++)
+		sum += buff[i];
+	CHECK_EQ(buff[9], sum);
+	CHECK_EQ(buff[10], 0x03);
+
+	// Log frames are skipped while the transmit buffer is busy
+	SerCom.sendMessage(9, data, 2);
+	const uint8_t log_text[] = "log line\n";
+	for (size_t i = 0; i < 6; i++)
+		SerCom.sendMessage(9, data, 2);
+	CHECK_EQ(SerCom.sendLogMessage(log_text, sizeof(log_text) - 1), 0);
+	Serial.flush();
+	CHECK_EQ(SerCom.sendLogMessage(log_text, sizeof(log_text) - 1), sizeof(log_text) - 1);
+}
+
+int main()
+{
+	RUN_TEST(testReceive);
+	RUN_TEST(testSend);
+	return TEST_RESULT();
+}
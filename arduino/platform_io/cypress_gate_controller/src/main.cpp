@@ -7,13 +7,13 @@
 /**
  * @file Main Arduino file for running the maze.
  *
- * @note Set DB_VERBOSE to 0 and use the "Serial" HardwareSerial port
- * for SerCom(Serial) initialation if you are performing serial
- * communication with the Arduino USB connection. Otherwise, if you
- * want to debug using hte Serial Monitor, you can set DB_VERBOSE to 1
- * and use a USB to TTL Serial Converter connected to the "Serial1" 
- * HardwareSerial port, or any other port that is available on your Arduino
- * board. If using this approarch, set SerialCom SerCom(Serial1). 
+ * @note Debug output is sent through SerialCom as log frames (message type 12)
+ * on the same "Serial" port as the protocol, so a rig can be debugged over its
+ * USB connection. Logging starts silent (DB_VERBOSE 0) and is turned on, and its
+ * level and frame rate set, with message type 13. The host tools in gui/ split
+ * the log frames from the protocol replies. To use the Serial Monitor on a
+ * second port instead, clear Dbg.logWriter in setup() and use a USB to TTL
+ * Serial Converter on the port SerialCom is not using.
  */
 
 // BUILT IN
@@ -24,23 +24,216 @@
 #include <GateDebug.h>
 #include <CypressCom.h>
 #include <SerialCom.h>
+#include <GateSync.h>
+#include <GateProfile.h>
 #include <GateOperation.h>
 
 //============ VARIABLES ===============
 
 // Global variables
 bool DB_VERBOSE = 0;  //< set to control debugging behavior [0:silent, 1:verbose]
+bool DB_BINARY = 0;   //< set to log compact binary records instead of text [0:text, 1:binary]
 bool DO_ECAT_SPI = 1; //< set to control block SPI [0:dont start, 1:start]
 
 // Gate operation setup
 uint8_t pwmDuty = 255;         // PWM duty for all walls [0-255]
 uint16_t dtMoveTimeout = 2000; // timeout for wall movement (ms)
 
+// Move trigger setup
+uint8_t triggerPin = 255;          // interrupt capable input pin that starts an armed move on a rising edge [255:disabled]
+volatile bool isTriggered = false; // set by the trigger pin interrupt
+volatile uint32_t tsTrigger = 0;   // micros() timestamp of the trigger pin edge
+
+// Sync output setup
+uint8_t syncStrobePin = 255;                 // output pin pulsed on every wall event [255:disabled]
+uint8_t syncCodePins[3] = {255, 255, 255};   // output pins for the event code bits [255:pulse only]
+uint16_t dtSyncPulse = 10;                   // sync strobe pulse width (us)
+
+// Performance counters
+uint32_t nLoop = 0; // loop() iterations
+uint32_t tsMsgRx[2] = {0, 0}; // micros() receive start and end of the last message other than a latency request
+
 // Initialize class instances for local libraries
 GateDebug Dbg;                                  // Debugging class                    
 GateOperation WallOper(pwmDuty, dtMoveTimeout); // Wall operation class
 SerialCom SerCom(Serial); // Serial communication class
 
+//=============== FUNCTIONS =============
+
+/**
+ * @brief Interrupt service routine for the trigger pin.
+ */
+void triggerISR()
+{
+  if (!isTriggered)
+  {
+    tsTrigger = micros();
+    isTriggered = true;
+  }
+}
+
+/**
+ * @brief Drop a trigger pin edge that has not started a move yet.
+ *
+ * @note Called before arming, so only an edge after the arm starts the new move.
+ */
+void clearTrigger()
+{
+  noInterrupts();
+  isTriggered = false;
+  interrupts();
+}
+
+/**
+ * @brief Send a chunk of queued debug output as a SerialCom log frame.
+ *
+ * @details Installed as GateDebug::logWriter in setup().
+ *
+ * @param p_log Log bytes.
+ * @param length Number of log bytes available.
+ * @return Number of log bytes sent [0:busy or rate limited].
+ */
+uint16_t sendLogFrame(const uint8_t p_log[], uint16_t length)
+{
+  return SerCom.sendLogMessage(p_log, length);
+}
+
+/**
+ * @brief Store the current wall position byte of each chip.
+ *
+ * @param p_wall_last Byte array with one entry per chip (used as output).
+ */
+void storeWallPositions(uint8_t p_wall_last[])
+{
+  for (size_t cyp_i = 0; cyp_i < WallOper.CypCom.nAddr; cyp_i++)
+    p_wall_last[cyp_i] = WallOper.C[cyp_i].bitWallPosition;
+}
+
+/**
+ * @brief Set walls to move from compact message data.
+ *
+ * @details The data is a chip bitmap of (nAddr + 7) / 8 bytes followed by one
+ * wall byte for each chip flagged in the bitmap. Once the length is checked, any staged
+ * or armed move is cleared, so only the flagged chips move. A message with the wrong
+ * length leaves the staged or armed move as it was.
+ *
+ * @param p_data Message data.
+ * @param length Length of the message data.
+ * @return true if the data length matches the chip bitmap, otherwise false.
+ */
+bool setWallsFromCompact(uint8_t p_data[], uint8_t length)
+{
+  uint8_t n_map = (WallOper.CypCom.nAddr + 7) / 8;
+
+  // Count flagged chips to validate the message length
+  uint8_t n_cyp_set = 0;
+  for (size_t cyp_i = 0; cyp_i < WallOper.CypCom.nAddr && n_map <= length; cyp_i++)
+    n_cyp_set += bitRead(p_data[cyp_i / 8], cyp_i % 8);
+  if (n_map > length || n_map + n_cyp_set != length)
+  {
+    DB_PRINT_MSG(Dbg, Dbg.MT::WARNING, "Compact move length mismatch: length[%d] map[%d] chips[%d]", length, n_map, n_cyp_set);
+    return false;
+  }
+
+  // Set flagged chips to move
+  WallOper.clearWallsMove();
+  uint8_t dat_i = n_map;
+  for (size_t cyp_i = 0; cyp_i < WallOper.CypCom.nAddr; cyp_i++)
+    if (bitRead(p_data[cyp_i / 8], cyp_i % 8) == 1)
+      WallOper.setWallsToMove(cyp_i, p_data[dat_i++]);
+  return true;
+}
+
+/**
+ * @brief Send the wall positions of all chips that changed since a move was staged.
+ *
+ * @details The message data is an optional header, then a chip bitmap of (nAddr + 7) / 8
+ * bytes followed by the wall position byte of each chip flagged in the bitmap.
+ *
+ * @param msg_type Message type to reply with.
+ * @param p_wall_last Wall position bytes for each chip before the move.
+ * @param p_head OPTIONAL: Header bytes sent before the chip bitmap.
+ * @param s_head OPTIONAL: Length of "p_head".
+ */
+void sendChangedWalls(uint8_t msg_type, uint8_t p_wall_last[], uint8_t p_head[] = nullptr, uint8_t s_head = 0)
+{
+  DB_SPAN_SCOPE(GateProfile::SP::SP_REPLY_TX, msg_type);
+  uint8_t n_map = (WallOper.CypCom.nAddr + 7) / 8;
+
+  // Store header followed by changed walls as a chip bitmap and their wall bytes
+  uint8_t msg_arg_arr[s_head + n_map + WallOper.CypCom.nAddr];
+  uint8_t msg_arg_len = s_head + n_map;
+  for (size_t head_i = 0; head_i < s_head; head_i++)
+    msg_arg_arr[head_i] = p_head[head_i];
+  for (size_t map_i = 0; map_i < n_map; map_i++)
+    msg_arg_arr[s_head + map_i] = 0;
+  for (size_t cyp_i = 0; cyp_i < WallOper.CypCom.nAddr; cyp_i++)
+  {
+    if (WallOper.C[cyp_i].bitWallPosition == p_wall_last[cyp_i])
+      continue;
+    bitWrite(msg_arg_arr[s_head + cyp_i / 8], cyp_i % 8, 1);
+    msg_arg_arr[msg_arg_len++] = WallOper.C[cyp_i].bitWallPosition;
+  }
+
+  // Send back changed wall states
+  SerCom.sendMessage(msg_type, msg_arg_arr, msg_arg_len);
+}
+
+/**
+ * @brief Move walls to a maze configuration stored in EEPROM and reply with the changed walls.
+ *
+ * @details The reply data is the status from GateOperation::setWallsToConfig() followed by
+ * the compact changed walls layout, so an invalid or empty configuration is not mistaken
+ * for a move that changed nothing.
+ *
+ * @param msg_type Message type to reply with.
+ * @param cfg_i Index of the stored maze configuration [-1=255:no index in the message].
+ */
+void moveWallsToConfig(uint8_t msg_type, uint8_t cfg_i)
+{
+  // Store wall positions before move
+  uint8_t byte_wall_state_last[WallOper.maxCyp];
+  storeWallPositions(byte_wall_state_last);
+
+  // Set walls from the configuration table and run move walls operation
+  uint8_t resp = WallOper.setWallsToConfig(cfg_i);
+  if (resp == 1)
+    WallOper.moveWallsConductor();
+
+  // Send back status and changed wall states
+  sendChangedWalls(msg_type, byte_wall_state_last, &resp, 1);
+}
+
+/**
+ * @brief Start the armed move and reply with its status, the trigger latency and the changed walls.
+ *
+ * @details The reply data starts with the move status [0:not armed, 1:moved, 2:i2c error,
+ * 3:timeout], then the trigger to first PWM write latency (us) as 4 little endian bytes,
+ * followed by the compact changed walls layout.
+ *
+ * @param ts_trigger micros() timestamp of the trigger.
+ */
+void runArmedMove(uint32_t ts_trigger)
+{
+  // Store wall positions before move
+  uint8_t byte_wall_state_last[WallOper.maxCyp];
+  storeWallPositions(byte_wall_state_last);
+
+  // Run armed move walls operation
+  uint8_t head_arr[5] = {0, 0, 0, 0, 0};
+  WallOper.dtTriggerToPwm = 0;
+  if (WallOper.isArmed)
+  {
+    WallOper.tsMoveTrigger = ts_trigger;
+    head_arr[0] = WallOper.moveWallsConductor();
+  }
+
+  // Send back status, latency and changed wall states
+  for (size_t byte_i = 0; byte_i < 4; byte_i++)
+    head_arr[1 + byte_i] = (WallOper.dtTriggerToPwm >> (8 * byte_i)) & 0xFF;
+  sendChangedWalls(SerialCom::GO_MSG_TYPE, byte_wall_state_last, head_arr, 5);
+}
+
 //=============== SETUP =================
 void setup()
 {
@@ -49,7 +242,12 @@ void setup()
   // Serial.begin(115200);
   // delay(100);
 
-  Dbg.printMsg(Dbg.MT::HEAD1, "UPLOADING TO ARDUNO...");
+  // Set debug log mode, send log output as SerialCom log frames and wait for it during setup instead of dropping it
+  Dbg.binaryLog = DB_BINARY;
+  Dbg.logWriter = sendLogFrame;
+  Dbg.logBlockWhenFull = true;
+
+  DB_PRINT_MSG(Dbg, Dbg.MT::HEAD1, "UPLOADING TO ARDUNO...");
 
   // Setup serial coms for SerialCom
   SerCom.initSerial(115200);
@@ -60,18 +258,37 @@ void setup()
   // Print available I2C addresses for debuggin
   WallOper.CypCom.i2cScan();
 
+  // Setup sync outputs
+  WallOper.Sync.setupSync(syncStrobePin, dtSyncPulse, syncCodePins, syncCodePins[0] == 255 ? 0 : 3);
+
+  // Setup move trigger pin
+  if (triggerPin != 255)
+  {
+    pinMode(triggerPin, INPUT);
+    attachInterrupt(digitalPinToInterrupt(triggerPin), triggerISR, RISING);
+  }
+
   // Print which microcontroller is active
-  Dbg.printMsg(Dbg.MT::HEAD2, "FINISHED UPLOADING TO ARDUNO");
+  DB_PRINT_MSG(Dbg, Dbg.MT::HEAD2, "FINISHED UPLOADING TO ARDUNO");
+
+  // Send remaining setup log output and drop log output from now on if the buffer is full
+  Dbg.flushLog(true);
+  Dbg.logBlockWhenFull = false;
 }
 
 //=============== LOOP ==================
 void loop()
 {
+  nLoop++;
+
   // Check if a message is received
   if (SerCom.receiveMessage())
   {
+    DB_PROFILE_SCOPE(GateProfile::PS::MSG_HANDLE);
+    DB_SPAN_SCOPE(GateProfile::SP::SP_MSG, SerCom.MD.msg_type);
+
     // Print the received message to the Serial Monitor
-    Dbg.printMsg(Dbg.MT::INFO, "Received message: type[%d]", SerCom.MD.msg_type);
+    DB_PRINT_MSG(Dbg, Dbg.MT::INFO, "Received message: type[%d]", SerCom.MD.msg_type);
 
     // Handle Cypress initialization message
     if (SerCom.MD.msg_type == 0)
@@ -112,6 +329,8 @@ void loop()
     // Handle move gates message
     if (SerCom.MD.msg_type == 2)
     {
+      // Drop any staged or armed move, chips past the message length do not move
+      WallOper.clearWallsMove();
 
       // Loop through message
       for (byte cyp_i = 0; cyp_i < SerCom.MD.length; ++cyp_i)
@@ -125,6 +344,7 @@ void loop()
 
       // Run move walls operation
       WallOper.moveWallsConductor();
+      DB_SPAN_SCOPE(GateProfile::SP::SP_REPLY_TX, SerCom.MD.msg_type);
 
       // Store up walls as a byte array
       uint8_t msg_arg_arr[WallOper.CypCom.nAddr];
@@ -136,8 +356,281 @@ void loop()
       // Send back wall states
       SerCom.sendMessage(SerCom.MD.msg_type, msg_arg_arr, WallOper.CypCom.nAddr);
     }
+
+    // Handle compact move gates message
+    /// @note Data is a chip bitmap of (nAddr + 7) / 8 bytes followed by one wall byte for each
+    /// flagged chip. The reply uses the same layout but only includes chips whose wall
+    /// position changed. A message whose length does not match its bitmap gets the single
+    /// byte reply [255] and moves nothing.
+    if (SerCom.MD.msg_type == 3)
+    {
+      // Store wall positions before move
+      uint8_t byte_wall_state_last[WallOper.maxCyp];
+      storeWallPositions(byte_wall_state_last);
+
+      // Set walls to move and run move walls operation
+      if (setWallsFromCompact(SerCom.MD.data, SerCom.MD.length))
+      {
+        WallOper.moveWallsConductor();
+
+        // Send back changed wall states
+        sendChangedWalls(SerCom.MD.msg_type, byte_wall_state_last);
+      }
+      else
+      {
+        // Send back length error status
+        uint8_t resp = -1;
+        SerCom.sendMessage(SerCom.MD.msg_type, &resp, 1);
+      }
+    }
+
+    // Handle store maze configuration message
+    /// @note Data is the configuration index followed by one wall byte for each chip. Reply
+    /// data is [index, status], with index 255 and status 255 for a message without an index.
+    if (SerCom.MD.msg_type == 4)
+    {
+      // Store configuration in EEPROM
+      uint8_t cfg_i = SerCom.MD.length > 0 ? SerCom.MD.data[0] : -1;
+      uint8_t resp = SerCom.MD.length > 0 ? WallOper.storeWallConfig(cfg_i, &SerCom.MD.data[1], SerCom.MD.length - 1) : -1;
+
+      // Send back configuration index and status
+      uint8_t msg_arg_arr[2] = {cfg_i, resp};
+      SerCom.sendMessage(SerCom.MD.msg_type, msg_arg_arr, 2);
+    }
+
+    // Handle apply maze configuration message
+    /// @note Data is the configuration index, optionally followed by 1 to arm the
+    /// configuration for a GO message or trigger pin edge instead of moving immediately.
+    /// Reply data starts with the status [0:no walls to move, 1:moved/armed, 2:empty
+    /// configuration or i2c error when arming, 3:table stored with another EEPROM layout,
+    /// 255:bad or missing index], followed by the compact changed walls layout when moving
+    /// immediately.
+    if (SerCom.MD.msg_type == 5)
+    {
+      uint8_t cfg_i = SerCom.MD.length > 0 ? SerCom.MD.data[0] : -1;
+      if (SerCom.MD.length > 1 && SerCom.MD.data[1] == 1)
+      {
+        // Arm configuration and send back arm status
+        uint8_t resp = WallOper.setWallsToConfig(cfg_i);
+        if (resp == 1)
+        {
+          clearTrigger();
+          resp = WallOper.armWallsMove();
+        }
+        SerCom.sendMessage(SerCom.MD.msg_type, &resp, 1);
+      }
+      else
+      {
+        // Move walls to configuration and send back status and changed wall states
+        moveWallsToConfig(SerCom.MD.msg_type, cfg_i);
+      }
+    }
+
+    // Handle arm move gates message
+    /// @note Data uses the compact move layout of message type 3. Reply data is the arm
+    /// status [0:no walls to move, 1:armed, 2:i2c error, 255:length mismatch, any armed move
+    /// is kept].
+    if (SerCom.MD.msg_type == 6)
+    {
+      // Set walls to move and precompute register images
+      uint8_t resp = -1;
+      if (setWallsFromCompact(SerCom.MD.data, SerCom.MD.length))
+      {
+        clearTrigger();
+        resp = WallOper.armWallsMove();
+      }
+
+      // Send back arm status
+      SerCom.sendMessage(SerCom.MD.msg_type, &resp, 1);
+    }
+
+    // Handle read sync events message
+    /// @note Reply data is the oldest logged events packed as GateSync::eventSize bytes each.
+    if (SerCom.MD.msg_type == 8)
+    {
+      uint8_t msg_arg_arr[GateSync::maxEvents * GateSync::eventSize];
+      uint8_t n_ev = WallOper.Sync.readEvents(msg_arg_arr, sizeof(msg_arg_arr));
+      SerCom.sendMessage(SerCom.MD.msg_type, msg_arg_arr, n_ev * GateSync::eventSize);
+    }
+
+    // Handle GO message
+    /// @note Sent either framed or as the single unframed SerialCom GO byte. The reply status
+    /// is 0 if nothing is armed, see runArmedMove().
+    if (SerCom.MD.msg_type == SerialCom::GO_MSG_TYPE)
+    {
+      runArmedMove(SerCom.MD.ts);
+    }
+
+    // Handle clock sync ping message
+    /// @note Reply data is the receive timestamp as 4 little endian bytes. Together with the
+    /// send timestamp SerialCom adds to every reply, this gives the host the device side of
+    /// an NTP-style offset and drift estimate.
+    if (SerCom.MD.msg_type == 9)
+    {
+      uint8_t ts_arr[4];
+      for (size_t byte_i = 0; byte_i < 4; byte_i++)
+        ts_arr[byte_i] = (SerCom.MD.ts >> (8 * byte_i)) & 0xFF;
+      SerCom.sendMessage(SerCom.MD.msg_type, ts_arr, 4);
+    }
+
+    // Handle profiling table message
+    /// @note Message data is [do_reset] (optional). One reply is sent per profiling scope with
+    /// the bytes from GateProfile::getScopeBytes(), or a single [0, 0] reply if profiling is
+    /// compiled out. The table is reset after sending if "do_reset" is 1.
+    if (SerCom.MD.msg_type == 10)
+    {
+      uint8_t scope_arr[GateProfile::scopeSize];
+      uint8_t n_sent = 0;
+      for (size_t scope_i = 0; scope_i < GateProfile::nScopes; scope_i++)
+      {
+        uint8_t len = GateProfile::getScopeBytes(scope_i, scope_arr, GateProfile::scopeSize);
+        if (len == 0)
+          break;
+        SerCom.sendMessage(SerCom.MD.msg_type, scope_arr, len);
+        n_sent++;
+      }
+      if (n_sent == 0)
+      {
+        uint8_t empty_arr[2] = {0, 0};
+        SerCom.sendMessage(SerCom.MD.msg_type, empty_arr, 2);
+      }
+      if (SerCom.MD.length > 0 && SerCom.MD.data[0] == 1)
+        GateProfile::resetScopes();
+    }
+
+    // Handle performance counters message
+    /// @note Message data is [do_reset] (optional). Reply data is, all little endian:
+    /// [loop iterations(4)] + SerialCom::getCounts() + GateOperation::getCounts() +
+    /// [log buffer high water(2), log messages dropped(2), log messages suppressed by the site rate limit(2),
+    /// log messages over the byte budget(2)] + CypressCom::getCounts(). The counters are reset after
+    /// sending if "do_reset" is 1.
+    if (SerCom.MD.msg_type == 11)
+    {
+      uint8_t cnt_arr[4 + SerCom.countSize + WallOper.moveCountSize + 8 + 1 + (WallOper.maxCyp + 1) * WallOper.CypCom.i2cCountSize];
+      uint8_t len = 0;
+      for (size_t byte_i = 0; byte_i < 4; byte_i++)
+        cnt_arr[len++] = (nLoop >> (8 * byte_i)) & 0xFF;
+      len += SerCom.getCounts(&cnt_arr[len], sizeof(cnt_arr) - len);
+      len += WallOper.getCounts(&cnt_arr[len], sizeof(cnt_arr) - len);
+      cnt_arr[len++] = Dbg.logHighWater & 0xFF;
+      cnt_arr[len++] = Dbg.logHighWater >> 8;
+      cnt_arr[len++] = Dbg.logDropped & 0xFF;
+      cnt_arr[len++] = Dbg.logDropped >> 8;
+      cnt_arr[len++] = Dbg.logSuppressed & 0xFF;
+      cnt_arr[len++] = Dbg.logSuppressed >> 8;
+      cnt_arr[len++] = Dbg.logOverBudget & 0xFF;
+      cnt_arr[len++] = Dbg.logOverBudget >> 8;
+      len += WallOper.CypCom.getCounts(&cnt_arr[len], sizeof(cnt_arr) - len);
+      SerCom.sendMessage(SerCom.MD.msg_type, cnt_arr, len);
+
+      if (SerCom.MD.length > 0 && SerCom.MD.data[0] == 1)
+      {
+        nLoop = 0;
+        SerCom.resetCounts();
+        WallOper.resetCounts();
+        WallOper.CypCom.resetCounts();
+        Dbg.logHighWater = 0;
+        Dbg.logDropped = 0;
+        Dbg.logSuppressed = 0;
+        Dbg.logOverBudget = 0;
+      }
+    }
+
+    // Handle log channel setup message
+    /// @note Data is [level, frames_per_sec(2), bytes_per_sec(2)] (optional, little endian).
+    /// The level [DB_LEVEL_NONE-DB_LEVEL_DEBUG] is limited to the compiled DB_LOG_LEVEL and 0
+    /// turns logging off, a rate or byte budget of 0 removes that limit. Reply data is
+    /// [level, frames_per_sec(2), DB_LOG_LEVEL, bytes_per_sec(2)]. Log frames (type 12) carry consecutive
+    /// pieces of the GateDebug output, text lines or binary records (DB_BINARY) that the
+    /// host joins back together.
+    if (SerCom.MD.msg_type == 13)
+    {
+      if (SerCom.MD.length > 0)
+      {
+        Dbg.logLevel = SerCom.MD.data[0] < DB_LOG_LEVEL ? SerCom.MD.data[0] : DB_LOG_LEVEL;
+        DB_VERBOSE = Dbg.logLevel > DB_LEVEL_NONE;
+      }
+      if (SerCom.MD.length > 2)
+        SerCom.logFramesPerSec = SerCom.MD.data[1] | (SerCom.MD.data[2] << 8);
+      if (SerCom.MD.length > 4)
+        Dbg.logBytesPerSec = SerCom.MD.data[3] | (SerCom.MD.data[4] << 8);
+      uint8_t log_arr[6] = {Dbg.logLevel, (uint8_t)(SerCom.logFramesPerSec & 0xFF), (uint8_t)(SerCom.logFramesPerSec >> 8), DB_LOG_LEVEL,
+                            (uint8_t)(Dbg.logBytesPerSec & 0xFF), (uint8_t)(Dbg.logBytesPerSec >> 8)};
+      SerCom.sendMessage(SerCom.MD.msg_type, log_arr, 6);
+    }
+
+    // Handle move timeline dump message
+    /// @note Message data is [do_reset] (optional). One reply is sent per timeline frame with the
+    /// bytes from GateProfile::getSpanBytes(), oldest record first. The timeline is cleared after
+    /// sending if "do_reset" is 1. Use gui/gate_timeline.py to convert it to trace-event JSON.
+    if (SerCom.MD.msg_type == 15)
+    {
+      uint8_t sp_arr[3 + GateProfile::spanFrameRecs * GateProfile::spanRecSize];
+      for (uint8_t frame_i = 0;; frame_i++)
+      {
+        uint8_t len = GateProfile::getSpanBytes(frame_i, sp_arr, sizeof(sp_arr));
+        if (len == 0)
+          break;
+        SerCom.sendMessage(SerCom.MD.msg_type, sp_arr, len);
+      }
+      if (SerCom.MD.length > 0 && SerCom.MD.data[0] == 1)
+        GateProfile::resetSpans();
+    }
+
+    // Handle I2C trace dump message
+    /// @note Message data is [do_reset] (optional). One reply is sent per trace frame with the
+    /// bytes from CypressCom::getTraceBytes(), oldest transaction first. The trace is cleared
+    /// after sending if "do_reset" is 1.
+    if (SerCom.MD.msg_type == 14)
+    {
+      uint8_t tr_arr[3 + CypressCom::traceFrameEntries * CypressCom::traceEntrySize];
+      for (uint8_t frame_i = 0;; frame_i++)
+      {
+        uint8_t len = WallOper.CypCom.getTraceBytes(frame_i, tr_arr, sizeof(tr_arr));
+        if (len == 0)
+          break;
+        SerCom.sendMessage(SerCom.MD.msg_type, tr_arr, len);
+      }
+      if (SerCom.MD.length > 0 && SerCom.MD.data[0] == 1)
+        WallOper.CypCom.resetTrace();
+    }
+
+    // Handle latency stamps message
+    /// @note Reply data is the receive start and end of the previous message followed by
+    /// GateOperation::getMoveTimes() for the last move, all little endian micros() values.
+    /// Sent right after a move reply, this splits the move latency into stages, see
+    /// gui/gate_latency.py.
+    if (SerCom.MD.msg_type == 16)
+    {
+      uint8_t lat_arr[8 + WallOper.moveTimeSize];
+      uint8_t len = 0;
+      for (size_t ts_i = 0; ts_i < 2; ts_i++)
+        for (size_t byte_i = 0; byte_i < 4; byte_i++)
+          lat_arr[len++] = (tsMsgRx[ts_i] >> (8 * byte_i)) & 0xFF;
+      len += WallOper.getMoveTimes(&lat_arr[len], sizeof(lat_arr) - len);
+      SerCom.sendMessage(SerCom.MD.msg_type, lat_arr, len);
+    }
+    else
+    {
+      tsMsgRx[0] = SerCom.MD.ts;
+      tsMsgRx[1] = SerCom.MD.tsEnd;
+    }
   }
 
+  // Start the armed move on a trigger pin edge
+  if (isTriggered)
+  {
+    noInterrupts();
+    uint32_t ts_trigger = tsTrigger;
+    isTriggered = false;
+    interrupts();
+    if (WallOper.isArmed)
+      runArmedMove(ts_trigger);
+  }
+
+  // Send queued log output as log frames while idle
+  Dbg.flushLog();
+
   // //............... Cypress Testing ...............
 
   // // Test input pins
@@ -142,10 +142,10 @@ void wallsCycleTest()
   }
 
   // Print cycles and status
-  Dbg.printMsg(Dbg.MT::INFO, "Cycle counts: w0[%lu] w1[%lu] w2[%lu] w3[%lu] w4[%lu]",
-               cycleCount[0], cycleCount[1], cycleCount[2], cycleCount[3], cycleCount[4]);
-  Dbg.printMsg(Dbg.MT::INFO, "Run status: w0[%d] w1[%d] w2[%d] w3[%d] w4[%d]",
-               runStatus[0], runStatus[1], runStatus[2], runStatus[3], runStatus[4]);
+  DB_PRINT_MSG(Dbg, Dbg.MT::INFO, "Cycle counts: w0[%lu] w1[%lu] w2[%lu] w3[%lu] w4[%lu]",
+                    cycleCount[0], cycleCount[1], cycleCount[2], cycleCount[3], cycleCount[4]);
+  DB_PRINT_MSG(Dbg, Dbg.MT::INFO, "Run status: w0[%d] w1[%d] w2[%d] w3[%d] w4[%d]",
+                    runStatus[0], runStatus[1], runStatus[2], runStatus[3], runStatus[4]);
 }
 
 void runTimingTest()
@@ -211,7 +211,7 @@ void setup()
   Serial.begin(115200);
   delay(100);
 
-  Dbg.printMsg(Dbg.MT::HEAD1, "UPLOADING TO ARDUNO...");
+  DB_PRINT_MSG(Dbg, Dbg.MT::HEAD1, "UPLOADING TO ARDUNO...");
 
   // Initialize I2C for Cypress chips
   WallOper.CypCom.i2cInit();
@@ -234,7 +234,7 @@ void setup()
     runWalls(wallInds[i], 0);
   }
 
-  Dbg.printMsg(Dbg.MT::HEAD2, "FINISHED SETUP");
+  DB_PRINT_MSG(Dbg, Dbg.MT::HEAD2, "FINISHED SETUP");
 }
 
 //=============== LOOP ==================
@@ -0,0 +1,90 @@
+# Import necessary modules
+import time
+
+# Device timestamps are 32-bit micros() values that wrap about every 71.6 minutes
+DEVICE_TS_WRAP = 2 ** 32
+
+
+# Class to unwrap 32-bit device micros() timestamps into a continuous count
+class DeviceTimeUnwrapper:
+    def __init__(self):
+        self.last_raw = None  # Last raw timestamp seen
+        self.last_unwrapped = 0  # Unwrapped value of the last raw timestamp
+
+    # Method to convert a raw device timestamp to an unwrapped timestamp (us)
+    def unwrap(self, ts_raw):
+        if self.last_raw is None:
+            self.last_raw = ts_raw
+            self.last_unwrapped = ts_raw
+            return ts_raw
+
+        # Get the signed difference to the last timestamp so older events still map correctly
+        delta = (ts_raw - self.last_raw) % DEVICE_TS_WRAP
+        if delta >= DEVICE_TS_WRAP // 2:
+            delta -= DEVICE_TS_WRAP
+        ts_unwrapped = self.last_unwrapped + delta
+
+        # Only move forward in time
+        if delta > 0:
+            self.last_raw = ts_raw
+            self.last_unwrapped = ts_unwrapped
+        return ts_unwrapped
+
+
+# Class to estimate the offset and drift between the device and host clocks (NTP-style)
+class ClockSync:
+    def __init__(self, max_samples=64):
+        self.max_samples = max_samples  # Number of ping samples kept for the fit
+        self.samples = []  # List of (host_mid, offset, delay) tuples in seconds
+        self.offset = 0.0  # Device minus host time at host time 0 (s)
+        self.drift = 0.0  # Device clock rate error relative to the host clock
+        self.unwrapper = DeviceTimeUnwrapper()
+
+    # Method to get the host clock used for all timestamps (s)
+    @staticmethod
+    def host_time():
+        return time.perf_counter()
+
+    # Method to add a ping exchange
+    #   t0: Host send time (s)
+    #   t1_us: Device receive timestamp (us)
+    #   t2_us: Device send timestamp (us)
+    #   t3: Host receive time (s)
+    def add_sample(self, t0, t1_us, t2_us, t3):
+        t1 = self.unwrapper.unwrap(t1_us) / 1e6
+        t2 = self.unwrapper.unwrap(t2_us) / 1e6
+        offset = ((t1 - t0) + (t2 - t3)) / 2
+        delay = (t3 - t0) - (t2 - t1)
+        self.samples.append(((t0 + t3) / 2, offset, delay))
+        self.samples = self.samples[-self.max_samples:]
+        self._fit()
+
+    # Method to fit offset and drift to the samples with the lowest round trip delay
+    def _fit(self):
+        delays = sorted(s[2] for s in self.samples)
+        max_delay = delays[(len(delays) - 1) // 2]
+        best = [s for s in self.samples if s[2] <= max_delay]
+
+        # Use the mean offset until there is enough host time spread for a drift estimate
+        n = len(best)
+        x_mean = sum(s[0] for s in best) / n
+        y_mean = sum(s[1] for s in best) / n
+        sxx = sum((s[0] - x_mean) ** 2 for s in best)
+        if n < 2 or sxx < 1e-6:
+            self.drift = 0.0
+        else:
+            self.drift = sum((s[0] - x_mean) * (s[1] - y_mean) for s in best) / sxx
+        self.offset = y_mean - self.drift * x_mean
+
+    # Method to check if at least one ping exchange has been added
+    def is_synced(self):
+        return len(self.samples) > 0
+
+    # Method to get the expected round trip delay of the best samples (s)
+    def min_delay(self):
+        return min(s[2] for s in self.samples) if self.samples else None
+
+    # Method to convert a raw device timestamp (us) to host time (s)
+    def device_to_host(self, ts_us):
+        t_dev = self.unwrapper.unwrap(ts_us) / 1e6
+        return (t_dev - self.offset) / (1 + self.drift)
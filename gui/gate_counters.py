@@ -0,0 +1,61 @@
+# Import necessary modules
+import argparse
+import struct
+
+from gate_profile import START_BYTE, END_BYTE, read_reply
+
+MSG_TYPE_COUNTERS = 11
+
+
+# Function to decode the reply of the performance counters message
+def decode_counters(data):
+    cnt = {}
+    (cnt['loop_iterations'], cnt['rx_frames'], cnt['rx_rejected'], cnt['tx_frames'], cnt['rx_high_water'],
+     cnt['tx_high_water'], cnt['moves'], cnt['poll_passes'], cnt['poll_passes_last_move'], cnt['poll_passes_max'],
+     cnt['log_high_water'], cnt['log_dropped'], cnt['log_suppressed'],
+     cnt['log_over_budget']) = struct.unpack_from("<4I2H2I6H", data, 0)
+    pos = struct.calcsize("<4I2H2I6H")
+
+    # Per chip I2C counters, the last entry is for all other addresses
+    n_chips = data[pos]
+    pos += 1
+    cnt['i2c'] = []
+    for chip_i in range(n_chips + 1):
+        trans, n_bytes, nack, timeout, err = struct.unpack_from("<2I3H", data, pos)
+        pos += 14
+        cnt['i2c'].append(dict(chip=chip_i if chip_i < n_chips else 'other', transactions=trans, bytes=n_bytes,
+                               nack=nack, timeout=timeout, error=err))
+    return cnt
+
+
+# Function to request the performance counters
+def read_counters(ser, do_reset=False):
+    data = bytes([int(do_reset)])
+    ser.write(bytes([START_BYTE, MSG_TYPE_COUNTERS, len(data)]) + data + bytes([sum(data) % 256, END_BYTE]))
+    return decode_counters(read_reply(ser, MSG_TYPE_COUNTERS))
+
+
+# Function to print the performance counters
+def print_counters(cnt):
+    for key, val in cnt.items():
+        if key != 'i2c':
+            print(f"{key:<24}{val:>10}")
+    print(f"\n{'chip':<8}{'transactions':>14}{'bytes':>12}{'nack':>8}{'timeout':>9}{'error':>8}")
+    for c in cnt['i2c']:
+        print(f"{c['chip']:<8}{c['transactions']:>14}{c['bytes']:>12}{c['nack']:>8}{c['timeout']:>9}{c['error']:>8}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Read the performance counters from the controller")
+    parser.add_argument("port", help="serial port of the controller")
+    parser.add_argument("--baud", type=int, default=115200, help="serial baud rate")
+    parser.add_argument("--reset", action="store_true", help="reset the counters after reading them")
+    args = parser.parse_args()
+
+    import serial
+    with serial.Serial(args.port, args.baud, timeout=1) as ser:
+        print_counters(read_counters(ser, args.reset))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,160 @@
+# Import necessary modules
+import argparse
+import csv
+import random
+import struct
+
+from gate_clock import ClockSync
+from gate_profile import START_BYTE, END_BYTE, read_reply
+
+MSG_TYPE_INIT = 0
+MSG_TYPE_GATE_INIT = 1
+MSG_TYPE_MOVE = 2
+MSG_TYPE_PING = 9
+MSG_TYPE_LATENCY = 16
+
+# Latency stamps layout matching the message type 16 reply:
+# [rx_start, rx_end] + GateOperation::getMoveTimes() [start, pwm_on, last_switch, pwm_off, end]
+STAMPS_FMT = "<7I"
+
+# Latency stages from the host send to the host receiving the move reply
+STAGES = ["transmit", "parse", "setup", "travel", "cutoff", "reply", "total"]
+STAGE_INFO = {
+    "transmit": "host send to device start byte",
+    "parse": "start byte to validated end byte",
+    "setup": "end byte to last PWM start write",
+    "travel": "last PWM start to last limit switch read",
+    "cutoff": "last limit switch read to last PWM cutoff write",
+    "reply": "last PWM cutoff to host reply received",
+    "total": "host send to host reply received",
+}
+
+
+# Function to send a SerialCom frame
+def send_frame(ser, msg_type, data=b""):
+    data = bytes(data)
+    ser.write(bytes([START_BYTE, msg_type, len(data)]) + data + bytes([sum(data) % 256, END_BYTE]))
+
+
+# Function to run ping exchanges and add them to the clock sync
+def sync_clock(ser, sync, n_pings):
+    for _ in range(n_pings):
+        t0 = sync.host_time()
+        send_frame(ser, MSG_TYPE_PING)
+        data, t2_us = read_reply(ser, MSG_TYPE_PING, with_ts=True)
+        t3 = sync.host_time()
+        sync.add_sample(t0, struct.unpack("<I", bytes(data[:4]))[0], t2_us, t3)
+
+
+# Function to get the difference of two device micros() timestamps (us)
+def dt_us(ts_a, ts_b):
+    return (ts_b - ts_a) % 2 ** 32
+
+
+# Function to run one move and return its stage latencies (ms), or None if no wall moved
+def run_move(ser, sync, wall_bytes):
+    t0 = sync.host_time()
+    send_frame(ser, MSG_TYPE_MOVE, wall_bytes)
+    reply = read_reply(ser, MSG_TYPE_MOVE)
+    t3 = sync.host_time()
+
+    send_frame(ser, MSG_TYPE_LATENCY)
+    rx_start, rx_end, ts_start, pwm_on, last_switch, pwm_off, ts_end = struct.unpack(STAMPS_FMT, bytes(read_reply(ser, MSG_TYPE_LATENCY)))
+
+    # Stamps from an earlier move are left when no wall had to move
+    if dt_us(rx_start, ts_start) >= 2 ** 31:
+        return None
+    lat = dict(
+        transmit=(sync.device_to_host(rx_start) - t0) * 1e3,
+        parse=dt_us(rx_start, rx_end) / 1e3,
+        setup=dt_us(rx_end, pwm_on) / 1e3,
+        travel=dt_us(pwm_on, last_switch) / 1e3,
+        cutoff=dt_us(last_switch, pwm_off) / 1e3,
+        reply=(t3 - sync.device_to_host(pwm_off)) * 1e3,
+        total=(t3 - t0) * 1e3,
+    )
+    lat["ok"] = bytes(reply) == bytes(wall_bytes)
+    return lat
+
+
+# Function to get a percentile of a sorted list
+def percentile(vals, pct):
+    if not vals:
+        return 0.0
+    return vals[min(len(vals) - 1, int(round(pct / 100 * (len(vals) - 1))))]
+
+
+# Function to print the latency percentiles of each stage
+def print_summary(rows):
+    print(f"\n{'stage':<10}{'p50':>10}{'p95':>10}{'p99':>10}{'max':>10}  (ms)")
+    for stage in STAGES:
+        vals = sorted(r[stage] for r in rows)
+        print(f"{stage:<10}{percentile(vals, 50):>10.3f}{percentile(vals, 95):>10.3f}"
+              f"{percentile(vals, 99):>10.3f}{vals[-1] if vals else 0:>10.3f}  {STAGE_INFO[stage]}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measure move latency from host command to wall reply, split into stages")
+    parser.add_argument("port", help="serial port of the controller or the gate_emulator pseudo-terminal")
+    parser.add_argument("--baud", type=int, default=115200, help="serial baud rate")
+    parser.add_argument("--trials", type=int, default=1000, help="number of random wall configurations to move to")
+    parser.add_argument("--seed", type=int, default=1, help="random seed for the wall configurations")
+    parser.add_argument("--sync-every", type=int, default=10, help="trials between clock sync pings")
+    parser.add_argument("--no-init", action="store_true", help="skip the chip and gate initialization")
+    parser.add_argument("--csv", metavar="FILE", help="write the latencies of each trial to a CSV file")
+    args = parser.parse_args()
+
+    import serial
+    with serial.Serial(args.port, args.baud, timeout=5) as ser:
+        ser.reset_input_buffer()
+
+        # Get the chips and set all walls to a known state
+        if args.no_init:
+            send_frame(ser, MSG_TYPE_MOVE, b"")
+            n_chips = len(read_reply(ser, MSG_TYPE_MOVE))
+        else:
+            send_frame(ser, MSG_TYPE_INIT)
+            n_chips = len(read_reply(ser, MSG_TYPE_INIT))
+            send_frame(ser, MSG_TYPE_GATE_INIT)
+            read_reply(ser, MSG_TYPE_GATE_INIT)
+        if n_chips == 0:
+            parser.error("no chips found")
+
+        # Sync the clocks, the first ping also waits for the walls to finish moving down
+        sync = ClockSync()
+        sync_clock(ser, sync, 16)
+        print(f"Chips[{n_chips}] clock sync delay[{sync.min_delay() * 1e3:.3f} ms], running {args.trials} trials")
+
+        rng = random.Random(args.seed)
+        rows = []
+        n_skipped = 0
+        n_failed = 0
+        for trial_i in range(args.trials):
+            wall_bytes = bytes(rng.randrange(256) for _ in range(n_chips))
+            lat = run_move(ser, sync, wall_bytes)
+            if lat is None:
+                n_skipped += 1
+            elif not lat["ok"]:
+                n_failed += 1
+            else:
+                lat["trial"] = trial_i
+                lat["walls"] = wall_bytes.hex()
+                rows.append(lat)
+            if (trial_i + 1) % args.sync_every == 0:
+                sync_clock(ser, sync, 1)
+            if (trial_i + 1) % 100 == 0:
+                print(f"  {trial_i + 1}/{args.trials}")
+
+    print(f"Moves[{len(rows)}] failed[{n_failed}] no_move[{n_skipped}]")
+    print_summary(rows)
+    if args.csv:
+        with open(args.csv, "w", newline="") as f:
+            writer = csv.DictWriter(f, fieldnames=["trial", "walls"] + STAGES, extrasaction="ignore")
+            writer.writeheader()
+            for r in rows:
+                writer.writerow({k: (f"{v:.3f}" if isinstance(v, float) else v) for k, v in r.items()})
+        print(f"Wrote {len(rows)} trials to {args.csv}")
+
+
+if __name__ == "__main__":
+    main()
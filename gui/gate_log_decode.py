@@ -0,0 +1,223 @@
+# Import necessary modules
+import argparse
+import codecs
+import json
+import os
+import re
+import struct
+import sys
+
+# Binary log record framing used by GateDebug::flushLog()
+LOG_SYNC_BYTE = 0xA5
+LOG_ID_DROPPED = 0
+LOG_ID_REPEATED = 1
+
+# SerialCom message types of the log channel
+MSG_TYPE_LOG = 12
+MSG_TYPE_LOG_SETUP = 13
+
+# Message type labels matching the GateDebug::MT enum
+MSG_TYPE_STR = ["HEAD1", "HEAD1A", "HEAD1B", "HEAD2", "INFO", "ERROR", "WARNING", "DEBUG"]
+
+# Default folder scanned for printMsg() format strings
+DEFAULT_SRC_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "arduino")
+
+# Regex for the format string literal passed to printMsg() or DB_PRINT_MSG()
+PRINT_MSG_RE = re.compile(r'(?:printMsg\s*\(|DB_PRINT_MSG\s*\([^,]+,)\s*[^,]+,\s*"((?:[^"\\]|\\.)*)"')
+
+# Regex for a C conversion specifier
+CONV_SPEC_RE = re.compile(r"%([-+ #0]*[0-9]*(?:\.[0-9]+)?)(l|h)?([diuxXcs%])")
+
+
+# Function to get the message ID of a format string (matches GateDebug::_getFmtInfo())
+def format_id(fmt):
+    h = 2166136261
+    for b in fmt.encode("latin-1"):
+        h ^= b
+        h = (h * 16777619) & 0xFFFFFFFF
+    fmt_id = (h >> 16) ^ (h & 0xFFFF)
+    return fmt_id + 2 if fmt_id <= LOG_ID_REPEATED else fmt_id
+
+
+# Function to build the message ID to format string table from the firmware sources
+def build_format_table(src_dirs):
+    table = {}
+    for src_dir in src_dirs:
+        for root, _, files in os.walk(src_dir):
+            for name in files:
+                if not name.endswith((".cpp", ".h", ".ino")):
+                    continue
+                with open(os.path.join(root, name), encoding="utf-8", errors="replace") as f:
+                    text = f.read()
+                for literal in PRINT_MSG_RE.findall(text):
+                    fmt = codecs.decode(literal, "unicode_escape")
+                    fmt_id = format_id(fmt)
+                    if fmt_id in table and table[fmt_id] != fmt:
+                        print(f"Warning: message ID {fmt_id:#06x} collision: {table[fmt_id]!r} and {fmt!r}",
+                              file=sys.stderr)
+                    table[fmt_id] = fmt
+    return table
+
+
+# Function to format a record's raw arguments with its format string
+def format_record(fmt, payload):
+    args = []
+    pos = 0
+    for _, length, conv in CONV_SPEC_RE.findall(fmt):
+        if conv == "%":
+            continue
+        if conv == "s":
+            n = payload[pos]
+            args.append(payload[pos + 1:pos + 1 + n].decode("latin-1"))
+            pos += 1 + n
+        elif length == "l":
+            val = struct.unpack_from("<I", payload, pos)[0]
+            args.append(val - 2 ** 32 if conv in "di" and val >= 2 ** 31 else val)
+            pos += 4
+        else:
+            val = struct.unpack_from("<H", payload, pos)[0]
+            args.append(val - 2 ** 16 if conv in "di" and val >= 2 ** 15 else val)
+            pos += 2
+        if len(args) == 8:
+            break
+
+    # Convert the C specifiers to Python ones and pad missing arguments
+    py_fmt = CONV_SPEC_RE.sub(lambda m: "%" + m.group(1) + ("d" if m.group(3) in "iu" else m.group(3))
+                              if m.group(3) != "%" else "%%", fmt)
+    n_spec = len([m for m in CONV_SPEC_RE.findall(fmt) if m[2] != "%"])
+    args += ["?"] * (n_spec - len(args))
+    try:
+        return py_fmt % tuple(args)
+    except (TypeError, ValueError):
+        return f"{fmt} {args}"
+
+
+# Function to split a byte stream into records [(msg_id, ts, msg_type, payload)]
+def parse_records(data):
+    records = []
+    i = 0
+    while i + 2 <= len(data):
+        if data[i] != LOG_SYNC_BYTE:
+            i += 1
+            continue
+        n = data[i + 1]
+        if i + 3 + n > len(data):
+            break
+        if n < 7:
+            i += 1
+            continue
+        rec = data[i + 2:i + 2 + n]
+        if sum(rec) % 256 != data[i + 2 + n]:
+            i += 1
+            continue
+        msg_id, ts, msg_type = struct.unpack_from("<HIB", rec)
+        records.append((msg_id, ts, msg_type, rec[7:]))
+        i += 3 + n
+    return records, data[i:]
+
+
+# Function to convert a record to a text line
+def decode_record(table, record):
+    msg_id, ts, msg_type, payload = record
+    if msg_id == LOG_ID_DROPPED:
+        text = "Log records dropped: %d" % struct.unpack_from("<H", payload)[0]
+    elif msg_id == LOG_ID_REPEATED:
+        site_id, n = struct.unpack_from("<2H", payload)
+        text = f"Message repeated {n} more times: {table.get(site_id, f'{site_id:#06x}')}"
+    elif msg_id in table:
+        text = format_record(table[msg_id], payload)
+    else:
+        text = f"Unknown message ID {msg_id:#06x} args[{payload.hex()}]"
+    type_str = MSG_TYPE_STR[msg_type] if msg_type < len(MSG_TYPE_STR) else str(msg_type)
+    return f"[{ts / 1e6:.6f}] [{type_str}] {text}"
+
+
+# Class to join the data of SerialCom log frames back into text lines
+class LogChannel:
+    def __init__(self, table=None):
+        self.table = table  # format table for binary records, None for text output
+        self.buff = b""
+
+    # Method to add the data of a log frame and return the completed lines
+    def feed(self, data):
+        self.buff += bytes(data)
+        if self.table is not None:
+            records, self.buff = parse_records(self.buff)
+            return [decode_record(self.table, record) for record in records]
+        *lines, self.buff = self.buff.split(b"\n")
+        return [line.decode("latin-1") for line in lines]
+
+
+# Function to build the log channel setup message (level [0-4], frames per second and bytes per second [0:no limit])
+def log_setup_message(level, rate=0, budget=None):
+    data = bytes([level, rate & 0xFF, rate >> 8])
+    if budget is not None:
+        data += bytes([budget & 0xFF, budget >> 8])
+    return bytes([0x02, MSG_TYPE_LOG_SETUP, len(data)]) + data + bytes([sum(data) % 256, 0x03])
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode GateDebug binary log records to text")
+    parser.add_argument("input", nargs="?", help="binary capture file (reads the serial port if omitted)")
+    parser.add_argument("--port", help="serial port to read records from")
+    parser.add_argument("--baud", type=int, default=115200, help="serial baud rate")
+    parser.add_argument("--src", action="append", help="firmware source folder to scan for format strings")
+    parser.add_argument("--table", help="format table JSON to use instead of scanning the sources")
+    parser.add_argument("--gen-table", metavar="FILE", help="write the format table JSON and exit")
+    parser.add_argument("--framed", action="store_true",
+                        help="read log output from SerialCom log frames on the protocol port")
+    parser.add_argument("--text", action="store_true", help="log frames carry text lines instead of binary records")
+    parser.add_argument("--level", type=int, help="with --framed, set the device log level [0-4] first")
+    parser.add_argument("--rate", type=int, default=0, help="with --level, most log frames per second [0:no limit]")
+    parser.add_argument("--budget", type=int, help="with --level, most log bytes per second [0:no limit]")
+    args = parser.parse_args()
+
+    # Get the format table
+    if args.table:
+        with open(args.table) as f:
+            table = {int(k, 0): v for k, v in json.load(f).items()}
+    else:
+        table = build_format_table(args.src or [DEFAULT_SRC_DIR])
+    if args.gen_table:
+        with open(args.gen_table, "w") as f:
+            json.dump({f"{k:#06x}": v for k, v in sorted(table.items())}, f, indent=2)
+        return
+
+    # Decode a capture file
+    if args.input:
+        with open(args.input, "rb") as f:
+            records, _ = parse_records(f.read())
+        for record in records:
+            print(decode_record(table, record))
+        return
+
+    # Decode records from the serial port as they arrive
+    if not args.port:
+        parser.error("either a capture file or --port is required")
+    import serial
+    ser = serial.Serial(args.port, args.baud, timeout=0.1)
+    buff = b""
+    try:
+        if args.framed:
+            from gate_profile import parse_frames
+            log_chan = LogChannel(None if args.text else table)
+            if args.level is not None:
+                ser.write(log_setup_message(args.level, args.rate, args.budget))
+            while True:
+                buff += ser.read(256)
+                frames, buff = parse_frames(buff)
+                for msg_type, data, _ in frames:
+                    if msg_type == MSG_TYPE_LOG:
+                        for line in log_chan.feed(data):
+                            print(line, flush=True)
+        while True:
+            buff += ser.read(256)
+            records, buff = parse_records(buff)
+            for record in records:
+                print(decode_record(table, record), flush=True)
+    except KeyboardInterrupt:
+        ser.close()
+
+
+if __name__ == "__main__":
+    main()
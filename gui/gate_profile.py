@@ -0,0 +1,111 @@
+# Import necessary modules
+import argparse
+import struct
+
+# Serial framing used by SerialCom
+START_BYTE = 0x02
+END_BYTE = 0x03
+MSG_TYPE_PROFILE = 10
+MSG_TYPE_LOG = 12
+
+# Profiling scope names matching the GateProfile::PS enum
+SCOPE_NAMES = ["I2C_SCAN", "I2C_READ", "I2C_WRITE", "CYP_SETUP", "IO_SETUP", "PWM_SETUP",
+               "MOVE_TOTAL", "MOVE_INIT", "POLL_PASS", "PWM_CUTOFF", "MSG_HANDLE"]
+
+# Histogram bin labels matching GateProfile::addSample()
+BIN_LABELS = ["<16us", "<64us", "<256us", "<1ms", "<4ms", "<16ms", "<66ms", ">=66ms"]
+
+
+# Function to split a byte stream into valid frames [(msg_type, data, ts)] and the unparsed remainder
+def parse_frames(buff):
+    frames = []
+    i = 0
+    while i + 3 <= len(buff):
+        if buff[i] != START_BYTE:
+            i += 1
+            continue
+        length = buff[i + 2]
+        end_i = i + 3 + length + 6
+        if end_i > len(buff):
+            break
+        data, ts = buff[i + 3:i + 3 + length], buff[i + 3 + length:i + 7 + length]
+        if buff[end_i - 1] != END_BYTE or (sum(data) + sum(ts) + buff[i + 1]) % 256 != buff[end_i - 2]:
+            i += 1
+            continue
+        frames.append((buff[i + 1], bytes(data), int.from_bytes(ts, "little")))
+        i = end_i
+    return frames, buff[i:]
+
+
+# Function to read one reply frame and return its data (device timestamp removed, or (data, ts) if "with_ts")
+# Log frames are passed to "on_log" if given and skipped otherwise
+def read_reply(ser, msg_type, on_log=None, with_ts=False):
+    while True:
+        head = ser.read(3)
+        if len(head) < 3:
+            raise TimeoutError("no reply from device")
+        if head[0] != START_BYTE:
+            continue
+        length = head[2]
+        rest = ser.read(length + 4 + 2)
+        if len(rest) < length + 6 or rest[-1] != END_BYTE:
+            continue
+        data, ts = rest[:length], rest[length:length + 4]
+        if (sum(data) + sum(ts) + head[1]) % 256 != rest[length + 4]:
+            continue
+        if head[1] == MSG_TYPE_LOG and on_log is not None:
+            on_log(data)
+        elif head[1] == msg_type:
+            return (data, int.from_bytes(ts, "little")) if with_ts else data
+
+
+# Function to decode a packed scope from GateProfile::getScopeBytes()
+def decode_scope(data):
+    scope, n_scopes = data[0], data[1]
+    count, dt_min, dt_max, dt_sum = struct.unpack_from("<4I", data, 2)
+    hist = struct.unpack_from("<8H", data, 18)
+    return scope, n_scopes, dict(count=count, min=dt_min, max=dt_max,
+                                 mean=dt_sum / count if count else 0.0, hist=hist)
+
+
+# Function to request the profiling table and return a list of (name, stats) tuples
+def read_profile(ser, do_reset=False):
+    data = bytes([int(do_reset)])
+    ser.write(bytes([START_BYTE, MSG_TYPE_PROFILE, len(data)]) + data + bytes([sum(data) % 256, END_BYTE]))
+
+    scopes = []
+    n_scopes = 1
+    while len(scopes) < n_scopes:
+        scope, n_scopes, stats = decode_scope(read_reply(ser, MSG_TYPE_PROFILE))
+        if n_scopes == 0:
+            break
+        name = SCOPE_NAMES[scope] if scope < len(SCOPE_NAMES) else f"SCOPE_{scope}"
+        scopes.append((name, stats))
+    return scopes
+
+
+# Function to print the profiling table
+def print_profile(scopes):
+    if not scopes:
+        print("Profiling is disabled in the firmware (DB_PROFILE=0), upload the megaatmega2560_debug env")
+        return
+    print(f"{'scope':<12}{'count':>9}{'min':>9}{'mean':>11}{'max':>9}  " + " ".join(f"{b:>7}" for b in BIN_LABELS))
+    for name, st in scopes:
+        print(f"{name:<12}{st['count']:>9}{st['min']:>9}{st['mean']:>11.1f}{st['max']:>9}  " +
+              " ".join(f"{h:>7}" for h in st["hist"]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Read the GateProfile timing table (us) from the controller")
+    parser.add_argument("port", help="serial port of the controller")
+    parser.add_argument("--baud", type=int, default=115200, help="serial baud rate")
+    parser.add_argument("--reset", action="store_true", help="reset the table after reading it")
+    args = parser.parse_args()
+
+    import serial
+    with serial.Serial(args.port, args.baud, timeout=1) as ser:
+        print_profile(read_profile(ser, args.reset))
+
+
+if __name__ == "__main__":
+    main()
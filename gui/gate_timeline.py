@@ -0,0 +1,140 @@
+# Import necessary modules
+import argparse
+import json
+import struct
+
+from gate_profile import START_BYTE, END_BYTE, read_reply
+
+MSG_TYPE_TIMELINE = 15
+
+# Span record layout matching GateProfile::getSpanBytes()
+REC_FMT = "<I2B"
+REC_SIZE = struct.calcsize(REC_FMT)
+SK_BEGIN = 0
+SK_END = 1
+
+# Spans matching the GateProfile::SP enum
+SPAN_NAMES = ["move", "chip init", "poll pass", "chip poll", "wall travel", "pwm cutoff", "reply", "message"]
+SP_MOVE, SP_CHIP_INIT, SP_POLL_PASS, SP_CHIP_POLL, SP_WALL_TRAVEL, SP_PWM_CUTOFF, SP_REPLY_TX, SP_MSG = range(8)
+
+
+# Function to request the timeline dump and return the raw record bytes, oldest first
+def read_timeline(ser, do_reset=False):
+    data = bytes([int(do_reset)])
+    ser.write(bytes([START_BYTE, MSG_TYPE_TIMELINE, len(data)]) + data + bytes([sum(data) % 256, END_BYTE]))
+
+    raw = b""
+    n_frames = 1
+    frame_i = 0
+    while frame_i < n_frames:
+        reply = read_reply(ser, MSG_TYPE_TIMELINE)
+        frame_i, n_frames, n_recs = reply[0] + 1, reply[1], reply[2]
+        raw += bytes(reply[3:3 + n_recs * REC_SIZE])
+    return raw
+
+
+# Function to unpack raw span records into (ts_us, kind, span, arg) tuples with unwrapped timestamps
+def decode_records(raw):
+    records = []
+    ts_last = None
+    ts_add = 0
+    for pos in range(0, len(raw) - REC_SIZE + 1, REC_SIZE):
+        ts, code, arg = struct.unpack_from(REC_FMT, raw, pos)
+        if ts_last is not None and ts < ts_last:
+            ts_add += 2 ** 32  # micros() wrapped
+        ts_last = ts
+        records.append((ts + ts_add, code >> 6, code & 0x3F, arg))
+    return records
+
+
+# Function to get the track (thread) id and name of a span, spans of a chip or wall get their own track
+def span_track(span, arg):
+    if span == SP_WALL_TRAVEL:
+        chip, wall = arg >> 3, arg & 0x07
+        return 1000 + arg, f"chip {chip} wall {wall}"
+    if span in (SP_CHIP_INIT, SP_CHIP_POLL, SP_PWM_CUTOFF):
+        return 100 + arg, f"chip {arg}"
+    return 0, "controller"
+
+
+# Function to get the display name of a span
+def span_name(span, arg):
+    name = SPAN_NAMES[span] if span < len(SPAN_NAMES) else f"span {span}"
+    if span == SP_WALL_TRAVEL:
+        return f"{name} {arg >> 3}.{arg & 0x07}"
+    if span in (SP_REPLY_TX, SP_MSG):
+        return f"{name} {arg}"
+    return name
+
+
+# Function to convert span records to trace-event JSON (complete "X" events in microseconds)
+def to_trace_events(records):
+    events = []
+    tracks = {}
+    open_spans = {}
+    ts_0 = records[0][0] if records else 0
+    for ts, kind, span, arg in records:
+        key = (span, arg)
+        if kind == SK_BEGIN:
+            open_spans.setdefault(key, []).append(ts)
+            continue
+        if not open_spans.get(key):
+            continue  # begin record was overwritten in the ring buffer
+        ts_begin = open_spans[key].pop()
+        tid, track_name = span_track(span, arg)
+        tracks[tid] = track_name
+        events.append(dict(name=span_name(span, arg), cat=SPAN_NAMES[span] if span < len(SPAN_NAMES) else "span",
+                           ph="X", ts=ts_begin - ts_0, dur=ts - ts_begin, pid=0, tid=tid, args=dict(arg=arg)))
+
+        # Close walls still traveling at the end of a move as failed
+        if span == SP_MOVE:
+            for (o_span, o_arg), starts in open_spans.items():
+                if o_span != SP_WALL_TRAVEL:
+                    continue
+                for o_ts in starts:
+                    tid, track_name = span_track(o_span, o_arg)
+                    tracks[tid] = track_name
+                    events.append(dict(name=span_name(o_span, o_arg) + " (failed)", cat="wall travel", ph="X",
+                                       ts=o_ts - ts_0, dur=ts - o_ts, pid=0, tid=tid, args=dict(arg=o_arg)))
+                starts.clear()
+
+    # Add process and track names
+    meta = [dict(name="process_name", ph="M", pid=0, args=dict(name="cypress_gate_controller"))]
+    for tid, track_name in sorted(tracks.items()):
+        meta.append(dict(name="thread_name", ph="M", pid=0, tid=tid, args=dict(name=track_name)))
+        meta.append(dict(name="thread_sort_index", ph="M", pid=0, tid=tid, args=dict(sort_index=tid)))
+    return dict(traceEvents=meta + sorted(events, key=lambda e: e["ts"]), displayTimeUnit="ms")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert the GateProfile move timeline to trace-event JSON")
+    parser.add_argument("input", nargs="?", help="binary timeline dump file (reads the serial port if omitted)")
+    parser.add_argument("--port", help="serial port of the controller")
+    parser.add_argument("--baud", type=int, default=115200, help="serial baud rate")
+    parser.add_argument("--reset", action="store_true", help="clear the timeline after reading it")
+    parser.add_argument("--save", metavar="FILE", help="write the binary timeline dump to a file")
+    parser.add_argument("-o", "--output", default="gate_timeline.json", help="trace-event JSON output file")
+    args = parser.parse_args()
+
+    # Get the raw timeline from a dump file or the controller
+    if args.input:
+        with open(args.input, "rb") as f:
+            raw = f.read()
+    elif args.port:
+        import serial
+        with serial.Serial(args.port, args.baud, timeout=1) as ser:
+            raw = read_timeline(ser, args.reset)
+    else:
+        parser.error("either a dump file or --port is required")
+    if args.save:
+        with open(args.save, "wb") as f:
+            f.write(raw)
+
+    trace = to_trace_events(decode_records(raw))
+    with open(args.output, "w") as f:
+        json.dump(trace, f)
+    print(f"Wrote {len(trace['traceEvents'])} events to {args.output} (open in chrome://tracing or ui.perfetto.dev)")
+
+
+if __name__ == "__main__":
+    main()
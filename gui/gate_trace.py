@@ -0,0 +1,139 @@
+# Import necessary modules
+import argparse
+import csv
+import struct
+import sys
+
+from gate_profile import START_BYTE, END_BYTE, read_reply
+
+MSG_TYPE_TRACE = 14
+
+# Trace entry layout matching CypressCom::getTraceBytes()
+ENTRY_FMT = "<5B2I"
+ENTRY_SIZE = struct.calcsize(ENTRY_FMT)
+
+# Transaction type labels matching the CypressCom::TR enum
+DIR_STR = ["W", "R", "PROBE"]
+
+# Status labels matching the Wire::endTransmission() codes
+STATUS_STR = ["ok", "too_long", "nack_addr", "nack_data", "error", "timeout"]
+
+
+# Function to get the status label of a trace entry, status 1 of a read is a short read
+def status_str(e):
+    if e['dir'] == 1 and e['status'] == 1:
+        return "short_read"
+    return STATUS_STR[e['status']] if e['status'] < len(STATUS_STR) else str(e['status'])
+
+
+# Column names of the CSV output
+CSV_FIELDS = ["i", "addr", "reg", "dir", "len", "status", "start_us", "end_us", "dur_us", "gap_us"]
+
+
+# Function to unpack raw trace entries into a list of dicts, times are relative to the first entry
+def decode_entries(raw):
+    entries = []
+    for pos in range(0, len(raw) - ENTRY_SIZE + 1, ENTRY_SIZE):
+        addr, reg, direction, length, status, ts_start, ts_end = struct.unpack_from(ENTRY_FMT, raw, pos)
+        entries.append(dict(addr=addr, reg=reg, dir=direction, len=length, status=status,
+                            ts_start=ts_start, ts_end=ts_end))
+
+    # Convert the micros() timestamps, which wrap every ~71 minutes, to offsets from the first entry
+    ts_0 = entries[0]['ts_start'] if entries else 0
+    end_last = None
+    for i, e in enumerate(entries):
+        e['i'] = i
+        e['start_us'] = (e['ts_start'] - ts_0) % 2 ** 32
+        e['dur_us'] = (e['ts_end'] - e['ts_start']) % 2 ** 32
+        e['end_us'] = e['start_us'] + e['dur_us']
+        e['gap_us'] = e['start_us'] - end_last if end_last is not None else 0
+        end_last = e['end_us']
+    return entries
+
+
+# Function to request the trace dump and return the raw entry bytes, oldest first
+def read_trace(ser, do_reset=False):
+    data = bytes([int(do_reset)])
+    ser.write(bytes([START_BYTE, MSG_TYPE_TRACE, len(data)]) + data + bytes([sum(data) % 256, END_BYTE]))
+
+    raw = b""
+    n_frames = 1
+    frame_i = 0
+    while frame_i < n_frames:
+        reply = read_reply(ser, MSG_TYPE_TRACE)
+        frame_i, n_frames, n_entries = reply[0] + 1, reply[1], reply[2]
+        raw += bytes(reply[3:3 + n_entries * ENTRY_SIZE])
+    return raw
+
+
+# Function to write the trace entries as CSV
+def write_csv(entries, f):
+    writer = csv.DictWriter(f, fieldnames=CSV_FIELDS, extrasaction="ignore")
+    writer.writeheader()
+    for e in entries:
+        row = dict(e)
+        row['addr'] = f"{e['addr']:#04x}"
+        row['reg'] = f"{e['reg']:#04x}"
+        row['dir'] = DIR_STR[e['dir']] if e['dir'] < len(DIR_STR) else e['dir']
+        row['status'] = status_str(e)
+        writer.writerow(row)
+
+
+# Function to print the trace entries as a text timeline with slow transactions flagged
+def print_timeline(entries, width=50, slow_factor=4.0):
+    if not entries:
+        print("Trace is empty (the megaatmega2560 env builds without it, upload megaatmega2560_debug)")
+        return
+    durations = sorted(e['dur_us'] for e in entries)
+    median = durations[len(durations) // 2]
+    t_total = max(entries[-1]['end_us'], 1)
+    print(f"{len(entries)} transactions over {t_total} us, median {median} us")
+    print(f"{'start':>10}{'dur':>7}{'gap':>8}  {'addr':<5}{'dir':<6}{'reg':<5}{'len':>3} {'status':<10}")
+    for e in entries:
+        col_0 = e['start_us'] * width // t_total
+        col_n = max(1, e['dur_us'] * width // t_total)
+        bar = " " * col_0 + "#" * col_n
+        flag = " << slow" if median and e['dur_us'] > slow_factor * median else ""
+        flag = " << failed" if e['status'] != 0 else flag
+        dir_str = DIR_STR[e['dir']] if e['dir'] < len(DIR_STR) else str(e['dir'])
+        print(f"{e['start_us']:>10}{e['dur_us']:>7}{e['gap_us']:>8}  {e['addr']:#04x} {dir_str:<6}{e['reg']:#04x} "
+              f"{e['len']:>3} {status_str(e):<10}|{bar:<{width}}|{flag}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Dump the CypressCom I2C transaction trace and convert it to CSV or a timeline")
+    parser.add_argument("input", nargs="?", help="binary trace dump file (reads the serial port if omitted)")
+    parser.add_argument("--port", help="serial port of the controller")
+    parser.add_argument("--baud", type=int, default=115200, help="serial baud rate")
+    parser.add_argument("--reset", action="store_true", help="clear the trace after reading it")
+    parser.add_argument("--save", metavar="FILE", help="write the binary trace dump to a file")
+    parser.add_argument("--csv", metavar="FILE", help="write the trace as CSV ('-' for stdout)")
+    parser.add_argument("--slow", type=float, default=4.0, help="flag transactions slower than this factor of the median")
+    args = parser.parse_args()
+
+    # Get the raw trace from a dump file or the controller
+    if args.input:
+        with open(args.input, "rb") as f:
+            raw = f.read()
+    elif args.port:
+        import serial
+        with serial.Serial(args.port, args.baud, timeout=1) as ser:
+            raw = read_trace(ser, args.reset)
+    else:
+        parser.error("either a dump file or --port is required")
+    if args.save:
+        with open(args.save, "wb") as f:
+            f.write(raw)
+
+    entries = decode_entries(raw)
+    if args.csv == "-":
+        write_csv(entries, sys.stdout)
+    elif args.csv:
+        with open(args.csv, "w", newline="") as f:
+            write_csv(entries, f)
+    else:
+        print_timeline(entries, slow_factor=args.slow)
+
+
+if __name__ == "__main__":
+    main()
@@ -12,6 +12,9 @@ from datetime import datetime
 import serial
 import serial.tools.list_ports
 import time
+from gate_clock import ClockSync
+from gate_profile import parse_frames
+from gate_log_decode import LogChannel, MSG_TYPE_LOG
 
 # Define the main application class inheriting from QMainWindow
 
@@ -55,6 +58,8 @@ class GateControlApp(QMainWindow):
         self.timer_check_serial = QTimer(self)
         self.timer_check_serial.timeout.connect(self.check_receive_serial)
         self.pending_message = None
+        self.rx_buff = b""  # received bytes not yet parsed into frames
+        self.log_channel = LogChannel()  # joins debug log frames into text lines
 
         # Define start and end bytes
         self.START_BYTE = b'\x02'  # Start byte
@@ -78,21 +83,44 @@ class GateControlApp(QMainWindow):
         #       0: Initialize cypress
         #       1: Initialize gates
         #       2: Move gates
+        #       3: Move gates (compact, only changed cypress chips are sent and returned),
+        #          reply [255] if the length does not match the chip bitmap
+        #       4: Store maze configuration [index, wall bytes...], reply [index, status]
+        #          status 0: stored, 255: bad or missing index or too many chips
+        #       5: Apply maze configuration [index] or [index, 1] to arm it for GO, reply
+        #          [status] followed by the compact changed walls when moving immediately
+        #          status 0: no walls to move, 1: moved (armed), 2: empty configuration
+        #          (I2C error when arming), 3: table stored with another EEPROM layout,
+        #          255: bad or missing index
+        #       6: Arm a compact move for GO, reply [status] 0: no walls to move, 1: armed,
+        #          2: I2C error, 255: bad data (a move armed before is kept)
+        #       7: GO (also the single unframed byte 0x07), reply [status, latency (4), compact
+        #          changed walls], status 0: not armed, 1: moved, 2: I2C error, 3: timeout
+        #       9: Clock sync ping
         #   'data': List of integers representing the data associated with the message.
         #       Initialized with a list of 100 zeros.
         #   'length': Integer indicating the length of the data.
         #       Initialized to 0.
+        #   'ts_device': Integer device micros() timestamp added to every Arduino reply.
+        #   'ts_host': Float host time (s) of 'ts_device' once the clocks are synced, else None.
         self.message_data = {
             'msg_type': 0,            # Initialize with default values
             'data': [0] * 100,        # Initialize with a list of 100 zeros
-            'length': 0
+            'length': 0,
+            'ts_device': 0,
+            'ts_host': None
         }
 
+        # Setup host-device clock synchronization
+        self.clock_sync = ClockSync()
+        self.CLOCK_SYNC_PINGS = 8  # Number of ping exchanges per sync
+
         # Initialize a list for storing cypress configuration data
         # This list will contain dictionaries, each representing an entry with:
         #   'i2c_addr': Hex of the I2C address associated with the entry.
         #   'enabled_gates': List of integers for the enabled gates for the entry.
         #   'active_gates': List of integers for the active (up) gates for the entry.
+        #   'wall_position': Byte of the last wall positions reported by the Arduino.
         self.cypress_list = []
 
     # Method to initialize the UI
@@ -193,8 +221,10 @@ class GateControlApp(QMainWindow):
             print(
                 f"Send move command for Cypress {i} Gates {active_gates_array}")
 
-        # Send the gate configuration message
-        self.send_serial(2, active_gates_byte_array)
+        # Send the compact gate configuration message with only the changed cypress chips
+        self.send_serial(3, self.encode_chip_delta(
+            active_gates_byte_array,
+            [entry['wall_position'] for entry in self.cypress_list]))
 
     # Method to handle the window close event
     def closeEvent(self, event):
@@ -290,54 +320,78 @@ class GateControlApp(QMainWindow):
     # Method to check for a response from the Arduino
     def check_receive_serial(self):
         if self.arduino and self.arduino.in_waiting:
-            message = self.arduino.read_all()  # Read the response as bytes
-
-            # Check for start and end bytes
-            if message and message[0:1] == self.START_BYTE and message[-1:] == self.END_BYTE:
-                # Extract the message type byte and store it in the dictionary
-                self.message_data['msg_type'] = int.from_bytes(
-                    message[1:2], 'little')
-
-                # Extract the length byte and store it in the dictionary
-                self.message_data['length'] = int.from_bytes(
-                    message[2:3], 'little')
-
-                # Extract the data bytes and store them in the dictionary
-                self.message_data['data'] = list(
-                    message[3:3+self.message_data['length']])
-
-                # Extract the checksum byte
-                checksum_byte = message[3+self.message_data['length']]
-
-                # Verify checksum
-                checksum_calculated = (
-                    sum(self.message_data['data']) + self.message_data['msg_type']) % 256
-                if checksum_byte == checksum_calculated:
-
-                    # Update variables
-                    self.timer_check_serial.stop()  # Stop the timer if a valid response is received
-                    self.timeout_timer.stop()  # Stop the timeout timer
-                    self.pending_message = None  # Clear the pending message
-
-                    # Process the received message
-                    self.proc_receive_message()
-
-                    # Uncomment to print the received message
-                    print(f"Received response from Arduino:")
-                    print(f"  Start Byte: {self.START_BYTE}")
-                    print(f"  Message Type Byte: {
-                          self.message_data['msg_type']}")
-                    print(f"  Length Byte: {self.message_data['length']}")
-                    print(f"  Data Bytes: {[hex(byte)
-                          for byte in self.message_data['data']]}")
-                    print(f"  Checksum Byte: {checksum_byte}")
-                    print(f"  End Byte: {self.END_BYTE}")
-                    print(f"  Full Message: {[byte for byte in message]}")
-                else:
-                    print(f"Invalid checksum. Expected: {
-                          checksum_byte}, Calculated: {checksum_calculated}")
-            else:
-                print(f"Invalid response format: {message}")
+            # Split the received bytes into frames, keeping any partial frame for the next check
+            self.rx_buff += self.arduino.read_all()
+            frames, self.rx_buff = parse_frames(self.rx_buff)
+
+            for msg_type, data, ts_device in frames:
+                # Print debug log frames and wait for the actual response
+                if msg_type == MSG_TYPE_LOG:
+                    for line in self.log_channel.feed(data):
+                        print(f"[ARDUINO] {line}")
+                    continue
+
+                # Store the message fields in the dictionary
+                self.message_data['msg_type'] = msg_type
+                self.message_data['length'] = len(data)
+                self.message_data['data'] = list(data)
+                self.message_data['ts_device'] = ts_device
+                self.message_data['ts_host'] = self.clock_sync.device_to_host(
+                    ts_device) if self.clock_sync.is_synced() else None
+
+                # Update variables
+                self.timer_check_serial.stop()  # Stop the timer if a valid response is received
+                self.timeout_timer.stop()  # Stop the timeout timer
+                self.pending_message = None  # Clear the pending message
+
+                # Process the received message
+                self.proc_receive_message()
+
+                # Uncomment to print the received message
+                print(f"Received response from Arduino:")
+                print(f"  Message Type Byte: {self.message_data['msg_type']}")
+                print(f"  Length Byte: {self.message_data['length']}")
+                print(f"  Data Bytes: {[hex(byte) for byte in self.message_data['data']]}")
+                print(f"  Device Timestamp: {self.message_data['ts_device']} us")
+
+    # Method to estimate the host-device clock offset and drift with blocking ping exchanges
+    def sync_clock(self):
+        if not (self.arduino and self.arduino.isOpen()):
+            return
+
+        # Ping message bytes: start byte, type 9, length 0, checksum 0, end byte
+        ping = self.START_BYTE + bytes([9, 0, 0]) + self.END_BYTE
+        for _ in range(self.CLOCK_SYNC_PINGS):
+            t0 = self.clock_sync.host_time()
+            self.arduino.write(ping)
+            reply = self.read_ping_reply()  # Reply is 4 data bytes plus the send timestamp
+            t3 = self.clock_sync.host_time()
+            if reply is None:
+                print("Clock sync ping failed")
+                continue
+            data, t2_us = reply
+            t1_us = int.from_bytes(data, 'little')
+            self.clock_sync.add_sample(t0, t1_us, t2_us, t3)
+
+        if self.clock_sync.is_synced():
+            print(f"Clock sync: offset[{self.clock_sync.offset:.6f} s] drift[{self.clock_sync.drift * 1e6:.1f} ppm] "
+                  f"delay[{self.clock_sync.min_delay() * 1e3:.3f} ms]")
+
+    # Method to read a clock sync ping reply, passing any log frames received first to the log channel
+    def read_ping_reply(self):
+        buff = b""
+        while True:
+            chunk = self.arduino.read(13)  # Size of the ping reply frame
+            if not chunk:
+                return None
+            buff += chunk
+            frames, buff = parse_frames(buff)
+            for msg_type, data, ts_device in frames:
+                if msg_type == MSG_TYPE_LOG:
+                    for line in self.log_channel.feed(data):
+                        print(f"[ARDUINO] {line}")
+                elif msg_type == 9 and len(data) == 4:
+                    return data, ts_device
 
     # Method to handle timeout
 
@@ -356,6 +410,9 @@ class GateControlApp(QMainWindow):
         # Process initialize system message
         if self.message_data['msg_type'] == 0:
 
+            # Sync the host and device clocks now that the Arduino is responding
+            self.sync_clock()
+
             # Loop through the received data
             for i in range(self.message_data['length']):
                 # Store the active I2C addresses
@@ -363,7 +420,8 @@ class GateControlApp(QMainWindow):
                     # Set i2c_addr to the value from data
                     'i2c_addr': self.message_data['data'][i],
                     'enabled_gates': [],  # Initialize entry
-                    'active_gates': []  # Initialize entry
+                    'active_gates': [],  # Initialize entry
+                    'wall_position': 0  # Initialize entry
                 }
                 self.cypress_list.append(entry)
 
@@ -405,43 +463,90 @@ class GateControlApp(QMainWindow):
         elif self.message_data['msg_type'] == 2:
 
             # Loop through the received data
+            mismatched = False
             for i in range(self.message_data['length']):
-                # Get the returned gate states
-                gate_state = set(self.byte_2_ind_array(
-                    self.message_data['data'][i]))
-
-                # Get a list of gates that should be active
-                active_gates = set(self.cypress_list[i]['active_gates'])
-
-                # Set all buttons to light green
-                for gate in active_gates:
-                    self.widget_groups[i]['buttons'][gate].setStyleSheet(
-                        "background-color: lightgreen;")
-
-                # Find mismatched gates
-                mismatched_gates = list(
-                    (active_gates - gate_state) | (gate_state - active_gates))
-
-                # Flag and print mismatched gates
-                for gate in mismatched_gates:
-                    # Print the error message
-                    # Print the error message
-                    print(f"ERROR: Gate {gate} for Cypress {i} was not moved.")
-                    self.ui_widget.error_label.setText(
-                        "ERROR: Gate move failed")  # Display the error message
-                    # Make the button red
-                    self.widget_groups[i]['buttons'][gate].setStyleSheet(
-                        "background-color: red;")
-                    # Reset the button to it's previous state
-                    if self.widget_groups[i]['buttons'][gate].isChecked():
-                        self.widget_groups[i]['buttons'][gate].setChecked(
-                            False)
-                    else:
-                        self.widget_groups[i]['buttons'][gate].setChecked(True)
-
-                # Clear the error if no mismatched gates
-                if not mismatched_gates:
-                    self.ui_widget.error_label.setText("")
+                # Store and check the returned gate states
+                self.cypress_list[i]['wall_position'] = self.message_data['data'][i]
+                mismatched = self.check_gate_states(i) or mismatched
+
+            # Clear the error if no mismatched gates
+            if not mismatched:
+                self.ui_widget.error_label.setText("")
+
+        # Process compact move gates message
+        elif self.message_data['msg_type'] == 3:
+
+            # Update the wall positions of the cypress chips that changed
+            changed = self.decode_chip_delta(
+                self.message_data['data'], len(self.cypress_list))
+            for i, wall_position in changed.items():
+                self.cypress_list[i]['wall_position'] = wall_position
+
+            # Check the gate states of all cypress chips
+            mismatched = False
+            for i in range(len(self.cypress_list)):
+                mismatched = self.check_gate_states(i) or mismatched
+
+            # Clear the error if no mismatched gates
+            if not mismatched:
+                self.ui_widget.error_label.setText("")
+
+    # Method to compare the reported wall positions of a cypress chip with its active gates
+    def check_gate_states(self, i):
+        # Get the returned gate states
+        gate_state = set(self.byte_2_ind_array(
+            self.cypress_list[i]['wall_position']))
+
+        # Get a list of gates that should be active
+        active_gates = set(self.cypress_list[i]['active_gates'])
+
+        # Set all buttons to light green
+        for gate in active_gates:
+            self.widget_groups[i]['buttons'][gate].setStyleSheet(
+                "background-color: lightgreen;")
+
+        # Find mismatched gates
+        mismatched_gates = list(
+            (active_gates - gate_state) | (gate_state - active_gates))
+
+        # Flag and print mismatched gates
+        for gate in mismatched_gates:
+            # Print the error message
+            print(f"ERROR: Gate {gate} for Cypress {i} was not moved.")
+            self.ui_widget.error_label.setText(
+                "ERROR: Gate move failed")  # Display the error message
+            # Make the button red
+            self.widget_groups[i]['buttons'][gate].setStyleSheet(
+                "background-color: red;")
+            # Reset the button to it's previous state
+            if self.widget_groups[i]['buttons'][gate].isChecked():
+                self.widget_groups[i]['buttons'][gate].setChecked(
+                    False)
+            else:
+                self.widget_groups[i]['buttons'][gate].setChecked(True)
+
+        return len(mismatched_gates) > 0
+
+    # Method to build the compact move data: a chip bitmap followed by the wall byte of each changed chip
+    def encode_chip_delta(self, wall_bytes, last_wall_bytes):
+        chip_map = [0] * ((len(wall_bytes) + 7) // 8)
+        changed = []
+        for i, wall_byte in enumerate(wall_bytes):
+            if wall_byte != last_wall_bytes[i]:
+                chip_map[i // 8] |= (1 << (i % 8))
+                changed.append(wall_byte)
+        return chip_map + changed
+
+    # Method to unpack compact move data into a dictionary of chip index to wall byte
+    def decode_chip_delta(self, data, n_chips):
+        n_map = (n_chips + 7) // 8
+        changed = {}
+        dat_i = n_map
+        for i in range(n_chips):
+            if data[i // 8] & (1 << (i % 8)):
+                changed[i] = data[dat_i]
+                dat_i += 1
+        return changed
 
     # Method to convert a byte to an array of indices corresponding to bits set to 1
     def byte_2_ind_array(self, byte):
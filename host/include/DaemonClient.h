@@ -0,0 +1,117 @@
+// ######################################
+
+//=========== DaemonClient.h ==========
+
+// ######################################
+
+/// @file Client for gate_daemon's Unix socket.
+
+#ifndef _DAEMON_CLIENT_h
+#define _DAEMON_CLIENT_h
+
+//============= INCLUDE ================
+#include "DaemonProtocol.h"
+#include "GateLink.h"
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+
+/// @brief Sends controller messages through gate_daemon and reads its cached wall state.
+///
+/// @details Offers the same requests as @ref GateClient, so tools can use either. Each request
+/// carries an id, so replies may complete in any order. Callbacks run on the reader thread.
+/// @ref readState() is answered by the daemon from its cache without a serial round trip, and
+/// @ref subscribe() delivers the wall state after every change.
+class DaemonClient : public GateLink
+{
+
+	// --------------VARIABLES--------------
+public:
+	typedef std::function<void(const DaemonProtocol::WallStateStruct &)> StateCallback;
+
+	/// @brief Completed state request.
+	struct StateReplyStruct
+	{
+		uint8_t status = ST_OK;
+		DaemonProtocol::WallStateStruct state;
+	};
+	typedef std::function<void(const StateReplyStruct &)> StateReplyCallback;
+
+	std::atomic<uint32_t> nEvents{0}; // state events delivered to the subscriber
+
+private:
+	typedef std::function<void(const DaemonProtocol::MsgStruct *, uint8_t)> DoneCallback;
+	struct PendingStruct
+	{
+		uint64_t tsSend;
+		uint64_t tsDeadline;
+		DoneCallback callback;
+	};
+
+	int _fd = -1;
+	int _fdWake[2] = {-1, -1};
+	std::thread _reader;
+	std::atomic<bool> _isOpen{false};
+	std::atomic<bool> _isStopped{false};
+	std::atomic<uint32_t> _dtTimeoutMs{15000};
+	std::mutex _mtxWrite;	// keeps messages from several threads whole
+	std::mutex _mtxPending; // guards the members below
+	std::map<uint32_t, PendingStruct> _pending;
+	uint32_t _idNext = 1;
+	StateCallback _stateCallback;
+	uint32_t _seqLast = 0; // last state delivered to the subscriber
+	DaemonParser _parser;
+
+	// ---------------METHODS---------------
+public:
+	~DaemonClient();
+
+public:
+	bool connect(const char *);
+
+public:
+	void close();
+
+public:
+	bool isOpen() const { return _isOpen; }
+
+public:
+	void setTimeout(uint32_t dt_ms) { _dtTimeoutMs = dt_ms; }
+
+public:
+	using GateLink::send;
+	void send(uint8_t, const std::vector<uint8_t> &, ReplyCallback) override;
+
+public:
+	void readState(StateReplyCallback);
+
+public:
+	std::future<StateReplyStruct> readState();
+
+public:
+	std::future<StateReplyStruct> subscribe(StateCallback);
+
+public:
+	std::future<StateReplyStruct> unsubscribe();
+
+private:
+	void _request(uint8_t, uint8_t, const std::vector<uint8_t> &, DoneCallback);
+
+private:
+	std::future<StateReplyStruct> _stateRequest(uint8_t);
+
+private:
+	void _readLoop();
+
+private:
+	void _dispatch(const DaemonProtocol::MsgStruct &);
+
+private:
+	void _expire(uint64_t);
+
+private:
+	void _failAll(uint8_t);
+};
+
+#endif
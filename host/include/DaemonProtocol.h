@@ -0,0 +1,99 @@
+// ######################################
+
+//========== DaemonProtocol.h =========
+
+// ######################################
+
+/// @file Messages between gate_daemon and its local clients, and the cached wall state.
+
+#ifndef _DAEMON_PROTOCOL_h
+#define _DAEMON_PROTOCOL_h
+
+//============= INCLUDE ================
+#include "GateProtocol.h"
+
+/// @brief Message layout of the gate_daemon Unix socket.
+///
+/// @details Every message in both directions is [kind][id(4)][status][type][len(2)][data][ts(4)],
+/// integers little endian. Clients pick the request id and get it back in the reply, so any
+/// number of requests can be in flight on one connection. Events carry the wall state sequence
+/// number as their id.
+class DaemonProtocol
+{
+
+	// --------------VARIABLES--------------
+public:
+	static const uint8_t headSize = 9;			 /// kind, id, status, type and length bytes
+	static const uint8_t tailSize = 4;			 /// device timestamp bytes
+	static const uint16_t maxData = 1024;		 /// data bytes per message
+	static const uint8_t maxChips = 64;			 /// chips in @ref WallStateStruct
+	static const uint8_t ST_NOT_SUBSCRIBED = 10; /// status of an UNSUBSCRIBE reply without a subscription
+
+	/// @brief Message kinds.
+	enum KIND
+	{
+		REQUEST = 1,	 // client: forward a controller message [type, data], reply is REPLY
+		STATUS = 2,		 // client: read the cached wall state, reply is STATE
+		SUBSCRIBE = 3,	 // client: receive an EVENT on every wall state change, reply is STATE
+		UNSUBSCRIBE = 4, // client: stop the events, reply is STATE
+		REPLY = 0x81,	 // daemon: controller reply [status, type, data, device ts]
+		STATE = 0x82,	 // daemon: wall state, data packed by packState()
+		EVENT = 0x83	 // daemon: wall state change, id is WallStateStruct::seq
+	};
+
+	/// @brief Decoded message.
+	struct MsgStruct
+	{
+		uint8_t kind = 0;
+		uint32_t id = 0;
+		uint8_t status = 0;
+		uint8_t type = 0;
+		std::vector<uint8_t> data;
+		uint32_t ts = 0; // device micros() of the reply frame or the state update
+	};
+
+	/// @brief Wall state cached from the controller replies.
+	///
+	/// @details "moving" marks walls a sent move will change and is cleared by its reply.
+	/// "error" marks walls that did not reach the position requested by the last move of their chip.
+	struct WallStateStruct
+	{
+		uint32_t seq = 0;				 // updates since the daemon started
+		uint32_t tsDevice = 0;			 // device micros() of the reply behind the last update
+		uint8_t nChips = 0;				 // chips found by the last scan
+		uint8_t addr[maxChips] = {};	 // chip I2C addresses
+		uint8_t position[maxChips] = {}; // bitWallPosition of each chip (bit set: wall up)
+		uint8_t target[maxChips] = {};	 // wall bytes requested by the last move of each chip
+		uint8_t error[maxChips] = {};	 // walls that missed the target
+		uint8_t moving[maxChips] = {};	 // walls being moved
+	};
+
+	// ---------------METHODS---------------
+public:
+	static std::vector<uint8_t> encode(const MsgStruct &);
+
+public:
+	static std::vector<uint8_t> packState(const WallStateStruct &);
+
+public:
+	static bool unpackState(const std::vector<uint8_t> &, WallStateStruct &);
+};
+
+/// @brief Incremental decoder for daemon messages.
+class DaemonParser
+{
+
+	// --------------VARIABLES--------------
+private:
+	std::vector<uint8_t> _buff;
+	size_t _posRead = 0;
+
+	// ---------------METHODS---------------
+public:
+	void push(const uint8_t *, size_t);
+
+public:
+	uint8_t next(DaemonProtocol::MsgStruct &);
+};
+
+#endif
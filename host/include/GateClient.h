@@ -0,0 +1,131 @@
+// ######################################
+
+//============ GateClient.h ===========
+
+// ######################################
+
+/// @file Asynchronous host client for the cypress_gate_controller serial protocol.
+
+#ifndef _GATE_CLIENT_h
+#define _GATE_CLIENT_h
+
+//============= INCLUDE ================
+#include "GateIoLoop.h"
+#include "GateLink.h"
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+/// @brief Talks to a gate controller (or gate_emulator) over a POSIX serial port.
+///
+/// @details Requests are written from the calling thread and complete through a future or a
+/// callback. A reader thread waits on the port with poll(), decodes device frames as they
+/// arrive and completes the oldest pending request of the same message type, since the
+/// firmware answers in order and replies carry no request id. Frames that match no request
+/// (log output, late replies) go to the frame callback. Callbacks run on the reader thread
+/// and must not block on other requests of the same client.
+///
+/// Opened with a @ref GateIoLoop, the client has no reader thread and the loop's thread does
+/// its reading and runs its callbacks instead.
+///
+/// A request that times out is completed with @ref ST_TIMEOUT; if its reply still arrives it
+/// is passed to the frame callback unless another request of the same type is pending, which
+/// would then receive it. Use a timeout longer than the slowest expected move.
+class GateClient : public GateLink
+{
+	friend class GateIoLoop;
+
+	// --------------VARIABLES--------------
+public:
+	typedef std::function<void(const GateProtocol::FrameStruct &)> FrameCallback;
+
+	std::atomic<uint32_t> nRequests{0};	 // requests written
+	std::atomic<uint32_t> nReplies{0};	 // requests completed with a reply
+	std::atomic<uint32_t> nTimeouts{0};	 // requests completed with ST_TIMEOUT
+	std::atomic<uint32_t> nUnmatched{0}; // frames that matched no pending request
+
+private:
+	struct PendingStruct
+	{
+		uint8_t type;
+		uint64_t tsSend;
+		uint64_t tsDeadline;
+		ReplyCallback callback;
+	};
+
+	int _fd = -1;
+	int _fdWake[2] = {-1, -1};
+	std::thread _reader;
+	GateIoLoop *_p_loop = nullptr; // loop reading the port instead of _reader
+	std::atomic<bool> _isOpen{false};
+	std::atomic<bool> _isStopped{false};
+	std::atomic<uint32_t> _dtTimeoutMs{5000};
+	std::mutex _mtxWrite;	// orders pending entries the same way as their frames on the port
+	std::mutex _mtxPending; // guards _pending and _frameCallback
+	std::deque<PendingStruct> _pending;
+	FrameCallback _frameCallback;
+	FrameParser _parser;
+
+	// ---------------METHODS---------------
+public:
+	GateClient();
+
+public:
+	~GateClient();
+
+public:
+	bool open(const char *, uint32_t = 115200, GateIoLoop * = nullptr);
+
+public:
+	void close();
+
+public:
+	bool isOpen() const { return _isOpen; }
+
+public:
+	void setTimeout(uint32_t dt_ms) { _dtTimeoutMs = dt_ms; }
+
+public:
+	void setFrameCallback(FrameCallback);
+
+public:
+	using GateLink::send;
+	void send(uint8_t, const std::vector<uint8_t> &, ReplyCallback) override;
+
+public:
+	using GateLink::go;
+	void go(ReplyCallback) override;
+
+public:
+	uint8_t writeRaw(const std::vector<uint8_t> &);
+
+public:
+	static int openPort(const char *, uint32_t);
+
+private:
+	uint8_t _write(uint8_t, const std::vector<uint8_t> &, ReplyCallback);
+
+private:
+	void _readLoop();
+
+private:
+	int _waitMs();
+
+private:
+	bool _readReady();
+
+private:
+	void _dispatch(const GateProtocol::FrameStruct &, uint64_t);
+
+private:
+	void _expire(uint64_t);
+
+private:
+	void _failAll(uint8_t);
+
+private:
+	void _wake();
+};
+
+#endif
@@ -0,0 +1,132 @@
+// ######################################
+
+//============ GateDaemon.h ===========
+
+// ######################################
+
+/// @file Serves one controller link to many local clients over a Unix socket.
+
+#ifndef _GATE_DAEMON_h
+#define _GATE_DAEMON_h
+
+//============= INCLUDE ================
+#include "DaemonProtocol.h"
+#include "GateClient.h"
+#include <map>
+#include <string>
+
+/// @brief Owns the controller link and multiplexes local clients onto it.
+///
+/// @details One event loop thread accepts connections on a Unix stream socket and decodes
+/// @ref DaemonProtocol messages. REQUEST messages are forwarded to the controller through
+/// @ref GateClient and answered with the client's request id when the reply arrives, so requests
+/// from all clients interleave on the serial link in arrival order. The replies also update
+/// a cached @ref DaemonProtocol::WallStateStruct. STATUS is answered from the cache without
+/// touching the serial link, and every change to the cache is sent as an EVENT to the
+/// subscribed clients and passed to the state callback.
+///
+/// A client whose unsent output grows past @ref maxOutBytes is disconnected, so a stalled
+/// subscriber cannot hold up the others.
+class GateDaemon
+{
+
+	// --------------VARIABLES--------------
+public:
+	typedef std::function<void(const DaemonProtocol::WallStateStruct &)> StateCallback;
+
+	static const size_t maxOutBytes = 1 << 22; /// unsent bytes per client before it is dropped
+
+	std::atomic<uint32_t> nClients{0};	// connections accepted
+	std::atomic<uint32_t> nRequests{0}; // REQUEST messages forwarded to the controller
+	std::atomic<uint32_t> nStatus{0};	// STATUS messages answered from the cache
+	std::atomic<uint32_t> nEvents{0};	// wall state changes broadcast
+	std::atomic<uint32_t> nDropped{0};	// clients disconnected for bad messages or unsent output
+
+private:
+	struct ConnStruct
+	{
+		int fd = -1;
+		bool isSubscribed = false;
+		std::vector<uint8_t> outBuff;
+		DaemonParser parser;
+	};
+	struct OutStruct
+	{
+		uint32_t connId; // 0: all subscribed clients
+		std::vector<uint8_t> bytes;
+	};
+
+	GateClient *_p_device = nullptr;
+	int _fdListen = -1;
+	int _fdWake[2] = {-1, -1};
+	std::string _pathSocket;
+	std::thread _loop;
+	std::atomic<bool> _isStopped{false};
+	std::atomic<uint32_t> _nInFlight{0}; // controller requests whose callback has not run
+
+	std::map<uint32_t, ConnStruct> _conns; // event loop thread only
+	uint32_t _connIdNext = 1;
+
+	std::mutex _mtxOut; // guards _out
+	std::deque<OutStruct> _out;
+
+	std::mutex _mtxState; // guards the state members below
+	DaemonProtocol::WallStateStruct _state;
+	uint8_t _nMovePending[DaemonProtocol::maxChips] = {};
+	std::vector<int16_t> _armTarget;
+	StateCallback _stateCallback;
+
+	// ---------------METHODS---------------
+public:
+	~GateDaemon();
+
+public:
+	bool start(GateClient &, const char *);
+
+public:
+	void stop();
+
+public:
+	DaemonProtocol::WallStateStruct getState();
+
+public:
+	void setStateCallback(StateCallback);
+
+private:
+	void _runLoop();
+
+private:
+	void _accept();
+
+private:
+	bool _readConn(uint32_t, ConnStruct &);
+
+private:
+	bool _writeConn(ConnStruct &);
+
+private:
+	void _handle(uint32_t, ConnStruct &, const DaemonProtocol::MsgStruct &);
+
+private:
+	void _queue(uint32_t, const DaemonProtocol::MsgStruct &);
+
+private:
+	void _refresh(bool);
+
+private:
+	void _onSend(uint8_t, const std::vector<uint8_t> &);
+
+private:
+	void _onReply(uint8_t, const std::vector<uint8_t> &, const GateLink::ReplyStruct &, bool = false);
+
+private:
+	void _endMove(uint8_t, bool);
+
+private:
+	void _publish();
+
+private:
+	static std::vector<int16_t> _parseCompact(const uint8_t *, size_t, uint8_t);
+};
+
+#endif
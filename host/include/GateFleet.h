@@ -0,0 +1,119 @@
+// ######################################
+
+//============ GateFleet.h ============
+
+// ######################################
+
+/// @file Drives several gate controllers as one arena.
+
+#ifndef _GATE_FLEET_h
+#define _GATE_FLEET_h
+
+//============= INCLUDE ================
+#include "GateClient.h"
+#include <string>
+
+/// @brief Maps one global chip and wall index space onto several controllers and sends each
+/// request to all of them at once.
+///
+/// @details Global chips are numbered through the devices in the order they were opened, so
+/// with 2 chips on device 0 and 3 on device 1, global chip 2 is chip 0 of device 1. Global wall
+/// "w" is bit w % 8 of global chip w / 8. The chip counts come from @ref initChips() or
+/// @ref setChips().
+///
+/// Every port is read by one @ref GateIoLoop thread. A fleet request writes one message per
+/// device without waiting, so the controllers work in parallel, and completes once with all the
+/// device replies, in device order. Callbacks run on the loop thread.
+class GateFleet
+{
+
+	// --------------VARIABLES--------------
+public:
+	/// @brief Completed fleet request.
+	struct FleetReplyStruct
+	{
+		uint8_t status = GateLink::ST_OK;			// first failed device status [ST_OK: all replied]
+		std::vector<uint8_t> data;					// device reply data concatenated in device order [empty unless ST_OK]
+		std::vector<GateLink::ReplyStruct> devices; // reply of each device [ST_OK with no frame: nothing to send it]
+		uint64_t tsSend = 0;						// host time the first message was written (us)
+		uint64_t tsRecv = 0;						// host time the last reply was decoded (us)
+		uint64_t dtSkewUs = 0;						// first to last device reply (us)
+	};
+
+	typedef std::function<void(const FleetReplyStruct &)> FleetCallback;
+
+	std::atomic<uint32_t> nRequests{0}; // fleet requests sent
+	std::atomic<uint32_t> nFailed{0};	// fleet requests with a device that did not reply
+
+private:
+	GateIoLoop _loop;
+	std::vector<std::unique_ptr<GateClient>> _devices;
+	mutable std::mutex _mtxChips; // guards _nChips
+	std::vector<uint8_t> _nChips;
+
+	// ---------------METHODS---------------
+public:
+	~GateFleet();
+
+public:
+	bool open(const std::vector<std::string> &, uint32_t = 115200);
+
+public:
+	void close();
+
+public:
+	size_t nDevices() const { return _devices.size(); }
+
+public:
+	GateClient &device(size_t dev_i) { return *_devices[dev_i]; }
+
+public:
+	void setTimeout(uint32_t);
+
+public:
+	void setChips(const std::vector<uint8_t> &);
+
+public:
+	std::vector<uint8_t> getChips() const;
+
+public:
+	uint16_t nChipsTotal() const;
+
+public:
+	bool locateChip(uint16_t, uint8_t &, uint8_t &) const;
+
+public:
+	std::vector<uint8_t> wallBytes(const std::vector<uint16_t> &) const;
+
+public:
+	void initChips(FleetCallback);
+
+public:
+	std::future<FleetReplyStruct> initChips();
+
+public:
+	void initGates(FleetCallback);
+
+public:
+	std::future<FleetReplyStruct> initGates();
+
+public:
+	void moveWalls(const std::vector<uint8_t> &, FleetCallback);
+
+public:
+	std::future<FleetReplyStruct> moveWalls(const std::vector<uint8_t> &);
+
+public:
+	void readWalls(FleetCallback);
+
+public:
+	std::future<FleetReplyStruct> readWalls();
+
+private:
+	void _fanOut(uint8_t, const std::vector<std::vector<uint8_t>> &, const std::vector<bool> &, FleetCallback);
+
+private:
+	static std::future<FleetReplyStruct> _future(std::function<void(FleetCallback)>);
+};
+
+#endif
@@ -0,0 +1,70 @@
+// ######################################
+
+//============ GateIoLoop.h ===========
+
+// ######################################
+
+/// @file One reader thread for many serial clients.
+
+#ifndef _GATE_IO_LOOP_h
+#define _GATE_IO_LOOP_h
+
+//============= INCLUDE ================
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class GateClient;
+
+/// @brief Waits on the ports of several @ref GateClient objects with a single poll() call.
+///
+/// @details A client opened with a loop starts no reader thread of its own: the loop reads its
+/// port, dispatches its replies and expires its requests. All their callbacks run on the loop
+/// thread, so a slow callback delays every port. A client may be closed from any thread,
+/// including from a callback.
+class GateIoLoop
+{
+	friend class GateClient;
+
+	// --------------VARIABLES--------------
+public:
+	std::atomic<uint32_t> nPolls{0}; // poll() calls returned
+
+private:
+	int _fdWake[2] = {-1, -1};
+	std::thread _thread;
+	std::atomic<bool> _isStopped{false};
+	std::recursive_mutex _mtx; // guards _clients, held while servicing them
+	std::vector<GateClient *> _clients;
+
+	// ---------------METHODS---------------
+public:
+	~GateIoLoop();
+
+public:
+	bool start();
+
+public:
+	void stop();
+
+public:
+	bool isRunning() const { return _thread.joinable(); }
+
+private:
+	bool _add(GateClient *);
+
+private:
+	void _remove(GateClient *);
+
+private:
+	bool _isAdded(GateClient *);
+
+private:
+	void _wake();
+
+private:
+	void _run();
+};
+
+#endif
@@ -0,0 +1,88 @@
+// ######################################
+
+//============= GateLink.h ============
+
+// ######################################
+
+/// @file Request interface shared by the serial and daemon clients.
+
+#ifndef _GATE_LINK_h
+#define _GATE_LINK_h
+
+//============= INCLUDE ================
+#include "GateProtocol.h"
+#include <functional>
+#include <future>
+#include <memory>
+
+/// @brief Sends controller messages and completes each with its reply, over the serial port
+/// (@ref GateClient) or through gate_daemon (@ref DaemonClient).
+class GateLink
+{
+
+	// --------------VARIABLES--------------
+public:
+	/// @brief Request status codes.
+	enum ST
+	{
+		ST_OK = 0,		// reply received
+		ST_TIMEOUT = 1, // no reply within the timeout
+		ST_CLOSED = 2,	// link not open, closed or lost before the reply
+		ST_ARG = 255	// bad argument, nothing was sent
+	};
+
+	/// @brief Completed request.
+	struct ReplyStruct
+	{
+		uint8_t status = ST_OK;
+		GateProtocol::FrameStruct frame; // reply frame [empty unless ST_OK]
+		uint64_t tsSend = 0;			 // host time the request was written (us, see GateLink::nowUs())
+		uint64_t tsRecv = 0;			 // host time the reply was decoded (us)
+	};
+
+	typedef std::function<void(const ReplyStruct &)> ReplyCallback;
+
+	// ---------------METHODS---------------
+public:
+	virtual ~GateLink() {}
+
+public:
+	/// @brief Send a message and call "callback" with its reply.
+	///
+	/// @param type Message type.
+	/// @param r_data Message data, at most GateProtocol::maxData bytes.
+	/// @param callback Completion callback, run on the link's reader thread or, if nothing could be sent, on the calling thread.
+	virtual void send(uint8_t type, const std::vector<uint8_t> &r_data, ReplyCallback callback) = 0;
+
+public:
+	std::future<ReplyStruct> send(uint8_t, const std::vector<uint8_t> & = std::vector<uint8_t>());
+
+public:
+	std::future<ReplyStruct> initChips() { return send(GateProtocol::INIT); }
+
+public:
+	std::future<ReplyStruct> initGates() { return send(GateProtocol::GATE_INIT); }
+
+public:
+	std::future<ReplyStruct> moveWalls(const std::vector<uint8_t> &r_wall_bytes) { return send(GateProtocol::MOVE, r_wall_bytes); }
+
+public:
+	std::future<ReplyStruct> readWalls() { return send(GateProtocol::MOVE); }
+
+public:
+	std::future<ReplyStruct> ping() { return send(GateProtocol::PING); }
+
+public:
+	/// @brief Start a move armed with message type 6 and call "callback" with the message type 7 reply.
+	///
+	/// @param callback Completion callback.
+	virtual void go(ReplyCallback callback) { send(GateProtocol::GO, std::vector<uint8_t>(), callback); }
+
+public:
+	std::future<ReplyStruct> go();
+
+public:
+	static uint64_t nowUs();
+};
+
+#endif
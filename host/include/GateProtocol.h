@@ -0,0 +1,136 @@
+// ######################################
+
+//=========== GateProtocol.h ==========
+
+// ######################################
+
+/// @file SerialCom frame encoding and decoding for host programs.
+
+#ifndef _GATE_PROTOCOL_h
+#define _GATE_PROTOCOL_h
+
+//============= INCLUDE ================
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/// @brief Constants and frame encoding of the SerialCom protocol used by cypress_gate_controller.
+///
+/// @details Host to device frames are [START][type][len][data][sum(data) % 256][END]. Device to
+/// host frames add the device micros() send timestamp: [START][type][len][data][ts(4, LE)]
+/// [(sum(data) + sum(ts) + type) % 256][END]. A move armed with message type 6 is started
+/// by the single unframed GO byte.
+class GateProtocol
+{
+
+	// --------------VARIABLES--------------
+public:
+	static const uint8_t START_BYTE = 0x02;
+	static const uint8_t END_BYTE = 0x03;
+	static const uint8_t GO_BYTE = 0x07;
+	static const uint8_t maxData = 255; /// data bytes per frame
+	static const uint8_t headSize = 3;	/// start, type and length bytes
+	static const uint8_t tailSize = 6;	/// device frames: timestamp, checksum and end bytes
+
+	/// @brief Message types handled by cypress_gate_controller (see its main.cpp for the data layouts).
+	enum MT
+	{
+		INIT = 0,		   // scan the bus and initialize the chips, reply is the chip addresses
+		GATE_INIT = 1,	   // run all walls up, reply is the wall bytes, then run them down
+		MOVE = 2,		   // move to one wall byte per chip, reply is the wall bytes
+		MOVE_COMPACT = 3,  // move with a chip bitmap and changed wall bytes, reply [255] for a bad length
+		STORE_CONFIG = 4,  // store a wall configuration in EEPROM, reply is the index and status
+		APPLY_CONFIG = 5,  // move to a stored wall configuration, reply is a status byte and the changed walls
+		ARM = 6,		   // arm a compact move for the GO byte or trigger pin, reply is the status
+		GO = 7,			   // start the armed move, reply is the status [0:not armed], latency and changed walls
+		SYNC_EVENTS = 8,   // read logged sync events
+		PING = 9,		   // clock sync ping, reply is the receive timestamp
+		PROFILE = 10,	   // profiling table, one reply per scope
+		COUNTERS = 11,	   // serial, move and I2C counters
+		LOG = 12,		   // log output, sent unsolicited
+		LOG_SETUP = 13,	   // log level and mode
+		I2C_TRACE = 14,	   // I2C transaction trace, several replies
+		TIMELINE = 15,	   // timeline spans, several replies
+		LATENCY = 16	   // receive and move stage timestamps of the last move
+	};
+
+	/// @brief Decoded device frame.
+	struct FrameStruct
+	{
+		uint8_t type = 0;
+		std::vector<uint8_t> data;
+		uint32_t ts = 0; // device micros() when the frame was sent
+	};
+
+	// ---------------METHODS---------------
+public:
+	static std::vector<uint8_t> encode(uint8_t, const uint8_t *, size_t);
+
+public:
+	static std::vector<uint8_t> encode(uint8_t type, const std::vector<uint8_t> &r_data) { return encode(type, r_data.data(), r_data.size()); }
+
+public:
+	static uint32_t readU32(const std::vector<uint8_t> &, size_t);
+};
+
+/// @brief Incremental decoder for device frames.
+///
+/// @details Bytes can arrive in any chunking. A candidate frame with a bad checksum or end byte
+/// is skipped one byte at a time, so the decoder resynchronizes on the next start byte inside it.
+class FrameParser
+{
+
+	// --------------VARIABLES--------------
+public:
+	uint32_t nFrames = 0;	  // frames decoded
+	uint32_t nBadFrames = 0;  // candidate frames with a bad checksum or end byte
+	uint32_t nSkipped = 0;	  // bytes discarded while searching for a frame
+
+private:
+	std::vector<uint8_t> _buff;
+	size_t _posRead = 0;
+
+	// ---------------METHODS---------------
+public:
+	void push(const uint8_t *, size_t);
+
+public:
+	bool next(GateProtocol::FrameStruct &);
+
+public:
+	void reset();
+};
+
+/// @brief Incremental decoder for host to device frames and GO bytes, to record what a host sends.
+///
+/// @details Follows the firmware: a GO byte is only taken between frames, and a candidate frame
+/// with a bad checksum or end byte is skipped one byte at a time.
+class RequestParser
+{
+
+	// --------------VARIABLES--------------
+public:
+	/// @brief Decode results.
+	enum RT
+	{
+		RT_NONE = 0,  // no complete frame buffered yet
+		RT_FRAME = 1, // framed message
+		RT_GO = 2	  // unframed GO byte
+	};
+
+	uint32_t nFrames = 0;  // frames and GO bytes decoded
+	uint32_t nSkipped = 0; // bytes discarded while searching for a frame
+
+private:
+	std::vector<uint8_t> _buff;
+	size_t _posRead = 0;
+
+	// ---------------METHODS---------------
+public:
+	void push(const uint8_t *, size_t);
+
+public:
+	uint8_t next(GateProtocol::FrameStruct &);
+};
+
+#endif
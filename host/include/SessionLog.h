@@ -0,0 +1,102 @@
+// ######################################
+
+//============ SessionLog.h ===========
+
+// ######################################
+
+/// @file Binary recording of the SerialCom frames of a host session, both directions.
+
+#ifndef _SESSION_LOG_h
+#define _SESSION_LOG_h
+
+//============= INCLUDE ================
+#include "GateProtocol.h"
+#include <atomic>
+#include <mutex>
+#include <stdio.h>
+#include <string>
+
+/// @brief Layout of a session recording.
+///
+/// @details A 16 byte header [magic(4)][version][0(3)][wall clock start (us since the epoch, 8)]
+/// is followed by one record per frame: [kind][dt][type][len][data], plus [ts(4)] for device
+/// frames. "dt" is the host time since the previous record in us and "len" the data length,
+/// both as LEB128 varints, integers little endian. A move frame takes about 10 bytes. Records
+/// are appended as they happen, so a recording cut short by a crash loads up to its last
+/// complete record.
+class SessionLog
+{
+
+	// --------------VARIABLES--------------
+public:
+	static const uint32_t fileMagic = 0x53344E43; /// "NC4S"
+	static const uint8_t fileVersion = 1;		   /// bumped when the layout changes
+	static const uint8_t headerSize = 16;		   /// header bytes
+
+	/// @brief Record kinds.
+	enum KIND
+	{
+		HOST_FRAME = 0x01,	// host to device frame
+		HOST_GO = 0x02,		// unframed GO byte, type is GateProtocol::GO
+		DEVICE_FRAME = 0x81 // device to host frame with its timestamp
+	};
+
+	/// @brief One recorded frame.
+	struct RecordStruct
+	{
+		uint8_t kind = HOST_FRAME;
+		uint64_t tsUs = 0; // host time since the start of the recording (us)
+		GateProtocol::FrameStruct frame;
+	};
+
+	/// @brief Loaded recording.
+	struct SessionStruct
+	{
+		uint64_t tsStartUnixUs = 0; // wall clock time the recording started
+		std::vector<RecordStruct> records;
+		bool isTruncated = false; // file ends inside a record
+	};
+
+	// ---------------METHODS---------------
+public:
+	static std::vector<uint8_t> encodeRecord(const RecordStruct &, uint64_t);
+
+public:
+	static bool load(const char *, SessionStruct &);
+
+public:
+	static bool isHost(const RecordStruct &r_rec) { return r_rec.kind != DEVICE_FRAME; }
+};
+
+/// @brief Appends records to a session file, from any thread.
+class SessionWriter
+{
+
+	// --------------VARIABLES--------------
+public:
+	std::atomic<uint32_t> nRecords{0}; // records written
+
+private:
+	FILE *_p_file = nullptr;
+	std::mutex _mtx; // guards the members below
+	uint64_t _tsStart = 0;
+	uint64_t _tsLast = 0;
+
+	// ---------------METHODS---------------
+public:
+	~SessionWriter();
+
+public:
+	bool open(const char *);
+
+public:
+	void close();
+
+public:
+	bool isOpen() const { return _p_file != nullptr; }
+
+public:
+	bool write(uint8_t, const GateProtocol::FrameStruct &);
+};
+
+#endif
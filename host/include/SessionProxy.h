@@ -0,0 +1,73 @@
+// ######################################
+
+//=========== SessionProxy.h ==========
+
+// ######################################
+
+/// @file Records a host session by standing between the host program and the controller port.
+
+#ifndef _SESSION_PROXY_h
+#define _SESSION_PROXY_h
+
+//============= INCLUDE ================
+#include "SessionLog.h"
+#include <thread>
+
+/// @brief Forwards bytes between a pseudo-terminal and a controller port and records every frame.
+///
+/// @details The host program (GUI, scripts) opens the pseudo-terminal instead of the controller
+/// port, so sessions are recorded without changing it. One thread copies bytes both ways as they
+/// arrive and decodes them on the side with @ref RequestParser and @ref FrameParser. Bytes are
+/// forwarded unchanged, including ones that decode to no frame.
+class SessionProxy
+{
+
+	// --------------VARIABLES--------------
+public:
+	std::atomic<uint32_t> nHostBytes{0};	   // bytes from the host to the controller
+	std::atomic<uint32_t> nDeviceBytes{0};	   // bytes from the controller to the host
+	std::atomic<uint32_t> nDeviceDropped{0};   // controller bytes dropped because no host was reading
+	std::atomic<uint32_t> nHostFrames{0};	   // host frames and GO bytes recorded
+	std::atomic<uint32_t> nDeviceFrames{0};	   // controller frames recorded
+
+private:
+	int _fdDevice = -1;
+	int _fdMaster = -1;
+	int _fdSlave = -1;
+	int _fdWake[2] = {-1, -1};
+	std::string _pathSlave;
+	std::string _pathLink;
+	std::thread _thread;
+	std::atomic<bool> _isStopped{false};
+	std::atomic<bool> _isDeviceOpen{false};
+	SessionWriter *_p_writer = nullptr;
+	RequestParser _reqParser;
+	FrameParser _frameParser;
+
+	// ---------------METHODS---------------
+public:
+	~SessionProxy();
+
+public:
+	bool start(const char *, uint32_t, const char *, SessionWriter &);
+
+public:
+	void stop();
+
+public:
+	const std::string &path() const { return _pathSlave; }
+
+public:
+	bool isDeviceOpen() const { return _isDeviceOpen; }
+
+private:
+	void _run();
+
+private:
+	void _fromHost(const uint8_t *, size_t);
+
+private:
+	void _fromDevice(const uint8_t *, size_t);
+};
+
+#endif
@@ -0,0 +1,77 @@
+// ######################################
+
+//=========== SessionReplay.h =========
+
+// ######################################
+
+/// @file Replays a recorded host session against a controller or gate_emulator.
+
+#ifndef _SESSION_REPLAY_h
+#define _SESSION_REPLAY_h
+
+//============= INCLUDE ================
+#include "GateClient.h"
+#include "SessionLog.h"
+
+/// @brief Sends the host frames of a recording in order and compares the replies with the recorded ones.
+///
+/// @details Replies are paired with requests the same way as @ref GateClient does, the oldest
+/// request of the reply type, both in the recording and in the replay. Replay keeps the causal
+/// order of the recording: a request that followed a reply is sent only once that reply has
+/// come back in the replay too, then after the recorded gap. Gaps can be kept, scaled, capped
+/// or dropped, so a session becomes either a faithful rerun or a stress benchmark.
+///
+/// Replies that hold device times (pings, profiles, counters, logs, traces, timelines,
+/// latency, sync events) are compared by type only, and GO replies without their move time.
+class SessionReplay
+{
+
+	// --------------VARIABLES--------------
+public:
+	/// @brief Replay pacing.
+	struct OptionsStruct
+	{
+		double speed = 1;		  // recorded gaps are divided by this
+		uint32_t dtMaxGapMs = 0; // longest gap after scaling [0: no cap]
+		bool isNoGaps = false;	  // send each request as soon as its causal reply is in
+	};
+
+	/// @brief Outcome of one recorded request.
+	struct RequestResultStruct
+	{
+		size_t recordIndex = 0;			  // index in the recording
+		uint8_t kind = 0;				  // SessionLog::HOST_FRAME or SessionLog::HOST_GO
+		GateProtocol::FrameStruct request;
+		bool hasReply = false;			  // recording has a reply for it
+		GateProtocol::FrameStruct recorded; // recorded reply [hasReply]
+		uint8_t status = GateLink::ST_OK; // replay status [ST_OK if no reply was expected]
+		GateProtocol::FrameStruct replayed; // replay reply [hasReply and ST_OK]
+		double dtRecordedMs = 0;		  // recorded request to reply time [hasReply]
+		double dtReplayedMs = 0;		  // replay request to reply time [hasReply]
+		bool isSame = true;				  // replay reply matches the recorded one
+	};
+
+	/// @brief Outcome of a replay.
+	struct ResultStruct
+	{
+		uint8_t status = GateLink::ST_OK; // ST_CLOSED: the port was lost before the end
+		std::vector<RequestResultStruct> requests;
+		uint32_t nDiffs = 0;			  // requests whose reply differs or is missing
+		uint32_t nExtraRecorded = 0;	  // recorded controller frames that answer no request
+		uint32_t nExtraReplayed = 0;	  // replay controller frames that answer no request
+		double dtRecordedS = 0;			  // recording length
+		double dtReplayedS = 0;			  // replay length
+	};
+
+	// ---------------METHODS---------------
+public:
+	static ResultStruct run(GateClient &, const SessionLog::SessionStruct &, const OptionsStruct &);
+
+public:
+	static std::vector<int> matchReplies(const SessionLog::SessionStruct &);
+
+public:
+	static bool isSameReply(const GateProtocol::FrameStruct &, const GateProtocol::FrameStruct &);
+};
+
+#endif
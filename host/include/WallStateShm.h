@@ -0,0 +1,112 @@
+// ######################################
+
+//=========== WallStateShm.h ==========
+
+// ######################################
+
+/// @file Wall state published in POSIX shared memory for readers that must not block.
+
+#ifndef _WALL_STATE_SHM_h
+#define _WALL_STATE_SHM_h
+
+//============= INCLUDE ================
+#include "DaemonProtocol.h"
+#include <atomic>
+#include <mutex>
+#include <type_traits>
+
+/// @brief Layout of the shared memory segment.
+///
+/// @details "lock" is a sequence lock: the writer makes it odd, copies the state and makes it
+/// even again, so a reader that sees the same even value before and after its copy has a
+/// consistent snapshot. Readers never write to the segment and never wait on the writer.
+struct WallStateShmStruct
+{
+	static const uint32_t shmMagic = 0x4E433457; /// "NC4W", set once the segment is initialized
+	static const uint32_t shmVersion = 1;		 /// bumped when the layout changes
+
+	std::atomic<uint32_t> magic;
+	uint32_t version;
+	std::atomic<uint32_t> lock;		 // sequence lock, odd while the writer is copying
+	std::atomic<uint32_t> pidWriter; // publishing process [0: none]
+	uint64_t tsHost;				 // host time of the last publish (us, see GateLink::nowUs())
+	DaemonProtocol::WallStateStruct state;
+};
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "the sequence lock must be lock free to be shared between processes");
+static_assert(std::is_trivially_copyable<DaemonProtocol::WallStateStruct>::value, "the wall state is copied with memcpy");
+
+/// @brief Publishes the wall state to a shared memory segment.
+///
+/// @details Only one writer per segment. The segment is kept when the writer closes, so readers
+/// that mapped it keep working across a daemon restart and see the new writer's states.
+class WallStateWriter
+{
+
+	// --------------VARIABLES--------------
+public:
+	std::atomic<uint32_t> nPublished{0}; // states copied to the segment
+
+private:
+	WallStateShmStruct *_p_shm = nullptr;
+	std::mutex _mtx; // serializes publish() between threads
+	bool _isPublished = false;
+	uint32_t _seqLast = 0;
+
+	// ---------------METHODS---------------
+public:
+	~WallStateWriter();
+
+public:
+	bool open(const char *);
+
+public:
+	void close();
+
+public:
+	bool isOpen() const { return _p_shm != nullptr; }
+
+public:
+	void publish(const DaemonProtocol::WallStateStruct &);
+
+public:
+	static bool unlink(const char *);
+};
+
+/// @brief Reads snapshots of the wall state from a shared memory segment.
+///
+/// @details @ref read() makes no system calls and takes no locks, so it can run at frame rate
+/// in a tracking loop. It retries only while the writer is in the middle of a copy.
+class WallStateReader
+{
+
+	// --------------VARIABLES--------------
+public:
+	static const uint32_t maxTries = 1000; /// copies attempted by read() before it gives up
+
+	std::atomic<uint32_t> nRetries{0}; // copies discarded because the writer was publishing
+
+private:
+	const WallStateShmStruct *_p_shm = nullptr;
+
+	// ---------------METHODS---------------
+public:
+	~WallStateReader();
+
+public:
+	bool open(const char *);
+
+public:
+	void close();
+
+public:
+	bool isOpen() const { return _p_shm != nullptr; }
+
+public:
+	bool read(DaemonProtocol::WallStateStruct &, uint64_t * = nullptr);
+
+public:
+	bool isWriterAlive() const;
+};
+
+#endif
@@ -0,0 +1,354 @@
+// ######################################
+
+//=========== DaemonClient.cpp ========
+
+// ######################################
+
+//============= INCLUDE ================
+#include "DaemonClient.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+//========CLASS: DaemonClient==========
+
+/// @brief DESTRUCTOR: Disconnect, completing pending requests with @ref ST_CLOSED.
+DaemonClient::~DaemonClient()
+{
+	close();
+}
+
+/// @brief Connect to the daemon and start the reader thread.
+///
+/// @param p_socket Daemon socket path.
+/// @return Success [false: no daemon listening on "p_socket"].
+bool DaemonClient::connect(const char *p_socket)
+{
+	close();
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (strlen(p_socket) >= sizeof(addr.sun_path))
+		return false;
+	strcpy(addr.sun_path, p_socket);
+	_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (_fd < 0 || ::connect(_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || pipe2(_fdWake, O_NONBLOCK | O_CLOEXEC) != 0)
+	{
+		if (_fd >= 0)
+			::close(_fd);
+		_fd = -1;
+		return false;
+	}
+	_parser = DaemonParser();
+	_seqLast = 0;
+	_isStopped = false;
+	_isOpen = true;
+	_reader = std::thread(&DaemonClient::_readLoop, this);
+	return true;
+}
+
+/// @brief Stop the reader thread and disconnect, completing pending requests with @ref ST_CLOSED.
+void DaemonClient::close()
+{
+	if (_reader.joinable())
+	{
+		_isStopped = true;
+		uint8_t wake = 0;
+		ssize_t n = ::write(_fdWake[1], &wake, 1);
+		(void)n;
+		_reader.join();
+	}
+	{
+		std::lock_guard<std::mutex> lock_write(_mtxWrite);
+		_isOpen = false;
+		for (int fd : {_fd, _fdWake[0], _fdWake[1]})
+			if (fd >= 0)
+				::close(fd);
+		_fd = -1;
+		_fdWake[0] = _fdWake[1] = -1;
+	}
+	_failAll(ST_CLOSED);
+	std::lock_guard<std::mutex> lock(_mtxPending);
+	_stateCallback = StateCallback();
+}
+
+/// @brief Send a controller message through the daemon and call "callback" with its reply.
+///
+/// @param type Message type.
+/// @param r_data Message data, at most GateProtocol::maxData bytes.
+/// @param callback Completion callback.
+void DaemonClient::send(uint8_t type, const std::vector<uint8_t> &r_data, ReplyCallback callback)
+{
+	if (r_data.size() > GateProtocol::maxData)
+	{
+		ReplyStruct reply;
+		reply.status = ST_ARG;
+		callback(reply);
+		return;
+	}
+	uint64_t ts_send = nowUs();
+	_request(DaemonProtocol::REQUEST, type, r_data, [callback, ts_send](const DaemonProtocol::MsgStruct *p_msg, uint8_t status)
+			 {
+		ReplyStruct reply;
+		reply.status = p_msg != nullptr ? p_msg->status : status;
+		reply.tsSend = ts_send;
+		reply.tsRecv = nowUs();
+		if (p_msg != nullptr && reply.status == ST_OK)
+		{
+			reply.frame.type = p_msg->type;
+			reply.frame.data = p_msg->data;
+			reply.frame.ts = p_msg->ts;
+		}
+		callback(reply); });
+}
+
+/// @brief Read the daemon's cached wall state and call "callback" with it.
+///
+/// @param callback Completion callback.
+void DaemonClient::readState(StateReplyCallback callback)
+{
+	_request(DaemonProtocol::STATUS, 0, std::vector<uint8_t>(), [callback](const DaemonProtocol::MsgStruct *p_msg, uint8_t status)
+			 {
+		StateReplyStruct reply;
+		reply.status = p_msg != nullptr ? p_msg->status : status;
+		if (p_msg != nullptr && !DaemonProtocol::unpackState(p_msg->data, reply.state))
+			reply.status = ST_ARG;
+		callback(reply); });
+}
+
+/// @brief Read the daemon's cached wall state.
+///
+/// @return Future of the wall state.
+std::future<DaemonClient::StateReplyStruct> DaemonClient::readState()
+{
+	return _stateRequest(DaemonProtocol::STATUS);
+}
+
+/// @brief Receive the wall state after every change.
+///
+/// @details "callback" runs on the reader thread, first with the current state and then with
+/// each newer state. States are delivered in sequence order and none is delivered twice.
+///
+/// @param callback State callback.
+/// @return Future of the current state.
+std::future<DaemonClient::StateReplyStruct> DaemonClient::subscribe(StateCallback callback)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mtxPending);
+		_stateCallback = callback;
+	}
+	return _stateRequest(DaemonProtocol::SUBSCRIBE);
+}
+
+/// @brief Stop receiving state changes.
+///
+/// @return Future of the current state, status DaemonProtocol::ST_NOT_SUBSCRIBED if there was no subscription.
+std::future<DaemonClient::StateReplyStruct> DaemonClient::unsubscribe()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mtxPending);
+		_stateCallback = StateCallback();
+	}
+	return _stateRequest(DaemonProtocol::UNSUBSCRIBE);
+}
+
+/// @brief Send a state request and get a future for its reply.
+///
+/// @param kind STATUS, SUBSCRIBE or UNSUBSCRIBE.
+/// @return Future of the wall state.
+std::future<DaemonClient::StateReplyStruct> DaemonClient::_stateRequest(uint8_t kind)
+{
+	std::shared_ptr<std::promise<StateReplyStruct>> p_prom = std::make_shared<std::promise<StateReplyStruct>>();
+	_request(kind, 0, std::vector<uint8_t>(), [p_prom](const DaemonProtocol::MsgStruct *p_msg, uint8_t status)
+			 {
+		StateReplyStruct reply;
+		reply.status = p_msg != nullptr ? p_msg->status : status;
+		if (p_msg != nullptr && !DaemonProtocol::unpackState(p_msg->data, reply.state))
+			reply.status = ST_ARG;
+		p_prom->set_value(reply); });
+	return p_prom->get_future();
+}
+
+/// @brief Queue a pending entry under a new id and write the message.
+///
+/// @param kind Message kind.
+/// @param type Controller message type.
+/// @param r_data Message data.
+/// @param callback Completion callback with the reply message, or nullptr and the failure status.
+void DaemonClient::_request(uint8_t kind, uint8_t type, const std::vector<uint8_t> &r_data, DoneCallback callback)
+{
+	std::unique_lock<std::mutex> lock_write(_mtxWrite);
+	if (!_isOpen)
+	{
+		lock_write.unlock();
+		callback(nullptr, ST_CLOSED);
+		return;
+	}
+	DaemonProtocol::MsgStruct msg;
+	msg.kind = kind;
+	msg.type = type;
+	msg.data = r_data;
+	uint64_t ts_send = nowUs();
+	{
+		std::lock_guard<std::mutex> lock(_mtxPending);
+		msg.id = _idNext++;
+		_pending[msg.id] = {ts_send, ts_send + (uint64_t)_dtTimeoutMs * 1000, callback};
+	}
+	uint8_t wake = 0;
+	ssize_t n = ::write(_fdWake[1], &wake, 1);
+	(void)n;
+
+	std::vector<uint8_t> bytes = DaemonProtocol::encode(msg);
+	size_t pos = 0;
+	while (pos < bytes.size())
+	{
+		n = ::send(_fd, bytes.data() + pos, bytes.size() - pos, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			break;
+		pos += n;
+	}
+	if (pos < bytes.size())
+	{
+		bool is_pending;
+		{
+			std::lock_guard<std::mutex> lock(_mtxPending);
+			is_pending = _pending.erase(msg.id) > 0;
+		}
+		lock_write.unlock();
+		if (is_pending)
+			callback(nullptr, ST_CLOSED);
+	}
+}
+
+/// @brief Reader thread: wait for messages or the next deadline and dispatch them.
+void DaemonClient::_readLoop()
+{
+	uint8_t buff[4096];
+	DaemonProtocol::MsgStruct msg;
+	while (!_isStopped)
+	{
+		int dt_wait_ms = -1;
+		{
+			std::lock_guard<std::mutex> lock(_mtxPending);
+			uint64_t ts_now = nowUs();
+			for (auto &r_pend : _pending)
+			{
+				int dt_ms = r_pend.second.tsDeadline > ts_now ? (int)((r_pend.second.tsDeadline - ts_now + 999) / 1000) : 0;
+				dt_wait_ms = dt_wait_ms < 0 || dt_ms < dt_wait_ms ? dt_ms : dt_wait_ms;
+			}
+		}
+
+		struct pollfd pfds[2] = {{_fd, POLLIN, 0}, {_fdWake[0], POLLIN, 0}};
+		if (poll(pfds, 2, dt_wait_ms) < 0 && errno != EINTR)
+			break;
+		if (pfds[1].revents & POLLIN)
+			while (::read(_fdWake[0], buff, sizeof(buff)) > 0)
+			{
+			}
+		if (pfds[0].revents & (POLLIN | POLLHUP | POLLERR))
+		{
+			ssize_t n = ::read(_fd, buff, sizeof(buff));
+			if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR))
+			{
+				// Daemon stopped
+				_isOpen = false;
+				_failAll(ST_CLOSED);
+				break;
+			}
+			if (n > 0)
+			{
+				_parser.push(buff, n);
+				uint8_t status;
+				while ((status = _parser.next(msg)) == 1)
+					_dispatch(msg);
+				if (status == 255)
+				{
+					_isOpen = false;
+					_failAll(ST_CLOSED);
+					break;
+				}
+			}
+		}
+		_expire(nowUs());
+	}
+}
+
+/// @brief Complete the request with the message id, or deliver an event.
+///
+/// @param r_msg Daemon message.
+void DaemonClient::_dispatch(const DaemonProtocol::MsgStruct &r_msg)
+{
+	DoneCallback callback;
+	StateCallback state_callback;
+	DaemonProtocol::WallStateStruct state;
+	bool is_state = (r_msg.kind == DaemonProtocol::STATE || r_msg.kind == DaemonProtocol::EVENT) && DaemonProtocol::unpackState(r_msg.data, state);
+	{
+		std::lock_guard<std::mutex> lock(_mtxPending);
+		if (r_msg.kind != DaemonProtocol::EVENT)
+		{
+			auto it = _pending.find(r_msg.id);
+			if (it != _pending.end())
+			{
+				callback = it->second.callback;
+				_pending.erase(it);
+			}
+		}
+
+		// Events queued before a SUBSCRIBE can arrive after its reply
+		if (is_state && _stateCallback && state.seq > _seqLast)
+		{
+			state_callback = _stateCallback;
+			_seqLast = state.seq;
+		}
+	}
+	if (state_callback && (r_msg.kind == DaemonProtocol::EVENT || r_msg.status == ST_OK))
+	{
+		nEvents++;
+		state_callback(state);
+	}
+	if (callback)
+		callback(&r_msg, ST_OK);
+}
+
+/// @brief Complete requests whose deadline has passed with @ref ST_TIMEOUT.
+///
+/// @param ts_now Host time (us).
+void DaemonClient::_expire(uint64_t ts_now)
+{
+	std::vector<DoneCallback> expired;
+	{
+		std::lock_guard<std::mutex> lock(_mtxPending);
+		for (auto it = _pending.begin(); it != _pending.end();)
+		{
+			if (it->second.tsDeadline <= ts_now)
+			{
+				expired.push_back(it->second.callback);
+				it = _pending.erase(it);
+			}
+			else
+				++it;
+		}
+	}
+	for (DoneCallback &r_callback : expired)
+		r_callback(nullptr, ST_TIMEOUT);
+}
+
+/// @brief Complete all pending requests with "status".
+///
+/// @param status Completion status.
+void DaemonClient::_failAll(uint8_t status)
+{
+	std::map<uint32_t, PendingStruct> failed;
+	{
+		std::lock_guard<std::mutex> lock(_mtxPending);
+		failed.swap(_pending);
+	}
+	for (auto &r_pend : failed)
+		r_pend.second.callback(nullptr, status);
+}
@@ -0,0 +1,135 @@
+// ######################################
+
+//========= DaemonProtocol.cpp ========
+
+// ######################################
+
+//============= INCLUDE ================
+#include "DaemonProtocol.h"
+#include <string.h>
+
+//============ FUNCTIONS ===============
+
+// Append a little endian 32 bit value
+static void pushU32(std::vector<uint8_t> &r_buff, uint32_t val)
+{
+	for (uint8_t byte_i = 0; byte_i < 4; byte_i++)
+		r_buff.push_back((val >> (8 * byte_i)) & 0xFF);
+}
+
+// Read a little endian 32 bit value
+static uint32_t readU32(const uint8_t *p_buff)
+{
+	return p_buff[0] | p_buff[1] << 8 | p_buff[2] << 16 | (uint32_t)p_buff[3] << 24;
+}
+
+//========CLASS: DaemonProtocol==========
+
+// Definitions for constants passed by reference
+const uint8_t DaemonProtocol::headSize;
+const uint8_t DaemonProtocol::tailSize;
+const uint16_t DaemonProtocol::maxData;
+const uint8_t DaemonProtocol::maxChips;
+const uint8_t DaemonProtocol::ST_NOT_SUBSCRIBED;
+
+/// @brief Encode a message.
+///
+/// @param r_msg Message, at most @ref maxData data bytes.
+/// @return Message bytes [empty: too much data].
+std::vector<uint8_t> DaemonProtocol::encode(const MsgStruct &r_msg)
+{
+	std::vector<uint8_t> buff;
+	if (r_msg.data.size() > maxData)
+		return buff;
+	buff.reserve(headSize + r_msg.data.size() + tailSize);
+	buff.push_back(r_msg.kind);
+	pushU32(buff, r_msg.id);
+	buff.push_back(r_msg.status);
+	buff.push_back(r_msg.type);
+	buff.push_back(r_msg.data.size() & 0xFF);
+	buff.push_back(r_msg.data.size() >> 8);
+	buff.insert(buff.end(), r_msg.data.begin(), r_msg.data.end());
+	pushU32(buff, r_msg.ts);
+	return buff;
+}
+
+/// @brief Pack the wall state as [seq(4)][tsDevice(4)][nChips] followed by the addr, position,
+/// target, error and moving bytes of each chip.
+///
+/// @param r_state Wall state.
+/// @return Packed state.
+std::vector<uint8_t> DaemonProtocol::packState(const WallStateStruct &r_state)
+{
+	std::vector<uint8_t> buff;
+	uint8_t n_chips = r_state.nChips < maxChips ? r_state.nChips : maxChips;
+	buff.reserve(9 + 5 * n_chips);
+	pushU32(buff, r_state.seq);
+	pushU32(buff, r_state.tsDevice);
+	buff.push_back(n_chips);
+	for (const uint8_t *p_arr : {r_state.addr, r_state.position, r_state.target, r_state.error, r_state.moving})
+		buff.insert(buff.end(), p_arr, p_arr + n_chips);
+	return buff;
+}
+
+/// @brief Unpack a wall state packed by @ref packState().
+///
+/// @param r_buff Packed state.
+/// @param r_state Unpacked state.
+/// @return Success [false: bad length].
+bool DaemonProtocol::unpackState(const std::vector<uint8_t> &r_buff, WallStateStruct &r_state)
+{
+	if (r_buff.size() < 9 || r_buff[8] > maxChips || r_buff.size() != 9 + 5 * (size_t)r_buff[8])
+		return false;
+	r_state = WallStateStruct();
+	r_state.seq = readU32(&r_buff[0]);
+	r_state.tsDevice = readU32(&r_buff[4]);
+	r_state.nChips = r_buff[8];
+	const uint8_t *p_src = &r_buff[9];
+	for (uint8_t *p_arr : {r_state.addr, r_state.position, r_state.target, r_state.error, r_state.moving})
+	{
+		memcpy(p_arr, p_src, r_state.nChips);
+		p_src += r_state.nChips;
+	}
+	return true;
+}
+
+//========CLASS: DaemonParser==========
+
+/// @brief Add received bytes.
+///
+/// @param p_buff Received bytes.
+/// @param len Number of bytes.
+void DaemonParser::push(const uint8_t *p_buff, size_t len)
+{
+	if (_posRead > 0 && _posRead >= _buff.size() / 2)
+	{
+		_buff.erase(_buff.begin(), _buff.begin() + _posRead);
+		_posRead = 0;
+	}
+	_buff.insert(_buff.end(), p_buff, p_buff + len);
+}
+
+/// @brief Decode the next complete message.
+///
+/// @param r_msg Decoded message.
+/// @return Status [0: no complete message yet, 1: message decoded, 255: length over DaemonProtocol::maxData, the stream is unusable].
+uint8_t DaemonParser::next(DaemonProtocol::MsgStruct &r_msg)
+{
+	if (_posRead + DaemonProtocol::headSize > _buff.size())
+		return 0;
+	const uint8_t *p_head = &_buff[_posRead];
+	size_t len = p_head[7] | p_head[8] << 8;
+	if (len > DaemonProtocol::maxData)
+		return 255;
+	if (_posRead + DaemonProtocol::headSize + len + DaemonProtocol::tailSize > _buff.size())
+		return 0;
+
+	r_msg.kind = p_head[0];
+	r_msg.id = readU32(p_head + 1);
+	r_msg.status = p_head[5];
+	r_msg.type = p_head[6];
+	r_msg.data.assign(p_head + DaemonProtocol::headSize, p_head + DaemonProtocol::headSize + len);
+	r_msg.ts = readU32(p_head + DaemonProtocol::headSize + len);
+	_posRead += DaemonProtocol::headSize + len + DaemonProtocol::tailSize;
+	return 1;
+}
@@ -0,0 +1,404 @@
+// ######################################
+
+//============ GateClient.cpp =========
+
+// ######################################
+
+//============= INCLUDE ================
+#include "GateClient.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+//============ FUNCTIONS ===============
+
+// termios speed for a baud rate [B0: not supported]
+static speed_t baudFlag(uint32_t baud)
+{
+	switch (baud)
+	{
+	case 9600:
+		return B9600;
+	case 19200:
+		return B19200;
+	case 38400:
+		return B38400;
+	case 57600:
+		return B57600;
+	case 115200:
+		return B115200;
+	case 230400:
+		return B230400;
+	case 460800:
+		return B460800;
+	case 921600:
+		return B921600;
+	default:
+		return B0;
+	}
+}
+
+// Write all bytes, retrying on interrupts and a full output buffer
+static bool writeAll(int fd, const uint8_t *p_buff, size_t len)
+{
+	while (len > 0)
+	{
+		ssize_t n = ::write(fd, p_buff, len);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN)
+			{
+				struct pollfd pfd = {fd, POLLOUT, 0};
+				poll(&pfd, 1, 100);
+				continue;
+			}
+			return false;
+		}
+		p_buff += n;
+		len -= n;
+	}
+	return true;
+}
+
+//========CLASS: GateClient==========
+
+/// @brief CONSTRUCTOR: Create a closed client.
+GateClient::GateClient()
+{
+}
+
+/// @brief DESTRUCTOR: Close the port, completing pending requests with @ref ST_CLOSED.
+GateClient::~GateClient()
+{
+	close();
+}
+
+/// @brief Open the serial port and start the reader thread, or hand the port to a loop.
+///
+/// @param p_path Serial port (e.g. /dev/ttyACM0, or the gate_emulator pseudo-terminal).
+/// @param baud Baud rate, ignored by pseudo-terminals [default: 115200].
+/// @param p_loop Running loop to read the port on [nullptr: own reader thread].
+/// @return Success [false: port could not be opened, "baud" is not supported or "p_loop" is not running].
+bool GateClient::open(const char *p_path, uint32_t baud, GateIoLoop *p_loop)
+{
+	close();
+	_fd = openPort(p_path, baud);
+	if (_fd < 0)
+		return false;
+	if (p_loop == nullptr && pipe2(_fdWake, O_NONBLOCK | O_CLOEXEC) != 0)
+	{
+		::close(_fd);
+		_fd = -1;
+		return false;
+	}
+
+	_parser.reset();
+	_isStopped = false;
+	_isOpen = true;
+	if (p_loop == nullptr)
+		_reader = std::thread(&GateClient::_readLoop, this);
+	else if (p_loop->_add(this))
+		_p_loop = p_loop;
+	else
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+/// @brief Stop the reader thread and close the port, completing pending requests with @ref ST_CLOSED.
+void GateClient::close()
+{
+	if (_reader.joinable())
+	{
+		_isStopped = true;
+		_wake();
+		_reader.join();
+	}
+	if (_p_loop != nullptr)
+		_p_loop->_remove(this);
+	{
+		std::lock_guard<std::mutex> lock_write(_mtxWrite);
+		_isOpen = false;
+		_p_loop = nullptr;
+		for (int fd : {_fd, _fdWake[0], _fdWake[1]})
+			if (fd >= 0)
+				::close(fd);
+		_fd = -1;
+		_fdWake[0] = _fdWake[1] = -1;
+	}
+	_failAll(ST_CLOSED);
+}
+
+/// @brief Set the function called with frames that match no pending request.
+///
+/// @details Called on the reader thread, e.g. with message type 12 log frames.
+///
+/// @param callback Frame callback [empty: drop unmatched frames].
+void GateClient::setFrameCallback(FrameCallback callback)
+{
+	std::lock_guard<std::mutex> lock(_mtxPending);
+	_frameCallback = callback;
+}
+
+/// @brief Send a message and call "callback" with its reply.
+///
+/// @param type Message type.
+/// @param r_data Message data, at most GateProtocol::maxData bytes.
+/// @param callback Completion callback.
+void GateClient::send(uint8_t type, const std::vector<uint8_t> &r_data, ReplyCallback callback)
+{
+	ReplyStruct reply;
+	reply.status = r_data.size() > GateProtocol::maxData ? (uint8_t)ST_ARG : _write(type, GateProtocol::encode(type, r_data), callback);
+	if (reply.status != ST_OK)
+		callback(reply);
+}
+
+/// @brief Send the unframed GO byte to start a move armed with message type 6.
+///
+/// @param callback Completion callback with the message type 7 reply.
+void GateClient::go(ReplyCallback callback)
+{
+	ReplyStruct reply;
+	reply.status = _write(GateProtocol::GO, std::vector<uint8_t>(1, GateProtocol::GO_BYTE), callback);
+	if (reply.status != ST_OK)
+		callback(reply);
+}
+
+/// @brief Write bytes without waiting for a reply, e.g. a message the firmware does not answer.
+///
+/// @details A reply that still arrives goes to the frame callback, or to a pending request of its type.
+///
+/// @param r_bytes Bytes to write, e.g. from GateProtocol::encode().
+/// @return Status [ST_OK, ST_CLOSED].
+uint8_t GateClient::writeRaw(const std::vector<uint8_t> &r_bytes)
+{
+	std::lock_guard<std::mutex> lock_write(_mtxWrite);
+	if (!_isOpen || !writeAll(_fd, r_bytes.data(), r_bytes.size()))
+		return ST_CLOSED;
+	nRequests++;
+	return ST_OK;
+}
+
+/// @brief Open a serial port raw (8N1, no flow control) and non-blocking.
+///
+/// @param p_path Serial port.
+/// @param baud Baud rate, ignored by pseudo-terminals.
+/// @return File descriptor [-1: port could not be opened or "baud" is not supported].
+int GateClient::openPort(const char *p_path, uint32_t baud)
+{
+	speed_t speed = baudFlag(baud);
+	if (speed == B0)
+		return -1;
+	int fd = ::open(p_path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+	if (fd < 0)
+		return -1;
+	struct termios tio;
+	if (tcgetattr(fd, &tio) == 0)
+	{
+		cfmakeraw(&tio);
+		tio.c_cflag |= CLOCAL | CREAD;
+		tio.c_cflag &= ~CRTSCTS;
+		cfsetispeed(&tio, speed);
+		cfsetospeed(&tio, speed);
+		tcsetattr(fd, TCSANOW, &tio);
+		tcflush(fd, TCIOFLUSH);
+	}
+	return fd;
+}
+
+/// @brief Queue the pending reply and write the bytes.
+///
+/// @param type Reply message type to wait for.
+/// @param r_bytes Bytes to write.
+/// @param callback Completion callback, not called unless the status is ST_OK.
+/// @return Status [ST_OK, ST_CLOSED].
+uint8_t GateClient::_write(uint8_t type, const std::vector<uint8_t> &r_bytes, ReplyCallback callback)
+{
+	std::lock_guard<std::mutex> lock_write(_mtxWrite);
+	if (!_isOpen)
+		return ST_CLOSED;
+	uint64_t ts_send = nowUs();
+	{
+		std::lock_guard<std::mutex> lock(_mtxPending);
+		_pending.push_back({type, ts_send, ts_send + (uint64_t)_dtTimeoutMs * 1000, callback});
+	}
+
+	// Let the reader wait for the new deadline
+	_wake();
+
+	if (!writeAll(_fd, r_bytes.data(), r_bytes.size()))
+	{
+		// Nothing after this entry can have been written, so it is the last one
+		std::lock_guard<std::mutex> lock(_mtxPending);
+		_pending.pop_back();
+		return ST_CLOSED;
+	}
+	nRequests++;
+	return ST_OK;
+}
+
+/// @brief Reader thread: wait for bytes or the next deadline, decode and dispatch frames.
+void GateClient::_readLoop()
+{
+	uint8_t buff[64];
+	while (!_isStopped)
+	{
+		struct pollfd pfds[2] = {{_fd, POLLIN, 0}, {_fdWake[0], POLLIN, 0}};
+		int n_ready = poll(pfds, 2, _waitMs());
+		if (n_ready < 0 && errno != EINTR)
+			break;
+		if (pfds[1].revents & POLLIN)
+			while (::read(_fdWake[0], buff, sizeof(buff)) > 0)
+			{
+			}
+		if ((pfds[0].revents & (POLLIN | POLLHUP | POLLERR)) && !_readReady())
+			break;
+		_expire(nowUs());
+	}
+}
+
+/// @brief Get the time to wait for the earliest request deadline.
+///
+/// @return Time (ms) [-1: no request pending].
+int GateClient::_waitMs()
+{
+	std::lock_guard<std::mutex> lock(_mtxPending);
+	if (_pending.empty())
+		return -1;
+	uint64_t ts_now = nowUs();
+	uint64_t ts_deadline = _pending.front().tsDeadline;
+	for (const PendingStruct &r_pend : _pending)
+		ts_deadline = r_pend.tsDeadline < ts_deadline ? r_pend.tsDeadline : ts_deadline;
+	return ts_deadline > ts_now ? (int)((ts_deadline - ts_now + 999) / 1000) : 0;
+}
+
+/// @brief Read the bytes waiting on the port and dispatch the frames they complete.
+///
+/// @return Port still open [false: lost, pending requests completed with @ref ST_CLOSED].
+bool GateClient::_readReady()
+{
+	uint8_t buff[1024];
+	GateProtocol::FrameStruct frame;
+	ssize_t n = ::read(_fd, buff, sizeof(buff));
+	if (n > 0)
+	{
+		uint64_t ts_recv = nowUs();
+		_parser.push(buff, n);
+		while (_parser.next(frame))
+			_dispatch(frame, ts_recv);
+		return true;
+	}
+	if (n < 0 && (errno == EAGAIN || errno == EINTR))
+		return true;
+
+	// Device unplugged or emulator stopped
+	_isOpen = false;
+	_failAll(ST_CLOSED);
+	return false;
+}
+
+/// @brief Complete the oldest pending request of the frame type or pass the frame to the frame callback.
+///
+/// @param r_frame Decoded frame.
+/// @param ts_recv Host receive time (us).
+void GateClient::_dispatch(const GateProtocol::FrameStruct &r_frame, uint64_t ts_recv)
+{
+	ReplyCallback callback;
+	FrameCallback frame_callback;
+	ReplyStruct reply;
+	{
+		std::lock_guard<std::mutex> lock(_mtxPending);
+		for (auto it = _pending.begin(); it != _pending.end(); ++it)
+			if (it->type == r_frame.type && r_frame.type != GateProtocol::LOG)
+			{
+				callback = it->callback;
+				reply.tsSend = it->tsSend;
+				_pending.erase(it);
+				break;
+			}
+		if (!callback)
+			frame_callback = _frameCallback;
+	}
+
+	if (callback)
+	{
+		reply.frame = r_frame;
+		reply.tsRecv = ts_recv;
+		nReplies++;
+		callback(reply);
+	}
+	else
+	{
+		nUnmatched++;
+		if (frame_callback)
+			frame_callback(r_frame);
+	}
+}
+
+/// @brief Complete requests whose deadline has passed with @ref ST_TIMEOUT.
+///
+/// @param ts_now Host time (us).
+void GateClient::_expire(uint64_t ts_now)
+{
+	std::vector<PendingStruct> expired;
+	{
+		std::lock_guard<std::mutex> lock(_mtxPending);
+		for (auto it = _pending.begin(); it != _pending.end();)
+		{
+			if (it->tsDeadline <= ts_now)
+			{
+				expired.push_back(*it);
+				it = _pending.erase(it);
+			}
+			else
+				++it;
+		}
+	}
+	for (const PendingStruct &r_pend : expired)
+	{
+		ReplyStruct reply;
+		reply.status = ST_TIMEOUT;
+		reply.tsSend = r_pend.tsSend;
+		reply.tsRecv = ts_now;
+		nTimeouts++;
+		r_pend.callback(reply);
+	}
+}
+
+/// @brief Complete all pending requests with "status".
+///
+/// @param status Completion status.
+void GateClient::_failAll(uint8_t status)
+{
+	std::deque<PendingStruct> failed;
+	{
+		std::lock_guard<std::mutex> lock(_mtxPending);
+		failed.swap(_pending);
+	}
+	for (const PendingStruct &r_pend : failed)
+	{
+		ReplyStruct reply;
+		reply.status = status;
+		reply.tsSend = r_pend.tsSend;
+		r_pend.callback(reply);
+	}
+}
+
+/// @brief Wake the reader thread, or the loop, from poll().
+void GateClient::_wake()
+{
+	if (_p_loop != nullptr)
+	{
+		_p_loop->_wake();
+		return;
+	}
+	uint8_t wake = 0;
+	ssize_t n = ::write(_fdWake[1], &wake, 1);
+	(void)n;
+}
@@ -0,0 +1,562 @@
+// ######################################
+
+//=========== GateDaemon.cpp ==========
+
+// ######################################
+
+//============= INCLUDE ================
+#include "GateDaemon.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+//============ FUNCTIONS ===============
+
+// Compare the wall fields of two states, ignoring the sequence number and timestamp
+static bool isSameWalls(const DaemonProtocol::WallStateStruct &r_a, const DaemonProtocol::WallStateStruct &r_b)
+{
+	return r_a.nChips == r_b.nChips &&
+		   memcmp(r_a.addr, r_b.addr, sizeof(r_a.addr)) == 0 &&
+		   memcmp(r_a.position, r_b.position, sizeof(r_a.position)) == 0 &&
+		   memcmp(r_a.target, r_b.target, sizeof(r_a.target)) == 0 &&
+		   memcmp(r_a.error, r_b.error, sizeof(r_a.error)) == 0 &&
+		   memcmp(r_a.moving, r_b.moving, sizeof(r_a.moving)) == 0;
+}
+
+// Check that a compact wall layout has one wall byte for each chip flagged in its bitmap, as the firmware does before staging it
+static bool isCompactLength(const uint8_t *p_data, size_t len, uint8_t n_chips)
+{
+	size_t n_map = (n_chips + 7) / 8;
+	if (len < n_map)
+		return false;
+	size_t n_set = 0;
+	for (uint8_t cyp_i = 0; cyp_i < n_chips; cyp_i++)
+		n_set += (p_data[cyp_i / 8] >> (cyp_i % 8)) & 1;
+	return n_map + n_set == len;
+}
+
+//========CLASS: GateDaemon==========
+
+const size_t GateDaemon::maxOutBytes;
+
+/// @brief DESTRUCTOR: Stop the event loop and remove the socket.
+GateDaemon::~GateDaemon()
+{
+	stop();
+}
+
+/// @brief Listen on the socket, read the wall state and start the event loop.
+///
+/// @param r_device Open controller link, used by the daemon until stop().
+/// @param p_socket Unix socket path, a stale socket file is replaced.
+/// @return Success [false: socket could not be created or another daemon is listening on it].
+bool GateDaemon::start(GateClient &r_device, const char *p_socket)
+{
+	stop();
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (strlen(p_socket) >= sizeof(addr.sun_path))
+		return false;
+	strcpy(addr.sun_path, p_socket);
+
+	// Keep a live daemon's socket, replace a stale one
+	int fd_probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	bool is_live = fd_probe >= 0 && connect(fd_probe, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+	if (fd_probe >= 0)
+		::close(fd_probe);
+	if (is_live)
+		return false;
+	unlink(p_socket);
+
+	_fdListen = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (_fdListen < 0 || bind(_fdListen, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(_fdListen, 64) != 0 ||
+		pipe2(_fdWake, O_NONBLOCK | O_CLOEXEC) != 0)
+	{
+		stop();
+		return false;
+	}
+	_pathSocket = p_socket;
+
+	{
+		std::lock_guard<std::mutex> lock(_mtxState);
+		_state = DaemonProtocol::WallStateStruct();
+		memset(_nMovePending, 0, sizeof(_nMovePending));
+		_armTarget.clear();
+	}
+	_p_device = &r_device;
+
+	// Moves started by the trigger pin are only reported by an unsolicited GO reply
+	r_device.setFrameCallback([this](const GateProtocol::FrameStruct &r_frame)
+							  {
+		if (r_frame.type == GateProtocol::GO)
+		{
+			GateLink::ReplyStruct reply;
+			reply.frame = r_frame;
+			_onReply(GateProtocol::GO, std::vector<uint8_t>(), reply);
+		} });
+	_refresh(false);
+
+	_isStopped = false;
+	_loop = std::thread(&GateDaemon::_runLoop, this);
+	return true;
+}
+
+/// @brief Stop the event loop, disconnect the clients and remove the socket.
+///
+/// @details Waits for the requests still pending on the controller link, which complete
+/// without a client, at most the controller link timeout.
+void GateDaemon::stop()
+{
+	if (_loop.joinable())
+	{
+		_isStopped = true;
+		uint8_t wake = 0;
+		ssize_t n = ::write(_fdWake[1], &wake, 1);
+		(void)n;
+		_loop.join();
+	}
+	if (_p_device != nullptr)
+		_p_device->setFrameCallback(GateClient::FrameCallback());
+	while (_nInFlight > 0)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	_p_device = nullptr;
+	for (auto &r_conn : _conns)
+		::close(r_conn.second.fd);
+	_conns.clear();
+	for (int fd : {_fdListen, _fdWake[0], _fdWake[1]})
+		if (fd >= 0)
+			::close(fd);
+	_fdListen = -1;
+	_fdWake[0] = _fdWake[1] = -1;
+	if (!_pathSocket.empty())
+		unlink(_pathSocket.c_str());
+	_pathSocket.clear();
+	std::lock_guard<std::mutex> lock(_mtxOut);
+	_out.clear();
+}
+
+/// @brief Get a copy of the cached wall state.
+///
+/// @return Wall state.
+DaemonProtocol::WallStateStruct GateDaemon::getState()
+{
+	std::lock_guard<std::mutex> lock(_mtxState);
+	return _state;
+}
+
+/// @brief Set the function called with the wall state after every change.
+///
+/// @details Called with the state lock held, in update order, from the event loop or the
+/// controller reader thread. It must return quickly and must not call back into the daemon.
+///
+/// @param callback State callback [empty: none].
+void GateDaemon::setStateCallback(StateCallback callback)
+{
+	std::lock_guard<std::mutex> lock(_mtxState);
+	_stateCallback = callback;
+}
+
+/// @brief Event loop: accept clients, read their messages and write queued output.
+void GateDaemon::_runLoop()
+{
+	std::vector<struct pollfd> pfds;
+	std::vector<uint32_t> conn_ids;
+	while (!_isStopped)
+	{
+		// Move queued replies and events to the client buffers
+		std::deque<OutStruct> out;
+		{
+			std::lock_guard<std::mutex> lock(_mtxOut);
+			out.swap(_out);
+		}
+		for (OutStruct &r_out : out)
+		{
+			for (auto &r_conn : _conns)
+				if (r_out.connId == r_conn.first || (r_out.connId == 0 && r_conn.second.isSubscribed))
+					r_conn.second.outBuff.insert(r_conn.second.outBuff.end(), r_out.bytes.begin(), r_out.bytes.end());
+		}
+		for (auto it = _conns.begin(); it != _conns.end();)
+		{
+			if (!it->second.outBuff.empty() && !_writeConn(it->second))
+			{
+				::close(it->second.fd);
+				it = _conns.erase(it);
+			}
+			else
+				++it;
+		}
+
+		pfds.clear();
+		conn_ids.clear();
+		pfds.push_back({_fdListen, POLLIN, 0});
+		pfds.push_back({_fdWake[0], POLLIN, 0});
+		for (auto &r_conn : _conns)
+		{
+			pfds.push_back({r_conn.second.fd, (short)(POLLIN | (r_conn.second.outBuff.empty() ? 0 : POLLOUT)), 0});
+			conn_ids.push_back(r_conn.first);
+		}
+		if (poll(pfds.data(), pfds.size(), -1) < 0 && errno != EINTR)
+			break;
+
+		uint8_t buff[256];
+		if (pfds[1].revents & POLLIN)
+			while (::read(_fdWake[0], buff, sizeof(buff)) > 0)
+			{
+			}
+		if (pfds[0].revents & POLLIN)
+			_accept();
+		for (size_t conn_i = 0; conn_i < conn_ids.size(); conn_i++)
+		{
+			auto it = _conns.find(conn_ids[conn_i]);
+			short revents = pfds[conn_i + 2].revents;
+			if (revents == 0 || it == _conns.end())
+				continue;
+			bool is_ok = true;
+			if (revents & (POLLIN | POLLHUP | POLLERR))
+				is_ok = _readConn(it->first, it->second);
+			if (is_ok && (revents & POLLOUT))
+				is_ok = _writeConn(it->second);
+			if (!is_ok)
+			{
+				::close(it->second.fd);
+				_conns.erase(it);
+			}
+		}
+	}
+}
+
+/// @brief Accept pending connections.
+void GateDaemon::_accept()
+{
+	int fd;
+	while ((fd = accept4(_fdListen, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+	{
+		_conns[_connIdNext++].fd = fd;
+		nClients++;
+	}
+}
+
+/// @brief Read and handle a client's messages.
+///
+/// @param conn_id Connection id.
+/// @param r_conn Connection.
+/// @return Keep the connection [false: closed by the client or bad message].
+bool GateDaemon::_readConn(uint32_t conn_id, ConnStruct &r_conn)
+{
+	uint8_t buff[4096];
+	ssize_t n = ::read(r_conn.fd, buff, sizeof(buff));
+	if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR))
+		return false;
+	if (n < 0)
+		return true;
+	r_conn.parser.push(buff, n);
+	DaemonProtocol::MsgStruct msg;
+	uint8_t status;
+	while ((status = r_conn.parser.next(msg)) == 1)
+		_handle(conn_id, r_conn, msg);
+	if (status == 255)
+		nDropped++;
+	return status != 255;
+}
+
+/// @brief Write as much buffered output as the socket takes.
+///
+/// @param r_conn Connection.
+/// @return Keep the connection [false: write error or too much unsent output].
+bool GateDaemon::_writeConn(ConnStruct &r_conn)
+{
+	ssize_t n = ::send(r_conn.fd, r_conn.outBuff.data(), r_conn.outBuff.size(), MSG_NOSIGNAL);
+	if (n < 0)
+		return errno == EAGAIN || errno == EINTR;
+	r_conn.outBuff.erase(r_conn.outBuff.begin(), r_conn.outBuff.begin() + n);
+	if (r_conn.outBuff.size() > maxOutBytes)
+	{
+		nDropped++;
+		return false;
+	}
+	return true;
+}
+
+/// @brief Handle a client message.
+///
+/// @param conn_id Connection id.
+/// @param r_conn Connection.
+/// @param r_msg Message.
+void GateDaemon::_handle(uint32_t conn_id, ConnStruct &r_conn, const DaemonProtocol::MsgStruct &r_msg)
+{
+	DaemonProtocol::MsgStruct reply;
+	reply.id = r_msg.id;
+	reply.type = r_msg.type;
+	if (r_msg.kind == DaemonProtocol::REQUEST)
+	{
+		// Forward to the controller, the reply is queued from the controller reader thread
+		nRequests++;
+		uint8_t type = r_msg.type;
+		std::vector<uint8_t> data = r_msg.data;
+		uint32_t id = r_msg.id;
+		GateLink::ReplyCallback callback = [this, conn_id, id, type, data](const GateLink::ReplyStruct &r_reply)
+		{
+			_onReply(type, data, r_reply);
+			DaemonProtocol::MsgStruct msg;
+			msg.kind = DaemonProtocol::REPLY;
+			msg.id = id;
+			msg.status = r_reply.status;
+			msg.type = r_reply.status == GateLink::ST_OK ? r_reply.frame.type : type;
+			msg.data = r_reply.frame.data;
+			msg.ts = r_reply.frame.ts;
+			_queue(conn_id, msg);
+			_nInFlight--;
+		};
+		if (data.size() > GateProtocol::maxData)
+		{
+			GateLink::ReplyStruct fail;
+			fail.status = GateLink::ST_ARG;
+			_nInFlight++;
+			callback(fail);
+			return;
+		}
+		_onSend(type, data);
+		_nInFlight++;
+		if (type == GateProtocol::GO)
+			_p_device->go(callback);
+		else
+			_p_device->send(type, data, callback);
+		return;
+	}
+
+	reply.kind = DaemonProtocol::STATE;
+	if (r_msg.kind == DaemonProtocol::STATUS)
+		nStatus++;
+	else if (r_msg.kind == DaemonProtocol::SUBSCRIBE)
+		r_conn.isSubscribed = true;
+	else if (r_msg.kind == DaemonProtocol::UNSUBSCRIBE)
+	{
+		reply.status = r_conn.isSubscribed ? (uint8_t)GateLink::ST_OK : DaemonProtocol::ST_NOT_SUBSCRIBED;
+		r_conn.isSubscribed = false;
+	}
+	else
+	{
+		reply.kind = DaemonProtocol::REPLY;
+		reply.status = GateLink::ST_ARG;
+	}
+	if (reply.kind == DaemonProtocol::STATE)
+	{
+		std::lock_guard<std::mutex> lock(_mtxState);
+		reply.data = DaemonProtocol::packState(_state);
+		reply.ts = _state.tsDevice;
+	}
+
+	// Written directly, so a SUBSCRIBE reply always comes before the first event
+	std::vector<uint8_t> bytes = DaemonProtocol::encode(reply);
+	r_conn.outBuff.insert(r_conn.outBuff.end(), bytes.begin(), bytes.end());
+}
+
+/// @brief Queue a message for a client and wake the event loop.
+///
+/// @param conn_id Connection id [0: all subscribed clients].
+/// @param r_msg Message.
+void GateDaemon::_queue(uint32_t conn_id, const DaemonProtocol::MsgStruct &r_msg)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mtxOut);
+		_out.push_back({conn_id, DaemonProtocol::encode(r_msg)});
+	}
+	uint8_t wake = 0;
+	ssize_t n = ::write(_fdWake[1], &wake, 1);
+	(void)n;
+}
+
+/// @brief Read the wall positions from the controller into the cache.
+///
+/// @param is_gate_init Refresh after a gate init, which ends the walls moving down.
+void GateDaemon::_refresh(bool is_gate_init)
+{
+	_nInFlight++;
+	_p_device->send(GateProtocol::MOVE, std::vector<uint8_t>(), [this, is_gate_init](const GateLink::ReplyStruct &r_reply)
+					{
+		_onReply(GateProtocol::MOVE, std::vector<uint8_t>(), r_reply, is_gate_init);
+		_nInFlight--; });
+}
+
+/// @brief Mark the walls a forwarded request will move.
+///
+/// @param type Message type.
+/// @param r_data Message data.
+void GateDaemon::_onSend(uint8_t type, const std::vector<uint8_t> &r_data)
+{
+	std::lock_guard<std::mutex> lock(_mtxState);
+	DaemonProtocol::WallStateStruct state_last = _state;
+	std::vector<int16_t> walls(_state.nChips, -1);
+	bool is_compact_ok = isCompactLength(r_data.data(), r_data.size(), _state.nChips);
+	if (type == GateProtocol::MOVE)
+		for (size_t cyp_i = 0; cyp_i < r_data.size() && cyp_i < _state.nChips; cyp_i++)
+			walls[cyp_i] = r_data[cyp_i];
+	else if (type == GateProtocol::MOVE_COMPACT)
+		walls = _parseCompact(r_data.data(), r_data.size(), _state.nChips);
+	else if (type == GateProtocol::GATE_INIT)
+		walls.assign(_state.nChips, 0xFF);
+	else if (type == GateProtocol::ARM && is_compact_ok)
+		_armTarget = _parseCompact(r_data.data(), r_data.size(), _state.nChips);
+	else if (type == GateProtocol::APPLY_CONFIG)
+		_armTarget.clear(); // a stored configuration replaces any armed walls with unknown ones
+	if (type == GateProtocol::MOVE || (type == GateProtocol::MOVE_COMPACT && is_compact_ok))
+		_armTarget.clear(); // the controller disarms when a new move is staged, a compact move with a bad length is rejected first
+
+	for (uint8_t cyp_i = 0; cyp_i < walls.size(); cyp_i++)
+	{
+		if (walls[cyp_i] < 0)
+			continue;
+		_state.target[cyp_i] = walls[cyp_i];
+		_state.moving[cyp_i] |= walls[cyp_i] ^ _state.position[cyp_i];
+		_nMovePending[cyp_i]++;
+	}
+	if (!isSameWalls(state_last, _state))
+		_publish();
+}
+
+/// @brief Update the cached wall state from a controller reply.
+///
+/// @param type Request message type.
+/// @param r_data Request data.
+/// @param r_reply Completed request.
+/// @param is_gate_init Reply of the refresh after a gate init [default: false].
+void GateDaemon::_onReply(uint8_t type, const std::vector<uint8_t> &r_data, const GateLink::ReplyStruct &r_reply, bool is_gate_init)
+{
+	std::unique_lock<std::mutex> lock(_mtxState);
+	DaemonProtocol::WallStateStruct state_last = _state;
+	const std::vector<uint8_t> &r_reply_data = r_reply.frame.data;
+	bool is_ok = r_reply.status == GateLink::ST_OK;
+	bool do_refresh = false;
+
+	if (type == GateProtocol::INIT && is_ok)
+	{
+		// New scan, the old positions no longer apply
+		_state = DaemonProtocol::WallStateStruct();
+		_state.seq = state_last.seq;
+		_state.nChips = r_reply_data.size() < DaemonProtocol::maxChips ? r_reply_data.size() : DaemonProtocol::maxChips;
+		memcpy(_state.addr, r_reply_data.data(), _state.nChips);
+		memset(_nMovePending, 0, sizeof(_nMovePending));
+		_armTarget.clear();
+	}
+	else if (type == GateProtocol::GATE_INIT)
+	{
+		// All walls up, then moving down until the refresh reply
+		for (uint8_t cyp_i = 0; cyp_i < _state.nChips; cyp_i++)
+		{
+			if (is_ok && cyp_i < r_reply_data.size())
+				_state.position[cyp_i] = r_reply_data[cyp_i];
+			_endMove(cyp_i, is_ok);
+			_state.target[cyp_i] = 0x00;
+			_state.moving[cyp_i] = _state.position[cyp_i];
+			_nMovePending[cyp_i]++;
+		}
+		do_refresh = true;
+	}
+	else if (type == GateProtocol::MOVE)
+	{
+		// Chips found by the scan in the firmware setup() if no INIT was sent since the daemon started
+		if (is_ok && _state.nChips == 0)
+			_state.nChips = r_reply_data.size() < DaemonProtocol::maxChips ? r_reply_data.size() : DaemonProtocol::maxChips;
+		if (is_ok)
+			for (uint8_t cyp_i = 0; cyp_i < _state.nChips && cyp_i < r_reply_data.size(); cyp_i++)
+				_state.position[cyp_i] = r_reply_data[cyp_i];
+		for (uint8_t cyp_i = 0; cyp_i < _state.nChips && cyp_i < r_data.size(); cyp_i++)
+			_endMove(cyp_i, is_ok);
+		if (is_gate_init)
+			for (uint8_t cyp_i = 0; cyp_i < _state.nChips; cyp_i++)
+				_endMove(cyp_i, is_ok);
+	}
+	else if (type == GateProtocol::MOVE_COMPACT || type == GateProtocol::GO ||
+			 (type == GateProtocol::APPLY_CONFIG && !(r_data.size() > 1 && r_data[1] == 1)))
+	{
+		// Reply has the changed walls, after the status byte and 4 byte trigger latency for GO and the status byte for a stored configuration
+		size_t n_head = type == GateProtocol::GO ? 5 : type == GateProtocol::APPLY_CONFIG ? 1 : 0;
+		if (is_ok && r_reply_data.size() >= n_head)
+		{
+			std::vector<int16_t> walls = _parseCompact(r_reply_data.data() + n_head, r_reply_data.size() - n_head, _state.nChips);
+			for (uint8_t cyp_i = 0; cyp_i < walls.size(); cyp_i++)
+				if (walls[cyp_i] >= 0)
+					_state.position[cyp_i] = walls[cyp_i];
+		}
+		if (type == GateProtocol::MOVE_COMPACT)
+		{
+			std::vector<int16_t> walls = _parseCompact(r_data.data(), r_data.size(), _state.nChips);
+			for (uint8_t cyp_i = 0; cyp_i < walls.size(); cyp_i++)
+				if (walls[cyp_i] >= 0)
+					_endMove(cyp_i, is_ok);
+		}
+		else if (type == GateProtocol::GO && is_ok && !r_reply_data.empty() && r_reply_data[0] != 0)
+		{
+			for (uint8_t cyp_i = 0; cyp_i < _armTarget.size() && cyp_i < _state.nChips; cyp_i++)
+				if (_armTarget[cyp_i] >= 0)
+				{
+					_state.target[cyp_i] = _armTarget[cyp_i];
+					_state.error[cyp_i] = _state.target[cyp_i] ^ _state.position[cyp_i];
+				}
+			_armTarget.clear();
+		}
+	}
+
+	if (is_ok)
+		_state.tsDevice = r_reply.frame.ts;
+	if (!isSameWalls(state_last, _state))
+		_publish();
+	else
+		_state.tsDevice = state_last.tsDevice;
+	lock.unlock();
+
+	if (do_refresh)
+		_refresh(true);
+}
+
+/// @brief End one pending move of a chip, the caller holds _mtxState.
+///
+/// @param cyp_i Chip index.
+/// @param is_ok The move reply was received, so the missed walls are known.
+void GateDaemon::_endMove(uint8_t cyp_i, bool is_ok)
+{
+	if (is_ok)
+		_state.error[cyp_i] = _state.target[cyp_i] ^ _state.position[cyp_i];
+	if (_nMovePending[cyp_i] > 0)
+		_nMovePending[cyp_i]--;
+	if (_nMovePending[cyp_i] == 0)
+		_state.moving[cyp_i] = 0;
+}
+
+/// @brief Count a state change, broadcast it and pass it to the state callback, the caller holds _mtxState.
+void GateDaemon::_publish()
+{
+	_state.seq++;
+	nEvents++;
+	DaemonProtocol::MsgStruct msg;
+	msg.kind = DaemonProtocol::EVENT;
+	msg.id = _state.seq;
+	msg.data = DaemonProtocol::packState(_state);
+	msg.ts = _state.tsDevice;
+	_queue(0, msg);
+	if (_stateCallback)
+		_stateCallback(_state);
+}
+
+/// @brief Decode the compact wall layout: a chip bitmap of (n_chips + 7) / 8 bytes followed by one wall byte for each flagged chip.
+///
+/// @param p_data Layout bytes.
+/// @param len Number of bytes.
+/// @param n_chips Number of chips.
+/// @return Wall byte of each chip [-1: not flagged, all -1 if the length does not match the bitmap].
+std::vector<int16_t> GateDaemon::_parseCompact(const uint8_t *p_data, size_t len, uint8_t n_chips)
+{
+	std::vector<int16_t> walls(n_chips, -1);
+	if (!isCompactLength(p_data, len, n_chips))
+		return walls;
+	size_t pos = (n_chips + 7) / 8;
+	for (uint8_t cyp_i = 0; cyp_i < n_chips; cyp_i++)
+		if (p_data[cyp_i / 8] & (1 << (cyp_i % 8)))
+			walls[cyp_i] = p_data[pos++];
+	return walls;
+}
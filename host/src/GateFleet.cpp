@@ -0,0 +1,323 @@
+// ######################################
+
+//============ GateFleet.cpp ==========
+
+// ######################################
+
+//============= INCLUDE ================
+#include "GateFleet.h"
+
+//========CLASS: GateFleet==========
+
+/// @brief DESTRUCTOR: Close all devices, completing pending requests with GateLink::ST_CLOSED.
+GateFleet::~GateFleet()
+{
+	close();
+}
+
+/// @brief Start the I/O loop and open every device on it.
+///
+/// @param r_paths Serial ports, in global chip order.
+/// @param baud Baud rate of all ports [default: 115200].
+/// @return Success [false: a port could not be opened, none are left open].
+bool GateFleet::open(const std::vector<std::string> &r_paths, uint32_t baud)
+{
+	close();
+	if (r_paths.empty() || !_loop.start())
+		return false;
+	for (const std::string &r_path : r_paths)
+	{
+		_devices.push_back(std::unique_ptr<GateClient>(new GateClient()));
+		if (!_devices.back()->open(r_path.c_str(), baud, &_loop))
+		{
+			close();
+			return false;
+		}
+	}
+	std::lock_guard<std::mutex> lock(_mtxChips);
+	_nChips.assign(_devices.size(), 0);
+	return true;
+}
+
+/// @brief Close all devices and stop the I/O loop.
+void GateFleet::close()
+{
+	for (std::unique_ptr<GateClient> &r_device : _devices)
+		r_device->close();
+	_loop.stop();
+	_devices.clear();
+	std::lock_guard<std::mutex> lock(_mtxChips);
+	_nChips.clear();
+}
+
+/// @brief Set the reply timeout of every device.
+///
+/// @param dt_ms Timeout (ms).
+void GateFleet::setTimeout(uint32_t dt_ms)
+{
+	for (std::unique_ptr<GateClient> &r_device : _devices)
+		r_device->setTimeout(dt_ms);
+}
+
+/// @brief Set the chip count of each device without scanning.
+///
+/// @param r_chips Chips per device, one entry per device.
+void GateFleet::setChips(const std::vector<uint8_t> &r_chips)
+{
+	std::lock_guard<std::mutex> lock(_mtxChips);
+	if (r_chips.size() == _devices.size())
+		_nChips = r_chips;
+}
+
+/// @brief Get the chip count of each device.
+///
+/// @return Chips per device.
+std::vector<uint8_t> GateFleet::getChips() const
+{
+	std::lock_guard<std::mutex> lock(_mtxChips);
+	return _nChips;
+}
+
+/// @brief Get the chip count of the whole fleet.
+///
+/// @return Global chips.
+uint16_t GateFleet::nChipsTotal() const
+{
+	std::lock_guard<std::mutex> lock(_mtxChips);
+	uint16_t n_chips = 0;
+	for (uint8_t n : _nChips)
+		n_chips += n;
+	return n_chips;
+}
+
+/// @brief Find the device and local chip of a global chip.
+///
+/// @param chip_i Global chip index.
+/// @param r_dev Device index.
+/// @param r_chip Chip index on the device.
+/// @return Success [false: "chip_i" is past the last chip].
+bool GateFleet::locateChip(uint16_t chip_i, uint8_t &r_dev, uint8_t &r_chip) const
+{
+	std::lock_guard<std::mutex> lock(_mtxChips);
+	for (size_t dev_i = 0; dev_i < _nChips.size(); dev_i++)
+	{
+		if (chip_i < _nChips[dev_i])
+		{
+			r_dev = (uint8_t)dev_i;
+			r_chip = (uint8_t)chip_i;
+			return true;
+		}
+		chip_i -= _nChips[dev_i];
+	}
+	return false;
+}
+
+/// @brief Build the global wall bytes for @ref moveWalls() from the walls to raise.
+///
+/// @param r_walls Global wall indices to raise, all others are lowered.
+/// @return One byte per global chip [empty: an index is past the last wall].
+std::vector<uint8_t> GateFleet::wallBytes(const std::vector<uint16_t> &r_walls) const
+{
+	std::vector<uint8_t> wall_bytes(nChipsTotal(), 0);
+	for (uint16_t wall_i : r_walls)
+	{
+		if (wall_i / 8 >= wall_bytes.size())
+			return std::vector<uint8_t>();
+		wall_bytes[wall_i / 8] |= 1 << (wall_i % 8);
+	}
+	return wall_bytes;
+}
+
+/// @brief Scan the chips of every device (message type 0) and store their counts.
+///
+/// @param callback Completion callback, data is the chip addresses in global order.
+void GateFleet::initChips(FleetCallback callback)
+{
+	std::vector<std::vector<uint8_t>> data(_devices.size());
+	_fanOut(GateProtocol::INIT, data, std::vector<bool>(_devices.size(), true), [this, callback](const FleetReplyStruct &r_reply)
+			{
+		{
+			std::lock_guard<std::mutex> lock(_mtxChips);
+			for (size_t dev_i = 0; dev_i < r_reply.devices.size() && dev_i < _nChips.size(); dev_i++)
+				if (r_reply.devices[dev_i].status == GateLink::ST_OK)
+					_nChips[dev_i] = (uint8_t)r_reply.devices[dev_i].frame.data.size();
+		}
+		callback(r_reply); });
+}
+
+/// @brief Scan the chips of every device and store their counts.
+///
+/// @return Future of the chip addresses in global order.
+std::future<GateFleet::FleetReplyStruct> GateFleet::initChips()
+{
+	return _future([this](FleetCallback callback)
+				   { initChips(callback); });
+}
+
+/// @brief Initialize the gates of every device (message type 1).
+///
+/// @param callback Completion callback.
+void GateFleet::initGates(FleetCallback callback)
+{
+	std::vector<std::vector<uint8_t>> data(_devices.size());
+	_fanOut(GateProtocol::GATE_INIT, data, std::vector<bool>(_devices.size(), true), callback);
+}
+
+/// @brief Initialize the gates of every device.
+///
+/// @return Future of the raised wall positions in global order.
+std::future<GateFleet::FleetReplyStruct> GateFleet::initGates()
+{
+	return _future([this](FleetCallback callback)
+				   { initGates(callback); });
+}
+
+/// @brief Move the walls of every device at once (message type 2).
+///
+/// @param r_wallBytes One byte per global chip (bit set: wall up), see @ref wallBytes().
+/// @param callback Completion callback, data is the wall positions in global order.
+void GateFleet::moveWalls(const std::vector<uint8_t> &r_wallBytes, FleetCallback callback)
+{
+	std::vector<uint8_t> n_chips = getChips();
+	std::vector<std::vector<uint8_t>> data(n_chips.size());
+	std::vector<bool> is_sent(n_chips.size());
+	size_t pos = 0;
+	for (size_t dev_i = 0; dev_i < n_chips.size(); dev_i++)
+	{
+		is_sent[dev_i] = n_chips[dev_i] > 0 && pos + n_chips[dev_i] <= r_wallBytes.size();
+		if (is_sent[dev_i])
+			data[dev_i].assign(r_wallBytes.begin() + pos, r_wallBytes.begin() + pos + n_chips[dev_i]);
+		pos += n_chips[dev_i];
+	}
+	if (pos == 0 || pos != r_wallBytes.size())
+	{
+		FleetReplyStruct reply;
+		reply.status = GateLink::ST_ARG;
+		callback(reply);
+		return;
+	}
+	_fanOut(GateProtocol::MOVE, data, is_sent, callback);
+}
+
+/// @brief Move the walls of every device at once.
+///
+/// @param r_wallBytes One byte per global chip (bit set: wall up).
+/// @return Future of the wall positions in global order.
+std::future<GateFleet::FleetReplyStruct> GateFleet::moveWalls(const std::vector<uint8_t> &r_wallBytes)
+{
+	return _future([this, r_wallBytes](FleetCallback callback)
+				   { moveWalls(r_wallBytes, callback); });
+}
+
+/// @brief Read the wall positions of every device (message type 2 without data).
+///
+/// @param callback Completion callback, data is the wall positions in global order.
+void GateFleet::readWalls(FleetCallback callback)
+{
+	std::vector<uint8_t> n_chips = getChips();
+	std::vector<bool> is_sent(n_chips.size());
+	bool is_any = false;
+	for (size_t dev_i = 0; dev_i < n_chips.size(); dev_i++)
+		is_any |= is_sent[dev_i] = n_chips[dev_i] > 0;
+	if (!is_any)
+	{
+		FleetReplyStruct reply;
+		reply.status = GateLink::ST_ARG;
+		callback(reply);
+		return;
+	}
+	_fanOut(GateProtocol::MOVE, std::vector<std::vector<uint8_t>>(n_chips.size()), is_sent, callback);
+}
+
+/// @brief Read the wall positions of every device.
+///
+/// @return Future of the wall positions in global order.
+std::future<GateFleet::FleetReplyStruct> GateFleet::readWalls()
+{
+	return _future([this](FleetCallback callback)
+				   { readWalls(callback); });
+}
+
+/// @brief Write one message to each selected device and complete once all have replied.
+///
+/// @param type Message type.
+/// @param r_data Message data of each device.
+/// @param r_isSent Devices to send to, the others complete as ST_OK without a frame.
+/// @param callback Completion callback, run by the last device reply.
+void GateFleet::_fanOut(uint8_t type, const std::vector<std::vector<uint8_t>> &r_data, const std::vector<bool> &r_isSent, FleetCallback callback)
+{
+	struct FanOutStruct
+	{
+		std::mutex mtx;
+		size_t nLeft = 0;
+		std::vector<bool> isSent;
+		FleetReplyStruct reply;
+		FleetCallback callback;
+	};
+	std::shared_ptr<FanOutStruct> p_fan = std::make_shared<FanOutStruct>();
+	p_fan->isSent = r_isSent;
+	p_fan->callback = callback;
+	p_fan->reply.devices.resize(_devices.size());
+	for (bool is_sent : r_isSent)
+		p_fan->nLeft += is_sent;
+	p_fan->reply.tsSend = GateLink::nowUs();
+	nRequests++;
+
+	// Combine the device replies in device order
+	std::function<void()> complete = [this, p_fan]()
+	{
+		FleetReplyStruct &r_reply = p_fan->reply;
+		uint64_t ts_first = 0;
+		for (size_t dev_i = 0; dev_i < r_reply.devices.size(); dev_i++)
+		{
+			if (!p_fan->isSent[dev_i])
+				continue;
+			const GateLink::ReplyStruct &r_dev = r_reply.devices[dev_i];
+			if (r_dev.status != GateLink::ST_OK && r_reply.status == GateLink::ST_OK)
+				r_reply.status = r_dev.status;
+			r_reply.data.insert(r_reply.data.end(), r_dev.frame.data.begin(), r_dev.frame.data.end());
+			ts_first = ts_first == 0 || r_dev.tsRecv < ts_first ? r_dev.tsRecv : ts_first;
+			r_reply.tsRecv = r_dev.tsRecv > r_reply.tsRecv ? r_dev.tsRecv : r_reply.tsRecv;
+		}
+		r_reply.dtSkewUs = r_reply.tsRecv - ts_first;
+		if (r_reply.status != GateLink::ST_OK)
+		{
+			r_reply.data.clear();
+			nFailed++;
+		}
+		p_fan->callback(r_reply);
+	};
+	if (p_fan->nLeft == 0)
+	{
+		complete();
+		return;
+	}
+
+	for (size_t dev_i = 0; dev_i < _devices.size(); dev_i++)
+	{
+		if (!r_isSent[dev_i])
+			continue;
+		_devices[dev_i]->send(type, r_data[dev_i], [p_fan, dev_i, complete](const GateLink::ReplyStruct &r_dev)
+							  {
+			bool is_last;
+			{
+				std::lock_guard<std::mutex> lock(p_fan->mtx);
+				p_fan->reply.devices[dev_i] = r_dev;
+				is_last = --p_fan->nLeft == 0;
+			}
+			if (is_last)
+				complete(); });
+	}
+}
+
+/// @brief Run a callback request and get a future for its completion.
+///
+/// @param request Function starting the request with a completion callback.
+/// @return Future of the fleet reply.
+std::future<GateFleet::FleetReplyStruct> GateFleet::_future(std::function<void(FleetCallback)> request)
+{
+	std::shared_ptr<std::promise<FleetReplyStruct>> p_prom = std::make_shared<std::promise<FleetReplyStruct>>();
+	request([p_prom](const FleetReplyStruct &r_reply)
+			{ p_prom->set_value(r_reply); });
+	return p_prom->get_future();
+}
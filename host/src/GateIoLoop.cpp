@@ -0,0 +1,138 @@
+// ######################################
+
+//============ GateIoLoop.cpp =========
+
+// ######################################
+
+//============= INCLUDE ================
+#include "GateIoLoop.h"
+#include "GateClient.h"
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+//========CLASS: GateIoLoop==========
+
+/// @brief DESTRUCTOR: Stop the loop, closing the clients still on it.
+GateIoLoop::~GateIoLoop()
+{
+	stop();
+}
+
+/// @brief Start the loop thread.
+///
+/// @return Success [false: already running or no wake pipe].
+bool GateIoLoop::start()
+{
+	if (_thread.joinable() || pipe2(_fdWake, O_NONBLOCK | O_CLOEXEC) != 0)
+		return false;
+	_isStopped = false;
+	_thread = std::thread(&GateIoLoop::_run, this);
+	return true;
+}
+
+/// @brief Stop the loop thread and close the clients still on it.
+void GateIoLoop::stop()
+{
+	if (!_thread.joinable())
+		return;
+	_isStopped = true;
+	_wake();
+	_thread.join();
+	std::vector<GateClient *> clients;
+	{
+		std::lock_guard<std::recursive_mutex> lock(_mtx);
+		clients = _clients;
+	}
+	for (GateClient *p_client : clients)
+		p_client->close();
+	for (int fd : {_fdWake[0], _fdWake[1]})
+		if (fd >= 0)
+			::close(fd);
+	_fdWake[0] = _fdWake[1] = -1;
+}
+
+/// @brief Start servicing an open client.
+///
+/// @param p_client Client.
+/// @return Success [false: loop not running].
+bool GateIoLoop::_add(GateClient *p_client)
+{
+	if (!_thread.joinable() || _isStopped)
+		return false;
+	{
+		std::lock_guard<std::recursive_mutex> lock(_mtx);
+		_clients.push_back(p_client);
+	}
+	_wake();
+	return true;
+}
+
+/// @brief Stop servicing a client, waiting for the loop to finish with it unless called from the loop thread.
+///
+/// @param p_client Client.
+void GateIoLoop::_remove(GateClient *p_client)
+{
+	std::lock_guard<std::recursive_mutex> lock(_mtx);
+	_clients.erase(std::remove(_clients.begin(), _clients.end(), p_client), _clients.end());
+}
+
+/// @brief Check if a client is still serviced, with _mtx held.
+///
+/// @param p_client Client.
+/// @return Client on the loop.
+bool GateIoLoop::_isAdded(GateClient *p_client)
+{
+	return std::find(_clients.begin(), _clients.end(), p_client) != _clients.end();
+}
+
+/// @brief Wake the loop thread from poll() to pick up new clients or deadlines.
+void GateIoLoop::_wake()
+{
+	uint8_t wake = 0;
+	ssize_t n = ::write(_fdWake[1], &wake, 1);
+	(void)n;
+}
+
+/// @brief Loop thread: wait on all client ports and the earliest deadline, then service the ready clients.
+void GateIoLoop::_run()
+{
+	std::vector<GateClient *> clients;
+	std::vector<struct pollfd> pfds;
+	uint8_t buff[64];
+	while (!_isStopped)
+	{
+		int dt_wait_ms = -1;
+		pfds.assign(1, {_fdWake[0], POLLIN, 0});
+		{
+			std::lock_guard<std::recursive_mutex> lock(_mtx);
+			clients = _clients;
+			for (GateClient *p_client : clients)
+			{
+				pfds.push_back({p_client->_fd, POLLIN, 0});
+				int dt_ms = p_client->_waitMs();
+				dt_wait_ms = dt_ms >= 0 && (dt_wait_ms < 0 || dt_ms < dt_wait_ms) ? dt_ms : dt_wait_ms;
+			}
+		}
+
+		if (poll(pfds.data(), pfds.size(), dt_wait_ms) < 0 && errno != EINTR)
+			break;
+		nPolls++;
+		if (pfds[0].revents & POLLIN)
+			while (::read(_fdWake[0], buff, sizeof(buff)) > 0)
+			{
+			}
+
+		// Clients closed since the poll are skipped, lost ones are dropped from the loop
+		std::lock_guard<std::recursive_mutex> lock(_mtx);
+		for (size_t cli_i = 0; cli_i < clients.size(); cli_i++)
+			if ((pfds[cli_i + 1].revents & (POLLIN | POLLHUP | POLLERR)) && _isAdded(clients[cli_i]) && !clients[cli_i]->_readReady())
+				_remove(clients[cli_i]);
+		uint64_t ts_now = GateLink::nowUs();
+		for (GateClient *p_client : clients)
+			if (_isAdded(p_client))
+				p_client->_expire(ts_now);
+	}
+}
@@ -0,0 +1,43 @@
+// ######################################
+
+//============= GateLink.cpp ==========
+
+// ######################################
+
+//============= INCLUDE ================
+#include "GateLink.h"
+#include <chrono>
+
+//========CLASS: GateLink==========
+
+/// @brief Send a message and get a future for its reply.
+///
+/// @param type Message type.
+/// @param r_data Message data, at most GateProtocol::maxData bytes [default: none].
+/// @return Future of the completed request.
+std::future<GateLink::ReplyStruct> GateLink::send(uint8_t type, const std::vector<uint8_t> &r_data)
+{
+	std::shared_ptr<std::promise<ReplyStruct>> p_prom = std::make_shared<std::promise<ReplyStruct>>();
+	send(type, r_data, [p_prom](const ReplyStruct &r_reply)
+		 { p_prom->set_value(r_reply); });
+	return p_prom->get_future();
+}
+
+/// @brief Start a move armed with message type 6.
+///
+/// @return Future of the message type 7 reply with the changed walls.
+std::future<GateLink::ReplyStruct> GateLink::go()
+{
+	std::shared_ptr<std::promise<ReplyStruct>> p_prom = std::make_shared<std::promise<ReplyStruct>>();
+	go([p_prom](const ReplyStruct &r_reply)
+	   { p_prom->set_value(r_reply); });
+	return p_prom->get_future();
+}
+
+/// @brief Host monotonic clock used for the request timestamps.
+///
+/// @return Time (us).
+uint64_t GateLink::nowUs()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
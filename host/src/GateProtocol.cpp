@@ -0,0 +1,194 @@
+// ######################################
+
+//=========== GateProtocol.cpp ========
+
+// ######################################
+
+//============= INCLUDE ================
+#include "GateProtocol.h"
+
+//========CLASS: GateProtocol==========
+
+// Definitions for constants passed by reference
+const uint8_t GateProtocol::START_BYTE;
+const uint8_t GateProtocol::END_BYTE;
+const uint8_t GateProtocol::GO_BYTE;
+const uint8_t GateProtocol::maxData;
+const uint8_t GateProtocol::headSize;
+const uint8_t GateProtocol::tailSize;
+
+/// @brief Encode a host to device frame.
+///
+/// @param type Message type.
+/// @param p_data Message data.
+/// @param len Data bytes, at most @ref maxData.
+/// @return Frame bytes [empty: "len" too large].
+std::vector<uint8_t> GateProtocol::encode(uint8_t type, const uint8_t *p_data, size_t len)
+{
+	std::vector<uint8_t> frame;
+	if (len > maxData)
+		return frame;
+	frame.reserve(len + 5);
+	frame.push_back(START_BYTE);
+	frame.push_back(type);
+	frame.push_back((uint8_t)len);
+	uint8_t chk = 0;
+	for (size_t byte_i = 0; byte_i < len; byte_i++)
+	{
+		frame.push_back(p_data[byte_i]);
+		chk += p_data[byte_i];
+	}
+	frame.push_back(chk);
+	frame.push_back(END_BYTE);
+	return frame;
+}
+
+/// @brief Read a little endian 32 bit value from message data.
+///
+/// @param r_data Message data.
+/// @param pos Index of the first byte.
+/// @return Value [0: out of range].
+uint32_t GateProtocol::readU32(const std::vector<uint8_t> &r_data, size_t pos)
+{
+	if (pos + 4 > r_data.size())
+		return 0;
+	return r_data[pos] | r_data[pos + 1] << 8 | r_data[pos + 2] << 16 | (uint32_t)r_data[pos + 3] << 24;
+}
+
+//========CLASS: FrameParser==========
+
+/// @brief Add received bytes.
+///
+/// @param p_buff Received bytes.
+/// @param len Number of bytes.
+void FrameParser::push(const uint8_t *p_buff, size_t len)
+{
+	// Drop consumed bytes before growing the buffer
+	if (_posRead > 0 && _posRead >= _buff.size() / 2)
+	{
+		_buff.erase(_buff.begin(), _buff.begin() + _posRead);
+		_posRead = 0;
+	}
+	_buff.insert(_buff.end(), p_buff, p_buff + len);
+}
+
+/// @brief Decode the next complete frame.
+///
+/// @param r_frame Decoded frame.
+/// @return Success [false: no complete frame buffered yet].
+bool FrameParser::next(GateProtocol::FrameStruct &r_frame)
+{
+	while (_posRead + GateProtocol::headSize <= _buff.size())
+	{
+		const uint8_t *p_head = &_buff[_posRead];
+		if (p_head[0] != GateProtocol::START_BYTE)
+		{
+			_posRead++;
+			nSkipped++;
+			continue;
+		}
+		size_t len = p_head[2];
+		size_t frame_len = GateProtocol::headSize + len + GateProtocol::tailSize;
+		if (_posRead + frame_len > _buff.size())
+			return false;
+
+		// Checksum covers the data, timestamp and type bytes
+		uint8_t chk = p_head[1];
+		for (size_t byte_i = 0; byte_i < len + 4; byte_i++)
+			chk += p_head[GateProtocol::headSize + byte_i];
+		if (p_head[frame_len - 1] != GateProtocol::END_BYTE || p_head[frame_len - 2] != chk)
+		{
+			_posRead++;
+			nSkipped++;
+			nBadFrames++;
+			continue;
+		}
+
+		r_frame.type = p_head[1];
+		r_frame.data.assign(p_head + GateProtocol::headSize, p_head + GateProtocol::headSize + len);
+		const uint8_t *p_ts = p_head + GateProtocol::headSize + len;
+		r_frame.ts = p_ts[0] | p_ts[1] << 8 | p_ts[2] << 16 | (uint32_t)p_ts[3] << 24;
+		_posRead += frame_len;
+		nFrames++;
+		return true;
+	}
+	return false;
+}
+
+/// @brief Drop buffered bytes and reset the counters.
+void FrameParser::reset()
+{
+	_buff.clear();
+	_posRead = 0;
+	nFrames = 0;
+	nBadFrames = 0;
+	nSkipped = 0;
+}
+
+//========CLASS: RequestParser==========
+
+/// @brief Add bytes written by the host.
+///
+/// @param p_buff Host bytes.
+/// @param len Number of bytes.
+void RequestParser::push(const uint8_t *p_buff, size_t len)
+{
+	if (_posRead > 0 && _posRead >= _buff.size() / 2)
+	{
+		_buff.erase(_buff.begin(), _buff.begin() + _posRead);
+		_posRead = 0;
+	}
+	_buff.insert(_buff.end(), p_buff, p_buff + len);
+}
+
+/// @brief Decode the next complete frame or GO byte.
+///
+/// @param r_frame Decoded frame, type GateProtocol::GO with no data for a GO byte [ts unused].
+/// @return Decode result, see @ref RT.
+uint8_t RequestParser::next(GateProtocol::FrameStruct &r_frame)
+{
+	while (_posRead < _buff.size())
+	{
+		const uint8_t *p_head = &_buff[_posRead];
+		if (p_head[0] == GateProtocol::GO_BYTE)
+		{
+			r_frame.type = GateProtocol::GO;
+			r_frame.data.clear();
+			r_frame.ts = 0;
+			_posRead++;
+			nFrames++;
+			return RT_GO;
+		}
+		if (p_head[0] != GateProtocol::START_BYTE)
+		{
+			_posRead++;
+			nSkipped++;
+			continue;
+		}
+		if (_posRead + GateProtocol::headSize > _buff.size())
+			return RT_NONE;
+
+		// Host frames end with the data checksum and the end byte
+		size_t len = p_head[2];
+		size_t frame_len = GateProtocol::headSize + len + 2;
+		if (_posRead + frame_len > _buff.size())
+			return RT_NONE;
+		uint8_t chk = 0;
+		for (size_t byte_i = 0; byte_i < len; byte_i++)
+			chk += p_head[GateProtocol::headSize + byte_i];
+		if (p_head[frame_len - 1] != GateProtocol::END_BYTE || p_head[frame_len - 2] != chk)
+		{
+			_posRead++;
+			nSkipped++;
+			continue;
+		}
+
+		r_frame.type = p_head[1];
+		r_frame.data.assign(p_head + GateProtocol::headSize, p_head + GateProtocol::headSize + len);
+		r_frame.ts = 0;
+		_posRead += frame_len;
+		nFrames++;
+		return RT_FRAME;
+	}
+	return RT_NONE;
+}
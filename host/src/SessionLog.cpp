@@ -0,0 +1,188 @@
+// ######################################
+
+//============ SessionLog.cpp =========
+
+// ######################################
+
+//============= INCLUDE ================
+#include "SessionLog.h"
+#include "GateLink.h"
+#include <chrono>
+
+// Definitions for constants passed by reference
+const uint32_t SessionLog::fileMagic;
+const uint8_t SessionLog::fileVersion;
+const uint8_t SessionLog::headerSize;
+
+//============ FUNCTIONS ===============
+
+// Append an unsigned LEB128 varint
+static void putVarint(std::vector<uint8_t> &r_bytes, uint64_t val)
+{
+	while (val >= 0x80)
+	{
+		r_bytes.push_back((uint8_t)(val | 0x80));
+		val >>= 7;
+	}
+	r_bytes.push_back((uint8_t)val);
+}
+
+// Read an unsigned LEB128 varint, false if the bytes end inside it
+static bool getVarint(const std::vector<uint8_t> &r_bytes, size_t &r_pos, uint64_t &r_val)
+{
+	r_val = 0;
+	for (int shift = 0; shift < 64 && r_pos < r_bytes.size(); shift += 7)
+	{
+		uint8_t b = r_bytes[r_pos++];
+		r_val |= (uint64_t)(b & 0x7F) << shift;
+		if ((b & 0x80) == 0)
+			return true;
+	}
+	return false;
+}
+
+//========CLASS: SessionLog==========
+
+/// @brief Encode one record.
+///
+/// @param r_rec Record.
+/// @param ts_prev Time of the previous record (us since the start).
+/// @return Record bytes.
+std::vector<uint8_t> SessionLog::encodeRecord(const RecordStruct &r_rec, uint64_t ts_prev)
+{
+	std::vector<uint8_t> bytes;
+	bytes.reserve(r_rec.frame.data.size() + 12);
+	bytes.push_back(r_rec.kind);
+	putVarint(bytes, r_rec.tsUs >= ts_prev ? r_rec.tsUs - ts_prev : 0);
+	bytes.push_back(r_rec.frame.type);
+	putVarint(bytes, r_rec.frame.data.size());
+	bytes.insert(bytes.end(), r_rec.frame.data.begin(), r_rec.frame.data.end());
+	if (r_rec.kind == DEVICE_FRAME)
+		for (int byte_i = 0; byte_i < 4; byte_i++)
+			bytes.push_back((uint8_t)(r_rec.frame.ts >> (8 * byte_i)));
+	return bytes;
+}
+
+/// @brief Read a session file.
+///
+/// @param p_path Session file.
+/// @param r_session Loaded records, up to the last complete one.
+/// @return Success [false: file missing, not a session file, or a newer version].
+bool SessionLog::load(const char *p_path, SessionStruct &r_session)
+{
+	r_session = SessionStruct();
+	FILE *p_file = fopen(p_path, "rb");
+	if (p_file == nullptr)
+		return false;
+	std::vector<uint8_t> bytes;
+	uint8_t buff[4096];
+	size_t n;
+	while ((n = fread(buff, 1, sizeof(buff), p_file)) > 0)
+		bytes.insert(bytes.end(), buff, buff + n);
+	fclose(p_file);
+	if (bytes.size() < headerSize || GateProtocol::readU32(bytes, 0) != fileMagic || bytes[4] != fileVersion)
+		return false;
+	r_session.tsStartUnixUs = GateProtocol::readU32(bytes, 8) | (uint64_t)GateProtocol::readU32(bytes, 12) << 32;
+
+	size_t pos = headerSize;
+	size_t pos_rec = pos;
+	uint64_t ts = 0;
+	while (pos < bytes.size())
+	{
+		pos_rec = pos;
+		RecordStruct rec;
+		uint64_t dt_us, len;
+		rec.kind = bytes[pos++];
+		if (rec.kind != HOST_FRAME && rec.kind != HOST_GO && rec.kind != DEVICE_FRAME)
+			break;
+		if (!getVarint(bytes, pos, dt_us) || pos >= bytes.size())
+			break;
+		rec.frame.type = bytes[pos++];
+		size_t tail = rec.kind == DEVICE_FRAME ? 4 : 0;
+		if (!getVarint(bytes, pos, len) || len > GateProtocol::maxData || pos + len + tail > bytes.size())
+			break;
+		rec.frame.data.assign(bytes.begin() + pos, bytes.begin() + pos + len);
+		pos += len;
+		if (tail > 0)
+			rec.frame.ts = GateProtocol::readU32(bytes, pos);
+		pos += tail;
+		ts += dt_us;
+		rec.tsUs = ts;
+		r_session.records.push_back(rec);
+		pos_rec = pos;
+	}
+	r_session.isTruncated = pos_rec < bytes.size();
+	return true;
+}
+
+//========CLASS: SessionWriter==========
+
+/// @brief DESTRUCTOR: Close the file.
+SessionWriter::~SessionWriter()
+{
+	close();
+}
+
+/// @brief Create a session file and write its header.
+///
+/// @param p_path Session file, replaced if it exists.
+/// @return Success [false: file could not be written].
+bool SessionWriter::open(const char *p_path)
+{
+	close();
+	std::lock_guard<std::mutex> lock(_mtx);
+	_p_file = fopen(p_path, "wb");
+	if (_p_file == nullptr)
+		return false;
+	uint64_t ts_unix = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	uint8_t header[SessionLog::headerSize] = {};
+	for (int byte_i = 0; byte_i < 4; byte_i++)
+		header[byte_i] = (uint8_t)(SessionLog::fileMagic >> (8 * byte_i));
+	header[4] = SessionLog::fileVersion;
+	for (int byte_i = 0; byte_i < 8; byte_i++)
+		header[8 + byte_i] = (uint8_t)(ts_unix >> (8 * byte_i));
+	if (fwrite(header, 1, sizeof(header), _p_file) != sizeof(header) || fflush(_p_file) != 0)
+	{
+		fclose(_p_file);
+		_p_file = nullptr;
+		return false;
+	}
+	_tsStart = GateLink::nowUs();
+	_tsLast = 0;
+	nRecords = 0;
+	return true;
+}
+
+/// @brief Flush and close the file.
+void SessionWriter::close()
+{
+	std::lock_guard<std::mutex> lock(_mtx);
+	if (_p_file != nullptr)
+		fclose(_p_file);
+	_p_file = nullptr;
+}
+
+/// @brief Append a record stamped with the current host time.
+///
+/// @details Each record is flushed, so the file is complete up to the last frame if the
+/// recording process dies.
+///
+/// @param kind Record kind, see SessionLog::KIND.
+/// @param r_frame Frame.
+/// @return Success [false: not open or the write failed].
+bool SessionWriter::write(uint8_t kind, const GateProtocol::FrameStruct &r_frame)
+{
+	std::lock_guard<std::mutex> lock(_mtx);
+	if (_p_file == nullptr)
+		return false;
+	SessionLog::RecordStruct rec;
+	rec.kind = kind;
+	rec.tsUs = GateLink::nowUs() - _tsStart;
+	rec.frame = r_frame;
+	std::vector<uint8_t> bytes = SessionLog::encodeRecord(rec, _tsLast);
+	_tsLast = rec.tsUs;
+	if (fwrite(bytes.data(), 1, bytes.size(), _p_file) != bytes.size() || fflush(_p_file) != 0)
+		return false;
+	nRecords++;
+	return true;
+}
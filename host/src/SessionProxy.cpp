@@ -0,0 +1,200 @@
+// ######################################
+
+//=========== SessionProxy.cpp ========
+
+// ######################################
+
+//============= INCLUDE ================
+#include "SessionProxy.h"
+#include "GateClient.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+//============ FUNCTIONS ===============
+
+// Write all bytes to the controller port, waiting while its output buffer is full
+static bool writeDevice(int fd, const uint8_t *p_buff, size_t len)
+{
+	while (len > 0)
+	{
+		ssize_t n = ::write(fd, p_buff, len);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN)
+			{
+				struct pollfd pfd = {fd, POLLOUT, 0};
+				poll(&pfd, 1, 100);
+				continue;
+			}
+			return false;
+		}
+		p_buff += n;
+		len -= n;
+	}
+	return true;
+}
+
+//========CLASS: SessionProxy==========
+
+/// @brief DESTRUCTOR: Stop forwarding and remove the link.
+SessionProxy::~SessionProxy()
+{
+	stop();
+}
+
+/// @brief Open the controller port, create the pseudo-terminal and start forwarding.
+///
+/// @param p_device Controller port.
+/// @param baud Controller baud rate.
+/// @param p_link Path of a symlink to create to the terminal [nullptr: none, see @ref path()].
+/// @param r_writer Open session file to record to.
+/// @return Success [false: port, terminal or link could not be opened].
+bool SessionProxy::start(const char *p_device, uint32_t baud, const char *p_link, SessionWriter &r_writer)
+{
+	stop();
+	_fdDevice = GateClient::openPort(p_device, baud);
+	_fdMaster = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+	if (_fdDevice < 0 || _fdMaster < 0 || grantpt(_fdMaster) != 0 || unlockpt(_fdMaster) != 0 || pipe2(_fdWake, O_NONBLOCK | O_CLOEXEC) != 0)
+	{
+		stop();
+		return false;
+	}
+	_pathSlave = ptsname(_fdMaster);
+
+	// Keep the terminal side open and raw, so the host can close and reopen it
+	_fdSlave = ::open(_pathSlave.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+	if (_fdSlave < 0)
+	{
+		stop();
+		return false;
+	}
+	struct termios tio;
+	tcgetattr(_fdSlave, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(_fdSlave, TCSANOW, &tio);
+	fcntl(_fdMaster, F_SETFL, fcntl(_fdMaster, F_GETFL) | O_NONBLOCK);
+	if (p_link != nullptr)
+	{
+		unlink(p_link);
+		if (symlink(_pathSlave.c_str(), p_link) != 0)
+		{
+			stop();
+			return false;
+		}
+		_pathLink = p_link;
+	}
+
+	_p_writer = &r_writer;
+	_reqParser = RequestParser();
+	_frameParser.reset();
+	_isStopped = false;
+	_isDeviceOpen = true;
+	_thread = std::thread(&SessionProxy::_run, this);
+	return true;
+}
+
+/// @brief Stop forwarding, close both sides and remove the link.
+void SessionProxy::stop()
+{
+	if (_thread.joinable())
+	{
+		_isStopped = true;
+		uint8_t wake = 0;
+		ssize_t n = ::write(_fdWake[1], &wake, 1);
+		(void)n;
+		_thread.join();
+	}
+	for (int fd : {_fdDevice, _fdMaster, _fdSlave, _fdWake[0], _fdWake[1]})
+		if (fd >= 0)
+			::close(fd);
+	_fdDevice = _fdMaster = _fdSlave = -1;
+	_fdWake[0] = _fdWake[1] = -1;
+	if (!_pathLink.empty())
+		unlink(_pathLink.c_str());
+	_pathLink.clear();
+	_pathSlave.clear();
+	_isDeviceOpen = false;
+	_p_writer = nullptr;
+}
+
+/// @brief Forwarding thread: copy bytes both ways as they arrive until stopped or the controller is lost.
+void SessionProxy::_run()
+{
+	uint8_t buff[1024];
+	while (!_isStopped)
+	{
+		struct pollfd pfds[3] = {{_fdMaster, POLLIN, 0}, {_fdDevice, POLLIN, 0}, {_fdWake[0], POLLIN, 0}};
+		if (poll(pfds, 3, -1) < 0 && errno != EINTR)
+			break;
+		if (pfds[2].revents & POLLIN)
+			while (::read(_fdWake[0], buff, sizeof(buff)) > 0)
+			{
+			}
+
+		// Host to controller
+		if (pfds[0].revents & POLLIN)
+		{
+			ssize_t n = ::read(_fdMaster, buff, sizeof(buff));
+			if (n > 0)
+			{
+				_fromHost(buff, n);
+				if (!writeDevice(_fdDevice, buff, n))
+					break;
+			}
+		}
+
+		// Controller to host
+		if (pfds[1].revents & (POLLIN | POLLHUP | POLLERR))
+		{
+			ssize_t n = ::read(_fdDevice, buff, sizeof(buff));
+			if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR))
+				break;
+			if (n > 0)
+			{
+				_fromDevice(buff, n);
+				ssize_t n_written = ::write(_fdMaster, buff, n);
+				n_written = n_written < 0 ? 0 : n_written;
+				nDeviceDropped += n - n_written;
+			}
+		}
+	}
+	_isDeviceOpen = false;
+}
+
+/// @brief Record the host frames completed by these bytes.
+///
+/// @param p_buff Host bytes.
+/// @param len Number of bytes.
+void SessionProxy::_fromHost(const uint8_t *p_buff, size_t len)
+{
+	nHostBytes += len;
+	_reqParser.push(p_buff, len);
+	GateProtocol::FrameStruct frame;
+	uint8_t status;
+	while ((status = _reqParser.next(frame)) != RequestParser::RT_NONE)
+	{
+		_p_writer->write(status == RequestParser::RT_GO ? SessionLog::HOST_GO : SessionLog::HOST_FRAME, frame);
+		nHostFrames++;
+	}
+}
+
+/// @brief Record the controller frames completed by these bytes.
+///
+/// @param p_buff Controller bytes.
+/// @param len Number of bytes.
+void SessionProxy::_fromDevice(const uint8_t *p_buff, size_t len)
+{
+	nDeviceBytes += len;
+	_frameParser.push(p_buff, len);
+	GateProtocol::FrameStruct frame;
+	while (_frameParser.next(frame))
+	{
+		_p_writer->write(SessionLog::DEVICE_FRAME, frame);
+		nDeviceFrames++;
+	}
+}
@@ -0,0 +1,201 @@
+// ######################################
+
+//=========== SessionReplay.cpp =======
+
+// ######################################
+
+//============= INCLUDE ================
+#include "SessionReplay.h"
+#include <algorithm>
+#include <deque>
+
+//========CLASS: SessionReplay==========
+
+/// @brief Replay a recording on an open client.
+///
+/// @details Replaces the client's frame callback while it runs, to count the replay frames
+/// that answer no request.
+///
+/// @param r_client Open client, its timeout bounds the wait for each reply.
+/// @param r_session Recording.
+/// @param r_opts Pacing.
+/// @return Outcome of every recorded request.
+SessionReplay::ResultStruct SessionReplay::run(GateClient &r_client, const SessionLog::SessionStruct &r_session, const OptionsStruct &r_opts)
+{
+	ResultStruct result;
+	const std::vector<SessionLog::RecordStruct> &r_recs = r_session.records;
+	std::vector<int> reply_of = matchReplies(r_session);
+	if (!r_recs.empty())
+		result.dtRecordedS = (r_recs.back().tsUs - r_recs.front().tsUs) / 1e6;
+
+	// One result slot per request, indexed by record
+	std::vector<int> req_of_rec(r_recs.size(), -1);
+	for (size_t rec_i = 0; rec_i < r_recs.size(); rec_i++)
+	{
+		if (SessionLog::isHost(r_recs[rec_i]))
+		{
+			req_of_rec[rec_i] = (int)result.requests.size();
+			RequestResultStruct req;
+			req.recordIndex = rec_i;
+			req.kind = r_recs[rec_i].kind;
+			req.request = r_recs[rec_i].frame;
+			result.requests.push_back(req);
+		}
+		else if (reply_of[rec_i] < 0)
+			result.nExtraRecorded++;
+	}
+	for (size_t rec_i = 0; rec_i < r_recs.size(); rec_i++)
+		if (reply_of[rec_i] >= 0)
+		{
+			RequestResultStruct &r_req = result.requests[req_of_rec[reply_of[rec_i]]];
+			r_req.hasReply = true;
+			r_req.recorded = r_recs[rec_i].frame;
+			r_req.dtRecordedMs = (r_recs[rec_i].tsUs - r_recs[reply_of[rec_i]].tsUs) / 1000.0;
+		}
+
+	std::atomic<uint32_t> n_extra{0};
+	r_client.setFrameCallback([&n_extra](const GateProtocol::FrameStruct &)
+							  { n_extra++; });
+	std::vector<std::future<GateLink::ReplyStruct>> futs(result.requests.size());
+	std::vector<bool> is_sent(result.requests.size(), false);
+	auto setReply = [&result, &futs](int req_i)
+	{
+		RequestResultStruct &r_req = result.requests[req_i];
+		GateLink::ReplyStruct reply = futs[req_i].get();
+		r_req.status = reply.status;
+		if (reply.status == GateLink::ST_OK)
+		{
+			r_req.replayed = reply.frame;
+			r_req.dtReplayedMs = (reply.tsRecv - reply.tsSend) / 1000.0;
+		}
+		return reply.status == GateLink::ST_OK ? reply.tsRecv : GateLink::nowUs();
+	};
+
+	uint64_t ts_start = GateLink::nowUs();
+	uint64_t ts_anchor = ts_start; // replay time of the previous record
+	for (size_t rec_i = 0; rec_i < r_recs.size() && r_client.isOpen(); rec_i++)
+	{
+		// Recorded gap to the previous record, paced
+		uint64_t dt_gap_us = 0;
+		if (rec_i > 0 && !r_opts.isNoGaps)
+		{
+			dt_gap_us = (uint64_t)((r_recs[rec_i].tsUs - r_recs[rec_i - 1].tsUs) / (r_opts.speed > 0 ? r_opts.speed : 1));
+			if (r_opts.dtMaxGapMs > 0 && dt_gap_us > (uint64_t)r_opts.dtMaxGapMs * 1000)
+				dt_gap_us = (uint64_t)r_opts.dtMaxGapMs * 1000;
+		}
+
+		if (SessionLog::isHost(r_recs[rec_i]))
+		{
+			uint64_t ts_now = GateLink::nowUs();
+			if (ts_anchor + dt_gap_us > ts_now)
+				std::this_thread::sleep_for(std::chrono::microseconds(ts_anchor + dt_gap_us - ts_now));
+			int req_i = req_of_rec[rec_i];
+			RequestResultStruct &r_req = result.requests[req_i];
+			bool is_go = r_req.kind == SessionLog::HOST_GO;
+			if (r_req.hasReply)
+			{
+				std::shared_ptr<std::promise<GateLink::ReplyStruct>> p_prom = std::make_shared<std::promise<GateLink::ReplyStruct>>();
+				futs[req_i] = p_prom->get_future();
+				GateLink::ReplyCallback callback = [p_prom](const GateLink::ReplyStruct &r_reply)
+				{ p_prom->set_value(r_reply); };
+				if (is_go)
+					r_client.go(callback);
+				else
+					r_client.send(r_req.request.type, r_req.request.data, callback);
+			}
+			else
+				r_req.status = r_client.writeRaw(is_go ? std::vector<uint8_t>(1, GateProtocol::GO_BYTE) : GateProtocol::encode(r_req.request.type, r_req.request.data));
+			is_sent[req_i] = true;
+			ts_anchor = GateLink::nowUs();
+		}
+		else if (reply_of[rec_i] >= 0)
+		{
+			// Wait for the same reply in the replay before anything that followed it
+			ts_anchor = setReply(req_of_rec[reply_of[rec_i]]);
+		}
+		else
+			ts_anchor += dt_gap_us;
+	}
+
+	// Replies still pending complete with the port, requests never sent count as lost
+	for (size_t req_i = 0; req_i < result.requests.size(); req_i++)
+		if (futs[req_i].valid())
+			setReply((int)req_i);
+	result.dtReplayedS = (GateLink::nowUs() - ts_start) / 1e6;
+	r_client.setFrameCallback(GateClient::FrameCallback());
+	result.nExtraReplayed = n_extra;
+	if (!r_client.isOpen())
+		result.status = GateLink::ST_CLOSED;
+	for (size_t req_i = 0; req_i < result.requests.size(); req_i++)
+	{
+		RequestResultStruct &r_req = result.requests[req_i];
+		if (!is_sent[req_i])
+			r_req.status = GateLink::ST_CLOSED;
+		r_req.isSame = r_req.status == GateLink::ST_OK && (!r_req.hasReply || isSameReply(r_req.recorded, r_req.replayed));
+		result.nDiffs += !r_req.isSame;
+	}
+	return result;
+}
+
+/// @brief Pair each recorded controller frame with the request it answers.
+///
+/// @details A frame answers the oldest unanswered request of its type, a GO byte counting as
+/// type GateProtocol::GO. Log frames and extra frames of multi-frame replies answer nothing.
+///
+/// @param r_session Recording.
+/// @return Per record, the record index of the request it answers [-1: host record or no request].
+std::vector<int> SessionReplay::matchReplies(const SessionLog::SessionStruct &r_session)
+{
+	const std::vector<SessionLog::RecordStruct> &r_recs = r_session.records;
+	std::vector<int> reply_of(r_recs.size(), -1);
+	std::deque<int> open;
+	for (size_t rec_i = 0; rec_i < r_recs.size(); rec_i++)
+	{
+		if (SessionLog::isHost(r_recs[rec_i]))
+		{
+			open.push_back((int)rec_i);
+			continue;
+		}
+		if (r_recs[rec_i].frame.type == GateProtocol::LOG)
+			continue;
+		for (auto it = open.begin(); it != open.end(); ++it)
+			if (r_recs[*it].frame.type == r_recs[rec_i].frame.type)
+			{
+				reply_of[rec_i] = *it;
+				open.erase(it);
+				break;
+			}
+	}
+	return reply_of;
+}
+
+/// @brief Compare a replay reply with the recorded one, ignoring device times.
+///
+/// @param r_recorded Recorded reply.
+/// @param r_replayed Replay reply.
+/// @return Same outcome.
+bool SessionReplay::isSameReply(const GateProtocol::FrameStruct &r_recorded, const GateProtocol::FrameStruct &r_replayed)
+{
+	if (r_recorded.type != r_replayed.type)
+		return false;
+	switch (r_recorded.type)
+	{
+	case GateProtocol::SYNC_EVENTS:
+	case GateProtocol::PING:
+	case GateProtocol::PROFILE:
+	case GateProtocol::COUNTERS:
+	case GateProtocol::LOG:
+	case GateProtocol::I2C_TRACE:
+	case GateProtocol::TIMELINE:
+	case GateProtocol::LATENCY:
+		return true;
+	case GateProtocol::GO:
+		// Status, move time, then the changed walls
+		return r_recorded.data.size() == r_replayed.data.size() && !r_recorded.data.empty() &&
+			   r_recorded.data[0] == r_replayed.data[0] &&
+			   std::equal(r_recorded.data.begin() + std::min<size_t>(5, r_recorded.data.size()), r_recorded.data.end(),
+						  r_replayed.data.begin() + std::min<size_t>(5, r_replayed.data.size()));
+	default:
+		return r_recorded.data == r_replayed.data;
+	}
+}
@@ -0,0 +1,222 @@
+// ######################################
+
+//=========== WallStateShm.cpp ========
+
+// ######################################
+
+//============= INCLUDE ================
+#include "WallStateShm.h"
+#include "GateLink.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Out of class definitions for the constants ODR-used by std::atomic and the tests
+const uint32_t WallStateShmStruct::shmMagic;
+const uint32_t WallStateShmStruct::shmVersion;
+const uint32_t WallStateReader::maxTries;
+
+//============ FUNCTIONS ===============
+
+/// @brief Check if a process exists.
+///
+/// @param pid Process id.
+/// @return Process exists [false: "pid" is 0 or not running].
+static bool isProcessAlive(uint32_t pid)
+{
+	return pid != 0 && (kill((pid_t)pid, 0) == 0 || errno == EPERM);
+}
+
+//========CLASS: WallStateWriter==========
+
+/// @brief DESTRUCTOR: Release the segment, leaving it for the readers.
+WallStateWriter::~WallStateWriter()
+{
+	close();
+}
+
+/// @brief Create or reuse the segment and claim it as its writer.
+///
+/// @details An existing segment with the same layout keeps its sequence lock, so readers
+/// that mapped it see the new states. A segment left odd by a writer that died mid copy is
+/// released.
+///
+/// @param p_name Segment name, starting with '/' (e.g. "/gate_walls").
+/// @return Success [false: segment could not be created or another live process writes it].
+bool WallStateWriter::open(const char *p_name)
+{
+	close();
+	int fd = shm_open(p_name, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || ((size_t)st.st_size < sizeof(WallStateShmStruct) && ftruncate(fd, sizeof(WallStateShmStruct)) != 0))
+	{
+		::close(fd);
+		return false;
+	}
+	void *p_map = mmap(nullptr, sizeof(WallStateShmStruct), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (p_map == MAP_FAILED)
+		return false;
+	WallStateShmStruct *p_shm = (WallStateShmStruct *)p_map;
+
+	// New segment or an old layout: readers check the magic before mapping the rest
+	if (p_shm->magic.load(std::memory_order_acquire) != WallStateShmStruct::shmMagic || p_shm->version != WallStateShmStruct::shmVersion)
+	{
+		p_shm->magic.store(0, std::memory_order_relaxed);
+		p_shm->lock.store(0, std::memory_order_relaxed);
+		p_shm->pidWriter.store(0, std::memory_order_relaxed);
+		p_shm->version = WallStateShmStruct::shmVersion;
+		p_shm->tsHost = 0;
+		p_shm->state = DaemonProtocol::WallStateStruct();
+		p_shm->magic.store(WallStateShmStruct::shmMagic, std::memory_order_release);
+	}
+
+	// Claim the segment unless its writer is still running
+	uint32_t pid_self = (uint32_t)getpid();
+	uint32_t pid_writer = p_shm->pidWriter.load();
+	if ((pid_writer != pid_self && isProcessAlive(pid_writer)) || !p_shm->pidWriter.compare_exchange_strong(pid_writer, pid_self))
+	{
+		munmap(p_map, sizeof(WallStateShmStruct));
+		return false;
+	}
+	uint32_t lock = p_shm->lock.load(std::memory_order_relaxed);
+	if (lock & 1)
+		p_shm->lock.store(lock + 1, std::memory_order_release);
+
+	std::lock_guard<std::mutex> lock_pub(_mtx);
+	_p_shm = p_shm;
+	_isPublished = false;
+	return true;
+}
+
+/// @brief Give up the segment, which stays readable with the last state.
+void WallStateWriter::close()
+{
+	std::lock_guard<std::mutex> lock(_mtx);
+	if (_p_shm == nullptr)
+		return;
+	_p_shm->pidWriter.store(0);
+	munmap(_p_shm, sizeof(WallStateShmStruct));
+	_p_shm = nullptr;
+}
+
+/// @brief Copy a wall state to the segment.
+///
+/// @details States older than the last one published are ignored, so this can be fed from
+/// both a state callback and an initial read without ordering them.
+///
+/// @param r_state Wall state.
+void WallStateWriter::publish(const DaemonProtocol::WallStateStruct &r_state)
+{
+	std::lock_guard<std::mutex> lock_pub(_mtx);
+	if (_p_shm == nullptr || (_isPublished && r_state.seq <= _seqLast))
+		return;
+	_isPublished = true;
+	_seqLast = r_state.seq;
+
+	uint32_t lock = _p_shm->lock.load(std::memory_order_relaxed);
+	_p_shm->lock.store(lock + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	_p_shm->tsHost = GateLink::nowUs();
+	memcpy(&_p_shm->state, &r_state, sizeof(r_state));
+	_p_shm->lock.store(lock + 2, std::memory_order_release);
+	nPublished++;
+}
+
+/// @brief Remove a segment name, mapped readers and writers keep their mapping.
+///
+/// @param p_name Segment name.
+/// @return Success [false: no such segment].
+bool WallStateWriter::unlink(const char *p_name)
+{
+	return shm_unlink(p_name) == 0;
+}
+
+//========CLASS: WallStateReader==========
+
+/// @brief DESTRUCTOR: Unmap the segment.
+WallStateReader::~WallStateReader()
+{
+	close();
+}
+
+/// @brief Map a segment read only.
+///
+/// @param p_name Segment name.
+/// @return Success [false: no initialized segment with this layout].
+bool WallStateReader::open(const char *p_name)
+{
+	close();
+	int fd = shm_open(p_name, O_RDONLY | O_CLOEXEC, 0);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	void *p_map = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(WallStateShmStruct))
+		p_map = mmap(nullptr, sizeof(WallStateShmStruct), PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (p_map == MAP_FAILED)
+		return false;
+	const WallStateShmStruct *p_shm = (const WallStateShmStruct *)p_map;
+	if (p_shm->magic.load(std::memory_order_acquire) != WallStateShmStruct::shmMagic || p_shm->version != WallStateShmStruct::shmVersion)
+	{
+		munmap(p_map, sizeof(WallStateShmStruct));
+		return false;
+	}
+	_p_shm = p_shm;
+	return true;
+}
+
+/// @brief Unmap the segment.
+void WallStateReader::close()
+{
+	if (_p_shm == nullptr)
+		return;
+	munmap((void *)_p_shm, sizeof(WallStateShmStruct));
+	_p_shm = nullptr;
+}
+
+/// @brief Copy a consistent snapshot of the wall state.
+///
+/// @param r_state Wall state [unchanged on failure].
+/// @param p_tsHost Host time the snapshot was published (us) [nullptr: not needed, 0: never published].
+/// @return Success [false: not open, or the writer was mid copy for @ref maxTries attempts].
+bool WallStateReader::read(DaemonProtocol::WallStateStruct &r_state, uint64_t *p_tsHost)
+{
+	if (_p_shm == nullptr)
+		return false;
+	DaemonProtocol::WallStateStruct state;
+	for (uint32_t try_i = 0; try_i < maxTries; try_i++)
+	{
+		uint32_t lock = _p_shm->lock.load(std::memory_order_acquire);
+		if ((lock & 1) == 0)
+		{
+			uint64_t ts_host = _p_shm->tsHost;
+			memcpy(&state, (const void *)&_p_shm->state, sizeof(state));
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (_p_shm->lock.load(std::memory_order_relaxed) == lock)
+			{
+				r_state = state;
+				if (p_tsHost != nullptr)
+					*p_tsHost = ts_host;
+				return true;
+			}
+		}
+		nRetries++;
+	}
+	return false;
+}
+
+/// @brief Check if the writer process is running, a system call unlike @ref read().
+///
+/// @return Writer running [false: the state is no longer updated].
+bool WallStateReader::isWriterAlive() const
+{
+	return _p_shm != nullptr && isProcessAlive(_p_shm->pidWriter.load());
+}
@@ -0,0 +1,85 @@
+// ######################################
+
+//========= EmulatorProcess.h =========
+
+// ######################################
+
+/// @file Runs gate_emulator as a child process for the host tests.
+
+#ifndef _EMULATOR_PROCESS_h
+#define _EMULATOR_PROCESS_h
+
+//============= INCLUDE ================
+#include <fcntl.h>
+#include <signal.h>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+/// @brief Starts gate_emulator (path from GATE_EMULATOR_PATH) on a pseudo-terminal linked to a temporary path.
+class EmulatorProcess
+{
+
+	// --------------VARIABLES--------------
+public:
+	std::string link; // serial port link, valid after start()
+
+private:
+	pid_t _pid = -1;
+
+	// ---------------METHODS---------------
+public:
+	~EmulatorProcess() { stop(); }
+
+public:
+	/// @brief Start the emulator and wait for its serial port.
+	///
+	/// @param r_args Emulator options, --link is added.
+	/// @param p_name Link name suffix, unique per test.
+	/// @return Success [false: emulator did not start within 5 s].
+	bool start(const std::vector<std::string> &r_args, const char *p_name)
+	{
+		stop();
+		link = "/tmp/gate_test_" + std::to_string(getpid()) + "_" + p_name;
+		unlink(link.c_str());
+		std::vector<std::string> args = r_args;
+		args.insert(args.begin(), GATE_EMULATOR_PATH);
+		args.push_back("--link");
+		args.push_back(link);
+		_pid = fork();
+		if (_pid == 0)
+		{
+			int fd_null = open("/dev/null", O_WRONLY);
+			dup2(fd_null, STDOUT_FILENO);
+			std::vector<char *> argv;
+			for (std::string &r_arg : args)
+				argv.push_back(&r_arg[0]);
+			argv.push_back(nullptr);
+			execv(argv[0], argv.data());
+			_exit(127);
+		}
+		for (int wait_i = 0; wait_i < 500; wait_i++)
+		{
+			struct stat st;
+			if (stat(link.c_str(), &st) == 0)
+				return true;
+			usleep(10000);
+		}
+		return false;
+	}
+
+public:
+	/// @brief Stop the emulator, which removes its link.
+	void stop()
+	{
+		if (_pid <= 0)
+			return;
+		kill(_pid, SIGTERM);
+		waitpid(_pid, nullptr, 0);
+		_pid = -1;
+	}
+};
+
+#endif
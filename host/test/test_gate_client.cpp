@@ -0,0 +1,205 @@
+// Host client: frame encoding and decoding, and requests against gate_emulator on a pseudo-terminal
+
+#include "EmulatorProcess.h"
+#include "GateClient.h"
+#include "NativeTest.h"
+#include <string.h>
+
+// Build a device to host frame
+static std::vector<uint8_t> deviceFrame(uint8_t type, const std::vector<uint8_t> &r_data, uint32_t ts)
+{
+	std::vector<uint8_t> frame = {GateProtocol::START_BYTE, type, (uint8_t)r_data.size()};
+	uint8_t chk = type;
+	for (uint8_t b : r_data)
+	{
+		frame.push_back(b);
+		chk += b;
+	}
+	for (uint8_t byte_i = 0; byte_i < 4; byte_i++)
+	{
+		frame.push_back((ts >> (8 * byte_i)) & 0xFF);
+		chk += frame.back();
+	}
+	frame.push_back(chk);
+	frame.push_back(GateProtocol::END_BYTE);
+	return frame;
+}
+
+// Wait for a future and get its status
+static uint8_t waitStatus(std::future<GateClient::ReplyStruct> fut, GateClient::ReplyStruct *p_reply = nullptr)
+{
+	if (fut.wait_for(std::chrono::seconds(20)) != std::future_status::ready)
+		return 254;
+	GateClient::ReplyStruct reply = fut.get();
+	if (p_reply != nullptr)
+		*p_reply = reply;
+	return reply.status;
+}
+
+void testEncode()
+{
+	std::vector<uint8_t> frame = GateProtocol::encode(GateProtocol::MOVE, {0x0F, 0xF0, 0x81});
+	std::vector<uint8_t> expect = {0x02, 0x02, 0x03, 0x0F, 0xF0, 0x81, 0x80, 0x03};
+	CHECK(frame == expect);
+	CHECK_EQ(GateProtocol::encode(GateProtocol::INIT, {}).size(), 5);
+	CHECK(GateProtocol::encode(GateProtocol::MOVE, std::vector<uint8_t>(256, 1)).empty());
+	CHECK_EQ(GateProtocol::readU32({1, 2, 3, 4, 0x80}, 1), 0x80040302);
+	CHECK_EQ(GateProtocol::readU32({1, 2, 3}, 0), 0);
+}
+
+void testParser()
+{
+	FrameParser parser;
+	GateProtocol::FrameStruct frame;
+
+	// Garbage, a frame with a bad checksum, then two good frames fed one byte at a time
+	std::vector<uint8_t> bytes = {0x55, 0x03};
+	std::vector<uint8_t> bad = deviceFrame(5, {1, 4, 6}, 7);
+	bad[4]++;
+	bytes.insert(bytes.end(), bad.begin(), bad.end());
+	std::vector<uint8_t> good = deviceFrame(9, {0x10, 0x20, 0x30, 0x40}, 0xA1B2C3D4);
+	bytes.insert(bytes.end(), good.begin(), good.end());
+	good = deviceFrame(12, {}, 5);
+	bytes.insert(bytes.end(), good.begin(), good.end());
+
+	std::vector<GateProtocol::FrameStruct> frames;
+	for (uint8_t b : bytes)
+	{
+		parser.push(&b, 1);
+		while (parser.next(frame))
+			frames.push_back(frame);
+	}
+	CHECK_EQ(frames.size(), 2);
+	CHECK_EQ(frames[0].type, 9);
+	CHECK_EQ(frames[0].data.size(), 4);
+	CHECK_EQ(frames[0].data[3], 0x40);
+	CHECK_EQ(frames[0].ts, 0xA1B2C3D4);
+	CHECK_EQ(frames[1].type, 12);
+	CHECK(frames[1].data.empty());
+	CHECK_EQ(parser.nFrames, 2);
+	CHECK_EQ(parser.nBadFrames, 1);
+	CHECK_EQ(parser.nSkipped, 2 + bad.size());
+
+	// Incomplete frame waits for more bytes
+	good = deviceFrame(2, {0xFF}, 1);
+	parser.push(good.data(), good.size() - 1);
+	CHECK(!parser.next(frame));
+	parser.push(&good.back(), 1);
+	CHECK(parser.next(frame));
+	CHECK_EQ(frame.data[0], 0xFF);
+}
+
+void testEmulator()
+{
+	EmulatorProcess emu;
+	CHECK(emu.start({"--fast", "--chips", "3"}, "client"));
+	GateClient client;
+	CHECK(client.open(emu.link.c_str()));
+	CHECK(client.isOpen());
+
+	// Chip and gate initialization
+	GateClient::ReplyStruct reply;
+	CHECK_EQ(waitStatus(client.initChips(), &reply), GateClient::ST_OK);
+	CHECK_EQ(reply.frame.type, GateProtocol::INIT);
+	CHECK_EQ(reply.frame.data.size(), 3);
+	CHECK(reply.tsRecv >= reply.tsSend);
+	CHECK_EQ(waitStatus(client.initGates(), &reply), GateClient::ST_OK);
+	CHECK(reply.frame.data == std::vector<uint8_t>(3, 0xFF));
+
+	// Move and read back, the read waits for the gate init to finish lowering the walls
+	CHECK_EQ(waitStatus(client.readWalls(), &reply), GateClient::ST_OK);
+	CHECK(reply.frame.data == std::vector<uint8_t>(3, 0x00));
+	std::vector<uint8_t> wall_bytes = {0x0F, 0xF0, 0x81};
+	CHECK_EQ(waitStatus(client.moveWalls(wall_bytes), &reply), GateClient::ST_OK);
+	CHECK(reply.frame.data == wall_bytes);
+	CHECK_EQ(waitStatus(client.readWalls(), &reply), GateClient::ST_OK);
+	CHECK(reply.frame.data == wall_bytes);
+
+	// Pipelined requests complete in order with their own replies
+	std::vector<std::future<GateClient::ReplyStruct>> futs;
+	for (uint8_t req_i = 0; req_i < 16; req_i++)
+		futs.push_back(req_i % 2 ? client.ping() : client.readWalls());
+	uint32_t ts_dev_last = 0;
+	for (uint8_t req_i = 0; req_i < 16; req_i++)
+	{
+		CHECK_EQ(waitStatus(std::move(futs[req_i]), &reply), GateClient::ST_OK);
+		CHECK_EQ(reply.frame.type, req_i % 2 ? GateProtocol::PING : GateProtocol::MOVE);
+		CHECK(req_i == 0 || reply.frame.ts > ts_dev_last);
+		ts_dev_last = reply.frame.ts;
+	}
+
+	// Callback completion
+	std::promise<uint8_t> prom;
+	client.send(GateProtocol::PING, {}, [&prom](const GateClient::ReplyStruct &r_reply)
+				{ prom.set_value(r_reply.status == GateClient::ST_OK && r_reply.frame.data.size() == 4 ? 1 : 0); });
+	std::future<uint8_t> fut = prom.get_future();
+	CHECK(fut.wait_for(std::chrono::seconds(20)) == std::future_status::ready && fut.get() == 1);
+	CHECK_EQ(client.nTimeouts, 0);
+	CHECK_EQ(client.nRequests, client.nReplies);
+}
+
+void testConfigs()
+{
+	EmulatorProcess emu;
+	CHECK(emu.start({"--fast", "--chips", "2"}, "configs"));
+	GateClient client;
+	CHECK(client.open(emu.link.c_str()));
+	GateClient::ReplyStruct reply;
+	CHECK_EQ(waitStatus(client.initChips()), GateClient::ST_OK);
+
+	// Short messages and bad indices are rejected with a status instead of reading past the data
+	CHECK_EQ(waitStatus(client.send(GateProtocol::STORE_CONFIG), &reply), GateClient::ST_OK);
+	CHECK(reply.frame.data == std::vector<uint8_t>({0xFF, 0xFF}));
+	CHECK_EQ(waitStatus(client.send(GateProtocol::STORE_CONFIG, {200, 0x01}), &reply), GateClient::ST_OK);
+	CHECK(reply.frame.data == std::vector<uint8_t>({200, 0xFF}));
+	CHECK_EQ(waitStatus(client.send(GateProtocol::APPLY_CONFIG), &reply), GateClient::ST_OK);
+	CHECK(reply.frame.data == std::vector<uint8_t>({0xFF, 0x00}));
+	CHECK_EQ(waitStatus(client.send(GateProtocol::APPLY_CONFIG, {200}), &reply), GateClient::ST_OK);
+	CHECK(reply.frame.data == std::vector<uint8_t>({0xFF, 0x00}));
+
+	// An empty configuration is told apart from one that moves nothing
+	CHECK_EQ(waitStatus(client.send(GateProtocol::APPLY_CONFIG, {3}), &reply), GateClient::ST_OK);
+	CHECK(reply.frame.data == std::vector<uint8_t>({2, 0x00}));
+	CHECK_EQ(waitStatus(client.send(GateProtocol::STORE_CONFIG, {3, 0x0F, 0x81}), &reply), GateClient::ST_OK);
+	CHECK(reply.frame.data == std::vector<uint8_t>({3, 0}));
+	CHECK_EQ(waitStatus(client.send(GateProtocol::APPLY_CONFIG, {3}), &reply), GateClient::ST_OK);
+	CHECK(reply.frame.data == std::vector<uint8_t>({1, 0x03, 0x0F, 0x81}));
+	CHECK_EQ(waitStatus(client.send(GateProtocol::APPLY_CONFIG, {3}), &reply), GateClient::ST_OK);
+	CHECK(reply.frame.data == std::vector<uint8_t>({0, 0x00}));
+}
+
+void testTimeoutAndClose()
+{
+	EmulatorProcess emu;
+	CHECK(emu.start({"--fast", "--chips", "1"}, "timeout"));
+	GateClient client;
+	CHECK(client.open(emu.link.c_str()));
+
+	// The firmware does not answer unknown message types
+	client.setTimeout(100);
+	GateClient::ReplyStruct reply;
+	CHECK_EQ(waitStatus(client.send(99), &reply), GateClient::ST_TIMEOUT);
+	CHECK(reply.tsRecv - reply.tsSend >= 100000);
+	CHECK_EQ(client.nTimeouts, 1);
+	CHECK_EQ(waitStatus(client.send(GateProtocol::MOVE, std::vector<uint8_t>(256, 0))), GateClient::ST_ARG);
+
+	// Losing the port completes pending requests
+	client.setTimeout(10000);
+	std::future<GateClient::ReplyStruct> fut = client.send(99);
+	emu.stop();
+	CHECK_EQ(waitStatus(std::move(fut)), GateClient::ST_CLOSED);
+	CHECK(!client.isOpen());
+	CHECK_EQ(waitStatus(client.ping()), GateClient::ST_CLOSED);
+	CHECK(!client.open("/nonexistent/gate_port"));
+}
+
+int main()
+{
+	signal(SIGPIPE, SIG_IGN);
+	RUN_TEST(testEncode);
+	RUN_TEST(testParser);
+	RUN_TEST(testEmulator);
+	RUN_TEST(testConfigs);
+	RUN_TEST(testTimeoutAndClose);
+	return TEST_RESULT();
+}
@@ -0,0 +1,254 @@
+// Host daemon: many clients on one controller link, the cached wall state and state events, against gate_emulator
+
+#include "DaemonClient.h"
+#include "EmulatorProcess.h"
+#include "GateDaemon.h"
+#include "NativeTest.h"
+#include <condition_variable>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Wait for a future and get its status
+template <typename T>
+static uint8_t waitStatus(std::future<T> fut, T *p_reply = nullptr)
+{
+	if (fut.wait_for(std::chrono::seconds(20)) != std::future_status::ready)
+		return 254;
+	T reply = fut.get();
+	if (p_reply != nullptr)
+		*p_reply = reply;
+	return reply.status;
+}
+
+// Wall state events seen by a subscriber
+struct EventLog
+{
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::vector<DaemonProtocol::WallStateStruct> states;
+
+	void add(const DaemonProtocol::WallStateStruct &r_state)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		states.push_back(r_state);
+		cv.notify_all();
+	}
+
+	// Wait for a state with these wall positions and nothing moving
+	bool waitFor(const std::vector<uint8_t> &r_walls)
+	{
+		std::unique_lock<std::mutex> lock(mtx);
+		return cv.wait_for(lock, std::chrono::seconds(20), [&]()
+						   {
+			if (states.empty())
+				return false;
+			const DaemonProtocol::WallStateStruct &r_last = states.back();
+			if (r_last.nChips != r_walls.size())
+				return false;
+			for (uint8_t cyp_i = 0; cyp_i < r_last.nChips; cyp_i++)
+				if (r_last.position[cyp_i] != r_walls[cyp_i] || r_last.moving[cyp_i] != 0)
+					return false;
+			return true; });
+	}
+};
+
+void testDaemon()
+{
+	EmulatorProcess emu;
+	CHECK(emu.start({"--fast", "--chips", "3", "--stuck", "2.0"}, "daemon"));
+	GateClient device;
+	CHECK(device.open(emu.link.c_str()));
+	device.setTimeout(1000);
+	std::string path_socket = emu.link + ".sock";
+	GateDaemon daemon;
+	CHECK(daemon.start(device, path_socket.c_str()));
+
+	// Only one daemon per socket
+	GateClient device_2;
+	GateDaemon daemon_2;
+	CHECK(!daemon_2.start(device_2, path_socket.c_str()));
+
+	DaemonClient client_a, client_b;
+	CHECK(client_a.connect(path_socket.c_str()));
+	CHECK(client_b.connect(path_socket.c_str()));
+	EventLog events;
+	DaemonClient::StateReplyStruct state_reply;
+	CHECK_EQ(waitStatus(client_b.subscribe([&events](const DaemonProtocol::WallStateStruct &r_state)
+										   { events.add(r_state); }),
+						&state_reply),
+			 GateLink::ST_OK);
+
+	// Chip and gate init through one client, seen by the other
+	GateLink::ReplyStruct reply;
+	CHECK_EQ(waitStatus(client_a.initChips(), &reply), GateLink::ST_OK);
+	CHECK_EQ(reply.frame.type, GateProtocol::INIT);
+	CHECK_EQ(reply.frame.data.size(), 3);
+	CHECK_EQ(waitStatus(client_a.initGates(), &reply), GateLink::ST_OK);
+	CHECK(reply.frame.data == std::vector<uint8_t>({0xFF, 0xFF, 0xFE}));
+	CHECK(events.waitFor({0x00, 0x00, 0x00}));
+	CHECK_EQ(waitStatus(client_b.readState(), &state_reply), GateLink::ST_OK);
+	CHECK_EQ(state_reply.state.nChips, 3);
+	CHECK_EQ(state_reply.state.addr[1], daemon.getState().addr[1]);
+	CHECK_EQ(state_reply.state.error[0], 0);
+
+	// A move with a stuck wall: moving while pending, then the missed wall is flagged
+	std::vector<uint8_t> wall_bytes = {0x0F, 0xF0, 0x81};
+	CHECK_EQ(waitStatus(client_a.moveWalls(wall_bytes), &reply), GateLink::ST_OK);
+	std::vector<uint8_t> wall_pos = {0x0F, 0xF0, 0x80};
+	CHECK(reply.frame.data == wall_pos);
+	CHECK(events.waitFor(wall_pos));
+	{
+		std::lock_guard<std::mutex> lock(events.mtx);
+		bool is_seen_moving = false;
+		for (const DaemonProtocol::WallStateStruct &r_state : events.states)
+			is_seen_moving |= r_state.moving[0] == 0x0F && r_state.moving[2] == 0x81;
+		CHECK(is_seen_moving);
+		for (size_t ev_i = 1; ev_i < events.states.size(); ev_i++)
+			CHECK(events.states[ev_i].seq > events.states[ev_i - 1].seq);
+	}
+	DaemonProtocol::WallStateStruct state = daemon.getState();
+	CHECK_EQ(state.target[2], 0x81);
+	CHECK_EQ(state.error[0], 0);
+	CHECK_EQ(state.error[2], 0x01);
+
+	// Status reads are served from the cache
+	uint32_t n_dev_requests = device.nRequests;
+	for (int req_i = 0; req_i < 100; req_i++)
+		CHECK_EQ(waitStatus(client_a.readState(), &state_reply), GateLink::ST_OK);
+	CHECK_EQ(state_reply.state.position[1], 0xF0);
+	CHECK_EQ(device.nRequests, n_dev_requests);
+	CHECK_EQ(daemon.nStatus, 101);
+
+	// Requests from several clients and threads interleave on the serial link
+	std::vector<std::thread> threads;
+	std::atomic<int> n_ok{0};
+	for (DaemonClient *p_client : {&client_a, &client_b})
+		for (int thread_i = 0; thread_i < 2; thread_i++)
+			threads.push_back(std::thread([p_client, &n_ok, &wall_pos]()
+										  {
+				std::vector<std::future<GateLink::ReplyStruct>> futs;
+				for (int req_i = 0; req_i < 10; req_i++)
+					futs.push_back(req_i % 2 ? p_client->ping() : p_client->readWalls());
+				for (int req_i = 0; req_i < 10; req_i++)
+				{
+					GateLink::ReplyStruct r = futs[req_i].get();
+					bool is_ok = r.status == GateLink::ST_OK;
+					if (req_i % 2)
+						is_ok &= r.frame.type == GateProtocol::PING && r.frame.data.size() == 4;
+					else
+						is_ok &= r.frame.type == GateProtocol::MOVE && r.frame.data == wall_pos;
+					n_ok += is_ok;
+				} }));
+	for (std::thread &r_thread : threads)
+		r_thread.join();
+	CHECK_EQ(n_ok, 40);
+
+	// Unsubscribed clients get no more events
+	CHECK_EQ(waitStatus(client_b.unsubscribe()), GateLink::ST_OK);
+	CHECK_EQ(waitStatus(client_b.unsubscribe()), DaemonProtocol::ST_NOT_SUBSCRIBED);
+	uint32_t n_events = client_b.nEvents;
+	CHECK_EQ(waitStatus(client_a.moveWalls({0x00, 0x00, 0x00})), GateLink::ST_OK);
+	CHECK_EQ(waitStatus(client_b.ping()), GateLink::ST_OK);
+	CHECK_EQ(client_b.nEvents, n_events);
+
+	// A client that disconnects with a request pending does not disturb the others,
+	// its move comes on another socket so wait for the daemon to forward it before reading
+	uint32_t n_forwarded = daemon.nRequests;
+	{
+		DaemonClient client_c;
+		CHECK(client_c.connect(path_socket.c_str()));
+		client_c.moveWalls({0xFF, 0xFF, 0xFF});
+	}
+	for (int wait_i = 0; wait_i < 2000 && daemon.nRequests == n_forwarded; wait_i++)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	CHECK_EQ(daemon.nRequests, n_forwarded + 1);
+	CHECK_EQ(waitStatus(client_a.readWalls(), &reply), GateLink::ST_OK);
+	CHECK(reply.frame.data == std::vector<uint8_t>({0xFF, 0xFF, 0xFE}));
+
+	// A malformed message drops only that client
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	struct sockaddr_un addr = {};
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path_socket.c_str());
+	CHECK_EQ(connect(fd, (struct sockaddr *)&addr, sizeof(addr)), 0);
+	uint8_t bad[DaemonProtocol::headSize] = {DaemonProtocol::REQUEST, 1, 0, 0, 0, 0, GateProtocol::PING, 0xFF, 0xFF};
+	CHECK_EQ(write(fd, bad, sizeof(bad)), sizeof(bad));
+	uint8_t buff[16];
+	CHECK_EQ(read(fd, buff, sizeof(buff)), 0);
+	close(fd);
+	CHECK_EQ(daemon.nDropped, 1);
+	CHECK_EQ(waitStatus(client_b.ping()), GateLink::ST_OK);
+
+	// Stopping the daemon completes the clients' pending requests
+	std::future<GateLink::ReplyStruct> fut = client_a.send(99);
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	device.close();
+	daemon.stop();
+	CHECK_EQ(waitStatus(std::move(fut)), GateLink::ST_CLOSED);
+	CHECK_EQ(waitStatus(client_b.ping()), GateLink::ST_CLOSED);
+
+	// The closed reply can arrive before the reader thread sees the socket close
+	for (int wait_i = 0; wait_i < 2000 && client_a.isOpen(); wait_i++)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	CHECK(!client_a.isOpen());
+	CHECK(!client_a.connect(path_socket.c_str()));
+}
+
+void testStateLayout()
+{
+	DaemonProtocol::WallStateStruct state;
+	state.seq = 0x01020304;
+	state.tsDevice = 77;
+	state.nChips = 2;
+	state.addr[1] = 0x21;
+	state.position[0] = 0x0F;
+	state.target[1] = 0xAA;
+	state.error[1] = 0x80;
+	state.moving[0] = 0x30;
+	std::vector<uint8_t> packed = DaemonProtocol::packState(state);
+	CHECK_EQ(packed.size(), 9 + 5 * 2);
+	DaemonProtocol::WallStateStruct unpacked;
+	CHECK(DaemonProtocol::unpackState(packed, unpacked));
+	CHECK_EQ(unpacked.seq, state.seq);
+	CHECK_EQ(unpacked.tsDevice, 77);
+	CHECK_EQ(unpacked.addr[1], 0x21);
+	CHECK_EQ(unpacked.position[0], 0x0F);
+	CHECK_EQ(unpacked.target[1], 0xAA);
+	CHECK_EQ(unpacked.error[1], 0x80);
+	CHECK_EQ(unpacked.moving[0], 0x30);
+	packed.pop_back();
+	CHECK(!DaemonProtocol::unpackState(packed, unpacked));
+
+	// Messages split at any byte
+	DaemonProtocol::MsgStruct msg;
+	msg.kind = DaemonProtocol::REPLY;
+	msg.id = 0xDEADBEEF;
+	msg.type = GateProtocol::MOVE;
+	msg.data = {1, 2, 3};
+	msg.ts = 12345;
+	std::vector<uint8_t> bytes = DaemonProtocol::encode(msg);
+	bytes.insert(bytes.end(), bytes.begin(), bytes.end());
+	DaemonParser parser;
+	DaemonProtocol::MsgStruct out;
+	int n_msgs = 0;
+	for (uint8_t b : bytes)
+	{
+		parser.push(&b, 1);
+		while (parser.next(out) == 1)
+		{
+			n_msgs++;
+			CHECK_EQ(out.id, 0xDEADBEEF);
+			CHECK(out.data == msg.data);
+			CHECK_EQ(out.ts, 12345);
+		}
+	}
+	CHECK_EQ(n_msgs, 2);
+}
+
+int main()
+{
+	signal(SIGPIPE, SIG_IGN);
+	RUN_TEST(testStateLayout);
+	RUN_TEST(testDaemon);
+	return TEST_RESULT();
+}
@@ -0,0 +1,134 @@
+// Fleet coordinator: global chip and wall indices across several controllers, fan out on one I/O thread, aggregated completion, against gate_emulator
+
+#include "EmulatorProcess.h"
+#include "GateFleet.h"
+#include "NativeTest.h"
+#include <dirent.h>
+
+// Threads of this process
+static int countThreads()
+{
+	int n_threads = 0;
+	DIR *p_dir = opendir("/proc/self/task");
+	if (p_dir == nullptr)
+		return -1;
+	while (struct dirent *p_ent = readdir(p_dir))
+		n_threads += p_ent->d_name[0] != '.';
+	closedir(p_dir);
+	return n_threads;
+}
+
+void testFleet()
+{
+	EmulatorProcess emu_0, emu_1, emu_2;
+	CHECK(emu_0.start({"--fast", "--chips", "2"}, "fleet_0"));
+	CHECK(emu_1.start({"--fast", "--chips", "3", "--stuck", "1.3"}, "fleet_1"));
+	CHECK(emu_2.start({"--fast", "--chips", "1"}, "fleet_2"));
+
+	// One I/O thread for all ports
+	int n_threads = countThreads();
+	GateFleet fleet;
+	CHECK(fleet.open({emu_0.link, emu_1.link, emu_2.link}));
+	CHECK_EQ(fleet.nDevices(), 3);
+	CHECK_EQ(countThreads(), n_threads + 1);
+
+	// Global chip space
+	CHECK_EQ(fleet.readWalls().get().status, GateLink::ST_ARG);
+	GateFleet::FleetReplyStruct reply = fleet.initChips().get();
+	CHECK_EQ(reply.status, GateLink::ST_OK);
+	CHECK_EQ(reply.data.size(), 6);
+	CHECK(fleet.getChips() == std::vector<uint8_t>({2, 3, 1}));
+	CHECK_EQ(fleet.nChipsTotal(), 6);
+	uint8_t dev_i = 0, chip_i = 0;
+	CHECK(fleet.locateChip(2, dev_i, chip_i));
+	CHECK_EQ(dev_i, 1);
+	CHECK_EQ(chip_i, 0);
+	CHECK(fleet.locateChip(5, dev_i, chip_i));
+	CHECK_EQ(dev_i, 2);
+	CHECK_EQ(chip_i, 0);
+	CHECK(!fleet.locateChip(6, dev_i, chip_i));
+	CHECK(fleet.wallBytes({0, 17, 41}) == std::vector<uint8_t>({0x01, 0x00, 0x02, 0x00, 0x00, 0x02}));
+	CHECK(fleet.wallBytes({48}).empty());
+
+	// A fleet move splits the global bytes by device and joins the replies back
+	CHECK_EQ(fleet.initGates().get().status, GateLink::ST_OK);
+	reply = fleet.moveWalls({0x0F, 0xF0, 0x09, 0xFF, 0x00, 0x81}).get();
+	CHECK_EQ(reply.status, GateLink::ST_OK);
+	CHECK(reply.data == std::vector<uint8_t>({0x0F, 0xF0, 0x09, 0xF7, 0x00, 0x81}));
+	CHECK_EQ(reply.devices.size(), 3);
+	CHECK(reply.devices[1].frame.data == std::vector<uint8_t>({0x09, 0xF7, 0x00}));
+	CHECK(reply.tsRecv >= reply.tsSend);
+	CHECK(reply.dtSkewUs <= reply.tsRecv - reply.tsSend);
+	CHECK_EQ(fleet.moveWalls({0x0F}).get().status, GateLink::ST_ARG);
+	for (size_t dev_i = 0; dev_i < fleet.nDevices(); dev_i++)
+		CHECK_EQ(fleet.device(dev_i).nRequests, 3);
+
+	// Fleet requests from several threads
+	std::vector<std::thread> threads;
+	std::atomic<int> n_ok{0};
+	for (int thread_i = 0; thread_i < 4; thread_i++)
+		threads.push_back(std::thread([&fleet, &n_ok]()
+									  {
+			std::vector<std::future<GateFleet::FleetReplyStruct>> futs;
+			for (int req_i = 0; req_i < 10; req_i++)
+				futs.push_back(fleet.readWalls());
+			for (std::future<GateFleet::FleetReplyStruct> &r_fut : futs)
+			{
+				GateFleet::FleetReplyStruct r = r_fut.get();
+				n_ok += r.status == GateLink::ST_OK && r.data.size() == 6 && r.data[3] == 0xF7;
+			} }));
+	for (std::thread &r_thread : threads)
+		r_thread.join();
+	CHECK_EQ(n_ok, 40);
+	CHECK_EQ(fleet.nFailed, 0);
+
+	// A lost controller fails the fleet request but not the others' replies
+	emu_2.stop();
+	reply = fleet.readWalls().get();
+	CHECK_EQ(reply.status, GateLink::ST_CLOSED);
+	CHECK(reply.data.empty());
+	CHECK_EQ(reply.devices[0].status, GateLink::ST_OK);
+	CHECK(reply.devices[0].frame.data == std::vector<uint8_t>({0x0F, 0xF0}));
+	CHECK_EQ(reply.devices[2].status, GateLink::ST_CLOSED);
+	CHECK_EQ(fleet.nFailed, 1);
+	CHECK(!fleet.device(2).isOpen());
+	CHECK(fleet.device(0).isOpen());
+
+	fleet.close();
+	CHECK_EQ(countThreads(), n_threads);
+}
+
+void testLoopClose()
+{
+	// Clients opened on a loop can be closed from their own callback and reopened
+	EmulatorProcess emu;
+	CHECK(emu.start({"--fast", "--chips", "1"}, "loop"));
+	GateIoLoop loop;
+	GateClient client;
+	CHECK(!client.open(emu.link.c_str(), 115200, &loop));
+	CHECK(loop.start());
+	CHECK(client.open(emu.link.c_str(), 115200, &loop));
+	std::promise<uint8_t> prom;
+	client.send(GateProtocol::PING, {}, [&client, &prom](const GateLink::ReplyStruct &r_reply)
+				{
+		client.close();
+		prom.set_value(r_reply.status); });
+	CHECK_EQ(prom.get_future().get(), GateLink::ST_OK);
+	CHECK(!client.isOpen());
+	CHECK_EQ(client.ping().get().status, GateLink::ST_CLOSED);
+	CHECK(client.open(emu.link.c_str(), 115200, &loop));
+	CHECK_EQ(client.ping().get().status, GateLink::ST_OK);
+
+	// Stopping the loop closes its clients
+	std::future<GateLink::ReplyStruct> fut = client.send(99);
+	loop.stop();
+	CHECK_EQ(fut.get().status, GateLink::ST_CLOSED);
+	CHECK(!client.isOpen());
+}
+
+int main()
+{
+	RUN_TEST(testLoopClose);
+	RUN_TEST(testFleet);
+	return TEST_RESULT();
+}
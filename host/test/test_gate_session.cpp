@@ -0,0 +1,238 @@
+// Session recording and replay: file layout, host frame parsing, recording through the pseudo-terminal proxy and replay, against gate_emulator
+
+#include "EmulatorProcess.h"
+#include "NativeTest.h"
+#include "SessionProxy.h"
+#include "SessionReplay.h"
+
+// Write a session file from records
+static bool writeSession(const std::string &r_path, const std::vector<SessionLog::RecordStruct> &r_recs, size_t n_cut = 0)
+{
+	std::vector<uint8_t> bytes(SessionLog::headerSize, 0);
+	for (int byte_i = 0; byte_i < 4; byte_i++)
+		bytes[byte_i] = (uint8_t)(SessionLog::fileMagic >> (8 * byte_i));
+	bytes[4] = SessionLog::fileVersion;
+	uint64_t ts_prev = 0;
+	for (const SessionLog::RecordStruct &r_rec : r_recs)
+	{
+		std::vector<uint8_t> rec_bytes = SessionLog::encodeRecord(r_rec, ts_prev);
+		bytes.insert(bytes.end(), rec_bytes.begin(), rec_bytes.end());
+		ts_prev = r_rec.tsUs;
+	}
+	bytes.resize(bytes.size() - n_cut);
+	FILE *p_file = fopen(r_path.c_str(), "wb");
+	if (p_file == nullptr)
+		return false;
+	bool is_ok = fwrite(bytes.data(), 1, bytes.size(), p_file) == bytes.size();
+	fclose(p_file);
+	return is_ok;
+}
+
+// Make a record
+static SessionLog::RecordStruct makeRecord(uint8_t kind, uint64_t ts_us, uint8_t type, const std::vector<uint8_t> &r_data, uint32_t ts = 0)
+{
+	SessionLog::RecordStruct rec;
+	rec.kind = kind;
+	rec.tsUs = ts_us;
+	rec.frame.type = type;
+	rec.frame.data = r_data;
+	rec.frame.ts = ts;
+	return rec;
+}
+
+void testSessionFile()
+{
+	std::string path = "/tmp/gate_test_" + std::to_string(getpid()) + "_file.bin";
+	std::vector<SessionLog::RecordStruct> recs = {
+		makeRecord(SessionLog::HOST_FRAME, 0, GateProtocol::MOVE, {0x0F, 0x00}),
+		makeRecord(SessionLog::DEVICE_FRAME, 180000, GateProtocol::MOVE, {0x0F, 0x00}, 0x12345678),
+		makeRecord(SessionLog::HOST_GO, 20000000, GateProtocol::GO, {}),
+		makeRecord(SessionLog::DEVICE_FRAME, 20000100, GateProtocol::LOG, std::vector<uint8_t>(200, 0xAA), 7)};
+
+	// Compact records: a move frame is kind, dt, type, len, data and ts
+	CHECK_EQ(SessionLog::encodeRecord(recs[1], recs[0].tsUs).size(), 1 + 3 + 1 + 1 + 2 + 4);
+	CHECK_EQ(SessionLog::encodeRecord(recs[2], recs[1].tsUs).size(), 1 + 4 + 1 + 1);
+
+	CHECK(writeSession(path, recs));
+	SessionLog::SessionStruct session;
+	CHECK(SessionLog::load(path.c_str(), session));
+	CHECK(!session.isTruncated);
+	CHECK_EQ(session.records.size(), 4);
+	for (size_t rec_i = 0; rec_i < recs.size(); rec_i++)
+	{
+		CHECK_EQ(session.records[rec_i].kind, recs[rec_i].kind);
+		CHECK_EQ(session.records[rec_i].tsUs, recs[rec_i].tsUs);
+		CHECK_EQ(session.records[rec_i].frame.type, recs[rec_i].frame.type);
+		CHECK(session.records[rec_i].frame.data == recs[rec_i].frame.data);
+		CHECK_EQ(session.records[rec_i].frame.ts, recs[rec_i].frame.ts);
+	}
+
+	// A file cut inside a record loads up to the last complete one
+	CHECK(writeSession(path, recs, 3));
+	CHECK(SessionLog::load(path.c_str(), session));
+	CHECK(session.isTruncated);
+	CHECK_EQ(session.records.size(), 3);
+
+	// Not a session file
+	CHECK(writeSession(path, {}));
+	CHECK(SessionLog::load(path.c_str(), session));
+	CHECK(session.records.empty());
+	FILE *p_file = fopen(path.c_str(), "wb");
+	fputs("not a session", p_file);
+	fclose(p_file);
+	CHECK(!SessionLog::load(path.c_str(), session));
+	CHECK(!SessionLog::load("/tmp/gate_test_missing.bin", session));
+	unlink(path.c_str());
+}
+
+void testRequestParser()
+{
+	RequestParser parser;
+	GateProtocol::FrameStruct frame;
+	std::vector<uint8_t> bytes = GateProtocol::encode(GateProtocol::MOVE, {0x01, 0x02});
+	std::vector<uint8_t> ping = GateProtocol::encode(GateProtocol::PING, {});
+
+	// Frame split across pushes, then a GO byte between frames
+	parser.push(bytes.data(), 3);
+	CHECK_EQ(parser.next(frame), RequestParser::RT_NONE);
+	parser.push(bytes.data() + 3, bytes.size() - 3);
+	parser.push(&GateProtocol::GO_BYTE, 1);
+	CHECK_EQ(parser.next(frame), RequestParser::RT_FRAME);
+	CHECK_EQ(frame.type, GateProtocol::MOVE);
+	CHECK(frame.data == std::vector<uint8_t>({0x01, 0x02}));
+	CHECK_EQ(parser.next(frame), RequestParser::RT_GO);
+	CHECK_EQ(frame.type, GateProtocol::GO);
+	CHECK(frame.data.empty());
+	CHECK_EQ(parser.next(frame), RequestParser::RT_NONE);
+
+	// Junk and a bad checksum are skipped
+	std::vector<uint8_t> bad = bytes;
+	bad[bad.size() - 2]++;
+	std::vector<uint8_t> junk = {0x55, 0x03};
+	parser.push(junk.data(), junk.size());
+	parser.push(bad.data(), bad.size());
+	parser.push(ping.data(), ping.size());
+	CHECK_EQ(parser.next(frame), RequestParser::RT_FRAME);
+	CHECK_EQ(frame.type, GateProtocol::PING);
+	CHECK_EQ(parser.next(frame), RequestParser::RT_NONE);
+	CHECK_EQ(parser.nFrames, 3);
+	CHECK(parser.nSkipped >= junk.size() + 1);
+}
+
+void testRecordReplay()
+{
+	std::string path = "/tmp/gate_test_" + std::to_string(getpid()) + "_session.bin";
+	std::string link = "/tmp/gate_test_" + std::to_string(getpid()) + "_proxy";
+
+	// Record a host session through the proxy
+	{
+		EmulatorProcess emu;
+		CHECK(emu.start({"--fast", "--chips", "3"}, "record"));
+		SessionWriter writer;
+		CHECK(writer.open(path.c_str()));
+		SessionProxy proxy;
+		CHECK(proxy.start(emu.link.c_str(), 115200, link.c_str(), writer));
+		CHECK(proxy.isDeviceOpen());
+
+		GateClient client;
+		CHECK(client.open(link.c_str()));
+		client.setTimeout(300);
+		CHECK(client.initChips().get().frame.data.size() == 3);
+		CHECK_EQ(client.initGates().get().status, GateLink::ST_OK);
+		CHECK(client.moveWalls({0x0F, 0xF0, 0x81}).get().frame.data == std::vector<uint8_t>({0x0F, 0xF0, 0x81}));
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		CHECK(client.readWalls().get().frame.data == std::vector<uint8_t>({0x0F, 0xF0, 0x81}));
+		CHECK_EQ(client.ping().get().status, GateLink::ST_OK);
+		CHECK(client.send(GateProtocol::ARM, {0x02, 0x08}).get().frame.data == std::vector<uint8_t>({1}));
+		CHECK_EQ(client.go().get().status, GateLink::ST_OK);
+		CHECK_EQ(client.send(99).get().status, GateLink::ST_TIMEOUT);
+		client.close();
+
+		proxy.stop();
+		writer.close();
+		CHECK(access(link.c_str(), F_OK) != 0);
+		CHECK_EQ(proxy.nHostFrames, 8);
+		CHECK_EQ(proxy.nDeviceFrames, 7);
+		CHECK_EQ(proxy.nDeviceDropped, 0);
+		CHECK_EQ(writer.nRecords, 15);
+	}
+
+	SessionLog::SessionStruct session;
+	CHECK(SessionLog::load(path.c_str(), session));
+	CHECK(!session.isTruncated);
+	CHECK_EQ(session.records.size(), 15);
+	CHECK_EQ(session.records[0].kind, SessionLog::HOST_FRAME);
+	CHECK_EQ(session.records[0].frame.type, GateProtocol::INIT);
+	size_t n_go = 0;
+	for (const SessionLog::RecordStruct &r_rec : session.records)
+		n_go += r_rec.kind == SessionLog::HOST_GO;
+	CHECK_EQ(n_go, 1);
+	std::vector<int> reply_of = SessionReplay::matchReplies(session);
+	CHECK_EQ(reply_of[0], -1);
+	CHECK_EQ(reply_of[1], 0);
+
+	// Same controller: same replies
+	SessionReplay::OptionsStruct opts;
+	{
+		EmulatorProcess emu;
+		CHECK(emu.start({"--fast", "--chips", "3"}, "replay"));
+		GateClient client;
+		CHECK(client.open(emu.link.c_str()));
+		client.setTimeout(2000);
+		SessionReplay::ResultStruct result = SessionReplay::run(client, session, opts);
+		CHECK_EQ(result.status, GateLink::ST_OK);
+		CHECK_EQ(result.requests.size(), 8);
+		CHECK_EQ(result.nDiffs, 0);
+		CHECK_EQ(result.nExtraRecorded, 0);
+		CHECK_EQ(result.nExtraReplayed, 0);
+		CHECK(!result.requests.back().hasReply);
+		CHECK(result.requests[0].hasReply);
+		CHECK(result.requests[0].dtReplayedMs > 0);
+		CHECK(result.dtReplayedS >= result.dtRecordedS * 0.5);
+
+		// Without gaps the replay is bounded by the replies alone
+		opts.isNoGaps = true;
+		SessionReplay::ResultStruct fast = SessionReplay::run(client, session, opts);
+		CHECK_EQ(fast.nDiffs, 0);
+		CHECK(fast.dtReplayedS < result.dtReplayedS);
+	}
+
+	// A stuck wall changes the outcome of the moves
+	{
+		EmulatorProcess emu;
+		CHECK(emu.start({"--fast", "--chips", "3", "--stuck", "1.4"}, "stuck"));
+		GateClient client;
+		CHECK(client.open(emu.link.c_str()));
+		client.setTimeout(2000);
+		SessionReplay::ResultStruct result = SessionReplay::run(client, session, opts);
+		CHECK_EQ(result.status, GateLink::ST_OK);
+		CHECK(result.nDiffs >= 2);
+		for (const SessionReplay::RequestResultStruct &r_req : result.requests)
+			if (!r_req.isSame)
+			{
+				CHECK_EQ(r_req.status, GateLink::ST_OK);
+				CHECK(r_req.request.type == GateProtocol::GATE_INIT || r_req.request.type == GateProtocol::MOVE);
+			}
+	}
+
+	// Lost controller: remaining requests fail
+	{
+		EmulatorProcess emu;
+		CHECK(emu.start({"--fast", "--chips", "3"}, "lost"));
+		GateClient client;
+		CHECK(client.open(emu.link.c_str()));
+		emu.stop();
+		SessionReplay::ResultStruct result = SessionReplay::run(client, session, opts);
+		CHECK_EQ(result.status, GateLink::ST_CLOSED);
+		CHECK_EQ(result.nDiffs, 8);
+	}
+	unlink(path.c_str());
+}
+
+int main()
+{
+	RUN_TEST(testSessionFile);
+	RUN_TEST(testRequestParser);
+	RUN_TEST(testRecordReplay);
+	return TEST_RESULT();
+}
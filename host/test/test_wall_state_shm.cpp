@@ -0,0 +1,170 @@
+// Shared memory wall state: snapshots are never torn, the segment outlives its writer, and gate_daemon's states reach readers
+
+#include "DaemonClient.h"
+#include "EmulatorProcess.h"
+#include "GateDaemon.h"
+#include "NativeTest.h"
+#include "WallStateShm.h"
+#include <cstring>
+
+// Segment name unique to this test process
+static std::string shmName(const char *p_name)
+{
+	return "/gate_test_" + std::to_string(getpid()) + "_" + p_name;
+}
+
+// Wall state with every byte derived from "seq", so a torn copy is detectable
+static DaemonProtocol::WallStateStruct makeState(uint32_t seq)
+{
+	DaemonProtocol::WallStateStruct state;
+	state.seq = seq;
+	state.tsDevice = seq * 3;
+	state.nChips = seq % DaemonProtocol::maxChips;
+	for (uint8_t cyp_i = 0; cyp_i < DaemonProtocol::maxChips; cyp_i++)
+	{
+		state.addr[cyp_i] = (uint8_t)(seq + cyp_i);
+		state.position[cyp_i] = (uint8_t)seq;
+		state.target[cyp_i] = (uint8_t)~seq;
+		state.error[cyp_i] = (uint8_t)(seq >> 8);
+		state.moving[cyp_i] = (uint8_t)(seq * 7);
+	}
+	return state;
+}
+
+static bool isConsistent(const DaemonProtocol::WallStateStruct &r_state)
+{
+	DaemonProtocol::WallStateStruct expected = makeState(r_state.seq);
+	return memcmp(&r_state, &expected, sizeof(r_state)) == 0;
+}
+
+void testSnapshots()
+{
+	std::string name = shmName("snap");
+	WallStateReader reader;
+	CHECK(!reader.open(name.c_str()));
+	WallStateWriter writer;
+	CHECK(writer.open(name.c_str()));
+	CHECK(reader.open(name.c_str()));
+	CHECK(reader.isWriterAlive());
+
+	// Never published
+	DaemonProtocol::WallStateStruct state;
+	uint64_t ts_pub = 1;
+	CHECK(reader.read(state, &ts_pub));
+	CHECK_EQ(ts_pub, 0);
+	CHECK_EQ(state.nChips, 0);
+
+	// Older states are ignored
+	writer.publish(makeState(5));
+	writer.publish(makeState(4));
+	CHECK(reader.read(state, &ts_pub));
+	CHECK_EQ(state.seq, 5);
+	CHECK(ts_pub > 0);
+	CHECK_EQ(writer.nPublished, 1);
+
+	// A writer thread publishing flat out against readers in other threads
+	const uint32_t n_pub = 200000;
+	std::atomic<bool> is_done{false};
+	std::atomic<uint32_t> n_torn{0}, n_reads{0}, n_backwards{0};
+	std::vector<std::thread> threads;
+	for (int thread_i = 0; thread_i < 2; thread_i++)
+		threads.push_back(std::thread([&]()
+									  {
+			WallStateReader reader_t;
+			if (!reader_t.open(name.c_str()))
+				return;
+			uint32_t seq_last = 0;
+			while (!is_done)
+			{
+				DaemonProtocol::WallStateStruct state_t;
+				if (!reader_t.read(state_t))
+					continue;
+				n_reads++;
+				n_torn += !isConsistent(state_t);
+				n_backwards += state_t.seq < seq_last;
+				seq_last = state_t.seq;
+			} }));
+	for (uint32_t seq = 6; seq < 6 + n_pub; seq++)
+		writer.publish(makeState(seq));
+	is_done = true;
+	for (std::thread &r_thread : threads)
+		r_thread.join();
+	CHECK(n_reads > 0);
+	CHECK_EQ(n_torn, 0);
+	CHECK_EQ(n_backwards, 0);
+	CHECK(reader.read(state));
+	CHECK_EQ(state.seq, 5 + n_pub);
+
+	// Only one live writer per segment
+	WallStateWriter writer_2;
+	CHECK(writer.open(name.c_str()));
+	pid_t pid = fork();
+	if (pid == 0)
+		_exit(writer_2.open(name.c_str()) ? 1 : 0);
+	int status = -1;
+	waitpid(pid, &status, 0);
+	CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+	// The segment keeps the last state after the writer closes and takes a new writer's states
+	writer.close();
+	CHECK(!reader.isWriterAlive());
+	CHECK(reader.read(state));
+	CHECK_EQ(state.seq, 5 + n_pub);
+	CHECK(writer_2.open(name.c_str()));
+	writer_2.publish(makeState(1));
+	CHECK(reader.read(state));
+	CHECK_EQ(state.seq, 1);
+	CHECK(isConsistent(state));
+
+	CHECK(WallStateWriter::unlink(name.c_str()));
+	CHECK(!WallStateWriter::unlink(name.c_str()));
+	CHECK(reader.read(state));
+}
+
+void testDaemonStates()
+{
+	EmulatorProcess emu;
+	CHECK(emu.start({"--fast", "--chips", "2"}, "shm"));
+	GateClient device;
+	CHECK(device.open(emu.link.c_str()));
+	std::string name = shmName("daemon");
+	WallStateWriter writer;
+	CHECK(writer.open(name.c_str()));
+	std::string path_socket = emu.link + ".sock";
+	GateDaemon daemon;
+	CHECK(daemon.start(device, path_socket.c_str()));
+	daemon.setStateCallback([&writer](const DaemonProtocol::WallStateStruct &r_state)
+							{ writer.publish(r_state); });
+	writer.publish(daemon.getState());
+
+	WallStateReader reader;
+	CHECK(reader.open(name.c_str()));
+	DaemonClient client;
+	CHECK(client.connect(path_socket.c_str()));
+	CHECK_EQ(client.initChips().get().status, GateLink::ST_OK);
+	CHECK_EQ(client.initGates().get().status, GateLink::ST_OK);
+	CHECK_EQ(client.moveWalls({0x0F, 0x81}).get().status, GateLink::ST_OK);
+
+	// The move reply updates the daemon before it is forwarded, so the segment already has it
+	DaemonProtocol::WallStateStruct state;
+	CHECK(reader.read(state));
+	CHECK_EQ(state.nChips, 2);
+	CHECK_EQ(state.position[0], 0x0F);
+	CHECK_EQ(state.position[1], 0x81);
+	CHECK_EQ(state.moving[0] | state.moving[1], 0);
+	CHECK_EQ(state.seq, daemon.getState().seq);
+	CHECK(writer.nPublished > 1);
+
+	client.close();
+	device.close();
+	daemon.stop();
+	writer.close();
+	WallStateWriter::unlink(name.c_str());
+}
+
+int main()
+{
+	RUN_TEST(testSnapshots);
+	RUN_TEST(testDaemonStates);
+	return TEST_RESULT();
+}
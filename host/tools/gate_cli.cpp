@@ -0,0 +1,276 @@
+// ######################################
+
+//============ gate_cli.cpp ===========
+
+// ######################################
+
+/// @file Command line client for scripting a gate controller or gate_emulator.
+///
+/// @details Each command prints one line: the reply data as hex bytes, or for ping the round
+/// trip time. Without a command on the command line, commands are read from stdin one per line,
+/// so a script can keep the port open across many moves. PORT can also be a gate_daemon
+/// socket, then status is read from the daemon's cache. The exit code is 0 if every command got
+/// a reply, 1 otherwise and 2 for usage errors.
+
+//============= INCLUDE ================
+#include "DaemonClient.h"
+#include "GateClient.h"
+#include <getopt.h>
+#include <condition_variable>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+
+//============ FUNCTIONS ===============
+
+static void printUsage(const char *p_name)
+{
+	printf("Usage: %s [options] PORT|SOCKET [COMMAND [ARGS...]]\n"
+		   "Commands (read from stdin one per line if none is given):\n"
+		   "  init               scan and initialize the chips, print their addresses\n"
+		   "  gate-init          run all walls up and back down, print the up wall bytes\n"
+		   "  move B0 [B1 ...]   move to one wall byte per chip, print the wall bytes\n"
+		   "  status             print the wall bytes without moving (from the cache through gate_daemon)\n"
+		   "  watch [N]          gate_daemon only: print the wall, moving and error bytes of N state changes [default: until stopped]\n"
+		   "  ping               print the round trip time and device receive timestamp\n"
+		   "  send TYPE [B ...]  send a raw message of decimal TYPE, print the reply data\n"
+		   "Bytes are hex, as printed (e.g. 0f or 0x0f).\n"
+		   "Options:\n"
+		   "  --baud N           baud rate [default: 115200]\n"
+		   "  --timeout MS       reply timeout [default: 5000, 15000 through gate_daemon]\n"
+		   "  --log              print unsolicited frames as hex to stderr (decode log frames with gui/gate_log_decode.py)\n",
+		   p_name);
+}
+
+// Parse a byte argument in base 16 (data bytes, as printed) or 10 (message type)
+static bool parseByte(const std::string &r_str, uint8_t &r_byte, int base = 16)
+{
+	char *p_end;
+	unsigned long val = strtoul(r_str.c_str(), &p_end, base);
+	if (r_str.empty() || *p_end != 0 || val > 255)
+		return false;
+	r_byte = (uint8_t)val;
+	return true;
+}
+
+// Print the reply data as hex bytes
+static void printData(const std::vector<uint8_t> &r_data)
+{
+	for (size_t byte_i = 0; byte_i < r_data.size(); byte_i++)
+		printf("%s%02x", byte_i ? " " : "", r_data[byte_i]);
+	printf("\n");
+	fflush(stdout);
+}
+
+// Print the wall position, moving and error bytes of a daemon wall state
+static void printState(const DaemonProtocol::WallStateStruct &r_state)
+{
+	printf("seq %u walls", r_state.seq);
+	for (const uint8_t *p_arr : {r_state.position, r_state.moving, r_state.error})
+	{
+		for (uint8_t cyp_i = 0; cyp_i < r_state.nChips; cyp_i++)
+			printf(" %02x", p_arr[cyp_i]);
+		if (p_arr != r_state.error)
+			printf(" %s", p_arr == r_state.position ? "moving" : "error");
+	}
+	printf("\n");
+	fflush(stdout);
+}
+
+// Run a command that reads the daemon's wall state
+static int runStateCommand(DaemonClient &r_daemon, const std::vector<std::string> &r_words)
+{
+	if (r_words[0] == "status")
+	{
+		DaemonClient::StateReplyStruct reply = r_daemon.readState().get();
+		if (reply.status != GateLink::ST_OK)
+		{
+			fprintf(stderr, "gate_cli: status failed with status[%u]\n", reply.status);
+			return 1;
+		}
+		printData(std::vector<uint8_t>(reply.state.position, reply.state.position + reply.state.nChips));
+		return 0;
+	}
+
+	// Print state changes until N are printed or the daemon stops
+	long n_max = r_words.size() > 1 ? atol(r_words[1].c_str()) : -1;
+	std::mutex mtx;
+	std::condition_variable cv;
+	long n_printed = 0;
+	DaemonClient::StateReplyStruct reply = r_daemon.subscribe([&](const DaemonProtocol::WallStateStruct &r_state)
+															  {
+		std::lock_guard<std::mutex> lock(mtx);
+		if (n_max < 0 || n_printed < n_max)
+			printState(r_state);
+		n_printed++;
+		cv.notify_all(); })
+											   .get();
+	if (reply.status != GateLink::ST_OK)
+	{
+		fprintf(stderr, "gate_cli: watch failed with status[%u]\n", reply.status);
+		return 1;
+	}
+	std::unique_lock<std::mutex> lock(mtx);
+	while ((n_max < 0 || n_printed < n_max) && r_daemon.isOpen())
+		cv.wait_for(lock, std::chrono::milliseconds(200));
+	lock.unlock();
+	r_daemon.unsubscribe().wait();
+	return 0;
+}
+
+// Run one command, return 0 on success, 1 on a failed request and 2 on a bad command
+static int runCommand(GateLink &r_link, DaemonClient *p_daemon, const std::vector<std::string> &r_words)
+{
+	if (r_words.empty())
+		return 0;
+	const std::string &r_cmd = r_words[0];
+	if (p_daemon != nullptr && (r_cmd == "status" || r_cmd == "watch"))
+		return runStateCommand(*p_daemon, r_words);
+	std::vector<uint8_t> data;
+	size_t arg_i = r_cmd == "send" ? 2 : 1;
+	for (; arg_i < r_words.size(); arg_i++)
+	{
+		uint8_t b;
+		if (!parseByte(r_words[arg_i], b))
+		{
+			fprintf(stderr, "gate_cli: bad byte [%s]\n", r_words[arg_i].c_str());
+			return 2;
+		}
+		data.push_back(b);
+	}
+
+	std::future<GateClient::ReplyStruct> fut;
+	if (r_cmd == "init")
+		fut = r_link.initChips();
+	else if (r_cmd == "gate-init")
+		fut = r_link.initGates();
+	else if (r_cmd == "move" && !data.empty())
+		fut = r_link.moveWalls(data);
+	else if (r_cmd == "status")
+		fut = r_link.readWalls();
+	else if (r_cmd == "ping")
+		fut = r_link.ping();
+	else if (r_cmd == "send" && r_words.size() > 1)
+	{
+		uint8_t type;
+		if (!parseByte(r_words[1], type, 10))
+		{
+			fprintf(stderr, "gate_cli: bad message type [%s]\n", r_words[1].c_str());
+			return 2;
+		}
+		fut = r_link.send(type, data);
+	}
+	else
+	{
+		fprintf(stderr, "gate_cli: unknown command or missing arguments [%s]\n", r_cmd.c_str());
+		return 2;
+	}
+
+	GateClient::ReplyStruct reply = fut.get();
+	if (reply.status != GateClient::ST_OK)
+	{
+		fprintf(stderr, "gate_cli: %s failed: %s\n", r_cmd.c_str(),
+				reply.status == GateClient::ST_TIMEOUT	? "no reply"
+				: reply.status == GateClient::ST_CLOSED ? "port closed"
+														: "bad argument");
+		return 1;
+	}
+	if (r_cmd == "ping")
+	{
+		printf("rtt_us %llu device_rx_us %u\n", (unsigned long long)(reply.tsRecv - reply.tsSend), GateProtocol::readU32(reply.frame.data, 0));
+		fflush(stdout);
+	}
+	else
+		printData(reply.frame.data);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t baud = 115200;
+	uint32_t dt_timeout_ms = 0;
+	bool do_log = false;
+
+	static struct option opts[] = {
+		{"baud", required_argument, 0, 'b'},
+		{"timeout", required_argument, 0, 't'},
+		{"log", no_argument, 0, 'l'},
+		{"help", no_argument, 0, 'h'},
+		{0, 0, 0, 0}};
+	int opt;
+	while ((opt = getopt_long(argc, argv, "+h", opts, nullptr)) != -1)
+	{
+		switch (opt)
+		{
+		case 'b':
+			baud = atoi(optarg);
+			break;
+		case 't':
+			dt_timeout_ms = atoi(optarg);
+			break;
+		case 'l':
+			do_log = true;
+			break;
+		default:
+			printUsage(argv[0]);
+			return opt == 'h' ? 0 : 2;
+		}
+	}
+	if (optind >= argc)
+	{
+		printUsage(argv[0]);
+		return 2;
+	}
+
+	// Serial port or daemon socket
+	GateClient client;
+	DaemonClient daemon;
+	DaemonClient *p_daemon = nullptr;
+	struct stat st;
+	if (stat(argv[optind], &st) == 0 && S_ISSOCK(st.st_mode))
+	{
+		if (!daemon.connect(argv[optind]))
+		{
+			fprintf(stderr, "gate_cli: failed to connect to gate_daemon on [%s]\n", argv[optind]);
+			return 1;
+		}
+		daemon.setTimeout(dt_timeout_ms > 0 ? dt_timeout_ms : 15000);
+		p_daemon = &daemon;
+	}
+	else if (!client.open(argv[optind], baud))
+	{
+		fprintf(stderr, "gate_cli: failed to open [%s] at baud[%u]\n", argv[optind], baud);
+		return 1;
+	}
+	client.setTimeout(dt_timeout_ms > 0 ? dt_timeout_ms : 5000);
+	GateLink &r_link = p_daemon != nullptr ? (GateLink &)daemon : (GateLink &)client;
+	if (do_log)
+		client.setFrameCallback([](const GateProtocol::FrameStruct &r_frame)
+								{
+									fprintf(stderr, "frame type[%u] ts[%u]:", r_frame.type, r_frame.ts);
+									for (uint8_t b : r_frame.data)
+										fprintf(stderr, " %02x", b);
+									fprintf(stderr, "\n"); });
+
+	// Single command from the arguments
+	if (optind + 1 < argc)
+		return runCommand(r_link, p_daemon, std::vector<std::string>(argv + optind + 1, argv + argc));
+
+	// Commands from stdin
+	int status = 0;
+	std::string line;
+	while (std::getline(std::cin, line))
+	{
+		std::istringstream iss(line);
+		std::vector<std::string> words;
+		std::string word;
+		while (iss >> word)
+			words.push_back(word);
+		if (!words.empty() && words[0][0] == '#')
+			continue;
+		int cmd_status = runCommand(r_link, p_daemon, words);
+		status = cmd_status > status ? cmd_status : status;
+	}
+	return status;
+}
@@ -0,0 +1,286 @@
+// ######################################
+
+//======= gate_client_bench.cpp =======
+
+// ######################################
+
+/// @file Request latency of the host client against a gate controller or gate_emulator.
+///
+/// @details Times request to reply round trips as seen by the caller: clock sync pings, wall
+/// status reads, random wall moves with message type 2, and pings with several requests in
+/// flight. With --poll-ms the pings are also read back on a fixed timer the way the GUI polls
+/// the port, to show the latency the poll interval adds. Prints p50/p95/p99/max per test and can
+/// write every sample to CSV.
+
+//============= INCLUDE ================
+#include "GateClient.h"
+#include <algorithm>
+#include <condition_variable>
+#include <getopt.h>
+#include <map>
+#include <random>
+#include <string>
+
+//============ VARIABLES ===============
+struct SampleStruct
+{
+	std::string test;
+	uint32_t trial;
+	double dtMs;
+};
+static std::vector<SampleStruct> Samples;
+
+//============ FUNCTIONS ===============
+
+static void printUsage(const char *p_name)
+{
+	printf("Usage: %s [options] PORT\n"
+		   "  --baud N          baud rate [default: 115200]\n"
+		   "  --trials N        pings and status reads [default: 1000]\n"
+		   "  --moves N         random wall moves [default: 100]\n"
+		   "  --depth N         requests in flight for the pipelined pings [default: 8]\n"
+		   "  --poll-ms MS      also read pings on a poll timer of MS [default: off]\n"
+		   "  --seed N          random seed for the wall configurations [default: 1]\n"
+		   "  --no-init         skip the chip and gate initialization\n"
+		   "  --csv FILE        write every sample to a CSV file\n",
+		   p_name);
+}
+
+// Wait for a reply, exit if the request failed
+static GateClient::ReplyStruct getReply(std::future<GateClient::ReplyStruct> fut, const char *p_what)
+{
+	GateClient::ReplyStruct reply = fut.get();
+	if (reply.status != GateClient::ST_OK)
+	{
+		fprintf(stderr, "gate_client_bench: %s failed with status[%u]\n", p_what, reply.status);
+		exit(1);
+	}
+	return reply;
+}
+
+// Store the round trip time of a reply
+static void addSample(const char *p_test, uint32_t trial, const GateClient::ReplyStruct &r_reply)
+{
+	Samples.push_back({p_test, trial, (r_reply.tsRecv - r_reply.tsSend) / 1000.0});
+}
+
+// Get a percentile of a sorted list
+static double percentile(const std::vector<double> &r_vals, double pct)
+{
+	if (r_vals.empty())
+		return 0;
+	return r_vals[std::min(r_vals.size() - 1, (size_t)(pct / 100 * (r_vals.size() - 1) + 0.5))];
+}
+
+// Print the latency percentiles of each test in run order
+static void printSummary(const std::vector<std::string> &r_tests, const std::map<std::string, double> &r_rates)
+{
+	printf("\n%-16s%8s%10s%10s%10s%10s%12s  (ms)\n", "test", "n", "p50", "p95", "p99", "max", "req/s");
+	for (const std::string &r_test : r_tests)
+	{
+		std::vector<double> vals;
+		for (const SampleStruct &r_samp : Samples)
+			if (r_samp.test == r_test)
+				vals.push_back(r_samp.dtMs);
+		std::sort(vals.begin(), vals.end());
+		printf("%-16s%8zu%10.3f%10.3f%10.3f%10.3f%12.1f\n", r_test.c_str(), vals.size(), percentile(vals, 50), percentile(vals, 95),
+			   percentile(vals, 99), vals.empty() ? 0 : vals.back(), r_rates.at(r_test));
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t baud = 115200;
+	uint32_t n_trials = 1000;
+	uint32_t n_moves = 100;
+	uint32_t depth = 8;
+	uint32_t dt_poll_ms = 0;
+	uint32_t seed = 1;
+	bool do_init = true;
+	const char *p_csv = nullptr;
+
+	static struct option opts[] = {
+		{"baud", required_argument, 0, 'b'},
+		{"trials", required_argument, 0, 'n'},
+		{"moves", required_argument, 0, 'm'},
+		{"depth", required_argument, 0, 'd'},
+		{"poll-ms", required_argument, 0, 'p'},
+		{"seed", required_argument, 0, 'r'},
+		{"no-init", no_argument, 0, 'i'},
+		{"csv", required_argument, 0, 'c'},
+		{"help", no_argument, 0, 'h'},
+		{0, 0, 0, 0}};
+	int opt;
+	while ((opt = getopt_long(argc, argv, "h", opts, nullptr)) != -1)
+	{
+		switch (opt)
+		{
+		case 'b':
+			baud = atoi(optarg);
+			break;
+		case 'n':
+			n_trials = atoi(optarg);
+			break;
+		case 'm':
+			n_moves = atoi(optarg);
+			break;
+		case 'd':
+			depth = std::max(1, atoi(optarg));
+			break;
+		case 'p':
+			dt_poll_ms = atoi(optarg);
+			break;
+		case 'r':
+			seed = atoi(optarg);
+			break;
+		case 'i':
+			do_init = false;
+			break;
+		case 'c':
+			p_csv = optarg;
+			break;
+		default:
+			printUsage(argv[0]);
+			return opt == 'h' ? 0 : 2;
+		}
+	}
+	if (optind != argc - 1)
+	{
+		printUsage(argv[0]);
+		return 2;
+	}
+
+	GateClient client;
+	if (!client.open(argv[optind], baud))
+	{
+		fprintf(stderr, "gate_client_bench: failed to open [%s]\n", argv[optind]);
+		return 1;
+	}
+	client.setTimeout(10000);
+
+	// Get the chips and set all walls to a known state
+	size_t n_chips;
+	if (do_init)
+	{
+		n_chips = getReply(client.initChips(), "init").frame.data.size();
+		getReply(client.initGates(), "gate init");
+	}
+	else
+		n_chips = getReply(client.readWalls(), "status").frame.data.size();
+	if (n_chips == 0)
+	{
+		fprintf(stderr, "gate_client_bench: no chips found\n");
+		return 1;
+	}
+	getReply(client.ping(), "ping"); // waits for the walls to finish moving down
+	printf("Chips[%zu] trials[%u] moves[%u] depth[%u]\n", n_chips, n_trials, n_moves, depth);
+
+	std::vector<std::string> tests;
+	std::map<std::string, double> rates;
+	uint64_t ts_start;
+
+	// Sequential requests
+	tests.push_back("ping");
+	ts_start = GateClient::nowUs();
+	for (uint32_t trial_i = 0; trial_i < n_trials; trial_i++)
+		addSample("ping", trial_i, getReply(client.ping(), "ping"));
+	rates["ping"] = n_trials / ((GateClient::nowUs() - ts_start) / 1e6);
+
+	tests.push_back("status");
+	ts_start = GateClient::nowUs();
+	for (uint32_t trial_i = 0; trial_i < n_trials; trial_i++)
+		addSample("status", trial_i, getReply(client.readWalls(), "status"));
+	rates["status"] = n_trials / ((GateClient::nowUs() - ts_start) / 1e6);
+
+	tests.push_back("move");
+	std::mt19937 rng(seed);
+	uint32_t n_failed = 0;
+	ts_start = GateClient::nowUs();
+	for (uint32_t trial_i = 0; trial_i < n_moves; trial_i++)
+	{
+		std::vector<uint8_t> wall_bytes(n_chips);
+		for (uint8_t &r_byte : wall_bytes)
+			r_byte = rng() & 0xFF;
+		GateClient::ReplyStruct reply = getReply(client.moveWalls(wall_bytes), "move");
+		if (reply.frame.data != wall_bytes)
+			n_failed++;
+		addSample("move", trial_i, reply);
+	}
+	rates["move"] = n_moves / ((GateClient::nowUs() - ts_start) / 1e6);
+
+	// Pipelined pings, a new request is sent as each reply arrives
+	tests.push_back("ping_pipelined");
+	std::recursive_mutex mtx; // a failed send completes on the sending thread
+	std::condition_variable_any cv;
+	uint32_t n_sent = 0, n_done = 0, n_bad = 0;
+	std::function<void()> sendNext;
+	GateClient::ReplyCallback on_reply = [&](const GateClient::ReplyStruct &r_reply)
+	{
+		std::lock_guard<std::recursive_mutex> lock(mtx);
+		if (r_reply.status == GateClient::ST_OK)
+			addSample("ping_pipelined", n_done, r_reply);
+		else
+			n_bad++;
+		n_done++;
+		if (n_sent < n_trials)
+			sendNext();
+		cv.notify_all();
+	};
+	sendNext = [&]()
+	{
+		n_sent++;
+		client.send(GateProtocol::PING, {}, on_reply);
+	};
+	ts_start = GateClient::nowUs();
+	{
+		std::unique_lock<std::recursive_mutex> lock(mtx);
+		for (uint32_t req_i = 0; req_i < depth && n_sent < n_trials; req_i++)
+			sendNext();
+		cv.wait(lock, [&]()
+				{ return n_done == n_trials; });
+	}
+	rates["ping_pipelined"] = n_trials / ((GateClient::nowUs() - ts_start) / 1e6);
+
+	// Pings read back on a poll timer
+	if (dt_poll_ms > 0)
+	{
+		tests.push_back("ping_polled");
+		ts_start = GateClient::nowUs();
+		uint64_t ts_tick = GateClient::nowUs();
+		for (uint32_t trial_i = 0; trial_i < n_trials; trial_i++)
+		{
+			std::future<GateClient::ReplyStruct> fut = client.ping();
+			do
+			{
+				ts_tick += dt_poll_ms * 1000;
+				uint64_t ts_now = GateClient::nowUs();
+				if (ts_tick > ts_now)
+					std::this_thread::sleep_for(std::chrono::microseconds(ts_tick - ts_now));
+			} while (fut.wait_for(std::chrono::seconds(0)) != std::future_status::ready);
+			GateClient::ReplyStruct reply = getReply(std::move(fut), "ping");
+			reply.tsRecv = GateClient::nowUs();
+			addSample("ping_polled", trial_i, reply);
+		}
+		rates["ping_polled"] = n_trials / ((GateClient::nowUs() - ts_start) / 1e6);
+	}
+
+	printf("Moves failed[%u] pipelined failed[%u] timeouts[%u] unmatched frames[%u]\n", n_failed, n_bad,
+		   (unsigned)client.nTimeouts, (unsigned)client.nUnmatched);
+	printSummary(tests, rates);
+
+	if (p_csv != nullptr)
+	{
+		FILE *p_file = fopen(p_csv, "w");
+		if (p_file == nullptr)
+		{
+			fprintf(stderr, "gate_client_bench: failed to write [%s]\n", p_csv);
+			return 1;
+		}
+		fprintf(p_file, "test,trial,latency_ms\n");
+		for (const SampleStruct &r_samp : Samples)
+			fprintf(p_file, "%s,%u,%.3f\n", r_samp.test.c_str(), r_samp.trial, r_samp.dtMs);
+		fclose(p_file);
+		printf("Wrote %zu samples to %s\n", Samples.size(), p_csv);
+	}
+	return n_failed + n_bad > 0 ? 1 : 0;
+}
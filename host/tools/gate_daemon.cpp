@@ -0,0 +1,124 @@
+// ######################################
+
+//=========== gate_daemon.cpp =========
+
+// ######################################
+
+/// @file Owns a controller serial port and serves it to local clients on a Unix socket.
+///
+/// @details Clients (gate_cli, tracking software, experiment scripts) connect with
+/// @ref DaemonClient and send controller messages concurrently. Status reads are answered from
+/// the cached wall state and subscribers get every wall state change. Exits with status 1 if
+/// the serial port is lost, so a service manager can restart it. With --shm the wall state is
+/// also published to shared memory for @ref WallStateReader.
+
+//============= INCLUDE ================
+#include "GateDaemon.h"
+#include "WallStateShm.h"
+#include <getopt.h>
+#include <signal.h>
+
+//============ VARIABLES ===============
+static volatile sig_atomic_t isStopped = 0;
+
+//============ FUNCTIONS ===============
+
+static void onSignal(int) { isStopped = 1; }
+
+static void printUsage(const char *p_name)
+{
+	printf("Usage: %s [options] PORT\n"
+		   "  --socket PATH      Unix socket to serve [default: /tmp/gate_daemon.sock]\n"
+		   "  --baud N           baud rate [default: 115200]\n"
+		   "  --timeout MS       controller reply timeout [default: 10000]\n"
+		   "  --shm NAME         also publish the wall state to shared memory NAME (e.g. /gate_walls)\n",
+		   p_name);
+}
+
+int main(int argc, char *argv[])
+{
+	const char *p_socket = "/tmp/gate_daemon.sock";
+	uint32_t baud = 115200;
+	uint32_t dt_timeout_ms = 10000;
+	const char *p_shm = nullptr;
+
+	static struct option opts[] = {
+		{"socket", required_argument, 0, 's'},
+		{"baud", required_argument, 0, 'b'},
+		{"timeout", required_argument, 0, 't'},
+		{"shm", required_argument, 0, 'm'},
+		{"help", no_argument, 0, 'h'},
+		{0, 0, 0, 0}};
+	int opt;
+	while ((opt = getopt_long(argc, argv, "h", opts, nullptr)) != -1)
+	{
+		switch (opt)
+		{
+		case 's':
+			p_socket = optarg;
+			break;
+		case 'b':
+			baud = atoi(optarg);
+			break;
+		case 't':
+			dt_timeout_ms = atoi(optarg);
+			break;
+		case 'm':
+			p_shm = optarg;
+			break;
+		default:
+			printUsage(argv[0]);
+			return opt == 'h' ? 0 : 2;
+		}
+	}
+	if (optind != argc - 1)
+	{
+		printUsage(argv[0]);
+		return 2;
+	}
+
+	GateClient device;
+	if (!device.open(argv[optind], baud))
+	{
+		fprintf(stderr, "gate_daemon: failed to open [%s] at baud[%u]\n", argv[optind], baud);
+		return 1;
+	}
+	device.setTimeout(dt_timeout_ms);
+	WallStateWriter shm;
+	if (p_shm != nullptr && !shm.open(p_shm))
+	{
+		fprintf(stderr, "gate_daemon: failed to open shared memory [%s], is another daemon publishing it?\n", p_shm);
+		return 1;
+	}
+	GateDaemon daemon;
+	if (!daemon.start(device, p_socket))
+	{
+		fprintf(stderr, "gate_daemon: failed to listen on [%s], is another daemon running?\n", p_socket);
+		return 1;
+	}
+	if (shm.isOpen())
+	{
+		daemon.setStateCallback([&shm](const DaemonProtocol::WallStateStruct &r_state)
+								{ shm.publish(r_state); });
+		shm.publish(daemon.getState());
+	}
+	printf("gate_daemon: serving %s on %s\n", argv[optind], p_socket);
+	fflush(stdout);
+	signal(SIGINT, onSignal);
+	signal(SIGTERM, onSignal);
+	signal(SIGPIPE, SIG_IGN);
+
+	while (!isStopped && device.isOpen())
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	bool is_lost = !device.isOpen();
+	if (is_lost)
+		fprintf(stderr, "gate_daemon: lost %s\n", argv[optind]);
+
+	device.close();
+	daemon.stop();
+	shm.close();
+	printf("gate_daemon: stopped clients[%u] requests[%u] status[%u] events[%u] dropped[%u] timeouts[%u] published[%u]\n",
+		   (unsigned)daemon.nClients, (unsigned)daemon.nRequests, (unsigned)daemon.nStatus, (unsigned)daemon.nEvents,
+		   (unsigned)daemon.nDropped, (unsigned)device.nTimeouts, (unsigned)shm.nPublished);
+	return is_lost ? 1 : 0;
+}
@@ -0,0 +1,182 @@
+// ######################################
+
+//============ gate_fleet.cpp =========
+
+// ######################################
+
+/// @file Drives several gate controllers as one arena and times the fleet moves.
+///
+/// @details Opens every port on one I/O thread, scans the chips into one global index space and
+/// moves the walls of all controllers to random configurations at once. Prints the fleet move
+/// time, from the first message written to the last controller reply, and the skew between
+/// the first and last reply. With --serial the same moves are also run one controller after
+/// another, the way separate GUI instances would drive them in turn.
+
+//============= INCLUDE ================
+#include "GateFleet.h"
+#include <algorithm>
+#include <getopt.h>
+#include <random>
+#include <string>
+
+//============ FUNCTIONS ===============
+
+static void printUsage(const char *p_name)
+{
+	printf("Usage: %s [options] PORT [PORT ...]\n"
+		   "  --baud N          baud rate of all ports [default: 115200]\n"
+		   "  --moves N         random fleet moves [default: 100]\n"
+		   "  --seed N          random seed for the wall configurations [default: 1]\n"
+		   "  --serial          also run the moves one controller at a time\n"
+		   "  --no-init         skip the gate initialization\n",
+		   p_name);
+}
+
+// Get a percentile of a sorted list
+static double percentile(const std::vector<double> &r_vals, double pct)
+{
+	if (r_vals.empty())
+		return 0;
+	return r_vals[std::min(r_vals.size() - 1, (size_t)(pct / 100 * (r_vals.size() - 1) + 0.5))];
+}
+
+// Print one row of percentiles
+static void printRow(const char *p_test, std::vector<double> vals, double rate)
+{
+	std::sort(vals.begin(), vals.end());
+	printf("%-16s%8zu%10.3f%10.3f%10.3f%10.3f%12.1f\n", p_test, vals.size(), percentile(vals, 50), percentile(vals, 95),
+		   percentile(vals, 99), vals.empty() ? 0 : vals.back(), rate);
+}
+
+// Wait for a fleet reply, exit if a controller failed
+static GateFleet::FleetReplyStruct getReply(std::future<GateFleet::FleetReplyStruct> fut, const char *p_what)
+{
+	GateFleet::FleetReplyStruct reply = fut.get();
+	if (reply.status != GateLink::ST_OK)
+	{
+		for (size_t dev_i = 0; dev_i < reply.devices.size(); dev_i++)
+			if (reply.devices[dev_i].status != GateLink::ST_OK)
+				fprintf(stderr, "gate_fleet: %s failed on device[%zu] with status[%u]\n", p_what, dev_i, reply.devices[dev_i].status);
+		exit(1);
+	}
+	return reply;
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t baud = 115200;
+	uint32_t n_moves = 100;
+	uint32_t seed = 1;
+	bool do_serial = false;
+	bool do_init = true;
+
+	static struct option opts[] = {
+		{"baud", required_argument, 0, 'b'},
+		{"moves", required_argument, 0, 'm'},
+		{"seed", required_argument, 0, 'r'},
+		{"serial", no_argument, 0, 's'},
+		{"no-init", no_argument, 0, 'i'},
+		{"help", no_argument, 0, 'h'},
+		{0, 0, 0, 0}};
+	int opt;
+	while ((opt = getopt_long(argc, argv, "h", opts, nullptr)) != -1)
+	{
+		switch (opt)
+		{
+		case 'b':
+			baud = atoi(optarg);
+			break;
+		case 'm':
+			n_moves = atoi(optarg);
+			break;
+		case 'r':
+			seed = atoi(optarg);
+			break;
+		case 's':
+			do_serial = true;
+			break;
+		case 'i':
+			do_init = false;
+			break;
+		default:
+			printUsage(argv[0]);
+			return opt == 'h' ? 0 : 2;
+		}
+	}
+	if (optind >= argc)
+	{
+		printUsage(argv[0]);
+		return 2;
+	}
+
+	GateFleet fleet;
+	if (!fleet.open(std::vector<std::string>(argv + optind, argv + argc), baud))
+	{
+		fprintf(stderr, "gate_fleet: failed to open the ports\n");
+		return 1;
+	}
+	fleet.setTimeout(10000);
+
+	// Build the global chip space and set all walls to a known state
+	getReply(fleet.initChips(), "init");
+	if (do_init)
+		getReply(fleet.initGates(), "gate init");
+	getReply(fleet.readWalls(), "status"); // waits for the walls to finish moving down
+	std::vector<uint8_t> n_chips = fleet.getChips();
+	printf("Devices[%zu] chips[", fleet.nDevices());
+	for (size_t dev_i = 0; dev_i < n_chips.size(); dev_i++)
+		printf("%s%u", dev_i ? " " : "", n_chips[dev_i]);
+	printf("] walls[%u] moves[%u]\n", fleet.nChipsTotal() * 8, n_moves);
+
+	std::mt19937 rng(seed);
+	std::vector<std::vector<uint8_t>> configs(n_moves, std::vector<uint8_t>(fleet.nChipsTotal()));
+	for (std::vector<uint8_t> &r_config : configs)
+		for (uint8_t &r_byte : r_config)
+			r_byte = rng() & 0xFF;
+
+	// All controllers at once
+	std::vector<double> dt_fleet_ms, dt_skew_ms;
+	uint32_t n_missed = 0;
+	uint64_t ts_start = GateLink::nowUs();
+	for (const std::vector<uint8_t> &r_config : configs)
+	{
+		GateFleet::FleetReplyStruct reply = getReply(fleet.moveWalls(r_config), "move");
+		n_missed += reply.data != r_config;
+		dt_fleet_ms.push_back((reply.tsRecv - reply.tsSend) / 1000.0);
+		dt_skew_ms.push_back(reply.dtSkewUs / 1000.0);
+	}
+	double rate_fleet = n_moves / ((GateLink::nowUs() - ts_start) / 1e6);
+
+	// One controller after another
+	std::vector<double> dt_serial_ms;
+	double rate_serial = 0;
+	if (do_serial)
+	{
+		ts_start = GateLink::nowUs();
+		for (const std::vector<uint8_t> &r_config : configs)
+		{
+			uint64_t ts_move = GateLink::nowUs();
+			size_t pos = 0;
+			for (size_t dev_i = 0; dev_i < n_chips.size(); dev_i++)
+			{
+				std::vector<uint8_t> wall_bytes(r_config.begin() + pos, r_config.begin() + pos + n_chips[dev_i]);
+				pos += n_chips[dev_i];
+				if (!wall_bytes.empty() && fleet.device(dev_i).moveWalls(wall_bytes).get().status != GateLink::ST_OK)
+				{
+					fprintf(stderr, "gate_fleet: serial move failed on device[%zu]\n", dev_i);
+					return 1;
+				}
+			}
+			dt_serial_ms.push_back((GateLink::nowUs() - ts_move) / 1000.0);
+		}
+		rate_serial = n_moves / ((GateLink::nowUs() - ts_start) / 1e6);
+	}
+
+	printf("Moves missed[%u] failed[%u]\n", n_missed, (unsigned)fleet.nFailed);
+	printf("\n%-16s%8s%10s%10s%10s%10s%12s  (ms)\n", "test", "n", "p50", "p95", "p99", "max", "moves/s");
+	printRow("fleet_move", dt_fleet_ms, rate_fleet);
+	printRow("fleet_skew", dt_skew_ms, rate_fleet);
+	if (do_serial)
+		printRow("serial_move", dt_serial_ms, rate_serial);
+	return n_missed > 0 ? 1 : 0;
+}
@@ -0,0 +1,256 @@
+// ######################################
+
+//=========== gate_session.cpp ========
+
+// ######################################
+
+/// @file Records host sessions with a gate controller and replays them for regression and timing tests.
+///
+/// @details "record" stands between the host program and the controller: point the GUI or a
+/// script at the printed pseudo-terminal (or the --link path) instead of the controller port,
+/// and every frame both ways is written to the session file. "replay" sends the recorded
+/// requests again to a controller or gate_emulator, then prints the requests whose reply
+/// differs, the reply times per message type, recorded against replayed, and the session
+/// lengths. "dump" prints a recording. The exit code of replay is 0 if every reply matched,
+/// 1 otherwise and 2 for usage errors.
+
+//============= INCLUDE ================
+#include "SessionProxy.h"
+#include "SessionReplay.h"
+#include <algorithm>
+#include <getopt.h>
+#include <map>
+#include <signal.h>
+#include <string>
+
+//============ VARIABLES ===============
+static volatile sig_atomic_t isStopped = 0;
+
+//============ FUNCTIONS ===============
+
+static void onSignal(int) { isStopped = 1; }
+
+static void printUsage(const char *p_name)
+{
+	printf("Usage: %s [options] COMMAND ...\n"
+		   "Commands:\n"
+		   "  record PORT        forward a pseudo-terminal to PORT and record the session until stopped\n"
+		   "  replay FILE PORT   replay a recording on PORT and report the differences\n"
+		   "  dump FILE          print the records of a recording\n"
+		   "Options:\n"
+		   "  --baud N           baud rate [default: 115200]\n"
+		   "  --out FILE         record: session file to write [default: session.bin]\n"
+		   "  --link PATH        record: also create a symlink PATH to the pseudo-terminal\n"
+		   "  --speed X          replay: divide the recorded gaps by X [default: 1]\n"
+		   "  --max-gap-ms N     replay: cap each gap after scaling [default: no cap]\n"
+		   "  --no-gaps          replay: send each request as soon as the reply it followed is in\n"
+		   "  --timeout MS       replay: reply timeout [default: 10000]\n"
+		   "  --max-diffs N      replay: differing requests to print [default: 20]\n",
+		   p_name);
+}
+
+// Format bytes as hex
+static std::string toHex(const std::vector<uint8_t> &r_data)
+{
+	std::string str;
+	char buff[4];
+	for (size_t byte_i = 0; byte_i < r_data.size(); byte_i++)
+	{
+		snprintf(buff, sizeof(buff), "%s%02x", byte_i ? " " : "", r_data[byte_i]);
+		str += buff;
+	}
+	return str;
+}
+
+// Get a percentile of a sorted list
+static double percentile(const std::vector<double> &r_vals, double pct)
+{
+	if (r_vals.empty())
+		return 0;
+	return r_vals[std::min(r_vals.size() - 1, (size_t)(pct / 100 * (r_vals.size() - 1) + 0.5))];
+}
+
+// Load a recording, exit if it cannot be read
+static SessionLog::SessionStruct loadSession(const char *p_path)
+{
+	SessionLog::SessionStruct session;
+	if (!SessionLog::load(p_path, session))
+	{
+		fprintf(stderr, "gate_session: [%s] is not a session file\n", p_path);
+		exit(1);
+	}
+	if (session.isTruncated)
+		fprintf(stderr, "gate_session: [%s] ends inside a record, loaded %zu records\n", p_path, session.records.size());
+	return session;
+}
+
+static int runRecord(const char *p_device, uint32_t baud, const char *p_out, const char *p_link)
+{
+	SessionWriter writer;
+	if (!writer.open(p_out))
+	{
+		fprintf(stderr, "gate_session: failed to create [%s]\n", p_out);
+		return 1;
+	}
+	SessionProxy proxy;
+	if (!proxy.start(p_device, baud, p_link, writer))
+	{
+		fprintf(stderr, "gate_session: failed to open %s or the pseudo-terminal\n", p_device);
+		return 1;
+	}
+	printf("gate_session: recording %s on %s%s%s to %s\n", p_device, proxy.path().c_str(),
+		   p_link ? " linked from " : "", p_link ? p_link : "", p_out);
+	fflush(stdout);
+	signal(SIGINT, onSignal);
+	signal(SIGTERM, onSignal);
+
+	while (!isStopped && proxy.isDeviceOpen())
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	bool is_lost = !proxy.isDeviceOpen();
+	if (is_lost)
+		fprintf(stderr, "gate_session: lost %s\n", p_device);
+
+	proxy.stop();
+	writer.close();
+	printf("gate_session: recorded records[%u] host frames[%u] device frames[%u] bytes in[%u] out[%u] dropped[%u]\n",
+		   (unsigned)writer.nRecords, (unsigned)proxy.nHostFrames, (unsigned)proxy.nDeviceFrames,
+		   (unsigned)proxy.nHostBytes, (unsigned)proxy.nDeviceBytes, (unsigned)proxy.nDeviceDropped);
+	return is_lost ? 1 : 0;
+}
+
+static int runReplay(const char *p_path, const char *p_device, uint32_t baud, uint32_t dt_timeout_ms,
+					 const SessionReplay::OptionsStruct &r_opts, uint32_t n_max_diffs)
+{
+	SessionLog::SessionStruct session = loadSession(p_path);
+	GateClient client;
+	if (!client.open(p_device, baud))
+	{
+		fprintf(stderr, "gate_session: failed to open %s\n", p_device);
+		return 1;
+	}
+	client.setTimeout(dt_timeout_ms);
+	SessionReplay::ResultStruct result = SessionReplay::run(client, session, r_opts);
+	client.close();
+
+	// Requests whose reply differs
+	uint32_t n_printed = 0;
+	for (const SessionReplay::RequestResultStruct &r_req : result.requests)
+	{
+		if (r_req.isSame || n_printed++ >= n_max_diffs)
+			continue;
+		printf("diff record[%zu] type[%u] request[%s]\n", r_req.recordIndex, r_req.request.type, toHex(r_req.request.data).c_str());
+		printf("  recorded: %s\n", r_req.hasReply ? toHex(r_req.recorded.data).c_str() : "no reply");
+		if (r_req.status == GateLink::ST_OK)
+			printf("  replayed: %s\n", r_req.hasReply ? toHex(r_req.replayed.data).c_str() : "sent");
+		else
+			printf("  replayed: status[%u]\n", r_req.status);
+	}
+	if (n_printed > n_max_diffs)
+		printf("... %u more\n", n_printed - n_max_diffs);
+
+	printf("Requests[%zu] diffs[%u] unanswered frames recorded[%u] replayed[%u]%s\n", result.requests.size(), result.nDiffs,
+		   result.nExtraRecorded, result.nExtraReplayed, result.status == GateLink::ST_CLOSED ? " port lost" : "");
+
+	// Reply times per message type, only where both runs got the reply
+	std::map<uint8_t, std::pair<std::vector<double>, std::vector<double>>> dt_by_type;
+	for (const SessionReplay::RequestResultStruct &r_req : result.requests)
+		if (r_req.hasReply && r_req.status == GateLink::ST_OK)
+		{
+			dt_by_type[r_req.request.type].first.push_back(r_req.dtRecordedMs);
+			dt_by_type[r_req.request.type].second.push_back(r_req.dtReplayedMs);
+		}
+	printf("\n%-6s%8s%12s%12s%12s%12s%12s  (ms)\n", "type", "n", "rec_p50", "rec_p95", "rep_p50", "rep_p95", "d_p50");
+	for (auto &r_pair : dt_by_type)
+	{
+		std::vector<double> &r_rec = r_pair.second.first;
+		std::vector<double> &r_rep = r_pair.second.second;
+		std::sort(r_rec.begin(), r_rec.end());
+		std::sort(r_rep.begin(), r_rep.end());
+		printf("%-6u%8zu%12.3f%12.3f%12.3f%12.3f%+12.3f\n", r_pair.first, r_rec.size(), percentile(r_rec, 50), percentile(r_rec, 95),
+			   percentile(r_rep, 50), percentile(r_rep, 95), percentile(r_rep, 50) - percentile(r_rec, 50));
+	}
+	printf("\nSession recorded[%.3f s] replayed[%.3f s]\n", result.dtRecordedS, result.dtReplayedS);
+	return result.nDiffs > 0 || result.status != GateLink::ST_OK ? 1 : 0;
+}
+
+static int runDump(const char *p_path)
+{
+	SessionLog::SessionStruct session = loadSession(p_path);
+	printf("Records[%zu] started[%.6f]\n", session.records.size(), session.tsStartUnixUs / 1e6);
+	for (const SessionLog::RecordStruct &r_rec : session.records)
+	{
+		printf("%12.6f %s type[%2u] %s", r_rec.tsUs / 1e6,
+			   r_rec.kind == SessionLog::DEVICE_FRAME ? "<" : r_rec.kind == SessionLog::HOST_GO ? "> GO" : ">",
+			   r_rec.frame.type, toHex(r_rec.frame.data).c_str());
+		if (r_rec.kind == SessionLog::DEVICE_FRAME)
+			printf(" ts[%u]", r_rec.frame.ts);
+		printf("\n");
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t baud = 115200;
+	const char *p_out = "session.bin";
+	const char *p_link = nullptr;
+	uint32_t dt_timeout_ms = 10000;
+	uint32_t n_max_diffs = 20;
+	SessionReplay::OptionsStruct replay_opts;
+
+	static struct option opts[] = {
+		{"baud", required_argument, 0, 'b'},
+		{"out", required_argument, 0, 'o'},
+		{"link", required_argument, 0, 'l'},
+		{"speed", required_argument, 0, 's'},
+		{"max-gap-ms", required_argument, 0, 'g'},
+		{"no-gaps", no_argument, 0, 'n'},
+		{"timeout", required_argument, 0, 't'},
+		{"max-diffs", required_argument, 0, 'd'},
+		{"help", no_argument, 0, 'h'},
+		{0, 0, 0, 0}};
+	int opt;
+	while ((opt = getopt_long(argc, argv, "h", opts, nullptr)) != -1)
+	{
+		switch (opt)
+		{
+		case 'b':
+			baud = atoi(optarg);
+			break;
+		case 'o':
+			p_out = optarg;
+			break;
+		case 'l':
+			p_link = optarg;
+			break;
+		case 's':
+			replay_opts.speed = atof(optarg);
+			break;
+		case 'g':
+			replay_opts.dtMaxGapMs = atoi(optarg);
+			break;
+		case 'n':
+			replay_opts.isNoGaps = true;
+			break;
+		case 't':
+			dt_timeout_ms = atoi(optarg);
+			break;
+		case 'd':
+			n_max_diffs = atoi(optarg);
+			break;
+		default:
+			printUsage(argv[0]);
+			return opt == 'h' ? 0 : 2;
+		}
+	}
+	std::string cmd = optind < argc ? argv[optind] : "";
+	int n_args = argc - optind - 1;
+	if (cmd == "record" && n_args == 1)
+		return runRecord(argv[optind + 1], baud, p_out, p_link);
+	if (cmd == "replay" && n_args == 2 && replay_opts.speed > 0)
+		return runReplay(argv[optind + 1], argv[optind + 2], baud, dt_timeout_ms, replay_opts, n_max_diffs);
+	if (cmd == "dump" && n_args == 1)
+		return runDump(argv[optind + 1]);
+	printUsage(argv[0]);
+	return 2;
+}
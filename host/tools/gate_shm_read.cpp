@@ -0,0 +1,151 @@
+// ######################################
+
+//========== gate_shm_read.cpp ========
+
+// ######################################
+
+/// @file Reads the wall state gate_daemon publishes to shared memory, the way a tracking loop would.
+///
+/// @details Reads a snapshot at a fixed rate and prints the wall, moving and error bytes when
+/// the state changes. On exit prints the read cost and how long after each publish the change
+/// was first read, which is bounded by the read period.
+
+//============= INCLUDE ================
+#include "GateLink.h"
+#include "WallStateShm.h"
+#include <algorithm>
+#include <getopt.h>
+#include <signal.h>
+#include <thread>
+
+//============ VARIABLES ===============
+static volatile sig_atomic_t isStopped = 0;
+
+//============ FUNCTIONS ===============
+
+static void onSignal(int) { isStopped = 1; }
+
+static void printUsage(const char *p_name)
+{
+	printf("Usage: %s [options] NAME\n"
+		   "  --rate HZ          snapshot reads per second [default: 500]\n"
+		   "  --seconds S        stop after S seconds [default: until stopped]\n"
+		   "  --quiet            print only the summary\n",
+		   p_name);
+}
+
+// Get a percentile of a sorted list
+static double percentile(const std::vector<double> &r_vals, double pct)
+{
+	if (r_vals.empty())
+		return 0;
+	return r_vals[std::min(r_vals.size() - 1, (size_t)(pct / 100 * (r_vals.size() - 1) + 0.5))];
+}
+
+// Print the wall position, moving and error bytes of a wall state
+static void printState(const DaemonProtocol::WallStateStruct &r_state)
+{
+	printf("seq %u walls", r_state.seq);
+	for (const uint8_t *p_arr : {r_state.position, r_state.moving, r_state.error})
+	{
+		for (uint8_t cyp_i = 0; cyp_i < r_state.nChips; cyp_i++)
+			printf(" %02x", p_arr[cyp_i]);
+		if (p_arr != r_state.error)
+			printf(" %s", p_arr == r_state.position ? "moving" : "error");
+	}
+	printf("\n");
+	fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+	double rate_hz = 500;
+	double dt_run_s = -1;
+	bool is_quiet = false;
+
+	static struct option opts[] = {
+		{"rate", required_argument, 0, 'r'},
+		{"seconds", required_argument, 0, 's'},
+		{"quiet", no_argument, 0, 'q'},
+		{"help", no_argument, 0, 'h'},
+		{0, 0, 0, 0}};
+	int opt;
+	while ((opt = getopt_long(argc, argv, "h", opts, nullptr)) != -1)
+	{
+		switch (opt)
+		{
+		case 'r':
+			rate_hz = atof(optarg);
+			break;
+		case 's':
+			dt_run_s = atof(optarg);
+			break;
+		case 'q':
+			is_quiet = true;
+			break;
+		default:
+			printUsage(argv[0]);
+			return opt == 'h' ? 0 : 2;
+		}
+	}
+	if (optind != argc - 1 || rate_hz <= 0)
+	{
+		printUsage(argv[0]);
+		return 2;
+	}
+
+	WallStateReader reader;
+	if (!reader.open(argv[optind]))
+	{
+		fprintf(stderr, "gate_shm_read: no wall state in shared memory [%s], is gate_daemon running with --shm?\n", argv[optind]);
+		return 1;
+	}
+	signal(SIGINT, onSignal);
+	signal(SIGTERM, onSignal);
+
+	std::vector<double> dt_reads_ns;
+	std::vector<double> dt_ages_us;
+	uint32_t n_changes = 0;
+	uint32_t n_failed = 0;
+	uint32_t seq_last = 0;
+	uint64_t ts_last = 0;
+	uint64_t ts_start = GateLink::nowUs();
+	uint64_t dt_period_us = (uint64_t)(1e6 / rate_hz);
+	uint64_t ts_next = ts_start;
+	while (!isStopped && (dt_run_s < 0 || GateLink::nowUs() - ts_start < dt_run_s * 1e6))
+	{
+		DaemonProtocol::WallStateStruct state;
+		uint64_t ts_pub;
+		auto t_0 = std::chrono::steady_clock::now();
+		bool is_read = reader.read(state, &ts_pub);
+		auto t_1 = std::chrono::steady_clock::now();
+		dt_reads_ns.push_back(std::chrono::duration<double, std::nano>(t_1 - t_0).count());
+		if (!is_read)
+			n_failed++;
+		else if (ts_pub != ts_last || state.seq != seq_last)
+		{
+			// Skip the age of the state already there at start
+			if (ts_last != 0 || n_changes > 0)
+				dt_ages_us.push_back((double)(GateLink::nowUs() - ts_pub));
+			n_changes++;
+			seq_last = state.seq;
+			ts_last = ts_pub;
+			if (!is_quiet)
+				printState(state);
+		}
+		ts_next += dt_period_us;
+		uint64_t ts_now = GateLink::nowUs();
+		if (ts_next > ts_now)
+			std::this_thread::sleep_for(std::chrono::microseconds(ts_next - ts_now));
+	}
+
+	std::sort(dt_reads_ns.begin(), dt_reads_ns.end());
+	std::sort(dt_ages_us.begin(), dt_ages_us.end());
+	printf("gate_shm_read: reads[%zu] failed[%u] retries[%u] changes[%u] writer[%s]\n",
+		   dt_reads_ns.size(), n_failed, (unsigned)reader.nRetries, n_changes, reader.isWriterAlive() ? "alive" : "gone");
+	printf("  %-22sp50 %8.0f  p99 %8.0f  max %8.0f\n", "read (ns)",
+		   percentile(dt_reads_ns, 50), percentile(dt_reads_ns, 99), percentile(dt_reads_ns, 100));
+	printf("  %-22sp50 %8.0f  p99 %8.0f  max %8.0f\n", "publish to read (us)",
+		   percentile(dt_ages_us, 50), percentile(dt_ages_us, 99), percentile(dt_ages_us, 100));
+	return 0;
+}